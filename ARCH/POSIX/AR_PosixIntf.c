@@ -0,0 +1,639 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  AR_PosixIntf.c - POSIX Interface (POSIX Port)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "AR_PosixIntf.h"
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+/* Signal used as the system timer interrupt */
+#define AR_POSIX_TICK_SIGNAL            SIGALRM
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+static TPosixProc volatile arPreemptiveProc;
+
+static volatile sig_atomic_t arInterruptEnable;
+static volatile sig_atomic_t arDelayedContextSwitch;
+
+struct TTaskContext arCurrentTaskContext;
+static ucontext_t arMainContext;
+static sigset_t arTickSignalSet;
+static struct sigaction arPrevTickAction;
+static struct timespec arStartTime;
+
+static void *arReleasedContext;
+static void *arReleasedStack;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixFreeReleased
+ *
+ *  Description:
+ *    Frees the memory of a task context that was released while it was
+ *    still the running context. Must be called from another context.
+ *
+ ***************************************************************************/
+
+static void arPosixFreeReleased(void)
+{
+  /* Nothing to free */
+  if(!arReleasedContext)
+    return;
+
+  /* Release context memory and task stack */
+  free(arReleasedContext);
+  free(arReleasedStack);
+  arReleasedContext = NULL;
+  arReleasedStack = NULL;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixContextSwitch
+ *
+ *  Description:
+ *    Executes the preemptive procedure (scheduler) and switches to the
+ *    context selected by it. Must be called with the tick signal blocked.
+ *
+ ***************************************************************************/
+
+static void arPosixContextSwitch(void)
+{
+  ucontext_t *PrevContext;
+
+  /* Save interrupt enable state for the current task */
+  PrevContext = (ucontext_t *) arCurrentTaskContext.Context;
+  arCurrentTaskContext.InterruptEnable = (int) arInterruptEnable;
+
+  /* Scheduler is executed with interrupts disabled */
+  arInterruptEnable = 0;
+  arDelayedContextSwitch = 0;
+
+  /* Execute the Preemption Handler (Scheduler call) */
+  if(arPreemptiveProc)
+    arPreemptiveProc(&arCurrentTaskContext);
+
+  /* Restore interrupt enable flag for the current task (now the new task) */
+  arInterruptEnable = arCurrentTaskContext.InterruptEnable;
+
+  /* Switch to the new task context. Execution continues here when the
+     preempted task is selected again. */
+  if(arCurrentTaskContext.Context != PrevContext)
+  {
+    swapcontext(PrevContext, (ucontext_t *) arCurrentTaskContext.Context);
+    arPosixFreeReleased();
+  }
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixTickHandler
+ *
+ *  Description:
+ *    Timer signal handler that simulates the cyclic system interrupt. It
+ *    forces a context switch, or delays it when interrupts are disabled.
+ *
+ *  Parameters:
+ *    Signal - Unused parameter.
+ *
+ ***************************************************************************/
+
+static void arPosixTickHandler(int Signal)
+{
+  int PrevErrNo;
+
+  /* Mark unused parameters */
+  (void) Signal;
+
+  /* Interrupts are disabled, the switch is performed by arPosixRestore */
+  if(!arInterruptEnable)
+  {
+    arDelayedContextSwitch = 1;
+    return;
+  }
+
+  /* Force a context switch (preserve errno of the preempted task) */
+  PrevErrNo = errno;
+  arPosixContextSwitch();
+  errno = PrevErrNo;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixSetTimer
+ *
+ *  Description:
+ *    Programs the system timer.
+ *
+ *  Parameters:
+ *    Interval - Time to the next tick in milliseconds (0 stops the timer).
+ *    Periodic - If non-zero, the timer fires every Interval milliseconds.
+ *
+ *  Return:
+ *    TRUE (1) on success, FALSE (0) on failure.
+ *
+ ***************************************************************************/
+
+static int arPosixSetTimer(unsigned long Interval, int Periodic)
+{
+  struct itimerval Timer;
+
+  /* Convert milliseconds to the timer value */
+  memset(&Timer, 0, sizeof(Timer));
+  Timer.it_value.tv_sec = (time_t) (Interval / 1000UL);
+  Timer.it_value.tv_usec = (suseconds_t) ((Interval % 1000UL) * 1000UL);
+  if(Periodic)
+    Timer.it_interval = Timer.it_value;
+
+  /* Start or stop the timer */
+  return !setitimer(ITIMER_REAL, &Timer, NULL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixInit
+ *
+ *  Description:
+ *    Initializes the platform-specific interface components.
+ *
+ *  Return:
+ *    TRUE (1) on success, FALSE (0) on failure.
+ *
+ ***************************************************************************/
+
+int arPosixInit(void)
+{
+  struct sigaction TickAction;
+
+  /* Initialize global variables */
+  arPreemptiveProc = NULL;
+  arReleasedContext = NULL;
+  arReleasedStack = NULL;
+  arDelayedContextSwitch = 0;
+
+  /* Interrupts are disabled until the first task is started */
+  arInterruptEnable = 0;
+
+  /* Define the current thread as the initial system context */
+  memset(&arCurrentTaskContext, 0, sizeof(arCurrentTaskContext));
+  arCurrentTaskContext.Context = &arMainContext;
+
+  /* Tick counter starts at initialization */
+  if(clock_gettime(CLOCK_MONOTONIC, &arStartTime))
+    return 0;
+
+  /* Install the timer signal handler. Further ticks are blocked while the
+     handler runs. */
+  sigemptyset(&arTickSignalSet);
+  sigaddset(&arTickSignalSet, AR_POSIX_TICK_SIGNAL);
+
+  memset(&TickAction, 0, sizeof(TickAction));
+  TickAction.sa_handler = arPosixTickHandler;
+  TickAction.sa_mask = arTickSignalSet;
+  TickAction.sa_flags = SA_RESTART;
+  if(sigaction(AR_POSIX_TICK_SIGNAL, &TickAction, &arPrevTickAction))
+    return 0;
+
+  /* Start periodic timer */
+  if(!arPosixSetTimer(AR_POSIX_CTX_SWITCH_INTERVAL, 1))
+  {
+    sigaction(AR_POSIX_TICK_SIGNAL, &arPrevTickAction, NULL);
+    return 0;
+  }
+
+  /* Initialization success */
+  return 1;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixDeinit
+ *
+ *  Description:
+ *    Deinitializes the platform interface and releases resources.
+ *
+ ***************************************************************************/
+
+void arPosixDeinit(void)
+{
+  /* Stop the periodic timer */
+  arPosixSetTimer(0UL, 0);
+
+  /* Restore previous signal handler */
+  arPreemptiveProc = NULL;
+  sigaction(AR_POSIX_TICK_SIGNAL, &arPrevTickAction, NULL);
+
+  /* Free the context released last */
+  arPosixFreeReleased();
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixLock
+ *
+ *  Description:
+ *    Disables "interrupts" by clearing the interrupt enable flag.
+ *
+ *  Return:
+ *    The previous state of the interrupt enable flag (1 if enabled, 0 otherwise).
+ *
+ ***************************************************************************/
+
+int arPosixLock(void)
+{
+  int PrevLockState;
+
+  /* Capture current interrupt enable status and disable interrupts. A tick
+     between both operations switches the context and restores the flag
+     before execution continues here. */
+  PrevLockState = (int) arInterruptEnable;
+  arInterruptEnable = 0;
+
+  /* Return previous state */
+  return PrevLockState;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixRestore
+ *
+ *  Description:
+ *    Restores the interrupt enable flag to the specified state.
+ *
+ *  Parameters:
+ *    PreviousLockState - The previous state of the interrupt enable flag.
+ *
+ ***************************************************************************/
+
+void arPosixRestore(int PrevLockState)
+{
+  /* Restore the state of the interrupt flag if it was previously enabled */
+  if(PrevLockState)
+  {
+    /* Enable interrupts */
+    arInterruptEnable = 1;
+
+    /* If a context switch was delayed during the lock, force it now */
+    if(arDelayedContextSwitch)
+      arPosixYield();
+  }
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixYield
+ *
+ *  Description:
+ *    Voluntarily yields execution of the current task.
+ *
+ ***************************************************************************/
+
+void arPosixYield(void)
+{
+  sigset_t PrevMask;
+
+  /* Block the timer signal for the time of the switch */
+  sigprocmask(SIG_BLOCK, &arTickSignalSet, &PrevMask);
+
+  /* Force a context switch */
+  arPosixContextSwitch();
+
+  /* Restore signal mask (scheduler resumed us) */
+  sigprocmask(SIG_SETMASK, &PrevMask, NULL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixSavePower
+ *
+ *  Description:
+ *    Called when the CPU is idle. Switches to power-save mode (suspends
+ *    execution) until an interrupt occurs.
+ *
+ ***************************************************************************/
+
+void arPosixSavePower(void)
+{
+  sigset_t PrevMask;
+
+  /* Block the timer signal to avoid losing a tick before suspending */
+  sigprocmask(SIG_BLOCK, &arTickSignalSet, &PrevMask);
+
+  /* Halt execution until the timer interrupt arrives */
+  if(!arDelayedContextSwitch)
+    sigsuspend(&PrevMask);
+
+  /* Restore signal mask */
+  sigprocmask(SIG_SETMASK, &PrevMask, NULL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixTicklessIdle
+ *
+ *  Description:
+ *    Replaces the periodic tick with a one-shot timer and suspends
+ *    execution until it fires. The tick counter follows the monotonic
+ *    host clock, so it needs no compensation after wakeup. Called with
+ *    interrupts disabled, the wakeup tick is delayed until arPosixRestore.
+ *
+ *  Parameters:
+ *    Ticks - Time to sleep in milliseconds (0 to sleep until a signal).
+ *
+ ***************************************************************************/
+
+void arPosixTicklessIdle(unsigned long Ticks)
+{
+  sigset_t PrevMask;
+
+  /* Block the timer signal to avoid losing the wakeup before suspending */
+  sigprocmask(SIG_BLOCK, &arTickSignalSet, &PrevMask);
+
+  /* Skip if a tick is already pending */
+  if(!arDelayedContextSwitch)
+  {
+    /* Program one-shot wakeup and halt execution */
+    arPosixSetTimer(Ticks, 0);
+    sigsuspend(&PrevMask);
+
+    /* Restart periodic timer */
+    arPosixSetTimer(AR_POSIX_CTX_SWITCH_INTERVAL, 1);
+  }
+
+  /* Restore signal mask */
+  sigprocmask(SIG_SETMASK, &PrevMask, NULL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixGetTickCount
+ *
+ *  Description:
+ *    Returns the total number of system timer ticks elapsed.
+ *
+ *  Return:
+ *    Total number of timer ticks.
+ *
+ ***************************************************************************/
+
+unsigned long arPosixGetTickCount(void)
+{
+  struct timespec Now;
+
+  /* Return milliseconds elapsed since initialization */
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (unsigned long) ((Now.tv_sec - arStartTime.tv_sec) * 1000L +
+    (Now.tv_nsec - arStartTime.tv_nsec) / 1000000L);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixGetCycleCount
+ *
+ *  Description:
+ *    Returns the number of nanoseconds elapsed since initialization.
+ *
+ *  Return:
+ *    Nanosecond counter (wraps around).
+ *
+ ***************************************************************************/
+
+unsigned long arPosixGetCycleCount(void)
+{
+  struct timespec Now;
+
+  /* Return nanoseconds elapsed since initialization */
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (unsigned long) (Now.tv_sec - arStartTime.tv_sec) * 1000000000UL +
+    (unsigned long) (Now.tv_nsec - arStartTime.tv_nsec);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixSetPreemptiveHandler
+ *
+ *  Description:
+ *    Sets the handler for the preemptive procedure (scheduler).
+ *
+ *  Parameters:
+ *    PreemptiveProc - Pointer to the handler function (or NULL to disable).
+ *    StackSize - Stack size expected for the handler call.
+ *
+ *  Return:
+ *    TRUE (1) on success, FALSE (0) on failure.
+ *
+ ***************************************************************************/
+
+int arPosixSetPreemptiveHandler(TPosixProc PreemptiveProc,
+  unsigned long StackSize)
+{
+  sigset_t PrevMask;
+
+  /* Stack size validation */
+  if(PreemptiveProc && !StackSize)
+    return 0;
+
+  /* Register the preemptive procedure */
+  sigprocmask(SIG_BLOCK, &arTickSignalSet, &PrevMask);
+  arPreemptiveProc = PreemptiveProc;
+  sigprocmask(SIG_SETMASK, &PrevMask, NULL);
+
+  /* Success */
+  return 1;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixTaskStartup
+ *
+ *  Description:
+ *    Wrapper procedure that executes the task startup code.
+ *
+ ***************************************************************************/
+
+static void arPosixTaskStartup(void)
+{
+  /* The previous task may have been released while running */
+  arPosixFreeReleased();
+
+  /* Execute the task startup procedure using the global context.
+     Note: The scheduler has already copied the context of this task into
+     arCurrentTaskContext. */
+  arCurrentTaskContext.TaskStartupProc(&arCurrentTaskContext);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixCreateTaskContext
+ *
+ *  Description:
+ *    Creates a new task context.
+ *    WARNING: The TaskStartupProc must not return. It should contain an
+ *    infinite loop or the task must be terminated explicitly.
+ *
+ *  Parameters:
+ *    TaskContext - Pointer to the task context structure.
+ *    TaskStartupProc - Pointer to the task entry function.
+ *    StackSize - Size of the task stack.
+ *
+ *  Return:
+ *    TRUE (1) on success, FALSE (0) on failure.
+ *
+ ***************************************************************************/
+
+int arPosixCreateTaskContext(struct TTaskContext *TaskContext,
+  TPosixProc TaskStartupProc, unsigned long StackSize)
+{
+  ucontext_t *Context;
+
+  /* Host stack frames are larger than on the target */
+  if(StackSize < AR_POSIX_MIN_STACK_SIZE)
+    StackSize = AR_POSIX_MIN_STACK_SIZE;
+
+  /* Enable interrupts by default for the new task */
+  TaskContext->InterruptEnable = 1;
+
+  /* Initialize task context fields */
+  TaskContext->TaskStartupProc = TaskStartupProc;
+
+  /* Allocate machine context and task stack */
+  Context = (ucontext_t *) malloc(sizeof(*Context));
+  if(!Context)
+    return 0;
+
+  TaskContext->Stack = malloc(StackSize);
+  if(!TaskContext->Stack || getcontext(Context))
+  {
+    free(TaskContext->Stack);
+    free(Context);
+    return 0;
+  }
+
+  /* The task starts with the timer signal unblocked */
+  Context->uc_stack.ss_sp = TaskContext->Stack;
+  Context->uc_stack.ss_size = (size_t) StackSize;
+  Context->uc_link = NULL;
+  sigemptyset(&Context->uc_sigmask);
+  makecontext(Context, arPosixTaskStartup, 0);
+
+  /* Success */
+  TaskContext->Context = Context;
+  return 1;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    arPosixReleaseTaskContext
+ *
+ *  Description:
+ *    Releases a task context and associated system resources.
+ *
+ *  Parameters:
+ *    TaskContext - Pointer to the task context structure.
+ *
+ *  Return:
+ *    TRUE (1) on success, FALSE (0) on failure.
+ *
+ ***************************************************************************/
+
+int arPosixReleaseTaskContext(struct TTaskContext *TaskContext)
+{
+  sigset_t PrevMask;
+
+  /* Enter critical section */
+  sigprocmask(SIG_BLOCK, &arTickSignalSet, &PrevMask);
+
+  /* The running stack can not be freed now, release it after the next
+     context switch */
+  if(TaskContext->Context == arCurrentTaskContext.Context)
+  {
+    arPosixFreeReleased();
+    arReleasedContext = TaskContext->Context;
+    arReleasedStack = TaskContext->Stack;
+  }
+
+  /* Release context memory and task stack */
+  else
+  {
+    free(TaskContext->Context);
+    free(TaskContext->Stack);
+  }
+
+  TaskContext->Context = NULL;
+  TaskContext->Stack = NULL;
+
+  /* Leave critical section */
+  sigprocmask(SIG_SETMASK, &PrevMask, NULL);
+
+  /* Success */
+  return 1;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  AR_PosixIntf.h - POSIX Interface (POSIX Port)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef AR_POSIX_INTF_H
+#define AR_POSIX_INTF_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "Config.h"
+
+
+/****************************************************************************
+ *
+ *  Default configuration
+ *
+ ***************************************************************************/
+
+/* Defines the context switch interval in milliseconds. Default value: 1 ms */
+#ifndef AR_POSIX_CTX_SWITCH_INTERVAL
+  #define AR_POSIX_CTX_SWITCH_INTERVAL  1
+#elif (AR_POSIX_CTX_SWITCH_INTERVAL) < 1
+  #error AR_POSIX_CTX_SWITCH_INTERVAL must be greater than zero
+#endif
+
+/* Minimum task stack size in bytes. Task stacks on the host must also hold
+   the frames of the timer signal handler and of the C library calls made
+   by the tasks, so smaller requests are rounded up to this value. */
+#ifndef AR_POSIX_MIN_STACK_SIZE
+  #define AR_POSIX_MIN_STACK_SIZE       0x10000UL
+#elif (AR_POSIX_MIN_STACK_SIZE) < 0x4000UL
+  #error AR_POSIX_MIN_STACK_SIZE must be at least 16 kB
+#endif
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+struct TTaskContext;
+
+/* Function callbacks */
+typedef void (* TPosixProc)(struct TTaskContext *TaskContext);
+
+/* Task context structure */
+struct TTaskContext
+{
+  void *Arg;
+  TPosixProc TaskStartupProc;
+
+  int InterruptEnable;
+
+  void *Context;
+  void *Stack;
+};
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  int arPosixInit(void);
+  void arPosixDeinit(void);
+
+  int arPosixLock(void);
+  void arPosixRestore(int PrevLockState);
+
+  unsigned long arPosixGetTickCount(void);
+  unsigned long arPosixGetCycleCount(void);
+
+  int arPosixSetPreemptiveHandler(TPosixProc PreemptiveProc,
+    unsigned long StackSize);
+  void arPosixYield(void);
+
+  int arPosixCreateTaskContext(struct TTaskContext *TaskContext,
+    TPosixProc TaskStartupProc, unsigned long StackSize);
+  int arPosixReleaseTaskContext(struct TTaskContext *TaskContext);
+
+  void arPosixSavePower(void);
+  void arPosixTicklessIdle(unsigned long Ticks);
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* AR_POSIX_INTF_H */
+/***************************************************************************/
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Bench.c - Benchmark support (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Pseudo-random generator state */
+static UINT32 bnRandomState = 0x12345678UL;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnGetTime
+ *
+ *  Description:
+ *    Returns the value of the monotonic host clock.
+ *
+ *  Return:
+ *    Current time in nanoseconds.
+ *
+ ***************************************************************************/
+
+BNTIME bnGetTime(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return ((BNTIME) Now.tv_sec) * 1000000000ULL + (BNTIME) Now.tv_nsec;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnRandomSeed
+ *
+ *  Description:
+ *    Sets the seed of the pseudo-random generator, so every benchmark run
+ *    uses the same sequence of operations.
+ *
+ *  Parameters:
+ *    Seed - Non-zero seed value.
+ *
+ ***************************************************************************/
+
+void bnRandomSeed(UINT32 Seed)
+{
+  bnRandomState = Seed ? Seed : 0x12345678UL;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnRandom
+ *
+ *  Description:
+ *    Returns the next value of the xorshift pseudo-random generator.
+ *
+ *  Return:
+ *    Pseudo-random 32-bit value.
+ *
+ ***************************************************************************/
+
+UINT32 bnRandom(void)
+{
+  bnRandomState ^= bnRandomState << 13;
+  bnRandomState ^= bnRandomState >> 17;
+  bnRandomState ^= bnRandomState << 5;
+  return bnRandomState;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnSampleCmp
+ *
+ *  Description:
+ *    Compares two samples (qsort callback).
+ *
+ *  Parameters:
+ *    Item1 - Pointer to first sample.
+ *    Item2 - Pointer to second sample.
+ *
+ *  Return:
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
+ *
+ ***************************************************************************/
+
+static int bnSampleCmp(const void *Item1, const void *Item2)
+{
+  double S1, S2;
+
+  S1 = *(const double *) Item1;
+  S2 = *(const double *) Item2;
+  return (S1 < S2) ? -1 : ((S1 > S2) ? 1 : 0);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnReport
+ *
+ *  Description:
+ *    Sorts the samples and prints a single JSON line with their median,
+ *    99th percentile, minimum, maximum and mean.
+ *
+ *  Parameters:
+ *    Name - Benchmark name.
+ *    Variant - Name of the measured configuration.
+ *    Count - Problem size (e.g. number of objects).
+ *    Samples - Array of samples in nanoseconds (sorted on return).
+ *    SampleCount - Number of samples.
+ *
+ ***************************************************************************/
+
+void bnReport(const char *Name, const char *Variant, UINT32 Count,
+  double *Samples, UINT32 SampleCount)
+{
+  double Sum;
+  UINT32 i;
+
+  /* Nothing was measured */
+  if(!SampleCount)
+    return;
+
+  /* Sort samples and sum them up */
+  qsort(Samples, SampleCount, sizeof(double), bnSampleCmp);
+  for(Sum = 0.0, i = 0; i < SampleCount; i++)
+    Sum += Samples[i];
+
+  /* Print results */
+  printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"n\":%lu,\"samples\":%lu,"
+    "\"median_ns\":%.1f,\"p99_ns\":%.1f,\"min_ns\":%.1f,\"max_ns\":%.1f,"
+    "\"mean_ns\":%.1f}\n", Name, Variant, (unsigned long) Count,
+    (unsigned long) SampleCount, Samples[SampleCount / 2],
+    Samples[(SampleCount * 99UL) / 100], Samples[0],
+    Samples[SampleCount - 1], Sum / SampleCount);
+  fflush(stdout);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnReportValue
+ *
+ *  Description:
+ *    Prints a single JSON line with a measured value that is not a time
+ *    distribution (e.g. a ratio or a count).
+ *
+ *  Parameters:
+ *    Name - Benchmark name.
+ *    Variant - Name of the measured configuration.
+ *    Key - Name of the value.
+ *    Value - Measured value.
+ *
+ ***************************************************************************/
+
+void bnReportValue(const char *Name, const char *Variant, const char *Key,
+  double Value)
+{
+  printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"%s\":%.4f}\n", Name,
+    Variant, Key, Value);
+  fflush(stdout);
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Bench.h - Benchmark support (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef BN_BENCH_H
+#define BN_BENCH_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_API.h"
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Benchmark time in nanoseconds */
+typedef unsigned long long BNTIME;
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  BNTIME bnGetTime(void);
+
+  UINT32 bnRandom(void);
+  void bnRandomSeed(UINT32 Seed);
+
+  void bnReport(const char *Name, const char *Variant, UINT32 Count,
+    double *Samples, UINT32 SampleCount);
+  void bnReportValue(const char *Name, const char *Variant, const char *Key,
+    double Value);
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* BN_BENCH_H */
+/***************************************************************************/
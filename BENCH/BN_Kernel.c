@@ -0,0 +1,750 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Kernel.c - Kernel microbenchmark suite (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of samples of each benchmark */
+#define BN_SAMPLE_COUNT                 20000
+
+/* Number of messages sent before they are received in IPC benchmarks */
+#define BN_IPC_BATCH                    16
+
+/* Number of samples of each IPC benchmark (batches) */
+#define BN_IPC_SAMPLE_COUNT             2000
+
+/* Largest IPC message size */
+#define BN_IPC_MAX_SIZE                 1024
+
+/* Size of blocks allocated in memory benchmarks */
+#define BN_BLOCK_SIZE                   64
+
+/* Size of the memory pools */
+#define BN_POOL_SIZE                    0x10000UL
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* IPC message sizes */
+static const SIZE bnMessageSize[] = {4, 16, 64, 256, BN_IPC_MAX_SIZE};
+
+/* Objects shared with the helper tasks */
+static HANDLE bnPing;
+static HANDLE bnPong;
+static HANDLE bnMutex;
+
+/* Helper task stop request */
+static volatile BOOL bnStop;
+
+/* Message buffers */
+static UINT8 bnMessage[BN_IPC_BATCH * BN_IPC_MAX_SIZE];
+
+/* Memory pools */
+static PVOID bnHeapPool[BN_POOL_SIZE / sizeof(PVOID)];
+static PVOID bnFixedPool[BN_POOL_SIZE / sizeof(PVOID)];
+
+/* Samples in nanoseconds */
+static double bnSamples[BN_SAMPLE_COUNT];
+static double bnSamples2[BN_SAMPLE_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnJoin
+ *
+ *  Description:
+ *    Waits for the task completion, checks its exit code and closes the
+ *    task handle.
+ *
+ *  Parameters:
+ *    Task - Task handle (may be NULL_HANDLE).
+ *
+ *  Return:
+ *    TRUE when the task succeeded or FALSE otherwise.
+ *
+ ***************************************************************************/
+
+static BOOL bnJoin(HANDLE Task)
+{
+  ERROR ExitCode;
+  BOOL Success;
+
+  if(!Task)
+    return FALSE;
+
+  osWaitForObject(Task, OS_INFINITE);
+  Success = (BOOL) (osGetTaskExitCode(Task, &ExitCode) && !ExitCode);
+  osCloseHandle(Task);
+  return Success;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnYieldTask
+ *
+ *  Description:
+ *    Yields the processor until it is asked to stop.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnYieldTask(PVOID Arg)
+{
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  while(!bnStop)
+    osSleep(OS_IGNORE);
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnYield
+ *
+ *  Description:
+ *    Measures osSleep(OS_IGNORE) with no other ready task of the same
+ *    priority and with one, when it includes two context switches.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnYield(void)
+{
+  HANDLE Task;
+  BNTIME Start;
+  UINT32 i;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    osSleep(OS_IGNORE);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+  bnReport("yield", "no_switch", 1, bnSamples, BN_SAMPLE_COUNT);
+
+  /* Task of the same priority starts at the first yield */
+  bnStop = FALSE;
+  Task = osCreateTask(bnYieldTask, NULL, 0, 2, FALSE);
+  if(!Task)
+    return FALSE;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    osSleep(OS_IGNORE);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  bnStop = TRUE;
+  if(!bnJoin(Task))
+    return FALSE;
+
+  bnReport("yield", "two_switches", 2, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnPongTask
+ *
+ *  Description:
+ *    Answers BN_SAMPLE_COUNT pings of the benchmark task.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnPongTask(PVOID Arg)
+{
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    if(!osWaitForObject(bnPing, OS_INFINITE))
+      return 1;
+    if(!osReleaseCountSem(bnPong, 1, NULL))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnPingPong
+ *
+ *  Description:
+ *    Measures the round trip of a counting semaphore released to a waiting
+ *    task of higher priority which answers by another semaphore.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnPingPong(void)
+{
+  HANDLE Task;
+  BNTIME Start;
+  BOOL Success;
+  UINT32 i;
+
+  bnPing = osCreateCountSem(NULL, 0, 1);
+  bnPong = osCreateCountSem(NULL, 0, 1);
+  if(!bnPing || !bnPong)
+    return FALSE;
+
+  /* Pong task starts waiting immediately */
+  Task = osCreateTask(bnPongTask, NULL, 0, 1, FALSE);
+  Success = (BOOL) (Task != NULL_HANDLE);
+
+  for(i = 0; Success && (i < BN_SAMPLE_COUNT); i++)
+  {
+    Start = bnGetTime();
+    Success = (BOOL) (osReleaseCountSem(bnPing, 1, NULL) &&
+      osWaitForObject(bnPong, OS_INFINITE));
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  Success = (BOOL) (bnJoin(Task) && Success);
+  osCloseHandle(bnPing);
+  osCloseHandle(bnPong);
+  if(!Success)
+    return FALSE;
+
+  bnReport("sem_ping_pong", "count_sem", 2, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnContenderTask
+ *
+ *  Description:
+ *    Waits BN_SAMPLE_COUNT times for the mutex owned by the benchmark task
+ *    of lower priority, which inherits the priority of this task.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnContenderTask(PVOID Arg)
+{
+  BNTIME Start;
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    if(!osWaitForObject(bnPing, OS_INFINITE))
+      return 1;
+
+    Start = bnGetTime();
+    if(!osWaitForObject(bnMutex, OS_INFINITE))
+      return 1;
+    if(!osReleaseMutex(bnMutex))
+      return 1;
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnMutexLock
+ *
+ *  Description:
+ *    Measures the mutex lock and unlock without contention and with a task
+ *    of higher priority blocked on the mutex. In the latter case a sample
+ *    spans the priority inheritance, two context switches and the release
+ *    of the inherited priority.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnMutexLock(void)
+{
+  HANDLE Task;
+  BNTIME Start;
+  BOOL Success;
+  UINT32 i;
+
+  bnMutex = osCreateMutex(NULL, FALSE);
+  bnPing = osCreateCountSem(NULL, 0, 1);
+  if(!bnMutex || !bnPing)
+    return FALSE;
+
+  /* Uncontended */
+  Success = TRUE;
+  for(i = 0; Success && (i < BN_SAMPLE_COUNT); i++)
+  {
+    Start = bnGetTime();
+    Success = (BOOL) (osWaitForObject(bnMutex, OS_INFINITE) &&
+      osReleaseMutex(bnMutex));
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+  if(Success)
+    bnReport("mutex_lock_unlock", "uncontended", 1, bnSamples,
+      BN_SAMPLE_COUNT);
+
+  /* Contender blocks on the mutex owned by this task */
+  Task = osCreateTask(bnContenderTask, NULL, 0, 1, FALSE);
+  Success = (BOOL) (Success && (Task != NULL_HANDLE));
+  for(i = 0; Success && (i < BN_SAMPLE_COUNT); i++)
+    Success = (BOOL) (osWaitForObject(bnMutex, OS_INFINITE) &&
+      osReleaseCountSem(bnPing, 1, NULL) && osReleaseMutex(bnMutex));
+
+  Success = (BOOL) (bnJoin(Task) && Success);
+  osCloseHandle(bnMutex);
+  osCloseHandle(bnPing);
+  if(!Success)
+    return FALSE;
+
+  bnReport("mutex_lock_unlock", "contended_pi", 2, bnSamples,
+    BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnIPCReport
+ *
+ *  Description:
+ *    Reports the time per message and the throughput of an IPC object.
+ *
+ *  Parameters:
+ *    Name - Benchmark name.
+ *    Size - Message size.
+ *
+ ***************************************************************************/
+
+static void bnIPCReport(const char *Name, SIZE Size)
+{
+  char Variant[32];
+
+  sprintf(Variant, "%lu_bytes", (unsigned long) Size);
+  bnReport(Name, Variant, (UINT32) Size, bnSamples, BN_IPC_SAMPLE_COUNT);
+
+  /* Samples are sorted, throughput of the median */
+  bnReportValue(Name, Variant, "mbytes_per_sec", (double) Size * 1000.0 /
+    bnSamples[BN_IPC_SAMPLE_COUNT / 2]);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnIPC
+ *
+ *  Description:
+ *    Measures Queue, Stream, Mailbox and PtrQueue by message size. Every
+ *    sample is the time of BN_IPC_BATCH messages sent and received by this
+ *    task divided by BN_IPC_BATCH. PtrQueue messages are pointers, so it
+ *    is measured only once.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnIPC(void)
+{
+  struct TIORequest IORequest;
+  HANDLE Handle;
+  BNTIME Start;
+  PVOID Ptr;
+  BOOL Success;
+  SIZE Size;
+  UINT32 i, j, k;
+
+  Success = TRUE;
+  for(k = 0; Success && (k < sizeof(bnMessageSize) / sizeof(SIZE)); k++)
+  {
+    Size = bnMessageSize[k];
+
+    /* Queue */
+    Handle = osCreateQueue(NULL, OS_IPC_PROTECT_INT_CTRL, BN_IPC_BATCH,
+      Size);
+    if(!Handle)
+      return FALSE;
+
+    for(i = 0; Success && (i < BN_IPC_SAMPLE_COUNT); i++)
+    {
+      Start = bnGetTime();
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= osQueuePost(Handle, &bnMessage[j * Size]);
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= osQueuePend(Handle, &bnMessage[j * Size]);
+      bnSamples[i] = (double) (bnGetTime() - Start) / BN_IPC_BATCH;
+    }
+
+    osCloseHandle(Handle);
+    if(Success)
+      bnIPCReport("ipc_queue", Size);
+
+    /* Stream */
+    Handle = osCreateStream(NULL, OS_IPC_PROTECT_INT_CTRL,
+      BN_IPC_BATCH * Size);
+    if(!Handle)
+      return FALSE;
+
+    IORequest.Timeout = 0;
+    for(i = 0; Success && (i < BN_IPC_SAMPLE_COUNT); i++)
+    {
+      Start = bnGetTime();
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= osWrite(Handle, &bnMessage[j * Size], Size, &IORequest);
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= osRead(Handle, &bnMessage[j * Size], Size, &IORequest);
+      bnSamples[i] = (double) (bnGetTime() - Start) / BN_IPC_BATCH;
+    }
+
+    osCloseHandle(Handle);
+    if(Success)
+      bnIPCReport("ipc_stream", Size);
+
+    /* Mailbox */
+    Handle = osCreateMailbox(NULL, OS_IPC_PROTECT_INT_CTRL);
+    if(!Handle)
+      return FALSE;
+
+    for(i = 0; Success && (i < BN_IPC_SAMPLE_COUNT); i++)
+    {
+      Start = bnGetTime();
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= (BOOL) (osMailboxPost(Handle, &bnMessage[j * Size],
+          Size) == Size);
+      for(j = 0; j < BN_IPC_BATCH; j++)
+        Success &= (BOOL) (osMailboxPend(Handle, &bnMessage[j * Size],
+          Size) == Size);
+      bnSamples[i] = (double) (bnGetTime() - Start) / BN_IPC_BATCH;
+    }
+
+    osCloseHandle(Handle);
+    if(Success)
+      bnIPCReport("ipc_mailbox", Size);
+  }
+
+  /* Pointer queue */
+  Handle = osCreatePtrQueue(NULL, BN_IPC_BATCH);
+  if(!Handle)
+    return FALSE;
+
+  for(i = 0; Success && (i < BN_IPC_SAMPLE_COUNT); i++)
+  {
+    Start = bnGetTime();
+    for(j = 0; j < BN_IPC_BATCH; j++)
+      Success &= osPtrQueuePost(Handle, &bnMessage[j]);
+    for(j = 0; j < BN_IPC_BATCH; j++)
+      Success &= osPtrQueuePend(Handle, &Ptr);
+    bnSamples[i] = (double) (bnGetTime() - Start) / BN_IPC_BATCH;
+  }
+
+  osCloseHandle(Handle);
+  if(Success)
+    bnIPCReport("ipc_ptr_queue", sizeof(PVOID));
+  return Success;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnTimer
+ *
+ *  Description:
+ *    Measures arming and canceling of a timer.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnTimer(void)
+{
+  HANDLE Timer;
+  BNTIME Start;
+  BOOL Success;
+  UINT32 i;
+
+  Timer = osCreateTimer(NULL, FALSE);
+  if(!Timer)
+    return FALSE;
+
+  Success = TRUE;
+  for(i = 0; Success && (i < BN_SAMPLE_COUNT); i++)
+  {
+    Start = bnGetTime();
+    Success = osSetTimer(Timer, 1000, 1);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+
+    Start = bnGetTime();
+    Success &= osCancelTimer(Timer);
+    bnSamples2[i] = (double) (bnGetTime() - Start);
+  }
+
+  osCloseHandle(Timer);
+  if(!Success)
+    return FALSE;
+
+  bnReport("timer_arm", "single", 1, bnSamples, BN_SAMPLE_COUNT);
+  bnReport("timer_cancel", "single", 1, bnSamples2, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnEmptyTask
+ *
+ *  Description:
+ *    Returns immediately.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnEmptyTask(PVOID Arg)
+{
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnTaskChurn
+ *
+ *  Description:
+ *    Measures creating a task of higher priority, which runs to its end
+ *    immediately, and closing its handle.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnTaskChurn(void)
+{
+  HANDLE Task;
+  BNTIME Start;
+  UINT32 i;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    Task = osCreateTask(bnEmptyTask, NULL, 0, 1, FALSE);
+    if(!Task || !osCloseHandle(Task))
+      return FALSE;
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  bnReport("task_churn", "create_run_close", 1, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnMemory
+ *
+ *  Description:
+ *    Measures allocation and release of a BN_BLOCK_SIZE block by the heap
+ *    allocator and by the fixed-size block allocator.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnMemory(void)
+{
+  BNTIME Start;
+  PVOID Block;
+  UINT32 i;
+
+  /* Heap allocator */
+  if(!stMemoryInit(bnHeapPool, sizeof(bnHeapPool)))
+    return FALSE;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    Block = stMemoryAlloc(bnHeapPool, BN_BLOCK_SIZE);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+    if(!Block)
+      return FALSE;
+
+    Start = bnGetTime();
+    stMemoryFree(bnHeapPool, Block);
+    bnSamples2[i] = (double) (bnGetTime() - Start);
+  }
+
+  bnReport("block_alloc", "heap", BN_BLOCK_SIZE, bnSamples, BN_SAMPLE_COUNT);
+  bnReport("block_free", "heap", BN_BLOCK_SIZE, bnSamples2, BN_SAMPLE_COUNT);
+
+  /* Fixed-size block allocator */
+  if(!stFixedMemInit(bnFixedPool, sizeof(bnFixedPool), BN_BLOCK_SIZE))
+    return FALSE;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    Block = stFixedMemAlloc(bnFixedPool);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+    if(!Block)
+      return FALSE;
+
+    Start = bnGetTime();
+    stFixedMemFree(bnFixedPool, Block);
+    bnSamples2[i] = (double) (bnGetTime() - Start);
+  }
+
+  bnReport("block_alloc", "fixed", BN_BLOCK_SIZE, bnSamples,
+    BN_SAMPLE_COUNT);
+  bnReport("block_free", "fixed", BN_BLOCK_SIZE, bnSamples2,
+    BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnKernelTask
+ *
+ *  Description:
+ *    Runs all benchmarks of the suite.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnKernelTask(PVOID Arg)
+{
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  if(bnYield() && bnPingPong() && bnMutexLock() && bnIPC() && bnTimer() &&
+    bnTaskChurn() && bnMemory())
+    bnExitCode = 0;
+  else
+    printf("Benchmark failed (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+
+  /* Run the benchmark task */
+  osCreateTask(bnKernelTask, NULL, 0, 2, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,424 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Latency.c - Latency histogram dump (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of periods of the periodic task */
+#define BN_PERIOD_COUNT                 200
+
+/* Number of mutex acquisitions and queue messages */
+#define BN_SAMPLE_COUNT                 5000
+
+/* Maximum time the mutex is held or a message is delayed (ns) */
+#define BN_MAX_DELAY                    20000
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Objects of the workload */
+static HANDLE bnEvent;
+static HANDLE bnMutex;
+static HANDLE bnQueue;
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/***************************************************************************/
+#if (OS_USE_LATENCY_HISTOGRAM)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnDelay
+ *
+ *  Description:
+ *    Busy waits for a random time up to BN_MAX_DELAY.
+ *
+ ***************************************************************************/
+
+static void bnDelay(void)
+{
+  BNTIME Start, Delay;
+
+  Delay = (BNTIME) (bnRandom() % BN_MAX_DELAY);
+  Start = bnGetTime();
+  while((bnGetTime() - Start) < Delay);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnPeriodicTask
+ *
+ *  Description:
+ *    Sleeps BN_PERIOD_COUNT times for a single tick, the way a control loop
+ *    waits for its next period.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnPeriodicTask(PVOID Arg)
+{
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_PERIOD_COUNT; i++)
+    if(!osSleep(1))
+      return 1;
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnContenderTask
+ *
+ *  Description:
+ *    Waits for the event and then for the mutex owned by the benchmark task
+ *    BN_SAMPLE_COUNT times.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnContenderTask(PVOID Arg)
+{
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    if(!osWaitForObject(bnEvent, OS_INFINITE))
+      return 1;
+    if(!osWaitForObject(bnMutex, OS_INFINITE))
+      return 1;
+    if(!osReleaseMutex(bnMutex))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnConsumerTask
+ *
+ *  Description:
+ *    Receives BN_SAMPLE_COUNT messages from the queue.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnConsumerTask(PVOID Arg)
+{
+  UINT32 i, Message;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+    if(!osQueuePend(bnQueue, &Message))
+      return 1;
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnJoin
+ *
+ *  Description:
+ *    Waits for the task completion and checks its exit code. The handle is
+ *    not closed, so that the histograms of the task can still be read.
+ *
+ *  Parameters:
+ *    Task - Task handle (may be NULL_HANDLE).
+ *
+ *  Return:
+ *    TRUE when the task succeeded or FALSE otherwise.
+ *
+ ***************************************************************************/
+
+static BOOL bnJoin(HANDLE Task)
+{
+  ERROR ExitCode;
+
+  if(!Task)
+    return FALSE;
+
+  osWaitForObject(Task, OS_INFINITE);
+  return (BOOL) (osGetTaskExitCode(Task, &ExitCode) && !ExitCode);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnDump
+ *
+ *  Description:
+ *    Prints a JSON line with the histogram, the median and the 99th
+ *    percentile. Percentiles are the upper bounds of the buckets they fall
+ *    in, so they are overestimated at most twice.
+ *
+ *  Parameters:
+ *    Name - Name of the task or the object.
+ *    Handle - Task or object handle.
+ *    Kind - OS_LATENCY_WAIT or OS_LATENCY_READY.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnDump(const char *Name, HANDLE Handle, UINT8 Kind)
+{
+  UINT32 Buckets[OS_LATENCY_BUCKET_COUNT];
+  double Count, Sum, Median, Tail, Bound;
+  int i, First;
+
+  if(!osGetLatencyHistogram(Handle, Kind, Buckets, FALSE))
+    return FALSE;
+
+  Count = 0.0;
+  for(i = 0; i < (OS_LATENCY_BUCKET_COUNT); i++)
+    Count += (double) Buckets[i];
+
+  /* Upper bound of bucket i is 2^(i+1) cycles */
+  Sum = 0.0;
+  Median = Tail = 0.0;
+  Bound = 2.0 * 1e9 / (double) (OS_CYCLES_PER_SECOND);
+  for(i = 0; i < (OS_LATENCY_BUCKET_COUNT); i++, Bound *= 2.0)
+  {
+    Sum += (double) Buckets[i];
+    if((Median == 0.0) && (Sum >= Count * 0.5))
+      Median = Bound;
+    if((Tail == 0.0) && (Sum >= Count * 0.99))
+      Tail = Bound;
+  }
+
+  printf("{\"bench\":\"latency\",\"variant\":\"%s\",\"kind\":\"%s\","
+    "\"count\":%.0f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"buckets\":[", Name,
+    (Kind == OS_LATENCY_READY) ? "ready" : "wait", Count, Median, Tail);
+
+  /* Lower bound of each non-empty bucket in nanoseconds and its count */
+  First = 1;
+  Bound = 1e9 / (double) (OS_CYCLES_PER_SECOND);
+  for(i = 0; i < (OS_LATENCY_BUCKET_COUNT); i++, Bound *= 2.0)
+    if(Buckets[i])
+    {
+      printf("%s[%.1f,%lu]", First ? "" : ",", i ? Bound : 0.0,
+        (unsigned long) Buckets[i]);
+      First = 0;
+    }
+
+  printf("]}\n");
+  fflush(stdout);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWorkload
+ *
+ *  Description:
+ *    Runs a periodic task, a task contending for a mutex owned by this task
+ *    and a task consuming messages from a queue, then dumps their latency
+ *    histograms.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnWorkload(void)
+{
+  HANDLE Periodic, Contender, Consumer;
+  BOOL Success;
+  UINT32 i;
+
+  /* Periodic task (higher priority) runs while this task waits for it */
+  Periodic = osCreateTask(bnPeriodicTask, NULL, 0, 1, FALSE);
+  Success = bnJoin(Periodic);
+
+  /* Contender blocks on the mutex while this task holds it */
+  Contender = osCreateTask(bnContenderTask, NULL, 0, 1, FALSE);
+  for(i = 0; Success && Contender && (i < BN_SAMPLE_COUNT); i++)
+  {
+    Success = osWaitForObject(bnMutex, OS_INFINITE);
+    if(Success)
+      Success = osSetEvent(bnEvent);
+    bnDelay();
+    if(Success)
+      Success = osReleaseMutex(bnMutex);
+  }
+  Success = (BOOL) (bnJoin(Contender) && Success);
+
+  /* Consumer waits for messages sent after random delays */
+  Consumer = osCreateTask(bnConsumerTask, NULL, 0, 1, FALSE);
+  for(i = 0; Success && Consumer && (i < BN_SAMPLE_COUNT); i++)
+  {
+    bnDelay();
+    Success = osQueuePost(bnQueue, &i);
+  }
+  Success = (BOOL) (bnJoin(Consumer) && Success);
+
+  /* Dump the histograms */
+  if(Success)
+    Success = (BOOL) (bnDump("periodic_task", Periodic, OS_LATENCY_READY) &&
+      bnDump("contender_task", Contender, OS_LATENCY_READY) &&
+      bnDump("consumer_task", Consumer, OS_LATENCY_READY) &&
+      bnDump("event", bnEvent, OS_LATENCY_WAIT) &&
+      bnDump("mutex", bnMutex, OS_LATENCY_WAIT) &&
+      bnDump("queue", bnQueue, OS_LATENCY_WAIT));
+
+  if(Periodic)
+    osCloseHandle(Periodic);
+  if(Contender)
+    osCloseHandle(Contender);
+  if(Consumer)
+    osCloseHandle(Consumer);
+  return Success;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_LATENCY_HISTOGRAM */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnLatencyTask
+ *
+ *  Description:
+ *    Creates the objects and runs the workload.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnLatencyTask(PVOID Arg)
+{
+  BOOL Success;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  bnEvent = osCreateEvent(NULL, FALSE, FALSE);
+  bnMutex = osCreateMutex(NULL, FALSE);
+  bnQueue = osCreateQueue(NULL, OS_IPC_PROTECT_INT_CTRL |
+    OS_IPC_WAIT_IF_EMPTY, 16, sizeof(UINT32));
+  Success = (BOOL) (bnEvent && bnMutex && bnQueue);
+
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    if(Success)
+      Success = bnWorkload();
+  #else
+    if(Success)
+      printf("Latency histograms are disabled "
+        "(build with DEFS=-DOS_USE_LATENCY_HISTOGRAM=1)\n");
+  #endif
+
+  if(Success)
+    bnExitCode = 0;
+  else
+    printf("Benchmark failed (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+
+  /* Run the benchmark task */
+  osCreateTask(bnLatencyTask, NULL, 0, 2, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_MemOps.c - Memory block operations benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "ST_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Largest measured block size */
+#define BN_MAX_SIZE                     0x10000UL
+
+/* Number of samples of each block size */
+#define BN_SAMPLE_COUNT                 200
+
+/* Minimal number of bytes processed by a single sample */
+#define BN_SAMPLE_BYTES                 0x4000UL
+
+/* Name of the measured implementation */
+#if (ST_USE_MEMORY_CLIB)
+  #define BN_VARIANT                    "clib"
+#elif (ST_USE_MEMORY_SIMD)
+  #define BN_VARIANT                    "simd"
+#elif (ST_USE_MEMORY_WORDS)
+  #define BN_VARIANT                    "word"
+#else
+  #define BN_VARIANT                    "byte"
+#endif
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Source and destination buffers (one extra word for misalignment) */
+static PVOID bnSource[(BN_MAX_SIZE + 64) / sizeof(PVOID)];
+static PVOID bnDest[(BN_MAX_SIZE + 64) / sizeof(PVOID)];
+
+/* Samples in nanoseconds per operation */
+static double bnSamples[BN_SAMPLE_COUNT];
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnMeasure
+ *
+ *  Description:
+ *    Measures one memory block operation with the specified size and
+ *    buffer offsets and prints the results.
+ *
+ *  Parameters:
+ *    Name - Benchmark name.
+ *    Operation - 0 for stMemCpy, 1 for stMemMove (overlapping blocks),
+ *      2 for stMemSet and 3 for stMemCmp.
+ *    Size - Block size in bytes.
+ *    DestOffset - Offset of the destination block.
+ *    SourceOffset - Offset of the source block.
+ *
+ ***************************************************************************/
+
+static void bnMeasure(const char *Name, int Operation, SIZE Size,
+  SIZE DestOffset, SIZE SourceOffset)
+{
+  UINT8 *Dest, *Source;
+  UINT32 i, j, Count;
+  BNTIME Start;
+  volatile int Result;
+
+  Dest = (UINT8 *) bnDest + DestOffset;
+  Source = (UINT8 *) bnSource + SourceOffset;
+  if(Operation == 1)
+    Source = Dest + 8;
+
+  /* Repeat small operations to get measurable samples */
+  Count = (UINT32) (BN_SAMPLE_BYTES / Size);
+  if(!Count)
+    Count = 1;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    for(j = 0; j < Count; j++)
+      switch(Operation)
+      {
+        case 0:
+          stMemCpy(Dest, Source, Size);
+          break;
+
+        case 1:
+          stMemMove(Dest, Source, Size - 8);
+          break;
+
+        case 2:
+          stMemSet(Dest, 0x5A, Size);
+          break;
+
+        default:
+          Result = stMemCmp(Dest, Source, Size);
+          break;
+      }
+    bnSamples[i] = (double) (bnGetTime() - Start) / Count;
+  }
+
+  (void) Result;
+  bnReport(Name, BN_VARIANT, Size, bnSamples, BN_SAMPLE_COUNT);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Measures stMemCpy, stMemMove, stMemSet and stMemCmp with block sizes
+ *    from 1 byte to 64 kB. The "n" field of the results is the block size.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  SIZE Size;
+
+  /* Identical buffers, so stMemCmp always compares the whole block */
+  stMemSet(bnSource, 0x5A, sizeof(bnSource));
+  stMemSet(bnDest, 0x5A, sizeof(bnDest));
+
+  for(Size = 1; Size <= BN_MAX_SIZE; Size <<= 1)
+  {
+    bnMeasure("memcpy_aligned", 0, Size, 0, 0);
+    bnMeasure("memcpy_same_offset", 0, Size, 3, 3);
+    bnMeasure("memcpy_misaligned", 0, Size, 0, 1);
+    if(Size > 8)
+      bnMeasure("memmove_overlap", 1, Size, 0, 0);
+    bnMeasure("memset", 2, Size, 1, 0);
+    bnMeasure("memcmp", 3, Size, 0, 0);
+  }
+
+  return 0;
+}
+
+
+/***************************************************************************/
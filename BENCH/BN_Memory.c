@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Memory.c - Memory Management benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "ST_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Size of the memory pool used for latency measurement */
+#define BN_LATENCY_POOL_SIZE            0x100000UL
+
+/* Size of the memory pool used for fragmentation measurement */
+#define BN_FRAGMENT_POOL_SIZE           0x40000UL
+
+/* Maximum number of simultaneously allocated blocks */
+#define BN_SLOT_COUNT                   1024
+
+/* Number of random allocations and releases */
+#define BN_OPERATION_COUNT              200000UL
+
+/* Name of the measured allocator */
+#if (ST_USE_TLSF_MEMORY)
+  #define BN_VARIANT                    "tlsf"
+#else
+  #define BN_VARIANT                    "tree"
+#endif
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Memory pools */
+static PVOID bnLatencyPool[BN_LATENCY_POOL_SIZE / sizeof(PVOID)];
+static PVOID bnFragmentPool[BN_FRAGMENT_POOL_SIZE / sizeof(PVOID)];
+
+/* Allocated blocks and their sizes */
+static PVOID bnBlock[BN_SLOT_COUNT];
+static SIZE bnBlockSize[BN_SLOT_COUNT];
+
+/* Samples in nanoseconds per operation */
+static double bnAllocSamples[BN_OPERATION_COUNT];
+static double bnFreeSamples[BN_OPERATION_COUNT];
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnRandomSize
+ *
+ *  Description:
+ *    Returns a random block size. Most of the blocks are small kernel
+ *    object descriptors, some are buffers and a few are task stacks.
+ *
+ *  Return:
+ *    Block size in bytes.
+ *
+ ***************************************************************************/
+
+static SIZE bnRandomSize(void)
+{
+  UINT32 Class;
+
+  Class = bnRandom() % 100;
+  if(Class < 70)
+    return (SIZE) (8 + bnRandom() % 120);
+  if(Class < 95)
+    return (SIZE) (128 + bnRandom() % 896);
+  return (SIZE) (1024 + bnRandom() % 7168);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnLargestBlock
+ *
+ *  Description:
+ *    Finds the size of the largest block that can be allocated from the
+ *    memory pool (binary search with allocations).
+ *
+ *  Parameters:
+ *    MemoryPool - Memory pool start address.
+ *    Limit - Upper limit of the block size.
+ *
+ *  Return:
+ *    Size of the largest block that can be allocated.
+ *
+ ***************************************************************************/
+
+static SIZE bnLargestBlock(PVOID MemoryPool, SIZE Limit)
+{
+  SIZE Low, High, Mid;
+  PVOID Ptr;
+
+  Low = 0;
+  High = Limit;
+  while(Low < High)
+  {
+    Mid = Low + (High - Low + 1) / 2;
+    Ptr = stMemoryAlloc(MemoryPool, Mid);
+    if(Ptr)
+    {
+      stMemoryFree(MemoryPool, Ptr);
+      Low = Mid;
+    }
+    else
+      High = Mid - 1;
+  }
+
+  return Low;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Measures the latency of random allocations and releases with a
+ *    mixed block size distribution, and the fragmentation of a small pool
+ *    under the same workload.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  UINT32 i, Slot, AllocCount, FreeCount, Failures;
+  SIZE Used;
+  ULONG TotalMemory, FreeMemory;
+  double UsedAtFailure;
+  BNTIME Start;
+
+  /* Initialize standard library and the latency memory pool */
+  stInit();
+  if(!stMemoryInit(bnLatencyPool, sizeof(bnLatencyPool)))
+    return 1;
+  bnRandomSeed(1);
+
+  /* Random allocations and releases, about half of the slots are used */
+  AllocCount = 0;
+  FreeCount = 0;
+  for(i = 0; i < BN_OPERATION_COUNT; i++)
+  {
+    Slot = bnRandom() % BN_SLOT_COUNT;
+    if(bnBlock[Slot])
+    {
+      Start = bnGetTime();
+      stMemoryFree(bnLatencyPool, bnBlock[Slot]);
+      bnFreeSamples[FreeCount++] = (double) (bnGetTime() - Start);
+      bnBlock[Slot] = NULL;
+    }
+    else
+    {
+      bnBlockSize[Slot] = bnRandomSize();
+      Start = bnGetTime();
+      bnBlock[Slot] = stMemoryAlloc(bnLatencyPool, bnBlockSize[Slot]);
+      bnAllocSamples[AllocCount++] = (double) (bnGetTime() - Start);
+    }
+  }
+
+  bnReport("memory_alloc", BN_VARIANT, BN_SLOT_COUNT, bnAllocSamples,
+    AllocCount);
+  bnReport("memory_free", BN_VARIANT, BN_SLOT_COUNT, bnFreeSamples,
+    FreeCount);
+
+  /* Same workload in a pool too small for all slots */
+  for(i = 0; i < BN_SLOT_COUNT; i++)
+    bnBlock[i] = NULL;
+  if(!stMemoryInit(bnFragmentPool, sizeof(bnFragmentPool)))
+    return 1;
+  stMemoryGetInfo(bnFragmentPool, &TotalMemory, &FreeMemory);
+
+  Used = 0;
+  Failures = 0;
+  UsedAtFailure = 0.0;
+  for(i = 0; i < BN_OPERATION_COUNT; i++)
+  {
+    Slot = bnRandom() % BN_SLOT_COUNT;
+    if(bnBlock[Slot])
+    {
+      stMemoryFree(bnFragmentPool, bnBlock[Slot]);
+      bnBlock[Slot] = NULL;
+      Used -= bnBlockSize[Slot];
+      continue;
+    }
+
+    bnBlockSize[Slot] = bnRandomSize();
+    bnBlock[Slot] = stMemoryAlloc(bnFragmentPool, bnBlockSize[Slot]);
+    if(bnBlock[Slot])
+      Used += bnBlockSize[Slot];
+    else
+    {
+      /* Requested bytes in use when an allocation fails */
+      UsedAtFailure += (double) Used / (double) FreeMemory;
+      Failures++;
+    }
+  }
+
+  /* Largest allocatable block compared to all free memory */
+  stMemoryGetInfo(bnFragmentPool, NULL, &FreeMemory);
+  bnReportValue("memory_fragmentation", BN_VARIANT, "used_at_failure",
+    Failures ? UsedAtFailure / Failures : 1.0);
+  bnReportValue("memory_fragmentation", BN_VARIANT, "largest_free_ratio",
+    FreeMemory ? (double) bnLargestBlock(bnFragmentPool,
+    (SIZE) FreeMemory) / (double) FreeMemory : 1.0);
+  bnReportValue("memory_fragmentation", BN_VARIANT, "failed_allocations",
+    (double) Failures);
+
+  return 0;
+}
+
+
+/***************************************************************************/
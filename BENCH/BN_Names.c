@@ -0,0 +1,219 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Names.c - Named object registry benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of named objects */
+#define BN_OBJECT_COUNT                 10000
+
+/* Number of operations measured by a single sample */
+#define BN_BATCH_SIZE                   16
+
+/* Number of samples of the open operation */
+#define BN_SAMPLE_COUNT                 20000
+
+/* Name of the measured name registry */
+#if ((OS_NAME_HASH_SIZE) > 0UL)
+  #define BN_VARIANT                    "hash"
+#else
+  #define BN_VARIANT                    "tree"
+#endif
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Object names and handles */
+static char bnName[BN_OBJECT_COUNT][OS_SYS_OBJECT_MAX_NAME_LEN];
+static HANDLE bnHandle[BN_OBJECT_COUNT];
+
+/* Samples in nanoseconds per operation */
+static double bnCreateSamples[BN_OBJECT_COUNT / BN_BATCH_SIZE];
+static double bnOpenSamples[BN_SAMPLE_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnOpenTask
+ *
+ *  Description:
+ *    Measures opening random events by their names. Each opened event is
+ *    closed again, so the list of objects opened by this task stays short
+ *    and the measured time is dominated by the name lookup.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnOpenTask(PVOID Arg)
+{
+  HANDLE Handle[BN_BATCH_SIZE];
+  INDEX Index[BN_BATCH_SIZE];
+  BNTIME Start;
+  UINT32 i, j;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  /* Open random objects by their names */
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      Index[j] = (INDEX) (bnRandom() %
+        (BN_OBJECT_COUNT / BN_BATCH_SIZE * BN_BATCH_SIZE));
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      Handle[j] = osOpenEvent(bnName[Index[j]]);
+    bnOpenSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      osCloseHandle(Handle[j]);
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnNamesTask
+ *
+ *  Description:
+ *    Creates BN_OBJECT_COUNT named events, then runs the task opening
+ *    them by their names (objects can be opened only by a task).
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnNamesTask(PVOID Arg)
+{
+  HANDLE OpenTask;
+  BNTIME Start;
+  UINT32 i, j, k;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  /* Prepare unique names */
+  for(i = 0; i < BN_OBJECT_COUNT; i++)
+    snprintf(bnName[i], OS_SYS_OBJECT_MAX_NAME_LEN, "E%05lu",
+      (unsigned long) i);
+
+  /* Create all named objects, stop at the first failure */
+  for(i = 0; i < BN_OBJECT_COUNT / BN_BATCH_SIZE; i++)
+  {
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+    {
+      k = i * BN_BATCH_SIZE + j;
+      bnHandle[k] = osCreateEvent(bnName[k], FALSE, FALSE);
+      if(!bnHandle[k])
+      {
+        printf("Cannot create object %lu (error 0x%04X)\n",
+          (unsigned long) k, (unsigned) osGetLastError());
+        while(k)
+          osCloseHandle(bnHandle[--k]);
+        osStop();
+        return 1;
+      }
+    }
+    bnCreateSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+  }
+
+  /* Measure opening by a task with higher priority (it runs to its
+     completion before this call returns) */
+  OpenTask = osCreateTask(bnOpenTask, NULL, 0, 0, FALSE);
+  if(!OpenTask)
+  {
+    osStop();
+    return 1;
+  }
+  osCloseHandle(OpenTask);
+
+  /* Report results */
+  bnReport("names_create", BN_VARIANT, BN_OBJECT_COUNT, bnCreateSamples,
+    BN_OBJECT_COUNT / BN_BATCH_SIZE);
+  bnReport("names_open", BN_VARIANT, BN_OBJECT_COUNT, bnOpenSamples,
+    BN_SAMPLE_COUNT);
+
+  /* Release all objects */
+  for(i = 0; i < BN_OBJECT_COUNT / BN_BATCH_SIZE * BN_BATCH_SIZE; i++)
+    osCloseHandle(bnHandle[i]);
+
+  bnExitCode = 0;
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+  bnRandomSeed(1);
+
+  /* Run the benchmark task */
+  osCreateTask(bnNamesTask, NULL, 0, 1, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
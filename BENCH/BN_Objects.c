@@ -0,0 +1,224 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Objects.c - System object churn benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of simultaneously existing objects of a single type */
+#define BN_SLOT_COUNT                   256
+
+/* Number of operations measured by a single sample */
+#define BN_BATCH_SIZE                   8
+
+/* Number of samples for each object type */
+#define BN_SAMPLE_COUNT                 20000
+
+/* Name of the measured allocator */
+#if (OS_USE_SLAB)
+  #define BN_VARIANT                    "slab"
+#else
+  #define BN_VARIANT                    "heap"
+#endif
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Object creation function */
+typedef HANDLE (*TBNCreateProc)(void);
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Existing objects */
+static HANDLE bnHandle[BN_SLOT_COUNT];
+
+/* Samples in nanoseconds per operation */
+static double bnSamples[BN_SAMPLE_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Object creation functions
+ *
+ ***************************************************************************/
+
+static HANDLE bnCreateEvent(void)
+{
+  return osCreateEvent(NULL, FALSE, FALSE);
+}
+
+static HANDLE bnCreateTimer(void)
+{
+  return osCreateTimer(NULL, FALSE);
+}
+
+static HANDLE bnCreateQueue(void)
+{
+  return osCreateQueue(NULL, OS_IPC_PROTECT_INT_CTRL, 8, 16);
+}
+
+static HANDLE bnCreateMailbox(void)
+{
+  return osCreateMailbox(NULL, OS_IPC_PROTECT_INT_CTRL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnChurn
+ *
+ *  Description:
+ *    Keeps BN_SLOT_COUNT objects alive and measures closing a random
+ *    object and creating a new one in its place.
+ *
+ *  Parameters:
+ *    Name - Benchmark name.
+ *    Create - Object creation function.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnChurn(const char *Name, TBNCreateProc Create)
+{
+  INDEX Index[BN_BATCH_SIZE];
+  BNTIME Start;
+  UINT32 i, j;
+
+  /* Create initial objects */
+  for(i = 0; i < BN_SLOT_COUNT; i++)
+  {
+    bnHandle[i] = Create();
+    if(!bnHandle[i])
+      return FALSE;
+  }
+
+  /* Replace random objects */
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      Index[j] = (INDEX) (bnRandom() % BN_SLOT_COUNT);
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+    {
+      osCloseHandle(bnHandle[Index[j]]);
+      bnHandle[Index[j]] = Create();
+    }
+    bnSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      if(!bnHandle[Index[j]])
+        return FALSE;
+  }
+
+  /* Release all objects */
+  for(i = 0; i < BN_SLOT_COUNT; i++)
+    osCloseHandle(bnHandle[i]);
+
+  bnReport(Name, BN_VARIANT, BN_SLOT_COUNT, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnObjectsTask
+ *
+ *  Description:
+ *    Runs the churn benchmark for each object type (objects can be closed
+ *    only by a task).
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnObjectsTask(PVOID Arg)
+{
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  if(bnChurn("objects_event", bnCreateEvent) &&
+    bnChurn("objects_timer", bnCreateTimer) &&
+    bnChurn("objects_queue", bnCreateQueue) &&
+    bnChurn("objects_mailbox", bnCreateMailbox))
+    bnExitCode = 0;
+  else
+    printf("Cannot create object (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+  bnRandomSeed(1);
+
+  /* Run the benchmark task */
+  osCreateTask(bnObjectsTask, NULL, 0, 1, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
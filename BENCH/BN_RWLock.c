@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_RWLock.c - Read-heavy lock throughput benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of tasks accessing the shared data */
+#define BN_WORKER_COUNT                 4
+
+/* Number of accesses made by a single task */
+#define BN_ACCESS_COUNT                 500
+
+/* Time (in ticks) for which a task blocks while it owns the lock */
+#define BN_HOLD_TIME                    1
+
+/* Percentage of accesses modifying the shared data */
+#define BN_WRITE_PERCENT                5
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Lock protecting the shared data and its kind */
+static HANDLE bnLock;
+static BOOL bnUseRWLock;
+
+/* Samples in nanoseconds per access */
+static double bnSamples[BN_WORKER_COUNT * BN_ACCESS_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWorkerTask
+ *
+ *  Description:
+ *    Reads or modifies the shared data BN_ACCESS_COUNT times. The task
+ *    blocks for BN_HOLD_TIME while it owns the lock, the same way it would
+ *    wait for a device in the middle of a longer access.
+ *
+ *  Parameters:
+ *    Arg - Array receiving the samples of this task.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnWorkerTask(PVOID Arg)
+{
+  double FAR *Samples;
+  BNTIME Start;
+  BOOL Write, Locked;
+  UINT32 i;
+
+  Samples = (double FAR *) Arg;
+  for(i = 0; i < BN_ACCESS_COUNT; i++)
+  {
+    Write = (BOOL) ((bnRandom() % 100) < BN_WRITE_PERCENT);
+
+    /* Acquire the lock (every access is exclusive with the mutex) */
+    Start = bnGetTime();
+    Locked = bnUseRWLock ? osAcquireRWLock(bnLock, Write, OS_INFINITE) :
+      osWaitForObject(bnLock, OS_INFINITE);
+    if(!Locked)
+      return 1;
+
+    /* Let other tasks run in the middle of the access */
+    osSleep(BN_HOLD_TIME);
+
+    if(!(bnUseRWLock ? osReleaseRWLock(bnLock) : osReleaseMutex(bnLock)))
+      return 1;
+    Samples[i] = (double) (bnGetTime() - Start);
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnReadHeavy
+ *
+ *  Description:
+ *    Runs BN_WORKER_COUNT tasks with the same priority accessing the data
+ *    protected by the specified lock and reports the access times and the
+ *    total throughput.
+ *
+ *  Parameters:
+ *    UseRWLock - TRUE to protect the data by a reader-writer lock, FALSE
+ *      to protect it by a mutex.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnReadHeavy(BOOL UseRWLock)
+{
+  HANDLE Worker[BN_WORKER_COUNT];
+  ERROR ExitCode;
+  BNTIME Start, Elapsed;
+  BOOL Success;
+  INDEX i;
+
+  /* Create the lock */
+  bnUseRWLock = UseRWLock;
+  bnLock = UseRWLock ? osCreateRWLock(NULL, BN_WORKER_COUNT, FALSE) :
+    osCreateMutex(NULL, FALSE);
+  if(!bnLock)
+    return FALSE;
+
+  /* Workers start when this task (higher priority) waits for them */
+  for(i = 0; i < BN_WORKER_COUNT; i++)
+  {
+    Worker[i] = osCreateTask(bnWorkerTask,
+      (PVOID) &bnSamples[i * BN_ACCESS_COUNT], 0, 2, FALSE);
+    if(!Worker[i])
+      return FALSE;
+  }
+
+  /* Wait for all workers */
+  Success = TRUE;
+  Start = bnGetTime();
+  for(i = 0; i < BN_WORKER_COUNT; i++)
+  {
+    osWaitForObject(Worker[i], OS_INFINITE);
+    if(!osGetTaskExitCode(Worker[i], &ExitCode) || ExitCode)
+      Success = FALSE;
+    osCloseHandle(Worker[i]);
+  }
+  Elapsed = bnGetTime() - Start;
+  osCloseHandle(bnLock);
+
+  if(!Success)
+    return FALSE;
+
+  /* Report results */
+  bnReport("rwlock_read_heavy", UseRWLock ? "rwlock" : "mutex",
+    BN_WORKER_COUNT, bnSamples, BN_WORKER_COUNT * BN_ACCESS_COUNT);
+  bnReportValue("rwlock_read_heavy", UseRWLock ? "rwlock" : "mutex",
+    "accesses_per_sec", (double) BN_WORKER_COUNT * BN_ACCESS_COUNT *
+    1e9 / (double) Elapsed);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnRWLockTask
+ *
+ *  Description:
+ *    Runs the read-heavy benchmark for both kinds of locks.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnRWLockTask(PVOID Arg)
+{
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  if(bnReadHeavy(FALSE) && bnReadHeavy(TRUE))
+    bnExitCode = 0;
+  else
+    printf("Benchmark failed (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+  bnRandomSeed(1);
+
+  /* Run the benchmark task */
+  osCreateTask(bnRWLockTask, NULL, 0, 1, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,343 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_TimeNotify.c - Time notification benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_Core.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of concurrently registered time notifications */
+#define BN_WAITER_COUNT                 10000
+
+/* Number of operations measured by a single sample */
+#define BN_BATCH_SIZE                   16
+
+/* Number of samples of the steady state operations */
+#define BN_SAMPLE_COUNT                 20000
+
+/* Timeouts are spread up to this number of time units */
+#define BN_MAX_TIMEOUT                  60000UL
+
+/* Number of tasks sleeping with spread timeouts in the expiry benchmark */
+#define BN_SLEEPER_COUNT                1000
+
+/* Number of measured ticks of the expiry benchmark */
+#define BN_TICK_COUNT                   3000
+
+/* Sleep times of the expiry benchmark up to the first, second and third
+   timing wheel level (in time units) */
+#define BN_SHORT_TIMEOUT                32UL
+#define BN_MEDIUM_TIMEOUT               1024UL
+#define BN_LONG_TIMEOUT                 2048UL
+
+/* Name of the measured time notification backend */
+#if (OS_USE_TIME_WHEEL)
+  #define BN_VARIANT                    "wheel"
+#else
+  #define BN_VARIANT                    "pqueue"
+#endif
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Time notification descriptors and their tasks (one task per priority) */
+static struct TTimeNotify bnTimeNotify[BN_WAITER_COUNT];
+static struct TTask bnTask[OS_LOWEST_USED_PRIORITY + 1];
+
+/* Samples in nanoseconds per operation */
+static double bnArmSamples[BN_WAITER_COUNT / BN_BATCH_SIZE];
+static double bnCancelSamples[BN_SAMPLE_COUNT];
+static double bnRearmSamples[BN_SAMPLE_COUNT];
+static double bnRestartSamples[BN_SAMPLE_COUNT];
+
+/* Sleep time ranges of the expiry benchmark */
+static TIME bnSleepRange[] = {1, BN_SHORT_TIMEOUT, BN_MEDIUM_TIMEOUT,
+  BN_LONG_TIMEOUT};
+
+/* Tasks of the expiry benchmark and the number of their expired sleeps */
+static HANDLE bnSleeper[BN_SLEEPER_COUNT];
+static volatile UINT32 bnExpired;
+static volatile BOOL bnStop;
+
+/* Samples in nanoseconds per tick and per expired notification */
+static double bnTickSamples[BN_TICK_COUNT];
+static double bnExpireSamples[BN_TICK_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnSleeperTask
+ *
+ *  Description:
+ *    Sleeps repeatedly until the benchmark stops. Every sleep time is
+ *    random within the range selected by the task argument, so the time
+ *    notifications of all tasks are spread over the timing wheel levels.
+ *
+ *  Parameters:
+ *    Arg - Pointer to the shortest sleep time of the range in
+ *      bnSleepRange, the next item is the end of the range.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnSleeperTask(PVOID Arg)
+{
+  TIME FAR *Range;
+
+  /* Sleep time range of this task */
+  Range = (TIME FAR *) Arg;
+
+  while(!bnStop)
+  {
+    if(!osSleep(Range[0] + bnRandom() % (Range[1] - Range[0])))
+      return 1;
+    bnExpired++;
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnExpiryTask
+ *
+ *  Description:
+ *    Runs BN_SLEEPER_COUNT tasks with higher priorities sleeping with
+ *    spread timeouts and measures the processing of BN_TICK_COUNT ticks.
+ *    At the start of each tick the task yields with interrupts disabled,
+ *    so the measured time covers advancing the time notifications by one
+ *    tick (the timing wheel cascade) and releasing all sleepers expired
+ *    in it until they sleep again.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnExpiryTask(PVOID Arg)
+{
+  ERROR ExitCode;
+  BNTIME Start, Elapsed;
+  TIME Tick;
+  UINT32 i, Expired, ExpireCount, TotalExpired;
+  BOOL PrevLockState;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  /* Sleepers start sleeping as soon as they are created */
+  for(i = 0; i < BN_SLEEPER_COUNT; i++)
+  {
+    bnSleeper[i] = osCreateTask(bnSleeperTask, (PVOID) &bnSleepRange[i % 3], 0,
+      (UINT8) (1 + i % (OS_LOWEST_USED_PRIORITY - 1)), FALSE);
+    if(!bnSleeper[i])
+    {
+      printf("Benchmark failed (error 0x%04X)\n",
+        (unsigned) osGetLastError());
+      osStop();
+      return 0;
+    }
+  }
+
+  /* Measure processing of single ticks */
+  ExpireCount = 0;
+  TotalExpired = 0;
+  for(i = 0; i < BN_TICK_COUNT; i++)
+  {
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* Wait for the next tick */
+    Tick = arGetTickCount();
+    while(arGetTickCount() == Tick);
+
+    Expired = bnExpired;
+    Start = bnGetTime();
+    osSleep(OS_IGNORE);
+    Elapsed = bnGetTime() - Start;
+    Expired = bnExpired - Expired;
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+
+    bnTickSamples[i] = (double) Elapsed;
+    if(Expired)
+    {
+      bnExpireSamples[ExpireCount++] = (double) Elapsed / Expired;
+      TotalExpired += Expired;
+    }
+  }
+
+  /* Wait until all sleepers wake up and exit */
+  bnStop = TRUE;
+  bnExitCode = 0;
+  for(i = 0; i < BN_SLEEPER_COUNT; i++)
+  {
+    osWaitForObject(bnSleeper[i], OS_INFINITE);
+    if(!osGetTaskExitCode(bnSleeper[i], &ExitCode) || ExitCode)
+      bnExitCode = 1;
+    osCloseHandle(bnSleeper[i]);
+  }
+
+  /* Report results */
+  bnReport("time_notify_tick", BN_VARIANT, BN_SLEEPER_COUNT, bnTickSamples,
+    BN_TICK_COUNT);
+  bnReport("time_notify_expire", BN_VARIANT, BN_SLEEPER_COUNT,
+    bnExpireSamples, ExpireCount);
+  bnReportValue("time_notify_tick", BN_VARIANT, "expired_per_tick",
+    (double) TotalExpired / BN_TICK_COUNT);
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Registers BN_WAITER_COUNT time notifications of tasks with random
+ *    priorities and timeouts, then measures arming, cancelling and
+ *    restarting of random notifications while all others stay registered.
+ *    Finally runs the expiry benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  struct TTimeNotify *Batch[BN_BATCH_SIZE];
+  TIME BatchTime[BN_BATCH_SIZE], Now;
+  BNTIME Start;
+  UINT32 i, j;
+  BOOL PrevLockState;
+
+  /* Initialize system, descriptors are measured without the scheduler */
+  arInit();
+  stInit();
+  osInit();
+  PrevLockState = arLock();
+  bnRandomSeed(1);
+
+  /* Descriptors of sleeping tasks */
+  for(i = 0; i <= OS_LOWEST_USED_PRIORITY; i++)
+    bnTask[i].Priority = (UINT8) i;
+  for(i = 0; i < BN_WAITER_COUNT; i++)
+  {
+    osInitTimeNotify(&bnTimeNotify[i]);
+    bnTimeNotify[i].Task =
+      &bnTask[bnRandom() % (OS_LOWEST_USED_PRIORITY + 1)];
+  }
+
+  /* Arm all time notifications */
+  Now = arGetTickCount();
+  for(i = 0; i < BN_WAITER_COUNT / BN_BATCH_SIZE; i++)
+  {
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      BatchTime[j] = Now + 1 + bnRandom() % BN_MAX_TIMEOUT;
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      osRegisterTimeNotify(&bnTimeNotify[i * BN_BATCH_SIZE + j],
+        BatchTime[j]);
+    bnArmSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+  }
+
+  /* Cancel and arm again random notifications */
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+    {
+      Batch[j] = &bnTimeNotify[bnRandom() % BN_WAITER_COUNT];
+      BatchTime[j] = Now + 1 + bnRandom() % BN_MAX_TIMEOUT;
+    }
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      osUnregisterTimeNotify(Batch[j]);
+    bnCancelSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      osRegisterTimeNotify(Batch[j], BatchTime[j]);
+    bnRearmSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+  }
+
+  /* Restart registered notifications (timeout of a repeated wait) */
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+    {
+      Batch[j] = &bnTimeNotify[bnRandom() % BN_WAITER_COUNT];
+      BatchTime[j] = Now + 1 + bnRandom() % BN_MAX_TIMEOUT;
+    }
+
+    Start = bnGetTime();
+    for(j = 0; j < BN_BATCH_SIZE; j++)
+      osRegisterTimeNotify(Batch[j], BatchTime[j]);
+    bnRestartSamples[i] = (double) (bnGetTime() - Start) / BN_BATCH_SIZE;
+  }
+
+  /* Report results */
+  bnReport("time_notify_arm", BN_VARIANT, BN_WAITER_COUNT, bnArmSamples,
+    BN_WAITER_COUNT / BN_BATCH_SIZE);
+  bnReport("time_notify_cancel", BN_VARIANT, BN_WAITER_COUNT,
+    bnCancelSamples, BN_SAMPLE_COUNT);
+  bnReport("time_notify_rearm", BN_VARIANT, BN_WAITER_COUNT, bnRearmSamples,
+    BN_SAMPLE_COUNT);
+  bnReport("time_notify_restart", BN_VARIANT, BN_WAITER_COUNT,
+    bnRestartSamples, BN_SAMPLE_COUNT);
+
+  /* Release all notifications */
+  for(i = 0; i < BN_WAITER_COUNT; i++)
+    osUnregisterTimeNotify(&bnTimeNotify[i]);
+  arRestore(PrevLockState);
+
+  /* Run the expiry benchmark task */
+  osCreateTask(bnExpiryTask, NULL, 0, OS_LOWEST_USED_PRIORITY, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_Trace.c - Kernel event trace overhead benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of samples for each variant */
+#define BN_SAMPLE_COUNT                 20000
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Event signaled to wake the waiting task */
+static HANDLE bnEvent;
+
+/* Samples in nanoseconds per wake-up */
+static double bnSamples[BN_SAMPLE_COUNT];
+
+/* File receiving the trace (NULL if not expected) */
+static const char *bnTraceFile;
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWaitTask
+ *
+ *  Description:
+ *    Waits BN_SAMPLE_COUNT times for the event.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnWaitTask(PVOID Arg)
+{
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+    if(!osWaitForObject(bnEvent, OS_INFINITE))
+      return 1;
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWake
+ *
+ *  Description:
+ *    Signals the event and measures the time until the waiting task (higher
+ *    priority) runs and waits again, which includes two context switches.
+ *
+ *  Parameters:
+ *    Variant - Name of the measured variant.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnWake(const char *Variant)
+{
+  HANDLE Waiting;
+  ERROR ExitCode;
+  BNTIME Start;
+  BOOL Success;
+  UINT32 i;
+
+  /* The waiting task starts waiting immediately */
+  Waiting = osCreateTask(bnWaitTask, NULL, 0, 1, FALSE);
+  if(!Waiting)
+    return FALSE;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Start = bnGetTime();
+    osSetEvent(bnEvent);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  /* Check the waiting task completion */
+  osWaitForObject(Waiting, OS_INFINITE);
+  Success = (BOOL) (osGetTaskExitCode(Waiting, &ExitCode) && !ExitCode);
+  osCloseHandle(Waiting);
+  if(!Success)
+    return FALSE;
+
+  bnReport("trace_wake", Variant, 1, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnSaveTrace
+ *
+ *  Description:
+ *    Writes the trace header and the records left in the trace buffer to
+ *    the trace file.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+#if (OS_USE_TRACE)
+
+static BOOL bnSaveTrace(void)
+{
+  struct TTraceHeader Header;
+  struct TTraceRecord Records[64];
+  FILE *File;
+  SIZE Size;
+
+  File = fopen(bnTraceFile, "wb");
+  if(!File)
+    return FALSE;
+
+  osGetTraceHeader(&Header);
+  fwrite(&Header, sizeof(Header), 1, File);
+  while((Size = osReadTrace(Records, sizeof(Records))) > 0)
+    fwrite(Records, 1, Size, File);
+
+  return (BOOL) !fclose(File);
+}
+
+#endif
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnTraceTask
+ *
+ *  Description:
+ *    Runs the benchmark with recording disabled and enabled and saves the
+ *    recorded trace.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnTraceTask(PVOID Arg)
+{
+  BOOL Success;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  /* Create auto-reset event */
+  bnEvent = osCreateEvent(NULL, FALSE, FALSE);
+  Success = (BOOL) (bnEvent != NULL_HANDLE);
+
+  #if (OS_USE_TRACE)
+    osEnableTrace(FALSE);
+    if(Success)
+      Success = bnWake("trace_off");
+
+    osEnableTrace(TRUE);
+    if(Success)
+      Success = bnWake("trace_on");
+
+    osEnableTrace(FALSE);
+    if(Success && bnTraceFile)
+      Success = bnSaveTrace();
+  #else
+    if(Success)
+      Success = bnWake("no_trace");
+  #endif
+
+  if(Success)
+    bnExitCode = 0;
+  else
+    printf("Benchmark failed (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task. The optional argument is the name of the
+ *    file receiving the recorded trace (see TOOLS/TL_Trace.c).
+ *
+ ***************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  bnTraceFile = (argc > 1) ? argv[1] : NULL;
+
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+
+  /* Run the benchmark task */
+  osCreateTask(bnTraceTask, NULL, 0, 2, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -0,0 +1,241 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  BN_WaitSet.c - Waiting for many objects benchmark (POSIX simulator)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include "OS_API.h"
+#include "BN_Bench.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Number of objects the gateway task waits for */
+#define BN_OBJECT_COUNT                 200
+
+/* Number of samples for each variant */
+#define BN_SAMPLE_COUNT                 20000
+
+/* Compare with osWaitForObjects when it can wait for all objects */
+#if ((OS_MAX_WAIT_FOR_OBJECTS) >= (BN_OBJECT_COUNT))
+  #define BN_WAIT_FOR_OBJECTS           1
+#else
+  #define BN_WAIT_FOR_OBJECTS           0
+#endif
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Objects and the wait set containing them */
+static HANDLE bnEvent[BN_OBJECT_COUNT];
+static HANDLE bnWaitSet;
+
+/* Samples in nanoseconds per signal */
+static double bnSamples[BN_SAMPLE_COUNT];
+
+/* Benchmark completion status */
+static int bnExitCode = 1;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnGatewayTask
+ *
+ *  Description:
+ *    Waits BN_SAMPLE_COUNT times for any of the objects, using the wait
+ *    set or osWaitForObjects.
+ *
+ *  Parameters:
+ *    Arg - Not NULL to use the wait set.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnGatewayTask(PVOID Arg)
+{
+  HANDLE Handle;
+  UINT32 i;
+
+  #if (BN_WAIT_FOR_OBJECTS)
+    INDEX Index;
+
+  /* Mark unused parameter */
+  #else
+    AR_UNUSED_PARAM(Arg);
+  #endif
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    #if (BN_WAIT_FOR_OBJECTS)
+      if(!Arg)
+      {
+        if(!osWaitForObjects(bnEvent, BN_OBJECT_COUNT, OS_INFINITE, &Index))
+          return 1;
+        continue;
+      }
+    #endif
+
+    if(!osWaitForWaitSet(bnWaitSet, OS_INFINITE, &Handle))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWake
+ *
+ *  Description:
+ *    Signals random objects and measures the time until the gateway task
+ *    (higher priority) receives the signal and waits again.
+ *
+ *  Parameters:
+ *    UseWaitSet - TRUE to let the gateway use the wait set, FALSE to use
+ *      osWaitForObjects.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL bnWake(BOOL UseWaitSet)
+{
+  HANDLE Gateway, Event;
+  ERROR ExitCode;
+  BNTIME Start;
+  BOOL Success;
+  UINT32 i;
+
+  /* The gateway starts waiting immediately */
+  Gateway = osCreateTask(bnGatewayTask, UseWaitSet ? (PVOID) &bnWaitSet :
+    NULL, 0, 1, FALSE);
+  if(!Gateway)
+    return FALSE;
+
+  for(i = 0; i < BN_SAMPLE_COUNT; i++)
+  {
+    Event = bnEvent[bnRandom() % BN_OBJECT_COUNT];
+
+    Start = bnGetTime();
+    osSetEvent(Event);
+    bnSamples[i] = (double) (bnGetTime() - Start);
+  }
+
+  /* Check the gateway completion */
+  osWaitForObject(Gateway, OS_INFINITE);
+  Success = (BOOL) (osGetTaskExitCode(Gateway, &ExitCode) && !ExitCode);
+  osCloseHandle(Gateway);
+  if(!Success)
+    return FALSE;
+
+  bnReport("waitset_wake", UseWaitSet ? "wait_set" : "wait_for_objects",
+    BN_OBJECT_COUNT, bnSamples, BN_SAMPLE_COUNT);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    bnWaitSetTask
+ *
+ *  Description:
+ *    Creates the objects and runs the benchmark for each way of waiting.
+ *
+ *  Parameters:
+ *    Arg - Not used.
+ *
+ *  Return:
+ *    Task exit code.
+ *
+ ***************************************************************************/
+
+static ERROR bnWaitSetTask(PVOID Arg)
+{
+  BOOL Success;
+  UINT32 i;
+
+  /* Mark unused parameter */
+  AR_UNUSED_PARAM(Arg);
+
+  /* Create auto-reset events and the wait set */
+  Success = (BOOL) ((bnWaitSet = osCreateWaitSet(NULL, BN_OBJECT_COUNT)) !=
+    NULL_HANDLE);
+  for(i = 0; Success && (i < BN_OBJECT_COUNT); i++)
+  {
+    bnEvent[i] = osCreateEvent(NULL, FALSE, FALSE);
+    Success = (BOOL) (bnEvent[i] && osAddToWaitSet(bnWaitSet, bnEvent[i]));
+  }
+
+  #if (BN_WAIT_FOR_OBJECTS)
+    if(Success)
+      Success = bnWake(FALSE);
+  #endif
+
+  if(Success && bnWake(TRUE))
+    bnExitCode = 0;
+  else
+    printf("Benchmark failed (error 0x%04X)\n",
+      (unsigned) osGetLastError());
+
+  osStop();
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Runs the benchmark task.
+ *
+ ***************************************************************************/
+
+int main(void)
+{
+  /* Initialize system */
+  arInit();
+  stInit();
+  osInit();
+  bnRandomSeed(1);
+
+  /* Run the benchmark task */
+  osCreateTask(bnWaitSetTask, NULL, 0, 2, FALSE);
+  osStart();
+
+  osDeinit();
+  arDeinit();
+  return bnExitCode;
+}
+
+
+/***************************************************************************/
@@ -35,7 +35,9 @@
 
 /* Add custom application settings here */
 #define ST_MALLOC_SIZE (16 * 1024 * 1024)
-#define ST_MAX_HANDLE_COUNT 1024
+#ifndef ST_MAX_HANDLE_COUNT
+  #define ST_MAX_HANDLE_COUNT 1024
+#endif
 #define OS_STAT_SAMPLE_RATE 1000
 
 
@@ -17,7 +17,9 @@
  ***************************************************************************/
 
 #include <stdio.h>
-#include <conio.h>
+#if defined(_WIN32)
+  #include <conio.h>
+#endif
 #include "OS_API.h"
 
 
@@ -56,6 +58,37 @@ void gotoxy(int x, int y)
 }
 
 
+/****************************************************************************
+ *
+ *  Name:
+ *    CPUUsageBP
+ *
+ *  Description:
+ *    Calculates CPU usage in Basis Points (0.01%) with integer math. Both
+ *    times are CPU cycles, so they are scaled down until the product with
+ *    10000 fits in INDEX.
+ *
+ *  Parameters:
+ *    CPUTime - CPU time (not greater than TotalTime)
+ *    TotalTime - Total time of the period (non-zero)
+ *
+ *  Return:
+ *    CPU usage in Basis Points.
+ *
+ ***************************************************************************/
+
+INDEX CPUUsageBP(INDEX CPUTime, INDEX TotalTime)
+{
+  while(TotalTime > (INDEX) ~((INDEX) 0) / 10000)
+  {
+    CPUTime >>= 1;
+    TotalTime >>= 1;
+  }
+
+  return CPUTime * 10000 / TotalTime;
+}
+
+
 /****************************************************************************
  *
  *  Name:
@@ -180,17 +213,17 @@ ERROR Main(PVOID Arg)
       /* Calculate usage in Basis Points (0.01%) for integer precision.
        * If TotalTime is valid, (CPUTime * 10000) / TotalTime.
        * If invalid, set to MAX_INDEX (displayed as '-'). */
-      CPUUsage[i] = Success && TotalTime ? CPUTime * 10000 / TotalTime : (INDEX) ~((INDEX) 0);
+      CPUUsage[i] = Success && TotalTime ? CPUUsageBP(CPUTime, TotalTime) : (INDEX) ~((INDEX) 0);
     }
   
     /* 2. Calculate Monitor (Self) Task CPU usage */
     Success = osGetTaskStat(osGetTaskHandle(), &CPUTime, &TotalTime);
-    CPUUsage[TASK_COUNT + 0] = Success && TotalTime ? CPUTime * 10000 / TotalTime : (INDEX) ~((INDEX) 0);
+    CPUUsage[TASK_COUNT + 0] = Success && TotalTime ? CPUUsageBP(CPUTime, TotalTime) : (INDEX) ~((INDEX) 0);
   
     /* 3. Calculate Idle Task CPU usage */
     /* Idle usage is the inverse of load: 100% - BusyTime */
     osGetSystemStat(&CPUTime, &TotalTime);
-    CPUUsage[TASK_COUNT + 1] = TotalTime ? 10000 - CPUTime * 10000 / TotalTime : (INDEX) ~((INDEX) 0);
+    CPUUsage[TASK_COUNT + 1] = TotalTime ? 10000 - CPUUsageBP(CPUTime, TotalTime) : (INDEX) ~((INDEX) 0);
   
     /* 4. Check for changes */
     BOOL HasChanged = FALSE;
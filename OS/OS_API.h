@@ -60,6 +60,15 @@
   #error OS_SYS_OBJECT_MAX_NAME_LEN must be greater or equal to 0
 #endif
 
+/* Number of slots in the hash table of system object names. It must be a
+   power of two and greater than the number of named objects. When zero,
+   names are kept in a binary search tree. Default is 0. */
+#ifndef OS_NAME_HASH_SIZE
+  #define OS_NAME_HASH_SIZE             0UL
+#elif (((OS_NAME_HASH_SIZE) & ((OS_NAME_HASH_SIZE) - 1UL)) != 0UL)
+  #error OS_NAME_HASH_SIZE must be zero or a power of two
+#endif
+
 /* Enable osOpenByHandle by default when object deletion is enabled.
    This function is only necessary when objects can be deleted. */
 #ifndef OS_OPEN_BY_HANDLE_FUNC
@@ -73,7 +82,8 @@
 
 /* Maximum number of objects that a task can await simultaneously.
    When set to 1, only osWaitForObject is available. When greater,
-   osWaitForObjects is also enabled. Default is 1. */
+   osWaitForObjects and osWaitForObjectsEx (waiting for all objects) are
+   also enabled. Default is 1. */
 #ifndef OS_MAX_WAIT_FOR_OBJECTS
   #define OS_MAX_WAIT_FOR_OBJECTS       1UL
 #elif ((OS_MAX_WAIT_FOR_OBJECTS) < 1UL)
@@ -117,6 +127,31 @@
   #error OS_GET_SYSTEM_STAT_FUNC must be either 0 or 1
 #endif
 
+/* Scheduling latency and wait time histograms are disabled by default */
+#ifndef OS_USE_LATENCY_HISTOGRAM
+  #define OS_USE_LATENCY_HISTOGRAM      0
+#elif (((OS_USE_LATENCY_HISTOGRAM) != 0) && \
+  ((OS_USE_LATENCY_HISTOGRAM) != 1))
+  #error OS_USE_LATENCY_HISTOGRAM must be either 0 or 1
+#endif
+
+/* Number of buckets of a latency histogram. Bucket i counts latencies of
+   2^i up to 2^(i+1) - 1 cycles, the last bucket counts all longer ones.
+   By default all 32-bit latencies have their own bucket. */
+#ifndef OS_LATENCY_BUCKET_COUNT
+  #define OS_LATENCY_BUCKET_COUNT       32
+#elif (((OS_LATENCY_BUCKET_COUNT) < 2) || ((OS_LATENCY_BUCKET_COUNT) > 32))
+  #error OS_LATENCY_BUCKET_COUNT must be in range from 2 to 32
+#endif
+
+/* Lock contention profiler (counters of critical sections of mutexes,
+   semaphores and other locks) is disabled by default */
+#ifndef OS_USE_LOCK_PROFILER
+  #define OS_USE_LOCK_PROFILER          0
+#elif (((OS_USE_LOCK_PROFILER) != 0) && ((OS_USE_LOCK_PROFILER) != 1))
+  #error OS_USE_LOCK_PROFILER must be either 0 or 1
+#endif
+
 
 /****************************************************************************
  *
@@ -128,6 +163,14 @@
 #define OS_IGNORE                       AR_TIME_IGNORE
 #define OS_INFINITE                     AR_TIME_INFINITE
 
+/* Units of CPU usage statistics per second (cycle counter or system
+   ticks) */
+#if (AR_USE_CYCLE_COUNTER)
+  #define OS_CYCLES_PER_SECOND          (AR_CYCLES_PER_SECOND)
+#else
+  #define OS_CYCLES_PER_SECOND          (AR_TICKS_PER_SECOND)
+#endif
+
 /* IPC mode flags */
 #define OS_IPC_PROTECTION_MASK          0x03
 #define OS_IPC_PROTECT_INT_CTRL         0x00
@@ -136,6 +179,11 @@
 #define OS_IPC_WAIT_IF_EMPTY            0x04
 #define OS_IPC_WAIT_IF_FULL             0x08
 #define OS_IPC_DIRECT_READ_WRITE        0x10
+#define OS_IPC_SPSC                     0x20
+
+/* Latency histogram kinds */
+#define OS_LATENCY_WAIT                 0
+#define OS_LATENCY_READY                1
 
 
 /****************************************************************************
@@ -158,6 +206,34 @@ struct TIORequest
   SIZE NumberOfBytesTransferred;
 };
 
+/* CPU time spent during the last statistics period (OS_CYCLES_PER_SECOND
+   units) */
+struct TSystemStat
+{
+  INDEX TotalTime;
+  INDEX TaskTime;
+  INDEX IdleTime;
+  INDEX ISRTime;
+  INDEX KernelTime;
+};
+
+/* Contention statistics of a critical section (times in
+   OS_CYCLES_PER_SECOND units). Contentions count the acquisitions that had
+   to wait, including the waits that timed out. Boosts count the priority
+   raises of the owners by tasks waiting for the critical section. */
+struct TLockStat
+{
+  HANDLE Handle;
+  UINT8 Type;
+  INDEX Acquisitions;
+  INDEX Contentions;
+  INDEX Boosts;
+  UINT32 MaxWaitTime;
+  UINT32 MaxHoldTime;
+  ULONG TotalWaitTime;
+  ULONG TotalHoldTime;
+};
+
 
 /****************************************************************************
  *
@@ -189,6 +265,17 @@ struct TIORequest
 
   #if (OS_GET_SYSTEM_STAT_FUNC)
     void osGetSystemStat(INDEX *CPUTime, INDEX *TotalTime);
+    void osGetSystemStatEx(struct TSystemStat *Stat);
+  #endif
+
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    BOOL osGetLatencyHistogram(HANDLE Handle, UINT8 Kind, UINT32 *Buckets,
+      BOOL Reset);
+  #endif
+
+  #if (OS_USE_LOCK_PROFILER)
+    INDEX osGetContendedLocks(struct TLockStat *Stat, INDEX Count);
+    void osResetLockStat(void);
   #endif
 
   #if (OS_OPEN_BY_HANDLE_FUNC)
@@ -205,6 +292,8 @@ struct TIORequest
   #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
     BOOL osWaitForObjects(HANDLE *Handles, INDEX Count, TIME Timeout,
       INDEX *ObjectIndex);
+    BOOL osWaitForObjectsEx(HANDLE *Handles, INDEX Count, BOOL WaitAll,
+      TIME Timeout, INDEX *ObjectIndex);
   #endif
 
   #if (OS_READ_WRITE_FUNC)
@@ -228,9 +317,12 @@ struct TIORequest
 /* Synchronization */
 #include "OS_Mutex.h"
 #include "OS_Semaphore.h"
+#include "OS_RWLock.h"
+#include "OS_CondVar.h"
 #include "OS_CountSem.h"
 #include "OS_Event.h"
 #include "OS_Timer.h"
+#include "OS_WaitSet.h"
 
 /* Interprocess communication */
 #include "OS_SharedMem.h"
@@ -240,6 +332,9 @@ struct TIORequest
 #include "OS_Mailbox.h"
 #include "OS_Flags.h"
 
+/* Diagnostics */
+#include "OS_Trace.h"
+
 
 /***************************************************************************/
 #endif /* OS_API_H */
@@ -0,0 +1,298 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_CondVar.c - Condition variable object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_Core.h"
+
+
+/***************************************************************************/
+#if (OS_USE_CONDVAR)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Condition variable object descriptor.
+   The signal of the object is never signaled; it only holds the queue of
+   waiting tasks, which are released directly by osCondSignal and
+   osCondBroadcast. */
+struct TCondVarObject
+{
+  /* System object descriptor */
+  struct TSysObject Object;
+
+  /* System object name descriptor */
+  #if (OS_OPEN_CONDVAR_FUNC)
+    struct TObjectName Name;
+  #endif
+};
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateCondVar
+ *
+ *  Description:
+ *    Creates a condition variable object.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateCondVar(SYSNAME Name)
+{
+  struct TCondVarObject FAR *CondVarObject;
+  struct TSysObject FAR *Object;
+
+  /* Allocate memory for the object */
+  CondVarObject = (struct TCondVarObject FAR *)
+    osMemAlloc(sizeof(*CondVarObject));
+  if(!CondVarObject)
+    return NULL_HANDLE;
+
+  /* Pointer to system object descriptor */
+  Object = &CondVarObject->Object;
+
+  /* Register new system object */
+  if(!osRegisterObject((PVOID) CondVarObject, Object,
+    OS_OBJECT_TYPE_CONDVAR))
+  {
+    osMemFree(CondVarObject);
+    return NULL_HANDLE;
+  }
+
+  /* Register name descriptor */
+  #if (OS_OPEN_CONDVAR_FUNC)
+    if(!osRegisterName(Object, &CondVarObject->Name, Name))
+    {
+      osDeleteObject(Object);
+      return NULL_HANDLE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(Name);
+  #endif
+
+  /* Setup the object (never signaled) */
+  Object->Signal.Signaled = 0;
+
+  /* Mark object as ready to use and return its handle */
+  Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
+  return Object->Handle;
+}
+
+
+/***************************************************************************/
+#if (OS_OPEN_CONDVAR_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osOpenCondVar
+ *
+ *  Description:
+ *    Opens an existing condition variable object by name.
+ *
+ *  Parameters:
+ *    Name - Name of the existing object.
+ *
+ *  Return:
+ *    Handle of the object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osOpenCondVar(SYSNAME Name)
+{
+  struct TSysObject FAR *Object;
+
+  /* Open named object */
+  Object = osOpenNamedObject(Name, OS_OBJECT_TYPE_CONDVAR);
+
+  /* Return handle of the opened object or NULL_HANDLE on failure */
+  return Object ? Object->Handle : NULL_HANDLE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_OPEN_CONDVAR_FUNC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCondWait
+ *
+ *  Description:
+ *    Releases the mutex and waits until the condition variable is signaled
+ *    or the specified timeout interval elapses. The task is queued on the
+ *    condition variable before the mutex is released, so a signal sent by
+ *    a task which acquired the mutex afterwards is never lost. The mutex
+ *    is acquired again before the function returns, also on timeout;
+ *    waiting tasks get the mutex in the order of their priorities. Repeated
+ *    acquisitions of the mutex by its owner are not counted, so the same
+ *    as osReleaseMutex the function releases it at once, and the task owns
+ *    it once on return.
+ *
+ *  Parameters:
+ *    Cond - Handle of the condition variable object.
+ *    Mutex - Handle of the mutex object owned by the calling task.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure. The calling task owns the mutex
+ *    on return, unless the function fails with the
+ *    ERR_OBJECT_CAN_NOT_BE_RELEASED error (mutex was not owned) or the
+ *    ERR_WAIT_DEADLOCK error (mutex could not be acquired again).
+ *
+ ***************************************************************************/
+
+BOOL osCondWait(HANDLE Cond, HANDLE Mutex, TIME Timeout)
+{
+  struct TSysObject FAR *CondObject;
+  struct TSysObject FAR *MutexObject;
+  BOOL Signaled;
+  ERROR ErrorCode;
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
+
+  /* Get objects by handles */
+  CondObject = osGetObjectByHandle(Cond, OS_OBJECT_TYPE_CONDVAR);
+  if(!CondObject)
+    return FALSE;
+
+  MutexObject = osGetObjectByHandle(Mutex, OS_OBJECT_TYPE_MUTEX);
+  if(!MutexObject)
+    return FALSE;
+
+  /* Release the mutex and wait for the condition variable */
+  ErrorCode = ERR_NO_ERROR;
+  Signaled = osWaitForAndReleaseCS(&CondObject->Signal,
+    MutexObject->Signal.CS, Timeout);
+  if(!Signaled)
+  {
+    ErrorCode = osGetLastError();
+    if(ErrorCode == ERR_OBJECT_CAN_NOT_BE_RELEASED)
+      return FALSE;
+  }
+
+  /* Acquire the mutex again. When waiting has failed before the mutex was
+     released, the task still owns it and this succeeds immediately. */
+  #if (OS_MUTEX_FAST_PATH)
+    if(!osMutexFastAcquire(MutexObject))
+  #endif
+      if(!osWaitFor(&MutexObject->Signal, OS_INFINITE))
+        return FALSE;
+
+  /* Return the result of waiting for the condition variable */
+  if(!Signaled)
+  {
+    osSetLastError(ErrorCode);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCondSignal
+ *
+ *  Description:
+ *    Releases the highest priority task waiting for the condition
+ *    variable. Nothing happens if no task is waiting.
+ *
+ *  Parameters:
+ *    Cond - Handle of the condition variable object.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osCondSignal(HANDLE Cond)
+{
+  struct TSysObject FAR *Object;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Cond, OS_OBJECT_TYPE_CONDVAR);
+  if(!Object)
+    return FALSE;
+
+  /* Release the first waiting task */
+  osWakeWaitingTasks(&Object->Signal, FALSE);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCondBroadcast
+ *
+ *  Description:
+ *    Releases all tasks waiting for the condition variable. Tasks which
+ *    start to wait after the call are not released.
+ *
+ *  Parameters:
+ *    Cond - Handle of the condition variable object.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osCondBroadcast(HANDLE Cond)
+{
+  struct TSysObject FAR *Object;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Cond, OS_OBJECT_TYPE_CONDVAR);
+  if(!Object)
+    return FALSE;
+
+  /* Release all waiting tasks */
+  osWakeWaitingTasks(&Object->Signal, TRUE);
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_CONDVAR */
+/***************************************************************************/
+
+
+/***************************************************************************/
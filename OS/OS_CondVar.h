@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_CondVar.h - Condition variable object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef OS_CONDVAR_H
+#define OS_CONDVAR_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_API.h"
+
+
+/****************************************************************************
+ *
+ *  Default configuration
+ *
+ ***************************************************************************/
+
+/* Enable Condition variable objects by default (when Mutexes are used) */
+#ifndef OS_USE_CONDVAR
+  #define OS_USE_CONDVAR                (OS_USE_MUTEX)
+#elif (((OS_USE_CONDVAR) != 0) && ((OS_USE_CONDVAR) != 1))
+  #error OS_USE_CONDVAR must be either 0 or 1
+#elif (((OS_USE_CONDVAR) != 0) && !(OS_USE_MUTEX))
+  #error OS_USE_MUTEX must be set to 1 when OS_USE_CONDVAR is 1
+#endif
+
+/* Enable osOpenCondVar (lookup by name) by default */
+#ifndef OS_OPEN_CONDVAR_FUNC
+  #define OS_OPEN_CONDVAR_FUNC          (OS_USE_CONDVAR)
+#elif (((OS_OPEN_CONDVAR_FUNC) != 0) && ((OS_OPEN_CONDVAR_FUNC) != 1))
+  #error OS_OPEN_CONDVAR_FUNC must be either 0 or 1
+#elif (((OS_OPEN_CONDVAR_FUNC) != 0) && !(OS_USE_CONDVAR))
+  #error OS_OPEN_CONDVAR_FUNC must be 0 when OS_USE_CONDVAR is 0
+#endif
+
+
+/****************************************************************************
+ *
+ *  System configuration
+ *
+ ***************************************************************************/
+
+/* Enable named object support if open function is used */
+#if ((OS_OPEN_CONDVAR_FUNC) && !defined(OS_USE_OBJECT_NAMES))
+  #define OS_USE_OBJECT_NAMES           1
+#endif
+
+/* Enable Multiple Signals support (mutex re-acquiring) */
+#if ((OS_USE_CONDVAR) && !defined(OS_USE_MULTIPLE_SIGNALS))
+  #define OS_USE_MULTIPLE_SIGNALS       1
+#endif
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+#define OS_OBJECT_TYPE_CONDVAR          14
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  #if (OS_USE_CONDVAR)
+
+    HANDLE osCreateCondVar(SYSNAME Name);
+
+    #if (OS_OPEN_CONDVAR_FUNC)
+      HANDLE osOpenCondVar(SYSNAME Name);
+    #endif
+
+    BOOL osCondWait(HANDLE Cond, HANDLE Mutex, TIME Timeout);
+    BOOL osCondSignal(HANDLE Cond);
+    BOOL osCondBroadcast(HANDLE Cond);
+
+  #endif
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* OS_CONDVAR_H */
+/***************************************************************************/
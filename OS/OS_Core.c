@@ -45,6 +45,115 @@
   #define OS_PRIORITY_COUNT             256
 #endif
 
+/* Bitmap bit of the index (lowest index is the most significant bit, so
+   it is found by counting leading zeros) */
+#if ((OS_USE_READY_BITMAP) || (OS_USE_TIME_WHEEL))
+  #define OS_BITMAP_BIT(Index)          (0x80000000UL >> ((Index) & 31))
+#endif
+
+/* Hierarchical timing wheel of time notifications */
+#if ((OS_USE_TIME_OBJECTS) && (OS_USE_TIME_WHEEL))
+
+  /* Number of time bits resolved by a single wheel level */
+  #define OS_TIME_WHEEL_BITS            5
+
+  /* Number of slots of a single wheel level (one bitmap word) */
+  #define OS_TIME_WHEEL_SLOTS           (1 << (OS_TIME_WHEEL_BITS))
+  #define OS_TIME_WHEEL_MASK            ((OS_TIME_WHEEL_SLOTS) - 1)
+
+  /* Number of wheel levels needed to cover the 32-bit time range */
+  #define OS_TIME_WHEEL_LEVELS \
+    ((32 + (OS_TIME_WHEEL_BITS) - 1) / (OS_TIME_WHEEL_BITS))
+
+  /* Level of the expired time notifications (slot is the due level) */
+  #define OS_TIME_WHEEL_DUE             (OS_TIME_WHEEL_LEVELS)
+
+  /* Number of expired time notification lists (used priorities and the
+     notifications of signals without waiting tasks) */
+  #define OS_TIME_DUE_LEVEL_COUNT       ((OS_LOWEST_USED_PRIORITY) + 2)
+
+  /* Number of 32-bit words in the expired time notification bitmap */
+  #define OS_TIME_DUE_WORD_COUNT        (((OS_TIME_DUE_LEVEL_COUNT) + 31) / 32)
+
+  /* Expired time notification list of the priority */
+  #define OS_TIME_DUE_LEVEL(Priority) \
+    (((Priority) > (OS_LOWEST_USED_PRIORITY)) ? \
+    ((OS_LOWEST_USED_PRIORITY) + 1) : (Priority))
+
+#endif
+
+/* Bitmap-indexed ready to run task queue */
+#if (OS_USE_READY_BITMAP)
+
+  /* Number of ready queue levels (used priorities and the idle task) */
+  #define OS_READY_LEVEL_COUNT          ((OS_LOWEST_USED_PRIORITY) + 2)
+
+  /* Number of 32-bit words in the ready level bitmap */
+  #define OS_READY_WORD_COUNT           (((OS_READY_LEVEL_COUNT) + 31) / 32)
+
+  /* Ready queue level of the priority (idle task uses the last level) */
+  #define OS_READY_LEVEL(Priority) \
+    (((Priority) > (OS_LOWEST_USED_PRIORITY)) ? \
+    ((OS_LOWEST_USED_PRIORITY) + 1) : (Priority))
+
+/* Priority queue of the ready to run tasks */
+#else
+
+  #define osReadyQueueInsert(Task) \
+    stPQueueInsert(&osTaskPQueue, &(Task)->ReadyTask, (Task))
+  #define osReadyQueueRemove(Task) \
+    stPQueueRemove(&osTaskPQueue, &(Task)->ReadyTask)
+  #define osReadyQueueGet() \
+    ((struct TTask FAR *) stPQueueGet(&osTaskPQueue))
+  #define osReadyQueueRotate(Forward) \
+    stPQueueRotate(&osTaskPQueue, NULL, (Forward))
+
+#endif
+
+/* Slab allocator */
+#if (OS_USE_SLAB)
+
+  /* Size of the header preceding each allocated block */
+  #define OS_SLAB_HEADER_SIZE \
+    AR_MEMORY_ALIGN_UP(sizeof(struct TSlab FAR *))
+
+  /* Size of the slab descriptor preceding the fixed-size memory pool */
+  #define OS_SLAB_DESC_SIZE \
+    AR_MEMORY_ALIGN_UP(sizeof(struct TSlab))
+
+  /* Fixed-size memory pool of the slab */
+  #define osSlabPool(Slab) \
+    ((PVOID) &((UINT8 FAR *) (Slab))[OS_SLAB_DESC_SIZE])
+
+#endif
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Slab descriptor (followed by the fixed-size memory pool) */
+#if (OS_USE_SLAB)
+  struct TSlab
+  {
+    struct TSlab FAR *Next;       /* Next slab of the size class */
+    struct TSlab FAR *NextFree;   /* Next slab with free blocks */
+    INDEX Class;                  /* Size class index */
+    INDEX Used;                   /* Number of allocated blocks */
+  };
+#endif
+
+/* Position of a walk through the list of profiled critical sections */
+#if (OS_USE_LOCK_PROFILER)
+  struct TLockCursor
+  {
+    struct TCriticalSection FAR *CS;  /* Next critical section to visit */
+    struct TLockCursor FAR *Next;     /* Next walk in progress */
+  };
+#endif
+
 
 /****************************************************************************
  *
@@ -77,6 +186,12 @@
   static UINT8 osFixMemPool3[OS_FIX_POOL3_SIZE];
 #endif
 
+/* Slabs of each size class and slabs with at least one free block */
+#if (OS_USE_SLAB)
+  static struct TSlab FAR *osSlabs[OS_SLAB_CLASS_COUNT];
+  static struct TSlab FAR *osFreeSlabs[OS_SLAB_CLASS_COUNT];
+#endif
+
 /* Last error code (used when operating system is not running or code is
    executed from an ISR) */
 static ERROR osLastErrorCode;
@@ -92,7 +207,15 @@ static BOOL osYieldAfterISR;
 #endif
 
 /* Time notification */
-#if (OS_USE_TIME_OBJECTS)
+#if ((OS_USE_TIME_OBJECTS) && (OS_USE_TIME_WHEEL))
+  static TIME osTimeWheelTime;
+  static struct TTimeNotify FAR *osTimeWheel[OS_TIME_WHEEL_LEVELS]
+    [OS_TIME_WHEEL_SLOTS];
+  static UINT32 osTimeWheelMap[OS_TIME_WHEEL_LEVELS];
+  static struct TTimeNotify FAR *osTimeNotifyDue[OS_TIME_DUE_LEVEL_COUNT];
+  static UINT32 osTimeDueMap[OS_TIME_DUE_WORD_COUNT];
+  static UINT32 osTimeDueGroup;
+#elif (OS_USE_TIME_OBJECTS)
   static struct TPQueue osTimeNotifyQueue;
   static struct TTimeNotify FAR *osTimeNotify[OS_LOWEST_USED_PRIORITY + 1];
   static TIME osTimeNotifyArr[OS_PRIORITY_COUNT +
@@ -100,7 +223,10 @@ static BOOL osYieldAfterISR;
 #endif
 
 /* System names */
-#if (OS_USE_OBJECT_NAMES)
+#if ((OS_USE_OBJECT_NAMES) && ((OS_NAME_HASH_SIZE) > 0UL))
+  static struct TObjectName FAR *osSysNameHash[OS_NAME_HASH_SIZE];
+  static UINT32 osSysNameCount;
+#elif (OS_USE_OBJECT_NAMES)
   static struct TBSTree osSysNames;
 #endif
 
@@ -108,7 +234,13 @@ static BOOL osYieldAfterISR;
 static struct TBSTree osDeferredSignal;
 
 /* Ready to run tasks queue */
-static struct TPQueue osTaskPQueue;
+#if (OS_USE_READY_BITMAP)
+  static struct TTask FAR *osReadyHead[OS_READY_LEVEL_COUNT];
+  static UINT32 osReadyMap[OS_READY_WORD_COUNT];
+  static UINT32 osReadyGroup;
+#else
+  static struct TPQueue osTaskPQueue;
+#endif
 
 /* Idle task pointer */
 #if ((OS_DEINIT_FUNC) || (OS_USE_STATISTICS))
@@ -122,12 +254,17 @@ struct TTask FAR *osCurrentTask;
 TIME osLastQuantumTime;
 INDEX osLastQuantumIndex;
 
-/* Total CPU usage information */
+/* Total CPU usage information (the current statistics period starts at
+   osCPUCalcTime ticks and osCPUCalcCycles cycles, CPU time up to
+   osCPULastCycles is already accounted) */
 #if (OS_USE_STATISTICS)
   TIME osCPUUsageTime;
-  INDEX osCPUUsage;
+  UINT32 osCPUUsage;
   static TIME osCPUCalcTime;
-  static INDEX osCPUCalc;
+  static UINT32 osCPUCalcCycles;
+  static UINT32 osCPULastCycles;
+  static struct TCPUStat osISRStat;
+  static struct TCPUStat osKernelStat;
 #endif
 
 /* System object deinitialization list */
@@ -135,6 +272,14 @@ INDEX osLastQuantumIndex;
   static struct TSysObject FAR *osFirstObject;
 #endif
 
+/* Critical sections counted by the lock profiler and the walks through
+   their list in progress (the list is walked with interrupts enabled
+   between the entries) */
+#if (OS_USE_LOCK_PROFILER)
+  static struct TCriticalSection FAR *osFirstLockCS;
+  static struct TLockCursor FAR *osFirstLockCursor;
+#endif
+
 
 /****************************************************************************
  *
@@ -146,6 +291,25 @@ static BOOL osAcquire(struct TSignal FAR *Signal, BOOL OnCheck);
 static struct TCSAssoc FAR *osFindCSAssoc(struct TCriticalSection *CS,
   struct TTask *Task);
 
+#if (OS_MUTEX_FAST_PATH)
+  static void osInflateCS(struct TCriticalSection FAR *CS);
+#endif
+
+#if (OS_USE_WAIT_SET)
+  static struct TTask FAR *osWatchNotify(struct TSignal FAR *Signal);
+#endif
+
+#if (OS_USE_LATENCY_HISTOGRAM)
+  static void osLatencyRecord(UINT32 FAR *Histogram, UINT32 Cycles);
+#endif
+
+#if (OS_USE_LOCK_PROFILER)
+  static void osLockWaited(struct TCriticalSection FAR *CS, UINT32 WaitTime);
+  #if (OS_ALLOW_OBJECT_DELETION)
+    static void osUnlinkLockCS(struct TSysObject FAR *Object);
+  #endif
+#endif
+
 
 /****************************************************************************
  *
@@ -311,6 +475,166 @@ BOOL osMemFree(PVOID Ptr)
 /***************************************************************************/
 
 
+/***************************************************************************/
+#if (OS_USE_SLAB)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMemAlloc
+ *
+ *  Description:
+ *    Allocates a new memory block in a slab of the size class matching the
+ *    requested size. When the class has no free block, a new slab is
+ *    allocated on the heap. Blocks larger than the largest size class are
+ *    allocated directly on the heap.
+ *
+ *  Parameters:
+ *    Size - Size of the memory to be allocated.
+ *
+ *  Return:
+ *    Address of the newly allocated memory block or NULL on failure.
+ *
+ ***************************************************************************/
+
+PVOID osMemAlloc(SIZE Size)
+{
+  struct TSlab FAR *Slab;
+  BOOL PrevLockState;
+  SIZE BlockSize, PoolSize;
+  UINT8 FAR *Ptr;
+  INDEX Class;
+
+  /* Allocate large block on the heap (header marks it by NULL) */
+  if(Size > (OS_SLAB_MAX_SIZE))
+  {
+    if(Size > ((SIZE) -1) - OS_SLAB_HEADER_SIZE)
+    {
+      osSetLastError(ERR_NOT_ENOUGH_MEMORY);
+      return NULL;
+    }
+
+    Ptr = (UINT8 FAR *) stMemAlloc(OS_SLAB_HEADER_SIZE + Size);
+    if(!Ptr)
+      return NULL;
+
+    *(struct TSlab FAR **) (PVOID) Ptr = NULL;
+    return (PVOID) &Ptr[OS_SLAB_HEADER_SIZE];
+  }
+
+  /* Size class index */
+  Class = (INDEX) (Size ? (Size - 1) / (OS_SLAB_GRANULARITY) : 0);
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Grow the size class when all its slabs are full */
+  if(!osFreeSlabs[Class])
+  {
+    /* Leave critical section during the heap allocation */
+    arRestore(PrevLockState);
+
+    /* Allocate and initialize a new slab */
+    BlockSize = OS_SLAB_HEADER_SIZE + (Class + 1) * (OS_SLAB_GRANULARITY);
+    PoolSize = stFixedMemSize(BlockSize, OS_SLAB_BLOCK_COUNT);
+    Slab = (struct TSlab FAR *) stMemAlloc(OS_SLAB_DESC_SIZE + PoolSize);
+    if(!Slab)
+      return NULL;
+
+    stFixedMemInit(osSlabPool(Slab), PoolSize, BlockSize);
+    Slab->Class = Class;
+    Slab->Used = 0;
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* Add the slab to the size class */
+    Slab->Next = osSlabs[Class];
+    osSlabs[Class] = Slab;
+    Slab->NextFree = osFreeSlabs[Class];
+    osFreeSlabs[Class] = Slab;
+  }
+
+  /* Allocate block in the first slab with free blocks. The full slab is
+     removed from the list until any of its blocks is released. */
+  Slab = osFreeSlabs[Class];
+  Ptr = (UINT8 FAR *) stFixedMemAlloc(osSlabPool(Slab));
+  Slab->Used++;
+  if(Slab->Used >= (OS_SLAB_BLOCK_COUNT))
+    osFreeSlabs[Class] = Slab->NextFree;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+
+  /* Header points to the slab the block belongs to */
+  *(struct TSlab FAR **) (PVOID) Ptr = Slab;
+  return (PVOID) &Ptr[OS_SLAB_HEADER_SIZE];
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMemFree
+ *
+ *  Description:
+ *    Releases an allocated memory block. Slabs are not released, their
+ *    blocks are reused by the following allocations of the size class.
+ *
+ *  Parameters:
+ *    Ptr - Address of the memory block to be released.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osMemFree(PVOID Ptr)
+{
+  struct TSlab FAR *Slab;
+  BOOL PrevLockState;
+  UINT8 FAR *Block;
+
+  /* Check the pointer */
+  if(!Ptr)
+  {
+    osSetLastError(ERR_INVALID_MEMORY_BLOCK);
+    return FALSE;
+  }
+
+  /* Get the slab the block belongs to */
+  Block = (UINT8 FAR *) Ptr - OS_SLAB_HEADER_SIZE;
+  Slab = *(struct TSlab FAR **) (PVOID) Block;
+
+  /* Release large block allocated on the heap */
+  if(!Slab)
+    return stMemFree(Block);
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Release the block, the slab has free blocks again when it was full */
+  stFixedMemFree(osSlabPool(Slab), Block);
+  if(Slab->Used >= (OS_SLAB_BLOCK_COUNT))
+  {
+    Slab->NextFree = osFreeSlabs[Slab->Class];
+    osFreeSlabs[Slab->Class] = Slab;
+  }
+  Slab->Used--;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_SLAB */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Error management
@@ -364,6 +688,119 @@ ERROR osGetLastError(void)
 }
 
 
+/****************************************************************************
+ *
+ *  CPU usage statistics
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_USE_STATISTICS)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osInitCPUStat
+ *
+ *  Description:
+ *    Initializes the CPU time descriptor. No CPU time is accounted.
+ *
+ *  Parameters:
+ *    Stat - Pointer to CPU time descriptor.
+ *
+ ***************************************************************************/
+
+void osInitCPUStat(struct TCPUStat FAR *Stat)
+{
+  Stat->UsageTime = OS_INFINITE;
+  Stat->Usage = 0;
+  Stat->CalcTime = osCPUUsageTime;
+  Stat->Calc = 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osAccountCPUTime
+ *
+ *  Description:
+ *    Adds the cycles elapsed since the previous call to the specified CPU
+ *    time descriptor. Must be called with interrupts disabled.
+ *
+ *  Parameters:
+ *    Stat - Pointer to CPU time descriptor.
+ *
+ ***************************************************************************/
+
+static void osAccountCPUTime(struct TCPUStat FAR *Stat)
+{
+  UINT32 Cycles, Elapsed;
+
+  /* Cycles elapsed since the previous accounting */
+  Cycles = OS_GET_CYCLE_COUNT();
+  Elapsed = Cycles - osCPULastCycles;
+  osCPULastCycles = Cycles;
+
+  /* Begin a new period or continue the current one */
+  if(Stat->CalcTime != osCPUCalcTime)
+  {
+    Stat->UsageTime = Stat->CalcTime;
+    Stat->Usage = Stat->Calc;
+    Stat->CalcTime = osCPUCalcTime;
+    Stat->Calc = Elapsed;
+  }
+  else
+    Stat->Calc += Elapsed;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetCPUTime
+ *
+ *  Description:
+ *    Returns the CPU time accounted to the descriptor during the last
+ *    complete statistics period.
+ *
+ *  Parameters:
+ *    Stat - Pointer to CPU time descriptor.
+ *
+ *  Return:
+ *    Number of cycles.
+ *
+ ***************************************************************************/
+
+UINT32 osGetCPUTime(struct TCPUStat FAR *Stat)
+{
+  BOOL PrevLockState;
+  UINT32 Cycles;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  if(Stat->UsageTime == osCPUUsageTime)
+    Cycles = Stat->Usage;
+  else if(Stat->CalcTime == osCPUUsageTime)
+    Cycles = Stat->Calc;
+  else
+    Cycles = 0;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Cycles;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_STATISTICS */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  ISR section management
@@ -401,6 +838,16 @@ INLINE BOOL osEnterISR(void)
   {
     osYieldAfterISR = FALSE;
     osInISR = TRUE;
+
+    /* CPU time up to now belongs to the interrupted task */
+    #if (OS_USE_STATISTICS)
+      osAccountCPUTime(osCurrentTask ? &osCurrentTask->CPUStat :
+        &osKernelStat);
+    #endif
+
+    #if (OS_USE_TRACE)
+      osTraceRecord(OS_TRACE_ISR_ENTER, osCurrentTask, NULL, 0, 0);
+    #endif
   }
 
   /* Leave critical section */
@@ -435,6 +882,15 @@ INLINE void osLeaveISR(BOOL PrevISRState)
     /* Enter critical section */
     PrevLockState = arLock();
 
+    #if (OS_USE_TRACE)
+      osTraceRecord(OS_TRACE_ISR_EXIT, osCurrentTask, NULL, 0, 0);
+    #endif
+
+    /* CPU time spent in the ISR */
+    #if (OS_USE_STATISTICS)
+      osAccountCPUTime(&osISRStat);
+    #endif
+
     /* End section of code executed in the ISR and execute delayed scheduler
        procedure */
     osInISR = FALSE;
@@ -483,108 +939,283 @@ static void osYield(void)
 /****************************************************************************
  *
  *  Name:
- *    osTimeNotifyCmp
+ *    osInitTimeWaiting
  *
  *  Description:
- *    Compares two time notification descriptors.
+ *    Initializes the time notification descriptor.
  *
  *  Parameters:
- *    Item1 - Pointer to first time notification descriptor.
- *    Item2 - Pointer to second time notification descriptor.
- *
- *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    TimeNotify - Time notification descriptor pointer.
  *
  ***************************************************************************/
 
-static int osTimeNotifyCmp(PVOID Item1, PVOID Item2)
+void osInitTimeNotify(struct TTimeNotify FAR *TimeNotify)
 {
-  register struct TTimeNotify FAR *T1;
-  register struct TTimeNotify FAR *T2;
-  register int Cmp;
+  /* Initialize time notification descriptor */
+  TimeNotify->Registered = FALSE;
+  TimeNotify->Task = NULL;
+  TimeNotify->Signal = NULL;
+}
 
-  /* Compare items */
-  T1 = Item1;
-  T2 = Item2;
 
-  Cmp = ((int) T1->Priority) - ((int) T2->Priority);
-  if(Cmp != 0)
-    return Cmp;
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetTimeNotifyPriority
+ *
+ *  Description:
+ *    Returns the priority of a time notification descriptor, that is the
+ *    priority of the controlled task or of the first task waiting for the
+ *    controlled signal.
+ *
+ *  Parameters:
+ *    TimeNotify - Time notification descriptor pointer.
+ *
+ *  Return:
+ *    Time notification descriptor priority.
+ *
+ ***************************************************************************/
 
-  if(T1->Time < T2->Time)
-    return -1;
-  if(T1->Time > T2->Time)
-    return 1;
+static UINT8 osGetTimeNotifyPriority(struct TTimeNotify FAR *TimeNotify)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
 
-  /* Items are equal */
-  return 0;
+  /* Priority of the controlled task */
+  if(TimeNotify->Task)
+    return TimeNotify->Task->Priority;
+
+  /* Priority of the first task waiting for the signal */
+  WaitAssoc = (struct TWaitAssoc FAR *)
+    stBSTreeGetFirst(&TimeNotify->Signal->WaitingTasks);
+  return (UINT8) (WaitAssoc ? WaitAssoc->Task->Priority : OS_LOWEST_PRIORITY);
 }
 
 
+/***************************************************************************/
+#if (OS_USE_TIME_WHEEL)
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osUpdateTimeNotify
+ *    osTimeWheelLink
  *
  *  Description:
- *    Internal function that updates the array used for searching time
- *    notifications.
+ *    Appends a time notification descriptor to the list of the specified
+ *    timing wheel level and slot.
  *
  *  Parameters:
  *    TimeNotify - Time notification descriptor pointer.
- *    Priority - Priority of the time notification.
+ *    Level - Timing wheel level or OS_TIME_WHEEL_DUE.
+ *    Slot - Slot within the level.
  *
  ***************************************************************************/
 
-static void osUpdateTimeNotify(struct TTimeNotify FAR *TimeNotify,
-  int Priority)
+static void osTimeWheelLink(struct TTimeNotify FAR *TimeNotify, INDEX Level,
+  INDEX Slot)
 {
-  TIME Time, TimeOp;
+  struct TTimeNotify FAR * FAR *Head;
 
-  /* Update array */
-  osTimeNotify[Priority] = TimeNotify;
+  /* Store position of the descriptor */
+  TimeNotify->Level = (UINT8) Level;
+  TimeNotify->Slot = (UINT8) Slot;
 
-  /* Update time tree */
-  Time = TimeNotify ? TimeNotify->Time : OS_INFINITE;
-  Priority += OS_PRIORITY_COUNT;
-  osTimeNotifyArr[Priority] = Time;
-  do
+  /* Mark the list as non-empty */
+  if(Level == OS_TIME_WHEEL_DUE)
   {
-    TimeOp = osTimeNotifyArr[Priority ^ 1];
-    if(Time > TimeOp)
-      Time = TimeOp;
+    Head = &osTimeNotifyDue[Slot];
+    osTimeDueMap[Slot >> 5] |= OS_BITMAP_BIT(Slot);
+    osTimeDueGroup |= OS_BITMAP_BIT(Slot >> 5);
+  }
+  else
+  {
+    Head = &osTimeWheel[Level][Slot];
+    osTimeWheelMap[Level] |= OS_BITMAP_BIT(Slot);
+  }
 
-    Priority >>= 1;
-    if(osTimeNotifyArr[Priority] == Time)
-      break;
+  /* Append descriptor at the end of the circular list */
+  if(*Head)
+  {
+    TimeNotify->Next = *Head;
+    TimeNotify->Prev = (*Head)->Prev;
+    (*Head)->Prev->Next = TimeNotify;
+    (*Head)->Prev = TimeNotify;
+  }
+  else
+  {
+    TimeNotify->Next = TimeNotify;
+    TimeNotify->Prev = TimeNotify;
+    *Head = TimeNotify;
+  }
+}
 
-    osTimeNotifyArr[Priority] = Time;
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osTimeWheelUnlink
+ *
+ *  Description:
+ *    Removes a time notification descriptor from its timing wheel list.
+ *
+ *  Parameters:
+ *    TimeNotify - Time notification descriptor pointer.
+ *
+ ***************************************************************************/
+
+static void osTimeWheelUnlink(struct TTimeNotify FAR *TimeNotify)
+{
+  struct TTimeNotify FAR * FAR *Head;
+  INDEX Slot;
+
+  /* List containing the descriptor */
+  Slot = TimeNotify->Slot;
+  Head = (TimeNotify->Level == OS_TIME_WHEEL_DUE) ? &osTimeNotifyDue[Slot] :
+    &osTimeWheel[TimeNotify->Level][Slot];
+
+  /* Remove descriptor from the list */
+  if(TimeNotify->Next != TimeNotify)
+  {
+    TimeNotify->Prev->Next = TimeNotify->Next;
+    TimeNotify->Next->Prev = TimeNotify->Prev;
+    if(*Head == TimeNotify)
+      *Head = TimeNotify->Next;
+    return;
   }
-  while(Priority > 1);
+
+  /* List became empty */
+  *Head = NULL;
+  if(TimeNotify->Level == OS_TIME_WHEEL_DUE)
+  {
+    osTimeDueMap[Slot >> 5] &= ~OS_BITMAP_BIT(Slot);
+    if(!osTimeDueMap[Slot >> 5])
+      osTimeDueGroup &= ~OS_BITMAP_BIT(Slot >> 5);
+  }
+  else
+    osTimeWheelMap[TimeNotify->Level] &= ~OS_BITMAP_BIT(Slot);
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osInitTimeWaiting
+ *    osTimeWheelPlace
  *
  *  Description:
- *    Initializes the time notification descriptor.
+ *    Inserts a time notification descriptor into the timing wheel relative
+ *    to the current wheel time. The level is chosen by the most significant
+ *    bit in which the notification time differs from the wheel time, so
+ *    the descriptor moves to a lower level only when the wheel time reaches
+ *    its slot. Expired descriptors are put on the list of their priority.
  *
  *  Parameters:
  *    TimeNotify - Time notification descriptor pointer.
  *
  ***************************************************************************/
 
-void osInitTimeNotify(struct TTimeNotify FAR *TimeNotify)
+static void osTimeWheelPlace(struct TTimeNotify FAR *TimeNotify)
 {
-  /* Initialize time notification descriptor */
-  TimeNotify->Registered = FALSE;
-  TimeNotify->Task = NULL;
-  TimeNotify->Signal = NULL;
+  INDEX Level;
+
+  /* Notification time has already passed (compared across the wrap of the
+     tick counter) */
+  if((INT32) (TimeNotify->Time - osTimeWheelTime) <= 0)
+  {
+    osTimeWheelLink(TimeNotify, OS_TIME_WHEEL_DUE,
+      OS_TIME_DUE_LEVEL(TimeNotify->Priority));
+    return;
+  }
+
+  /* Insert descriptor into the wheel */
+  Level = (31 - stCountLeadingZeros(TimeNotify->Time ^ osTimeWheelTime)) /
+    OS_TIME_WHEEL_BITS;
+  osTimeWheelLink(TimeNotify, Level, (INDEX) ((TimeNotify->Time >>
+    (Level * OS_TIME_WHEEL_BITS)) & OS_TIME_WHEEL_MASK));
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osTimeWheelAdvance
+ *
+ *  Description:
+ *    Advances the timing wheel to the specified time. Descriptors of all
+ *    slots passed by the wheel are inserted again, which moves them to a
+ *    lower level or to the expired lists. Levels are processed from the
+ *    lowest one, since descriptors never move to a higher level. When the
+ *    tick counter wraps, the passed slots of the highest level wrap too.
+ *
+ *  Parameters:
+ *    Time - New wheel time.
+ *
+ ***************************************************************************/
+
+static void osTimeWheelAdvance(TIME Time)
+{
+  struct TTimeNotify FAR *TimeNotify, FAR *Next;
+  TIME PrevTime;
+  UINT32 Mask;
+  INDEX Level, Shift, Slot, PrevSlot;
+
+  /* Wheel time has not changed (compared across the wrap of the tick
+     counter) */
+  if((INT32) (Time - osTimeWheelTime) <= 0)
+    return;
+
+  /* Set the new wheel time */
+  PrevTime = osTimeWheelTime;
+  osTimeWheelTime = Time;
+
+  for(Level = 0; Level < OS_TIME_WHEEL_LEVELS; Level++)
+  {
+    Shift = Level * OS_TIME_WHEEL_BITS;
+
+    /* All slots are passed when time changed on the higher levels */
+    if(((Shift + OS_TIME_WHEEL_BITS) < 32) &&
+      ((PrevTime >> (Shift + OS_TIME_WHEEL_BITS)) !=
+      (Time >> (Shift + OS_TIME_WHEEL_BITS))))
+      Mask = 0xFFFFFFFFUL;
+
+    /* Otherwise slots after the previous one up to the current one */
+    else
+    {
+      PrevSlot = (INDEX) ((PrevTime >> Shift) & OS_TIME_WHEEL_MASK);
+      Slot = (INDEX) ((Time >> Shift) & OS_TIME_WHEEL_MASK);
+      if(PrevSlot == Slot)
+        break;
+
+      /* Slots of the highest level wrap with the tick counter */
+      Mask = 0xFFFFFFFFUL >> (PrevSlot + 1);
+      if(Slot > PrevSlot)
+        Mask &= ~((0xFFFFFFFFUL >> Slot) >> 1);
+      else
+        Mask |= ~((0xFFFFFFFFUL >> Slot) >> 1);
+    }
+
+    /* Insert descriptors of the passed slots again */
+    Mask &= osTimeWheelMap[Level];
+    while(Mask)
+    {
+      Slot = stCountLeadingZeros(Mask);
+      Mask &= ~OS_BITMAP_BIT(Slot);
+
+      /* Detach the whole list */
+      TimeNotify = osTimeWheel[Level][Slot];
+      osTimeWheel[Level][Slot] = NULL;
+      osTimeWheelMap[Level] &= ~OS_BITMAP_BIT(Slot);
+      TimeNotify->Prev->Next = NULL;
+
+      do
+      {
+        Next = TimeNotify->Next;
+        osTimeWheelPlace(TimeNotify);
+        TimeNotify = Next;
+      }
+      while(TimeNotify);
+    }
+  }
 }
 
 
@@ -608,31 +1239,17 @@ void osRegisterTimeNotify(struct TTimeNotify FAR *TimeNotify,
 {
   /* Unregister object if it is already registered */
   if(TimeNotify->Registered)
-     osUnregisterTimeNotify(TimeNotify);
+    osTimeWheelUnlink(TimeNotify);
 
   /* Define item */
   TimeNotify->Registered = TRUE;
   TimeNotify->Time = Time;
 
   /* Obtain the time notification descriptor priority */
-  if(TimeNotify->Task)
-    TimeNotify->Priority = TimeNotify->Task->Priority;
-  else
-  {
-    struct TWaitAssoc FAR *WaitAssoc;
+  TimeNotify->Priority = osGetTimeNotifyPriority(TimeNotify);
 
-    WaitAssoc = (struct TWaitAssoc FAR *)
-      stBSTreeGetFirst(&TimeNotify->Signal->WaitingTasks);
-    TimeNotify->Priority = (UINT8)
-      (WaitAssoc ? WaitAssoc->Task->Priority : OS_LOWEST_PRIORITY);
-  }
-
-  /* Add time notification descriptor into the queue */
-  stPQueueInsert(&osTimeNotifyQueue, &TimeNotify->Item, TimeNotify);
-
-  /* Update time notification array */
-  if(Time < osTimeNotifyArr[OS_PRIORITY_COUNT + TimeNotify->Priority])
-    osUpdateTimeNotify(TimeNotify, TimeNotify->Priority);
+  /* Insert time notification descriptor into the timing wheel */
+  osTimeWheelPlace(TimeNotify);
 }
 
 
@@ -652,40 +1269,13 @@ void osRegisterTimeNotify(struct TTimeNotify FAR *TimeNotify,
 
 void osUnregisterTimeNotify(struct TTimeNotify FAR *TimeNotify)
 {
-  UINT8 Priority;
-  struct TBSTreeNode FAR *BSTreeNode;
-  struct TTimeNotify FAR *Tmp;
-
   /* Return if object is not registered */
   if(!TimeNotify->Registered)
     return;
 
-  /* Get time notification descriptor priority */
-  Priority = TimeNotify->Priority;
-
-  /* Remove item from the queue */
-  stPQueueRemove(&osTimeNotifyQueue, &TimeNotify->Item);
+  /* Remove time notification descriptor from the timing wheel */
+  osTimeWheelUnlink(TimeNotify);
   TimeNotify->Registered = FALSE;
-
-  /* Find the minimal value with the same priority */
-  TimeNotify = NULL;
-  BSTreeNode = (struct TBSTreeNode FAR *) osTimeNotifyQueue.Tree.Root;
-  while(BSTreeNode)
-  {
-    Tmp = (struct TTimeNotify FAR *) BSTreeNode->Data;
-
-    if(Priority == Tmp->Priority)
-      TimeNotify = Tmp;
-
-    if(Priority <= Tmp->Priority)
-      BSTreeNode = Tmp->Item.Node.Left;
-
-    else
-      BSTreeNode = Tmp->Item.Node.Right;
-  }
-
-  /* Update time notification array */
-  osUpdateTimeNotify(TimeNotify, Priority);
 }
 
 
@@ -712,63 +1302,93 @@ void osUnregisterTimeNotify(struct TTimeNotify FAR *TimeNotify)
 
 static struct TTimeNotify FAR *osGetTimeNotify(UINT8 Priority, TIME Time)
 {
-  int i, Offset, BaseOffset;
-
-  /* Find time notification descriptor that meets specified conditions */
-  Offset = 0;
-  BaseOffset = 1;
-  for(i = 1; i < OS_PRIORITY_COUNT; i <<= 1)
-  {
-    /* Check time of the node */
-    if(osTimeNotifyArr[BaseOffset + Offset] > Time)
-      return NULL;
+  INDEX Word, Level;
 
-    /* Child position */
-    BaseOffset += i;
-    Offset <<= 1;
+  /* Move expired descriptors to the lists of their priorities */
+  osTimeWheelAdvance(Time);
 
-    /* Choose left or right child */
-    if(osTimeNotifyArr[BaseOffset + Offset] > Time)
-      Offset++;
+  /* No time notification has expired */
+  if(!osTimeDueGroup)
+    return NULL;
 
-    /* Check priority */
-    if(Offset > (Priority / ((OS_PRIORITY_COUNT >> 1) / i)))
-      return NULL;
-  }
+  /* Check priority of the highest priority expired descriptor */
+  Word = stCountLeadingZeros(osTimeDueGroup);
+  Level = (Word << 5) + stCountLeadingZeros(osTimeDueMap[Word]);
+  if(Level > Priority)
+    return NULL;
 
   /* Return pointer to time notification descriptor */
-  return osTimeNotify[Offset];
+  return osTimeNotifyDue[Level];
 }
 
 
 /***************************************************************************/
-#endif  /* OS_USE_TIME_OBJECTS */
+#if (OS_USE_TICKLESS)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
- *  System object opening, naming and handling
+ *  Name:
+ *    osGetNextTimeNotify
+ *
+ *  Description:
+ *    Returns the time of the earliest registered time notification. For
+ *    descriptors above the lowest wheel level the start time of their slot
+ *    is returned, which is never later than the notification time.
+ *    Function must be called from inside a critical section.
+ *
+ *  Return:
+ *    Notification time or OS_INFINITE if no notification is registered.
  *
  ***************************************************************************/
 
+static TIME osGetNextTimeNotify(void)
+{
+  INDEX Level, Shift;
+  TIME Time;
+
+  /* Expired time notification is pending */
+  if(osTimeDueGroup)
+    return osTimeWheelTime;
+
+  /* First used slot of the lowest non-empty level */
+  for(Level = 0; Level < OS_TIME_WHEEL_LEVELS; Level++)
+    if(osTimeWheelMap[Level])
+    {
+      Shift = Level * OS_TIME_WHEEL_BITS;
+      Time = ((Shift + OS_TIME_WHEEL_BITS) < 32) ? (osTimeWheelTime >>
+        (Shift + OS_TIME_WHEEL_BITS)) << (Shift + OS_TIME_WHEEL_BITS) : 0;
+      return Time | ((TIME) stCountLeadingZeros(osTimeWheelMap[Level]) <<
+        Shift);
+    }
+
+  /* No time notification is registered */
+  return OS_INFINITE;
+}
+
 
 /***************************************************************************/
-#if (OS_ALLOW_OBJECT_DELETION)
+#endif /* OS_USE_TICKLESS */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#else
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osObjectByHandleCmp
+ *    osTimeNotifyCmp
  *
  *  Description:
- *    Compares two object descriptors by their handle.
+ *    Compares two time notification descriptors.
  *
  *  Parameters:
- *    Item1 - Pointer to first object descriptor.
- *    Item2 - Pointer to second object descriptor.
+ *    Item1 - Pointer to first time notification descriptor.
+ *    Item2 - Pointer to second time notification descriptor.
  *
  *  Return:
  *    - < 0 if Item1 is less than Item2
@@ -777,15 +1397,23 @@ static struct TTimeNotify FAR *osGetTimeNotify(UINT8 Priority, TIME Time)
  *
  ***************************************************************************/
 
-int osObjectByHandleCmp(PVOID Item1, PVOID Item2)
+static int osTimeNotifyCmp(PVOID Item1, PVOID Item2)
 {
-  /* Compare handle of the objects */
-  if(((struct TSysObject FAR *) Item1)->Handle <
-    ((struct TSysObject FAR *) Item2)->Handle)
-    return -1;
+  register struct TTimeNotify FAR *T1;
+  register struct TTimeNotify FAR *T2;
+  register int Cmp;
 
-  if(((struct TSysObject FAR *) Item1)->Handle >
-    ((struct TSysObject FAR *) Item2)->Handle)
+  /* Compare items */
+  T1 = Item1;
+  T2 = Item2;
+
+  Cmp = ((int) T1->Priority) - ((int) T2->Priority);
+  if(Cmp != 0)
+    return Cmp;
+
+  if(T1->Time < T2->Time)
+    return -1;
+  if(T1->Time > T2->Time)
     return 1;
 
   /* Items are equal */
@@ -796,250 +1424,253 @@ int osObjectByHandleCmp(PVOID Item1, PVOID Item2)
 /****************************************************************************
  *
  *  Name:
- *    osOpenObject
+ *    osUpdateTimeNotify
  *
  *  Description:
- *    Opens the specified system object. The opened object becomes a child
- *    of the calling task and cannot be deleted until all tasks that opened
- *    the object close it using the osCloseHandle function. If the object
- *    is already opened by the calling task, the function returns
- *    immediately with success.
+ *    Internal function that updates the array used for searching time
+ *    notifications.
  *
  *  Parameters:
- *    Object - Pointer to system object descriptor.
- *
- *  Return:
- *    TRUE on success or FALSE on failure.
+ *    TimeNotify - Time notification descriptor pointer.
+ *    Priority - Priority of the time notification.
  *
  ***************************************************************************/
 
-static BOOL osOpenObject(struct TSysObject FAR *Object)
+static void osUpdateTimeNotify(struct TTimeNotify FAR *TimeNotify,
+  int Priority)
 {
-  struct TBSTreeNode FAR *Node;
-  BOOL PrevLockState, Success;
+  TIME Time, TimeOp;
 
-  /* Allocate memory for child descriptor */
-  Node = (struct TBSTreeNode FAR *) osMemAlloc(sizeof(*Node));
-  if(!Node)
-    return FALSE;
+  /* Update array */
+  osTimeNotify[Priority] = TimeNotify;
 
-  /* Enter critical section */
-  PrevLockState = arLock();
+  /* Update time tree */
+  Time = TimeNotify ? TimeNotify->Time : OS_INFINITE;
+  Priority += OS_PRIORITY_COUNT;
+  osTimeNotifyArr[Priority] = Time;
+  do
+  {
+    TimeOp = osTimeNotifyArr[Priority ^ 1];
+    if(Time > TimeOp)
+      Time = TimeOp;
 
-  /* Insert to task child tree */
-  Success = stBSTreeInsert(&osCurrentTask->Childs, Node, NULL, Object);
-  if(Success)
-    Object->OwnerCount++;
+    Priority >>= 1;
+    if(osTimeNotifyArr[Priority] == Time)
+      break;
 
-  /* Leave critical section */
-  arRestore(PrevLockState);
+    osTimeNotifyArr[Priority] = Time;
+  }
+  while(Priority > 1);
+}
 
-  /* If the object is already opened, the node descriptor is not used */
-  if(!Success)
-    osMemFree(Node);
 
-  /* Return with success */
-  return TRUE;
-}
+/****************************************************************************
+ *
+ *  Name:
+ *    osRegisterTimeNotify
+ *
+ *  Description:
+ *    Registers a time notification descriptor. Function must be called
+ *    from inside a critical section.
+ *
+ *  Parameters:
+ *    TimeNotify - Time notification descriptor pointer.
+ *    Time - Notification time.
+ *
+ ***************************************************************************/
 
+void osRegisterTimeNotify(struct TTimeNotify FAR *TimeNotify,
+  TIME Time)
+{
+  /* Unregister object if it is already registered */
+  if(TimeNotify->Registered)
+     osUnregisterTimeNotify(TimeNotify);
 
-/***************************************************************************/
-#endif /* OS_ALLOW_OBJECT_DELETION */
-/***************************************************************************/
+  /* Define item */
+  TimeNotify->Registered = TRUE;
+  TimeNotify->Time = Time;
+
+  /* Obtain the time notification descriptor priority */
+  TimeNotify->Priority = osGetTimeNotifyPriority(TimeNotify);
+
+  /* Add time notification descriptor into the queue */
+  stPQueueInsert(&osTimeNotifyQueue, &TimeNotify->Item, TimeNotify);
+
+  /* Update time notification array */
+  if(Time < osTimeNotifyArr[OS_PRIORITY_COUNT + TimeNotify->Priority])
+    osUpdateTimeNotify(TimeNotify, TimeNotify->Priority);
+}
 
 
 /****************************************************************************
  *
  *  Name:
- *    osTaskCmp
+ *    osUnregisterTimeNotify
  *
  *  Description:
- *    Compares two tasks by their priorities. When priorities are equal,
- *    it also compares the time quantum assign time.
+ *    Unregisters a time notification descriptor. Function must be called
+ *    from inside a critical section.
  *
  *  Parameters:
- *    Item1 - Pointer to first task descriptor.
- *    Item2 - Pointer to second task descriptor.
- *
- *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    TimeNotify - Time notification descriptor pointer.
  *
  ***************************************************************************/
 
-static int osTaskCmp(PVOID Item1, PVOID Item2)
+void osUnregisterTimeNotify(struct TTimeNotify FAR *TimeNotify)
 {
-  register struct TTask FAR *Task1;
-  register struct TTask FAR *Task2;
-  register int Cmp;
+  UINT8 Priority;
+  struct TBSTreeNode FAR *BSTreeNode;
+  struct TTimeNotify FAR *Tmp;
 
-  /* Get task pointers */
-  Task1 = (struct TTask FAR *) Item1;
-  Task2 = (struct TTask FAR *) Item2;
+  /* Return if object is not registered */
+  if(!TimeNotify->Registered)
+    return;
 
-  /* Compare task priorities */
-  Cmp = ((int) Task1->Priority) - ((int) Task2->Priority);
-  if(Cmp != 0)
-    return Cmp;
+  /* Get time notification descriptor priority */
+  Priority = TimeNotify->Priority;
 
-  /* Compare time quantum assign time when priorities are equal */
-  if(Task1->LastQuantumTime < Task2->LastQuantumTime)
-    return -1;
+  /* Remove item from the queue */
+  stPQueueRemove(&osTimeNotifyQueue, &TimeNotify->Item);
+  TimeNotify->Registered = FALSE;
 
-  if(Task1->LastQuantumTime > Task2->LastQuantumTime)
-    return 1;
+  /* Find the minimal value with the same priority */
+  TimeNotify = NULL;
+  BSTreeNode = (struct TBSTreeNode FAR *) osTimeNotifyQueue.Tree.Root;
+  while(BSTreeNode)
+  {
+    Tmp = (struct TTimeNotify FAR *) BSTreeNode->Data;
 
-  if(Task1->LastQuantumIndex < Task2->LastQuantumIndex)
-    return -1;
+    if(Priority == Tmp->Priority)
+      TimeNotify = Tmp;
 
-  if(Task1->LastQuantumIndex > Task2->LastQuantumIndex)
-    return 1;
+    if(Priority <= Tmp->Priority)
+      BSTreeNode = Tmp->Item.Node.Left;
 
-  /* Tasks are equal */
-  return 0;
+    else
+      BSTreeNode = Tmp->Item.Node.Right;
+  }
+
+  /* Update time notification array */
+  osUpdateTimeNotify(TimeNotify, Priority);
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osWaitAssocCmp
+ *    osGetTimeNotify
  *
  *  Description:
- *    Compares two wait associations by task priorities. When priorities
- *    are equal, it also compares the time quantum assign time.
+ *    Returns a pointer to a registered time notification descriptor.
+ *    The priority and time must be less than or equal to those specified
+ *    in the function parameters. If this condition is not met, the function
+ *    returns NULL.
+ *    Function must be called from inside a critical section.
  *
  *  Parameters:
- *    Item1 - Pointer to first association descriptor.
- *    Item2 - Pointer to second association descriptor.
+ *    Priority - Minimal priority value.
+ *    Time - Maximal time value.
  *
  *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    Time notification descriptor.
  *
  ***************************************************************************/
 
-int osWaitAssocCmp(PVOID Item1, PVOID Item2)
+static struct TTimeNotify FAR *osGetTimeNotify(UINT8 Priority, TIME Time)
 {
-  /* Compare association by tasks */
-  return osTaskCmp(
-    ((struct TWaitAssoc FAR *) Item1)->Task,
-    ((struct TWaitAssoc FAR *) Item2)->Task);
+  int i, Offset, BaseOffset;
+
+  /* Find time notification descriptor that meets specified conditions */
+  Offset = 0;
+  BaseOffset = 1;
+  for(i = 1; i < OS_PRIORITY_COUNT; i <<= 1)
+  {
+    /* Check time of the node */
+    if(osTimeNotifyArr[BaseOffset + Offset] > Time)
+      return NULL;
+
+    /* Child position */
+    BaseOffset += i;
+    Offset <<= 1;
+
+    /* Choose left or right child */
+    if(osTimeNotifyArr[BaseOffset + Offset] > Time)
+      Offset++;
+
+    /* Check priority */
+    if(Offset > (Priority / ((OS_PRIORITY_COUNT >> 1) / i)))
+      return NULL;
+  }
+
+  /* Return pointer to time notification descriptor */
+  return osTimeNotify[Offset];
 }
 
 
+/***************************************************************************/
+#if (OS_USE_TICKLESS)
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osRegisterObject
+ *    osGetNextTimeNotify
  *
  *  Description:
- *    Registers a new system object. The registered object is not ready to
- *    use, and the OS_OBJECT_FLAG_READY_TO_USE flag should be set after
- *    full object initialization and configuration. The registered object
- *    is in the signaled state by default.
- *
- *  Parameters:
- *    ObjectDesc - Pointer to specific object descriptor.
- *    Object - Pointer to system object descriptor.
- *    Type - Object type.
+ *    Returns the time of the earliest registered time notification.
+ *    Function must be called from inside a critical section.
  *
  *  Return:
- *    TRUE on success or FALSE on failure.
+ *    Notification time or OS_INFINITE if no notification is registered.
  *
  ***************************************************************************/
 
-BOOL osRegisterObject(PVOID ObjectDesc, struct TSysObject FAR *Object,
-  UINT8 Type)
+static TIME osGetNextTimeNotify(void)
 {
-  /* System object type */
-  Object->Type = Type;
+  /* Root of the time notification tree */
+  return osTimeNotifyArr[1];
+}
 
-  /* Initial flags (object is not ready to use) */
-  Object->Flags = 0;
 
-  /* Setup the default signal */
-  Object->Signal.Flags = 0;
-  Object->Signal.Signaled = (INDEX) TRUE;
-  stBSTreeInit(&Object->Signal.WaitingTasks, osWaitAssocCmp);
+/***************************************************************************/
+#endif /* OS_USE_TICKLESS */
+/***************************************************************************/
 
-  /* Object signalization descriptor */
-  #if (OS_USE_SYSTEM_IO_CTRL)
-    Object->Signal.Object = Object;
-  #endif
 
-  /* Critical section descriptor */
-  #if (OS_USE_CSEC_OBJECTS)
-    Object->Signal.CS = NULL;
-  #endif
+/***************************************************************************/
+#endif /* OS_USE_TIME_WHEEL */
+/***************************************************************************/
 
-  /* Multiple signals associated with object */
-  #if ((OS_USE_MULTIPLE_SIGNALS) && (OS_ALLOW_OBJECT_DELETION))
-    Object->Signal.NextSignal = NULL;
-  #endif
 
-  /* Object name descriptor pointer */
-  #if (OS_USE_OBJECT_NAMES)
-    Object->Name = NULL;
-  #endif
+/***************************************************************************/
+#endif  /* OS_USE_TIME_OBJECTS */
+/***************************************************************************/
 
-  /* Device IO control function for specified object */
-  #if (OS_USE_DEVICE_IO_CTRL)
-    Object->DeviceIOCtrl = NULL;
-  #endif
 
-  /* Add object to system object deinitialization list */
-  #if (OS_DEINIT_FUNC)
-    Object->PrevObject = NULL;
-    Object->NextObject = osFirstObject;
-    osFirstObject->PrevObject = Object;
-    osFirstObject = Object;
-  #endif
-
-  /* Pointer to specific object descriptor */
-  Object->ObjectDesc = ObjectDesc;
-
-  /* Try to assign new handle for the object */
-  if(!stHandleAlloc(&Object->Handle, Object, 0, Type))
-    return FALSE;
-
-  /* Open created object */
-  #if (OS_ALLOW_OBJECT_DELETION)
-    if(!osCurrentTask || osInISR)
-      Object->OwnerCount = 1;
-    else
-    {
-      Object->OwnerCount = 0;
-      if(!osOpenObject(Object))
-      {
-        stHandleRelease(Object->Handle);
-        return FALSE;
-      }
-    }
-  #endif
+/****************************************************************************
+ *
+ *  System object opening, naming and handling
+ *
+ ***************************************************************************/
 
-  /* Return with success */
-  return TRUE;
-}
 
 /***************************************************************************/
-#if (OS_USE_OBJECT_NAMES)
+#if (OS_ALLOW_OBJECT_DELETION)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osObjectByNameCmp
+ *    osObjectByHandleCmp
  *
  *  Description:
- *    Compares two name descriptors by object name.
+ *    Compares two object descriptors by their handle.
  *
  *  Parameters:
- *    Item1 - Pointer to first name descriptor.
- *    Item2 - Pointer to second name descriptor.
+ *    Item1 - Pointer to first object descriptor.
+ *    Item2 - Pointer to second object descriptor.
  *
  *  Return:
  *    - < 0 if Item1 is less than Item2
@@ -1048,476 +1679,476 @@ BOOL osRegisterObject(PVOID ObjectDesc, struct TSysObject FAR *Object,
  *
  ***************************************************************************/
 
-static int osObjectByNameCmp(PVOID Item1, PVOID Item2)
+int osObjectByHandleCmp(PVOID Item1, PVOID Item2)
 {
-  /* Compare string names */
-  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
-
-    return stStrNICmp(((struct TObjectName FAR *) Item1)->Name,
-      ((struct TObjectName FAR *) Item2)->Name, OS_SYS_OBJECT_MAX_NAME_LEN);
-
-  /* Compare integer names */
-  #else
-
-    if(((struct TObjectName FAR *) Item1)->Name <
-      ((struct TObjectName FAR *) Item2)->Name)
-      return -1;
-
-    if(((struct TObjectName FAR *) Item1)->Name >
-      ((struct TObjectName FAR *) Item2)->Name)
-      return 1;
+  /* Compare handle of the objects */
+  if(((struct TSysObject FAR *) Item1)->Handle <
+    ((struct TSysObject FAR *) Item2)->Handle)
+    return -1;
 
-    return 0;
+  if(((struct TSysObject FAR *) Item1)->Handle >
+    ((struct TSysObject FAR *) Item2)->Handle)
+    return 1;
 
-  #endif
+  /* Items are equal */
+  return 0;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osRegisterName
+ *    osOpenObject
  *
  *  Description:
- *    Registers a new name descriptor for the specified object.
+ *    Opens the specified system object. The opened object becomes a child
+ *    of the calling task and cannot be deleted until all tasks that opened
+ *    the object close it using the osCloseHandle function. If the object
+ *    is already opened by the calling task, the function returns
+ *    immediately with success.
  *
  *  Parameters:
  *    Object - Pointer to system object descriptor.
- *    ObjectName - Pointer to name descriptor.
- *    Name - Object name to register.
  *
  *  Return:
  *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-BOOL osRegisterName(struct TSysObject FAR *Object,
-  struct TObjectName FAR *ObjectName, SYSNAME Name)
+static BOOL osOpenObject(struct TSysObject FAR *Object)
 {
+  struct TBSTreeNode FAR *Node;
   BOOL PrevLockState, Success;
 
-  /* Assign empty string, if NULL is specified */
-  if(Name == NULL)
-    Name = "";
-
-  /* Return with success, when name is not specified */
-  if(Name[0] == '\0')
-    return TRUE;
-
-  /* Assign name */
-  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
-    stStrNCpy(ObjectName->Name, Name, OS_SYS_OBJECT_MAX_NAME_LEN);
-  #else
-    ObjectName->Name = Name;
-  #endif
-
-  /* Assign object descriptor pointer */
-  ObjectName->Object = Object;
+  /* Allocate memory for child descriptor */
+  Node = (struct TBSTreeNode FAR *) osMemAlloc(sizeof(*Node));
+  if(!Node)
+    return FALSE;
 
   /* Enter critical section */
   PrevLockState = arLock();
 
-  /* Register name descriptor in the system */
-  Success = stBSTreeInsert(&osSysNames, &ObjectName->Node, NULL, ObjectName);
+  /* Insert to task child tree */
+  Success = stBSTreeInsert(&osCurrentTask->Childs, Node, NULL, Object);
   if(Success)
-    Object->Name = ObjectName;
+    Object->OwnerCount++;
 
   /* Leave critical section */
   arRestore(PrevLockState);
 
-  /* Return status */
+  /* If the object is already opened, the node descriptor is not used */
   if(!Success)
-    osSetLastError(ERR_OBJECT_ALREADY_EXISTS);
+    osMemFree(Node);
 
-  return Success;
+  /* Return with success */
+  return TRUE;
 }
 
 
+/***************************************************************************/
+#endif /* OS_ALLOW_OBJECT_DELETION */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osOpenNamedObject
+ *    osTaskCmp
  *
  *  Description:
- *    Opens the specified system object by its name. When the specified
- *    type is different from OS_OBJECT_TYPE_IGNORE and the object type,
- *    the function will fail.
+ *    Compares two tasks by their priorities. When priorities are equal,
+ *    it also compares the time quantum assign time.
  *
  *  Parameters:
- *    Name - Object name.
- *    Type - Type of the object (or OS_OBJECT_TYPE_IGNORE to ignore).
+ *    Item1 - Pointer to first task descriptor.
+ *    Item2 - Pointer to second task descriptor.
  *
  *  Return:
- *    Pointer to opened system object or NULL on failure.
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
  *
  ***************************************************************************/
 
-struct TSysObject FAR *osOpenNamedObject(SYSNAME Name, UINT8 Type)
+static int osTaskCmp(PVOID Item1, PVOID Item2)
 {
-  struct TSysObject FAR *Object;
-  struct TObjectName FAR *ObjectName;
-  struct TObjectName TmpName;
-  BOOL PrevLockState;
+  register struct TTask FAR *Task1;
+  register struct TTask FAR *Task2;
+  register int Cmp;
 
-  /* Object can be opened only by a task */
-  if(!osCurrentTask || osInISR)
-  {
-    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
-    return NULL;
-  }
+  /* Get task pointers */
+  Task1 = (struct TTask FAR *) Item1;
+  Task2 = (struct TTask FAR *) Item2;
 
-  /* Prepare temporary name descriptor */
-  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
-    stStrNCpy(TmpName.Name, Name, OS_SYS_OBJECT_MAX_NAME_LEN);
-  #else
-    TmpName.Name = Name;
-  #endif
+  /* Compare task priorities */
+  Cmp = ((int) Task1->Priority) - ((int) Task2->Priority);
+  if(Cmp != 0)
+    return Cmp;
 
-  /* Enter critical section */
-  PrevLockState = arLock();
+  /* Compare time quantum assign time when priorities are equal */
+  if(Task1->LastQuantumTime < Task2->LastQuantumTime)
+    return -1;
 
-  /* Find object by name */
-  ObjectName =
-    (struct TObjectName FAR *) stBSTreeSearch(&osSysNames, &TmpName);
-  Object = ObjectName ? ObjectName->Object : NULL;
+  if(Task1->LastQuantumTime > Task2->LastQuantumTime)
+    return 1;
 
-  /* Leave critical section */
-  arRestore(PrevLockState);
+  if(Task1->LastQuantumIndex < Task2->LastQuantumIndex)
+    return -1;
 
-  /* [!] NOTE: Deleting the object at this moment will cause an error.
-     Ensure the object remains valid until opened. */
+  if(Task1->LastQuantumIndex > Task2->LastQuantumIndex)
+    return 1;
 
-  /* Object not found */
-  while(Object)
-  {
-    /* Check object type */
-    if(Object->Type != Type)
-      break;
+  /* Tasks are equal */
+  return 0;
+}
 
-    /* Return with error if object is not ready to use yet */
-    if(!(Object->Flags & OS_OBJECT_FLAG_READY_TO_USE))
-      break;
 
-    /* Open object */
-    #if (OS_ALLOW_OBJECT_DELETION)
-      return osOpenObject(Object) ? Object : NULL;
-    #else
-      return Object;
-    #endif
-  }
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitAssocCmp
+ *
+ *  Description:
+ *    Compares two wait associations by task priorities. When priorities
+ *    are equal, it also compares the time quantum assign time.
+ *
+ *  Parameters:
+ *    Item1 - Pointer to first association descriptor.
+ *    Item2 - Pointer to second association descriptor.
+ *
+ *  Return:
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
+ *
+ ***************************************************************************/
 
-  /* Object opening failure */
-  osSetLastError(ERR_OBJECT_CAN_NOT_BE_OPENED);
-  return NULL;
+int osWaitAssocCmp(PVOID Item1, PVOID Item2)
+{
+  /* Compare association by tasks */
+  return osTaskCmp(
+    ((struct TWaitAssoc FAR *) Item1)->Task,
+    ((struct TWaitAssoc FAR *) Item2)->Task);
 }
 
 
-/***************************************************************************/
-#endif /* OS_USE_OBJECT_NAMES */
-/***************************************************************************/
-
-
 /****************************************************************************
  *
  *  Name:
- *    osGetObjectByHandle
+ *    osRegisterObject
  *
  *  Description:
- *    Returns a pointer to the system object descriptor specified by the
- *    handle. The function fails if the specified type is different from
- *    OS_OBJECT_TYPE_IGNORE and the object type.
+ *    Registers a new system object. The registered object is not ready to
+ *    use, and the OS_OBJECT_FLAG_READY_TO_USE flag should be set after
+ *    full object initialization and configuration. The registered object
+ *    is in the signaled state by default.
  *
  *  Parameters:
- *    Handle - Object handle.
- *    Type - Object type or OS_OBJECT_TYPE_IGNORE.
+ *    ObjectDesc - Pointer to specific object descriptor.
+ *    Object - Pointer to system object descriptor.
+ *    Type - Object type.
  *
  *  Return:
- *    Pointer to system object descriptor or NULL on failure.
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-struct TSysObject FAR *osGetObjectByHandle(HANDLE Handle, UINT8 Type)
+BOOL osRegisterObject(PVOID ObjectDesc, struct TSysObject FAR *Object,
+  UINT8 Type)
 {
-  struct TSysObject FAR *Object;
+  /* System object type */
+  Object->Type = Type;
 
-  /* Get object by handle */
-  if(!stGetHandleInfo(Handle, (PVOID *) &Object, Type))
-    return NULL;
+  /* Initial flags (object is not ready to use) */
+  Object->Flags = 0;
 
-  while(TRUE)
-  {
-    /* Is the object ready to use? */
-    if(!(Object->Flags & OS_OBJECT_FLAG_READY_TO_USE))
-      break;
+  /* Setup the default signal */
+  Object->Signal.Flags = 0;
+  Object->Signal.Signaled = (INDEX) TRUE;
+  stBSTreeInit(&Object->Signal.WaitingTasks, osWaitAssocCmp);
 
-    /* Check object type */
-    if(Type != OS_OBJECT_TYPE_IGNORE)
-      if(Object->Type != Type)
-        break;
+  /* Object signalization descriptor */
+  #if ((OS_USE_SYSTEM_IO_CTRL) || (OS_USE_LATENCY_HISTOGRAM) || \
+    (OS_USE_LOCK_PROFILER))
+    Object->Signal.Object = Object;
+  #endif
 
-    /* Return object pointer */
-    return Object;
-  }
+  /* No task waited for the object yet */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    stMemSet(Object->WaitHistogram, 0x00, sizeof(Object->WaitHistogram));
+  #endif
 
-  /* Failure, object cannot be used */
-  osSetLastError(ERR_INVALID_HANDLE);
-  return NULL;
-}
+  /* Critical section descriptor */
+  #if (OS_USE_CSEC_OBJECTS)
+    Object->Signal.CS = NULL;
+  #endif
+
+  /* Multiple signals associated with object */
+  #if ((OS_USE_MULTIPLE_SIGNALS) && (OS_ALLOW_OBJECT_DELETION))
+    Object->Signal.NextSignal = NULL;
+  #endif
+
+  /* Wait sets watching the object */
+  #if (OS_USE_WAIT_SET)
+    Object->Signal.Watches = NULL;
+  #endif
+
+  /* Object name descriptor pointer */
+  #if (OS_USE_OBJECT_NAMES)
+    Object->Name = NULL;
+  #endif
+
+  /* Device IO control function for specified object */
+  #if (OS_USE_DEVICE_IO_CTRL)
+    Object->DeviceIOCtrl = NULL;
+  #endif
+
+  /* Add object to system object deinitialization list */
+  #if (OS_DEINIT_FUNC)
+    Object->PrevObject = NULL;
+    Object->NextObject = osFirstObject;
+    osFirstObject->PrevObject = Object;
+    osFirstObject = Object;
+  #endif
+
+  /* Pointer to specific object descriptor */
+  Object->ObjectDesc = ObjectDesc;
+
+  /* Try to assign new handle for the object */
+  if(!stHandleAlloc(&Object->Handle, Object, 0, Type))
+    return FALSE;
 
+  /* Open created object */
+  #if (OS_ALLOW_OBJECT_DELETION)
+    if(!osCurrentTask || osInISR)
+      Object->OwnerCount = 1;
+    else
+    {
+      Object->OwnerCount = 0;
+      if(!osOpenObject(Object))
+      {
+        stHandleRelease(Object->Handle);
+        return FALSE;
+      }
+    }
+  #endif
+
+  #if (OS_USE_TRACE)
+    osTraceRecord(OS_TRACE_CREATE, osCurrentTask, &Object->Signal,
+      (UINT32) ((unsigned long) Object->Handle), (UINT16) Type);
+  #endif
+
+  /* Return with success */
+  return TRUE;
+}
 
 /***************************************************************************/
-#if (OS_OPEN_BY_HANDLE_FUNC)
+#if (OS_USE_OBJECT_NAMES)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osOpenByHandle
+ *    osObjectByNameCmp
  *
  *  Description:
- *    Opens the specified system object by its handle.
+ *    Compares two name descriptors by object name.
  *
  *  Parameters:
- *    Handle - Object handle.
+ *    Item1 - Pointer to first name descriptor.
+ *    Item2 - Pointer to second name descriptor.
  *
  *  Return:
- *    TRUE on success or FALSE on failure.
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
  *
  ***************************************************************************/
 
-BOOL osOpenByHandle(HANDLE Handle)
+static int osObjectByNameCmp(PVOID Item1, PVOID Item2)
 {
-  struct TSysObject FAR *Object;
+  /* Compare string names */
+  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
 
-  /* Get object by handle */
-  if(!stGetHandleInfo(Handle, (PVOID *) &Object, ST_HANDLE_TYPE_IGNORE))
-    return FALSE;
+    return stStrNICmp(((struct TObjectName FAR *) Item1)->Name,
+      ((struct TObjectName FAR *) Item2)->Name, OS_SYS_OBJECT_MAX_NAME_LEN);
 
-  /* [!] NOTE: Deleting the object at this moment will cause an error. */
+  /* Compare integer names */
+  #else
 
-  /* Try to open the object */
-  return osOpenObject(Object);
-}
+    if(((struct TObjectName FAR *) Item1)->Name <
+      ((struct TObjectName FAR *) Item2)->Name)
+      return -1;
 
+    if(((struct TObjectName FAR *) Item1)->Name >
+      ((struct TObjectName FAR *) Item2)->Name)
+      return 1;
 
-/***************************************************************************/
-#endif /* OS_OPEN_BY_HANDLE_FUNC */
-/***************************************************************************/
+    return 0;
+
+  #endif
+}
 
 
 /***************************************************************************/
-#if (OS_ALLOW_OBJECT_DELETION)
+#if ((OS_NAME_HASH_SIZE) > 0UL)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osDeleteObject
+ *    osNameHash
  *
  *  Description:
- *    Deletes the specified system object. Before deletion, the object is
- *    marked as not ready to use. Corresponding deinit IO control code is
- *    performed (when defined). If the deleting object is a task, it also
- *    releases the task context. Finally, the memory of the specific
- *    object descriptor is released.
+ *    Calculates the hash of the object name (FNV-1a). String names are
+ *    hashed case-insensitively, consistently with osObjectByNameCmp.
  *
  *  Parameters:
- *    Object - Pointer to system object descriptor.
+ *    ObjectName - Pointer to name descriptor.
+ *
+ *  Return:
+ *    Hash of the name.
  *
  ***************************************************************************/
 
-void osDeleteObject(struct TSysObject FAR *Object)
+static UINT32 osNameHash(struct TObjectName FAR *ObjectName)
 {
-  /* Mark as not ready to use */
-  Object->Flags &= (UINT8) ~OS_OBJECT_FLAG_READY_TO_USE;
+  UINT32 Hash;
 
-  /* Perform device IO control code for deinitialization */
-  #if (OS_USE_DEVICE_IO_CTRL)
-    if(Object->Flags & OS_OBJECT_FLAG_USES_IO_DEINIT)
-      Object->DeviceIOCtrl(Object, DEV_IO_CTL_DEINIT, NULL, 0, NULL);
-  #endif
+  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
+    SIZE i;
+    char Ch;
 
-  /* Remove object from system object deinitialization list */
-  #if (OS_DEINIT_FUNC)
-    if(Object->PrevObject)
-      Object->PrevObject->NextObject = Object->NextObject;
-    else
-      osFirstObject = Object->NextObject;
-    if(Object->NextObject)
-      Object->NextObject->PrevObject = Object->PrevObject;
-  #endif
+    /* Hash characters up to the end of the string or the length limit */
+    Hash = 2166136261UL;
+    for(i = 0; i < OS_SYS_OBJECT_MAX_NAME_LEN; i++)
+    {
+      Ch = ObjectName->Name[i];
+      if(Ch == '\0')
+        break;
 
-  /* Unregister object name from the system */
-  #if (OS_USE_OBJECT_NAMES)
-    if(Object->Name)
-      stBSTreeRemove(&osSysNames, &Object->Name->Node);
-  #endif
+      if((Ch >= 'a') && (Ch <= 'z'))
+        Ch -= (char) ('a' - 'A');
 
-  /* Release task context if object is a task */
-  if(Object->Type == OS_OBJECT_TYPE_TASK)
-    arReleaseTaskContext(&((struct TTask FAR *)
-      Object->ObjectDesc)->TaskContext);
+      Hash = (Hash ^ (UINT8) Ch) * 16777619UL;
+    }
 
-  /* Release object handle */
-  stHandleRelease(Object->Handle);
+  #else
 
-  /* Release memory allocated for the object descriptor */
-  osMemFree(Object);
+    /* Spread integer names over the table (Fibonacci hashing) */
+    Hash = (UINT32) ObjectName->Name * 2654435769UL;
+
+  #endif
+
+  return Hash;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osCloseObject
+ *    osFindNameSlot
  *
  *  Description:
- *    Closes the system object for the specified task. When the closed
- *    object has no more owners, it will be deleted. If the object is a
- *    task, it will be deleted only when it is terminated.
+ *    Finds the slot of the hash table holding the specified name (linear
+ *    probing). The table always has at least one empty slot, so the
+ *    search ends at the first empty slot when the name is not registered.
  *
  *  Parameters:
- *    Handle - Object handle.
- *    Task - Object parent.
+ *    ObjectName - Pointer to name descriptor with the hash calculated.
  *
  *  Return:
- *    TRUE on success or FALSE on failure.
+ *    Index of the slot holding the name, or of the empty slot where the
+ *    name should be inserted.
  *
  ***************************************************************************/
 
-static BOOL osCloseObject(struct TSysObject FAR *Object,
-  struct TTask FAR *Task)
+static UINT32 osFindNameSlot(struct TObjectName FAR *ObjectName)
 {
-  struct TBSTreeNode FAR *Node;
-
-  #if (OS_USE_CSEC_OBJECTS)
-    struct TCSAssoc FAR *CSAssoc;
-    struct TCriticalSection FAR *CS;
-
-    #if (OS_USE_MULTIPLE_SIGNALS)
-      struct TSignal FAR *Signal;
-    #endif
-  #endif
+  struct TObjectName FAR *SlotName;
+  UINT32 Slot;
 
-  /* Find corresponding child */
-  Node = Task->Childs.Root;
-  while(Node)
+  /* Probe subsequent slots starting from the home slot of the hash */
+  Slot = ObjectName->Hash & (OS_NAME_HASH_SIZE - 1UL);
+  while(TRUE)
   {
-    int Cmp;
-
-    /* Compare objects by their handles */
-    Cmp = osObjectByHandleCmp(Object, (struct TSysObject FAR *) Node->Data);
-    if(!Cmp)
+    SlotName = osSysNameHash[Slot];
+    if(!SlotName)
       break;
 
-    Node = (Cmp < 0) ? Node->Left : Node->Right;
-  }
+    /* Compare names only when hashes are equal */
+    if(SlotName->Hash == ObjectName->Hash)
+      if(!osObjectByNameCmp(SlotName, ObjectName))
+        break;
 
-  /* Return if specified object is not a child of the task */
-  if(!Node)
-  {
-    osSetLastError(ERR_INVALID_HANDLE);
-    return FALSE;
+    Slot = (Slot + 1UL) & (OS_NAME_HASH_SIZE - 1UL);
   }
 
-  /* Remove a child */
-  stBSTreeRemove(&Task->Childs, Node);
-  osMemFree(Node);
+  /* Return slot index */
+  return Slot;
+}
 
-  /* Release each abandoned critical section associated with specified
-     object */
-  #if (OS_USE_CSEC_OBJECTS)
-    #if (OS_USE_MULTIPLE_SIGNALS)
-      Signal = &Object->Signal;
-      while(TRUE)
-      {
-        CS = Signal->CS;
-    #else
-        CS = Object->Signal.CS;
-    #endif
 
-        /* Release abandoned critical section (if owned) */
-        if(CS)
-        {
-          CSAssoc = osFindCSAssoc(CS, Task);
-          if(CSAssoc)
-          {
-            CS->Signal->Flags |= OS_SIGNAL_FLAG_ABANDONED;
-            osReleaseCS(CS, Task, CSAssoc->Count, NULL);
-          }
-        }
+/***************************************************************************/
+#if (OS_ALLOW_OBJECT_DELETION)
+/***************************************************************************/
 
-    #if (OS_USE_MULTIPLE_SIGNALS)
 
-        /* Check next signal */
-        Signal = Signal->NextSignal;
-        if(!Signal)
-          break;
-      }
-    #endif
-  #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osRemoveName
+ *
+ *  Description:
+ *    Removes the name descriptor from the hash table. Subsequent names of
+ *    the probe sequence are shifted back, so no deleted slot markers are
+ *    necessary.
+ *
+ *  Parameters:
+ *    ObjectName - Pointer to registered name descriptor.
+ *
+ ***************************************************************************/
 
-  /* Decrease object owner counter. When it reaches zero, the object
-     is not owned (opened) by any task and should be deleted */
-  Object->OwnerCount--;
-  if(!Object->OwnerCount)
-  {
-    /* When object is a task, delete it only when it is terminated */
-    if(Object->Type == OS_OBJECT_TYPE_TASK)
-    {
-      if(((struct TTask FAR *) Object->ObjectDesc)->BlockingFlags &
-        OS_BLOCK_FLAG_TERMINATED)
-        osDeleteObject(Object);
-    }
-
-    /* Delete object */
-    else
-      osDeleteObject(Object);
-  }
+static void osRemoveName(struct TObjectName FAR *ObjectName)
+{
+  UINT32 Slot, Next, Home;
+  BOOL PrevLockState;
 
-  /* Return with success */
-  return TRUE;
-}
+  /* Enter critical section */
+  PrevLockState = arLock();
 
+  /* Find the slot holding the descriptor */
+  Slot = ObjectName->Hash & (OS_NAME_HASH_SIZE - 1UL);
+  while(osSysNameHash[Slot] != ObjectName)
+    Slot = (Slot + 1UL) & (OS_NAME_HASH_SIZE - 1UL);
 
-/****************************************************************************
- *
- *  Name:
- *    osCloseHandle
- *
- *  Description:
- *    Closes the system object for the current task. When the closed object
- *    has no more owners, it will be deleted. If the object is a task, it
- *    will be deleted only when it is terminated.
- *
- *  Parameters:
- *    Handle - Object handle.
- *
- *  Return:
- *    TRUE on success or FALSE on failure.
- *
- ***************************************************************************/
+  /* Move back each following name that cannot be found anymore when
+     the slot becomes empty */
+  Next = Slot;
+  while(TRUE)
+  {
+    Next = (Next + 1UL) & (OS_NAME_HASH_SIZE - 1UL);
+    if(!osSysNameHash[Next])
+      break;
 
-BOOL osCloseHandle(HANDLE Handle)
-{
-  struct TSysObject FAR *Object;
+    /* Skip the name if its home slot lies cyclically in (Slot, Next] */
+    Home = osSysNameHash[Next]->Hash & (OS_NAME_HASH_SIZE - 1UL);
+    if((Slot <= Next) ? ((Slot < Home) && (Home <= Next)) :
+      ((Slot < Home) || (Home <= Next)))
+      continue;
 
-  /* Can be performed only by a task */
-  if(!osCurrentTask || osInISR)
-  {
-    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
-    return FALSE;
+    osSysNameHash[Slot] = osSysNameHash[Next];
+    Slot = Next;
   }
 
-  /* Get object by handle */
-  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_IGNORE);
-  if(!Object)
-    return FALSE;
+  /* Release the last slot of the shifted sequence */
+  osSysNameHash[Slot] = NULL;
+  osSysNameCount--;
 
-  /* Close specified object */
-  return osCloseObject(Object, osCurrentTask);
+  /* Leave critical section */
+  arRestore(PrevLockState);
 }
 
 
@@ -1527,502 +2158,693 @@ BOOL osCloseHandle(HANDLE Handle)
 
 
 /***************************************************************************/
-#if ((OS_ALLOW_OBJECT_DELETION) || (OS_USE_CSEC_OBJECTS))
+#endif /* OS_NAME_HASH_SIZE > 0UL */
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osReleaseTaskResources
+ *    osRegisterName
  *
  *  Description:
- *    Releases each owned critical section and marks it as abandoned. It also
- *    closes all opened objects. When a closed object has no more owners,
- *    it will be deleted. When the closing object is a task, it will be
- *    deleted only when it is terminated.
+ *    Registers a new name descriptor for the specified object.
  *
  *  Parameters:
- *    Task - A pointer to task descriptor.
+ *    Object - Pointer to system object descriptor.
+ *    ObjectName - Pointer to name descriptor.
+ *    Name - Object name to register.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-void osReleaseTaskResources(struct TTask FAR *Task)
+BOOL osRegisterName(struct TSysObject FAR *Object,
+  struct TObjectName FAR *ObjectName, SYSNAME Name)
 {
-  #if (OS_ALLOW_OBJECT_DELETION)
-    struct TSysObject FAR *Object;
-  #endif
+  BOOL PrevLockState;
 
-  #if (OS_USE_CSEC_OBJECTS)
-    struct TCSAssoc FAR *CSAssoc;
+  #if ((OS_NAME_HASH_SIZE) > 0UL)
+    ERROR ErrorCode;
+    UINT32 Slot;
+  #else
+    BOOL Success;
   #endif
 
-  /* Release owned critical sections */
-  #if (OS_USE_CSEC_OBJECTS)
-    while(TRUE)
-    {
-      /* Get first critical section with the highest priority */
-      CSAssoc = (struct TCSAssoc FAR *) stPQueueGet(&Task->OwnedCS);
-      if(!CSAssoc)
-        break;
+  /* Assign empty string, if NULL is specified */
+  if(Name == NULL)
+    Name = "";
 
-      /* Release abandoned critical section */
-      CSAssoc->CS->Signal->Flags |= OS_SIGNAL_FLAG_ABANDONED;
-      osReleaseCS(CSAssoc->CS, Task, CSAssoc->Count, NULL);
-    }
+  /* Return with success, when name is not specified */
+  if(Name[0] == '\0')
+    return TRUE;
+
+  /* Assign name */
+  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
+    stStrNCpy(ObjectName->Name, Name, OS_SYS_OBJECT_MAX_NAME_LEN);
+  #else
+    ObjectName->Name = Name;
   #endif
 
-  /* Close each child (opened objects) */
-  #if (OS_ALLOW_OBJECT_DELETION)
-    while(TRUE)
-    {
-      Object = (struct TSysObject FAR *) stBSTreeGetFirst(&Task->Childs);
-      if(!Object)
-        break;
+  /* Assign object descriptor pointer */
+  ObjectName->Object = Object;
 
-      /* Close object */
-      osCloseObject(Object, osCurrentTask);
+  /* Register name descriptor in the hash table. One slot always stays
+     empty to terminate unsuccessful searches. */
+  #if ((OS_NAME_HASH_SIZE) > 0UL)
+
+    ObjectName->Hash = osNameHash(ObjectName);
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* Check free space and name uniqueness */
+    ErrorCode = ERR_NO_ERROR;
+    if(osSysNameCount >= OS_NAME_HASH_SIZE - 1UL)
+      ErrorCode = ERR_NAME_TABLE_IS_FULL;
+    else
+    {
+      Slot = osFindNameSlot(ObjectName);
+      if(osSysNameHash[Slot])
+        ErrorCode = ERR_OBJECT_ALREADY_EXISTS;
+      else
+      {
+        osSysNameHash[Slot] = ObjectName;
+        osSysNameCount++;
+        Object->Name = ObjectName;
+      }
     }
-  #endif
-}
 
+    /* Leave critical section */
+    arRestore(PrevLockState);
 
-/***************************************************************************/
-#endif /* OS_ALLOW_OBJECT_DELETION || OS_USE_CSEC_OBJECTS */
-/***************************************************************************/
+    /* Return status */
+    if(ErrorCode)
+      osSetLastError(ErrorCode);
 
+    return (BOOL) !ErrorCode;
 
-/****************************************************************************
- *
- *  Deferred signalization queue management
- *
- ***************************************************************************/
+  /* Register name descriptor in the binary search tree */
+  #else
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* Register name descriptor in the system */
+    Success = stBSTreeInsert(&osSysNames, &ObjectName->Node, NULL,
+      ObjectName);
+    if(Success)
+      Object->Name = ObjectName;
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+
+    /* Return status */
+    if(!Success)
+      osSetLastError(ERR_OBJECT_ALREADY_EXISTS);
+
+    return Success;
+
+  #endif
+}
 
 
 /****************************************************************************
  *
  *  Name:
- *    osSignalCmp
+ *    osOpenNamedObject
  *
  *  Description:
- *    Compares two signals by their priorities. The signal priority is
- *    the highest priority of all the tasks waiting for the signal.
+ *    Opens the specified system object by its name. When the specified
+ *    type is different from OS_OBJECT_TYPE_IGNORE and the object type,
+ *    the function will fail.
  *
  *  Parameters:
- *    Item1 - Pointer to first signal descriptor.
- *    Item2 - Pointer to second signal descriptor.
+ *    Name - Object name.
+ *    Type - Type of the object (or OS_OBJECT_TYPE_IGNORE to ignore).
  *
  *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    Pointer to opened system object or NULL on failure.
  *
  ***************************************************************************/
 
-static int osSignalCmp(PVOID Item1, PVOID Item2)
+struct TSysObject FAR *osOpenNamedObject(SYSNAME Name, UINT8 Type)
 {
-  /* Compare specified signals by priority of waiting tasks */
-  return osTaskCmp(
-    ((struct TWaitAssoc FAR *) stBSTreeGetFirst(&((struct TSignal FAR *)
-      Item1)->WaitingTasks))->Task,
-    ((struct TWaitAssoc FAR *) stBSTreeGetFirst(&((struct TSignal FAR *)
-      Item2)->WaitingTasks))->Task);
+  struct TSysObject FAR *Object;
+  struct TObjectName FAR *ObjectName;
+  struct TObjectName TmpName;
+  BOOL PrevLockState;
+
+  /* Object can be opened only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return NULL;
+  }
+
+  /* Prepare temporary name descriptor */
+  #if ((OS_SYS_OBJECT_MAX_NAME_LEN) > 0UL)
+    stStrNCpy(TmpName.Name, Name, OS_SYS_OBJECT_MAX_NAME_LEN);
+  #else
+    TmpName.Name = Name;
+  #endif
+
+  /* Calculate the name hash */
+  #if ((OS_NAME_HASH_SIZE) > 0UL)
+    TmpName.Hash = osNameHash(&TmpName);
+  #endif
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Find object by name */
+  #if ((OS_NAME_HASH_SIZE) > 0UL)
+    ObjectName = osSysNameHash[osFindNameSlot(&TmpName)];
+  #else
+    ObjectName =
+      (struct TObjectName FAR *) stBSTreeSearch(&osSysNames, &TmpName);
+  #endif
+  Object = ObjectName ? ObjectName->Object : NULL;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+
+  /* [!] NOTE: Deleting the object at this moment will cause an error.
+     Ensure the object remains valid until opened. */
+
+  /* Object not found */
+  while(Object)
+  {
+    /* Check object type */
+    if(Object->Type != Type)
+      break;
+
+    /* Return with error if object is not ready to use yet */
+    if(!(Object->Flags & OS_OBJECT_FLAG_READY_TO_USE))
+      break;
+
+    /* Open object */
+    #if (OS_ALLOW_OBJECT_DELETION)
+      return osOpenObject(Object) ? Object : NULL;
+    #else
+      return Object;
+    #endif
+  }
+
+  /* Object opening failure */
+  osSetLastError(ERR_OBJECT_CAN_NOT_BE_OPENED);
+  return NULL;
 }
 
+
+/***************************************************************************/
+#endif /* OS_USE_OBJECT_NAMES */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osSignalUpdated
+ *    osGetObjectByHandle
  *
  *  Description:
- *    Puts the specified signal in the valid position of the deferred
- *    signalization list or removes it if necessary.
+ *    Returns a pointer to the system object descriptor specified by the
+ *    handle. The function fails if the specified type is different from
+ *    OS_OBJECT_TYPE_IGNORE and the object type.
  *
  *  Parameters:
- *    Signal - Pointer to signal descriptor.
+ *    Handle - Object handle.
+ *    Type - Object type or OS_OBJECT_TYPE_IGNORE.
  *
  *  Return:
- *    Pointer to the first task waiting for the signal or NULL when no
- *    task is waiting for the signal.
+ *    Pointer to system object descriptor or NULL on failure.
  *
  ***************************************************************************/
 
-static struct TTask FAR *osSignalUpdated(struct TSignal FAR *Signal)
+struct TSysObject FAR *osGetObjectByHandle(HANDLE Handle, UINT8 Type)
 {
-  struct TWaitAssoc FAR *WaitAssoc;
+  struct TSysObject FAR *Object;
 
-  /* Remove signal from deferred signalization list */
-  if(Signal->Flags & OS_SIGNAL_FLAG_DEFERRED)
-  {
-    stBSTreeRemove(&osDeferredSignal, &Signal->DeferredSgn);
-    Signal->Flags &= (UINT8) ~OS_SIGNAL_FLAG_DEFERRED;
-  }
+  /* Get object by handle */
+  if(!stGetHandleInfo(Handle, (PVOID *) &Object, Type))
+    return NULL;
 
-  /* Insert signal into deferred signalization list if necessary */
-  WaitAssoc = (struct TWaitAssoc FAR *)
-    stBSTreeGetFirst(&Signal->WaitingTasks);
-  if(Signal->Signaled && WaitAssoc)
+  while(TRUE)
   {
-    stBSTreeInsert(&osDeferredSignal, &Signal->DeferredSgn, NULL, Signal);
-    Signal->Flags |= OS_SIGNAL_FLAG_DEFERRED;
-  }
+    /* Is the object ready to use? */
+    if(!(Object->Flags & OS_OBJECT_FLAG_READY_TO_USE))
+      break;
 
-  /* [!] ISSUE: Check when this is called. There might be a bug if this is
-     called when the priority is the same, as it might change the position
-     in the queue incorrectly. */
+    /* Check object type */
+    if(Type != OS_OBJECT_TYPE_IGNORE)
+      if(Object->Type != Type)
+        break;
 
-  /* Pointer to first task waiting for signal */
-  return WaitAssoc ? WaitAssoc->Task : NULL;
+    /* Return object pointer */
+    return Object;
+  }
+
+  /* Failure, object cannot be used */
+  osSetLastError(ERR_INVALID_HANDLE);
+  return NULL;
 }
 
 
-/****************************************************************************
- *
- *  Scheduling
- *
- ***************************************************************************/
+/***************************************************************************/
+#if (OS_OPEN_BY_HANDLE_FUNC)
+/***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osRoundRobinTaskCmp
+ *    osOpenByHandle
  *
  *  Description:
- *    Compares two tasks only by their priorities.
+ *    Opens the specified system object by its handle.
  *
  *  Parameters:
- *    Item1 - Pointer to first task descriptor.
- *    Item2 - Pointer to second task descriptor.
+ *    Handle - Object handle.
  *
  *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-static int osRoundRobinTaskCmp(PVOID Item1, PVOID Item2)
+BOOL osOpenByHandle(HANDLE Handle)
 {
-  /* Compare tasks by their priorities only */
-  return ((int) ((struct TTask FAR *) Item1)->Priority) -
-    ((int) ((struct TTask FAR *) Item2)->Priority);
+  struct TSysObject FAR *Object;
+
+  /* Get object by handle */
+  if(!stGetHandleInfo(Handle, (PVOID *) &Object, ST_HANDLE_TYPE_IGNORE))
+    return FALSE;
+
+  /* [!] NOTE: Deleting the object at this moment will cause an error. */
+
+  /* Try to open the object */
+  return osOpenObject(Object);
 }
 
 
+/***************************************************************************/
+#endif /* OS_OPEN_BY_HANDLE_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_ALLOW_OBJECT_DELETION)
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osSchedCmp
+ *    osFindChild
  *
  *  Description:
- *    Compares the current task with another specified task. If the
- *    priority is higher, the current task pointer is overwritten with
- *    the specified task and the reason code is set.
+ *    Finds the node of the task child tree associated with the object.
  *
  *  Parameters:
- *    Reason - Pointer to current reason index.
- *    NewReason - New reason index.
- *    Task - New task pointer (may be NULL).
+ *    Object - Pointer to system object descriptor.
+ *    Task - Object parent.
+ *
+ *  Return:
+ *    Pointer to the child node or NULL if the object is not opened by the
+ *    task.
  *
  ***************************************************************************/
 
-static void osSchedCmp(INDEX *Reason, INDEX NewReason,
+static struct TBSTreeNode FAR *osFindChild(struct TSysObject FAR *Object,
   struct TTask FAR *Task)
 {
-  /* Overwrite current task pointer, when new task has higher priority
-     or time quantum assign time */
-  if(Task)
-    if(osTaskCmp(osCurrentTask, Task) >= 0)
-    {
-      *Reason = NewReason;
-      osCurrentTask = Task;
-    }
+  struct TBSTreeNode FAR *Node;
+
+  Node = Task->Childs.Root;
+  while(Node)
+  {
+    int Cmp;
+
+    /* Compare objects by their handles */
+    Cmp = osObjectByHandleCmp(Object, (struct TSysObject FAR *) Node->Data);
+    if(!Cmp)
+      break;
+
+    Node = (Cmp < 0) ? Node->Left : Node->Right;
+  }
+
+  return Node;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osMakeReady
+ *    osDeleteObject
  *
  *  Description:
- *    Makes a task ready to run if it is not blocked.
+ *    Deletes the specified system object. Before deletion, the object is
+ *    marked as not ready to use. Corresponding deinit IO control code is
+ *    performed (when defined). If the deleting object is a task, it also
+ *    releases the task context. Finally, the memory of the specific
+ *    object descriptor is released. When the object creation failed, the
+ *    object is also removed from the child tree of the creating task.
  *
  *  Parameters:
- *    Task - Pointer to task descriptor.
+ *    Object - Pointer to system object descriptor.
  *
  ***************************************************************************/
 
-void osMakeReady(struct TTask FAR *Task)
+void osDeleteObject(struct TSysObject FAR *Object)
 {
-  /* Do not make ready if some blocking flag is set or task is already
-     ready to run */
-  if((Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN) ||
-    Task->BlockingFlags)
-    return;
+  struct TBSTreeNode FAR *Node;
 
-  /* Make task ready */
-  Task->Object.Flags |= OS_OBJECT_FLAG_READY_TO_RUN;
-  stPQueueInsert(&osTaskPQueue, &Task->ReadyTask, Task);
+  #if (OS_USE_TRACE)
+    osTraceRecord(OS_TRACE_DELETE, osCurrentTask, &Object->Signal, 0,
+      (UINT16) Object->Type);
+  #endif
 
-  /* Reset time quanta counter */
-  #if (OS_USE_TIME_QUANTA)
-    Task->TimeQuantumCounter = Task->MaxTimeQuantum;
+  /* Mark as not ready to use */
+  Object->Flags &= (UINT8) ~OS_OBJECT_FLAG_READY_TO_USE;
+
+  /* The object is still opened only when its creation failed, remove it
+     from the child tree of the creating task */
+  if(Object->OwnerCount && osCurrentTask && !osInISR)
+  {
+    Node = osFindChild(Object, osCurrentTask);
+    if(Node)
+    {
+      stBSTreeRemove(&osCurrentTask->Childs, Node);
+      osMemFree(Node);
+    }
+  }
+
+  /* Remove the object from wait sets watching it */
+  #if (OS_USE_WAIT_SET)
+    while(Object->Signal.Flags & OS_SIGNAL_FLAG_WATCHED)
+      osUnwatchSignal(Object->Signal.Watches);
   #endif
 
-  /* Reschedule if new task has higher priority */
-  if(osCurrentTask)
-    if(osCurrentTask->Priority > Task->Priority)
-      osYield();
-}
+  /* Stop profiling critical sections of the object */
+  #if (OS_USE_LOCK_PROFILER)
+    osUnlinkLockCS(Object);
+  #endif
 
+  /* Perform device IO control code for deinitialization */
+  #if (OS_USE_DEVICE_IO_CTRL)
+    if(Object->Flags & OS_OBJECT_FLAG_USES_IO_DEINIT)
+      Object->DeviceIOCtrl(Object, DEV_IO_CTL_DEINIT, NULL, 0, NULL);
+  #endif
 
-/****************************************************************************
- *
- *  Name:
- *    osMakeNotReady
- *
- *  Description:
- *    Removes the specified task from the ready to run queue.
- *
- *  Parameters:
- *    Task - Pointer to task descriptor.
- *
- ***************************************************************************/
+  /* Remove object from system object deinitialization list */
+  #if (OS_DEINIT_FUNC)
+    if(Object->PrevObject)
+      Object->PrevObject->NextObject = Object->NextObject;
+    else
+      osFirstObject = Object->NextObject;
+    if(Object->NextObject)
+      Object->NextObject->PrevObject = Object->PrevObject;
+  #endif
 
-void osMakeNotReady(struct TTask FAR *Task)
-{
-  /* Skip if task is not ready to run */
-  if(!(Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN))
-    return;
+  /* Unregister object name from the system */
+  #if ((OS_USE_OBJECT_NAMES) && ((OS_NAME_HASH_SIZE) > 0UL))
+    if(Object->Name)
+      osRemoveName(Object->Name);
+  #elif (OS_USE_OBJECT_NAMES)
+    if(Object->Name)
+      stBSTreeRemove(&osSysNames, &Object->Name->Node);
+  #endif
 
-  /* Remove task from the ready to run tasks queue */
-  stPQueueRemove(&osTaskPQueue, &Task->ReadyTask);
-  Task->Object.Flags &= (UINT8) ~OS_OBJECT_FLAG_READY_TO_RUN;
+  /* Release task context if object is a task */
+  if(Object->Type == OS_OBJECT_TYPE_TASK)
+    arReleaseTaskContext(&((struct TTask FAR *)
+      Object->ObjectDesc)->TaskContext);
 
-  /* Call scheduler when current task is specified */
-  if(Task == osCurrentTask)
-    osYield();
+  /* Release object handle */
+  stHandleRelease(Object->Handle);
+
+  /* Release memory allocated for the object descriptor */
+  osMemFree(Object);
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osScheduler
+ *    osCloseObject
  *
  *  Description:
- *    The scheduler determines which task gets the next slice of CPU time.
- *    Priority-based scheduling allows running ready tasks with the
- *    highest priority only. When several tasks can run, the scheduler
- *    uses a Round-Robin algorithm, activating the task that hasn't run
- *    for the longest time first.
+ *    Closes the system object for the specified task. When the closed
+ *    object has no more owners, it will be deleted. If the object is a
+ *    task, it will be deleted only when it is terminated.
  *
  *  Parameters:
- *    TaskContext - Pointer to current task context descriptor.
+ *    Handle - Object handle.
+ *    Task - Object parent.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-static void CALLBACK osScheduler(struct TTaskContext FAR *TaskContext)
+static BOOL osCloseObject(struct TSysObject FAR *Object,
+  struct TTask FAR *Task)
 {
-  struct TWaitAssoc FAR *WaitAssoc;
-  struct TSignal FAR *Signal;
-  TIME CurrentTime;
-  INDEX Reason;
+  struct TBSTreeNode FAR *Node;
 
-  #if (OS_USE_TIME_OBJECTS)
-    struct TTimeNotify FAR *TimeNotify;
+  #if (OS_MUTEX_FAST_PATH)
+    BOOL PrevLockState;
   #endif
 
-  /* Return immediately if ISR is processing */
-  if(osInISR)
+  #if (OS_USE_CSEC_OBJECTS)
+    struct TCSAssoc FAR *CSAssoc;
+    struct TCriticalSection FAR *CS;
+
+    #if (OS_USE_MULTIPLE_SIGNALS)
+      struct TSignal FAR *Signal;
+    #endif
+  #endif
+
+  /* Find corresponding child */
+  Node = osFindChild(Object, Task);
+
+  /* Return if specified object is not a child of the task */
+  if(!Node)
   {
-    osYieldAfterISR = TRUE;
-    return;
+    osSetLastError(ERR_INVALID_HANDLE);
+    return FALSE;
   }
 
-  /* If the operating system is not running */
-  if(!osCurrentTask)
-  {
-    #if (OS_STOP_FUNC)
+  /* Remove a child */
+  stBSTreeRemove(&Task->Childs, Node);
+  osMemFree(Node);
 
-      /* If osStart was called, save caller context */
-      if(osSaveCallerAndStart)
-        osCallerContext = *TaskContext;
+  /* Release each abandoned critical section associated with specified
+     object */
+  #if (OS_USE_CSEC_OBJECTS)
+    #if (OS_USE_MULTIPLE_SIGNALS)
+      Signal = &Object->Signal;
+      while(TRUE)
+      {
+        CS = Signal->CS;
+    #else
+        CS = Object->Signal.CS;
+    #endif
 
-      /* Else exit immediately */
-      else
-        return;
+        /* Release abandoned critical section (if owned) */
+        if(CS)
+        {
+          /* Register the owner if acquired by the fast path */
+          #if (OS_MUTEX_FAST_PATH)
+            PrevLockState = arLock();
+            if(CS->FastOwner == Task)
+              osInflateCS(CS);
+            arRestore(PrevLockState);
+          #endif
 
-    #else
+          CSAssoc = osFindCSAssoc(CS, Task);
+          if(CSAssoc)
+          {
+            CS->Signal->Flags |= OS_SIGNAL_FLAG_ABANDONED;
+            osReleaseCS(CS, Task, CSAssoc->Count, NULL);
+          }
+        }
 
-      /* Exit immediately */
-      return;
+    #if (OS_USE_MULTIPLE_SIGNALS)
 
+        /* Check next signal */
+        Signal = Signal->NextSignal;
+        if(!Signal)
+          break;
+      }
     #endif
-  }
-
-  /* Save context of the preempted task */
-  if(osCurrentTask)
-    osCurrentTask->TaskContext = *TaskContext;
+  #endif
 
-  /* If osStop was called, restore caller context */
-  #if (OS_STOP_FUNC)
-    if(osRestoreCallerAndStop)
+  /* Decrease object owner counter. When it reaches zero, the object
+     is not owned (opened) by any task and should be deleted */
+  Object->OwnerCount--;
+  if(!Object->OwnerCount)
+  {
+    /* When object is a task, delete it only when it is terminated */
+    if(Object->Type == OS_OBJECT_TYPE_TASK)
     {
-      *TaskContext = osCallerContext;
-      osCurrentTask = NULL;
-      return;
+      if(((struct TTask FAR *) Object->ObjectDesc)->BlockingFlags &
+        OS_BLOCK_FLAG_TERMINATED)
+        osDeleteObject(Object);
     }
-  #endif
 
-  /* Get current time */
-  CurrentTime = arGetTickCount();
+    /* Delete object */
+    else
+      osDeleteObject(Object);
+  }
 
-  /* Set a new current task pointer based on Round-Robin scheduling
-     and time quanta */
-  Reason = OS_SCHED_READY_TO_RUN;
-  #if (OS_USE_TIME_QUANTA)
-    osCurrentTask = (struct TTask FAR *) stPQueueGet(&osTaskPQueue);
-    if(!osCurrentTask->TimeQuantumCounter)
-    {
-      osCurrentTask->TimeQuantumCounter = osCurrentTask->MaxTimeQuantum;
-      stPQueueRotate(&osTaskPQueue, NULL, TRUE);
-      osCurrentTask = (struct TTask FAR *) stPQueueGet(&osTaskPQueue);
-    }
-  #else
-    osCurrentTask = (struct TTask FAR *) stPQueueGet(&osTaskPQueue);
-  #endif
+  /* Return with success */
+  return TRUE;
+}
 
-  /* Time notification */
-  #if (OS_USE_TIME_OBJECTS)
-    TimeNotify = osGetTimeNotify(osCurrentTask->Priority, CurrentTime);
-    if(TimeNotify)
-    {
-      if(TimeNotify->Task)
-        osSchedCmp(&Reason, OS_SCHED_TIME_NOTIFICATION, TimeNotify->Task);
-      else
-      {
-        TimeNotify->Signal->Signaled = (INDEX) TRUE;
-        osSignalUpdated(TimeNotify->Signal);
-        osUnregisterTimeNotify(TimeNotify);
-      }
-    }
-  #endif
 
-  /* Deferred signalization */
-  Signal = (struct TSignal FAR *) stBSTreeGetFirst(&osDeferredSignal);
-  if(Signal)
+/****************************************************************************
+ *
+ *  Name:
+ *    osCloseHandle
+ *
+ *  Description:
+ *    Closes the system object for the current task. When the closed object
+ *    has no more owners, it will be deleted. If the object is a task, it
+ *    will be deleted only when it is terminated.
+ *
+ *  Parameters:
+ *    Handle - Object handle.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osCloseHandle(HANDLE Handle)
+{
+  struct TSysObject FAR *Object;
+
+  /* Can be performed only by a task */
+  if(!osCurrentTask || osInISR)
   {
-    WaitAssoc = (struct TWaitAssoc FAR *)
-      stBSTreeGetFirst(&Signal->WaitingTasks);
-    osSchedCmp(&Reason, OS_SCHED_DEFERRED_SIGNALIZATION, WaitAssoc->Task);
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
   }
 
-  /* Perform operation depending on task release reason */
-  switch(Reason)
-  {
-    #if (OS_USE_TIME_OBJECTS)
-      case OS_SCHED_TIME_NOTIFICATION:
-        osUnregisterTimeNotify(TimeNotify);
-        osCurrentTask->WaitExitCode = ERR_WAIT_TIMEOUT;
-        osCurrentTask->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_SLEEP;
-        break;
-    #endif
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_IGNORE);
+  if(!Object)
+    return FALSE;
 
-    case OS_SCHED_DEFERRED_SIGNALIZATION:
-      osAcquire(Signal, FALSE);
-      break;
-  }
+  /* Close specified object */
+  return osCloseObject(Object, osCurrentTask);
+}
 
-  /* Insert task at the beginning of the ready to run task queue */
-  if(Reason != OS_SCHED_READY_TO_RUN)
-  {
-    /* Make task not waiting */
-    if(osCurrentTask->BlockingFlags & OS_BLOCK_FLAG_WAITING)
-      osMakeNotWaiting(osCurrentTask);
 
-    /* Insert item at the queue beginning */
-    stPQueueInsert(&osTaskPQueue, &osCurrentTask->ReadyTask, osCurrentTask);
-    stPQueueRotate(&osTaskPQueue, NULL, FALSE);
-    osCurrentTask->Object.Flags |= OS_OBJECT_FLAG_READY_TO_RUN;
+/***************************************************************************/
+#endif /* OS_ALLOW_OBJECT_DELETION */
+/***************************************************************************/
 
-    /* Restart time quanta counter */
-    #if (OS_USE_TIME_QUANTA)
-      osCurrentTask->TimeQuantumCounter = osCurrentTask->MaxTimeQuantum;
-    #endif
-  }
 
-  /* Round Robin fashion scheduling with time quanta */
-  #if (OS_USE_TIME_QUANTA)
-    osCurrentTask->TimeQuantumCounter--;
-  #else
-    stPQueueRotate(&osTaskPQueue, TRUE);
+/***************************************************************************/
+#if ((OS_ALLOW_OBJECT_DELETION) || (OS_USE_CSEC_OBJECTS))
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osReleaseTaskResources
+ *
+ *  Description:
+ *    Releases each owned critical section and marks it as abandoned. It also
+ *    closes all opened objects. When a closed object has no more owners,
+ *    it will be deleted. When the closing object is a task, it will be
+ *    deleted only when it is terminated.
+ *
+ *  Parameters:
+ *    Task - A pointer to task descriptor.
+ *
+ ***************************************************************************/
+
+void osReleaseTaskResources(struct TTask FAR *Task)
+{
+  #if (OS_ALLOW_OBJECT_DELETION)
+    struct TSysObject FAR *Object;
   #endif
 
-  /* Update last time quantum assign time */
-  if(osLastQuantumTime != CurrentTime)
-  {
-    osLastQuantumTime = CurrentTime;
-    osLastQuantumIndex = 0;
-  }
+  #if (OS_USE_CSEC_OBJECTS)
+    struct TCSAssoc FAR *CSAssoc;
+  #endif
 
-  /* Set the last time quantum assign time */
-  osCurrentTask->LastQuantumTime = osLastQuantumTime;
-  osCurrentTask->LastQuantumIndex = osLastQuantumIndex++;
+  #if (OS_MUTEX_FAST_PATH)
+    BOOL PrevLockState;
+  #endif
 
-  /* Task statistics (CPU usage) */
-  #if (OS_USE_STATISTICS)
-    if(CurrentTime >= (osCPUCalcTime + OS_STAT_SAMPLE_RATE))
+  /* Register the task as owner of each critical section acquired by
+     the fast path, so they are released below */
+  #if (OS_MUTEX_FAST_PATH)
+    PrevLockState = arLock();
+    while(Task->FastCS)
+      osInflateCS(Task->FastCS);
+    arRestore(PrevLockState);
+  #endif
+
+  /* Release owned critical sections */
+  #if (OS_USE_CSEC_OBJECTS)
+    while(TRUE)
     {
-      osCPUUsageTime = osCPUCalcTime;
-      osCPUUsage = osCPUCalc;
-      osCPUCalcTime = CurrentTime;
-      osCPUCalc = 1;
+      /* Get first critical section with the highest priority */
+      CSAssoc = (struct TCSAssoc FAR *) stPQueueGet(&Task->OwnedCS);
+      if(!CSAssoc)
+        break;
+
+      /* Release abandoned critical section */
+      CSAssoc->CS->Signal->Flags |= OS_SIGNAL_FLAG_ABANDONED;
+      osReleaseCS(CSAssoc->CS, Task, CSAssoc->Count, NULL);
     }
-    else
-      osCPUCalc++;
+  #endif
 
-    if(osCurrentTask->CPUCalcTime != osCPUCalcTime)
+  /* Close each child (opened objects) */
+  #if (OS_ALLOW_OBJECT_DELETION)
+    while(TRUE)
     {
-      osCurrentTask->CPUUsageTime = osCurrentTask->CPUCalcTime;
-      osCurrentTask->CPUUsage = osCurrentTask->CPUCalc;
-      osCurrentTask->CPUCalcTime = osCPUCalcTime;
-      osCurrentTask->CPUCalc = 1;
+      Object = (struct TSysObject FAR *) stBSTreeGetFirst(&Task->Childs);
+      if(!Object)
+        break;
+
+      /* Close object */
+      osCloseObject(Object, osCurrentTask);
     }
-    else
-      osCurrentTask->CPUCalc++;
   #endif
-
-  /* Restore task context */
-  *TaskContext = osCurrentTask->TaskContext;
 }
 
 
+/***************************************************************************/
+#endif /* OS_ALLOW_OBJECT_DELETION || OS_USE_CSEC_OBJECTS */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
- *  Critical section management
+ *  Deferred signalization queue management
  *
  ***************************************************************************/
 
 
-/***************************************************************************/
-#if (OS_USE_CSEC_OBJECTS)
-/***************************************************************************/
-
-
 /****************************************************************************
  *
  *  Name:
- *    osCSAssocCmp
+ *    osSignalCmp
  *
  *  Description:
- *    Compares two critical sections by their priorities.
+ *    Compares two signals by their priorities. The signal priority is
+ *    the highest priority of all the tasks waiting for the signal.
  *
  *  Parameters:
- *    Item1 - Pointer to first critical section association descriptor.
- *    Item2 - Pointer to second critical section association descriptor.
+ *    Item1 - Pointer to first signal descriptor.
+ *    Item2 - Pointer to second signal descriptor.
  *
  *  Return:
  *    - < 0 if Item1 is less than Item2
@@ -2031,310 +2853,2164 @@ static void CALLBACK osScheduler(struct TTaskContext FAR *TaskContext)
  *
  ***************************************************************************/
 
-int osCSAssocCmp(PVOID Item1, PVOID Item2)
+static int osSignalCmp(PVOID Item1, PVOID Item2)
 {
-  struct TWaitAssoc FAR *WaitAssoc1;
-  struct TWaitAssoc FAR *WaitAssoc2;
-
-  /* Return a difference between priorities of specified critical section
-     associations */
-  WaitAssoc1 = (struct TWaitAssoc FAR *) stBSTreeGetFirst(
-    &((struct TCSAssoc FAR *) Item1)->CS->Signal->WaitingTasks);
-  WaitAssoc2 = (struct TWaitAssoc FAR *) stBSTreeGetFirst(
-    &((struct TCSAssoc FAR *) Item2)->CS->Signal->WaitingTasks);
-
-  return
-    (WaitAssoc1 ? (int) WaitAssoc1->Task->Priority : OS_LOWEST_PRIORITY) -
-    (WaitAssoc2 ? (int) WaitAssoc2->Task->Priority : OS_LOWEST_PRIORITY);
+  /* Compare specified signals by priority of waiting tasks */
+  return osTaskCmp(
+    ((struct TWaitAssoc FAR *) stBSTreeGetFirst(&((struct TSignal FAR *)
+      Item1)->WaitingTasks))->Task,
+    ((struct TWaitAssoc FAR *) stBSTreeGetFirst(&((struct TSignal FAR *)
+      Item2)->WaitingTasks))->Task);
 }
 
-
 /****************************************************************************
  *
  *  Name:
- *    osCSPtrCmp
+ *    osSignalUpdated
  *
  *  Description:
- *    Compares two critical sections by their addresses.
+ *    Puts the specified signal in the valid position of the deferred
+ *    signalization list or removes it if necessary.
  *
  *  Parameters:
- *    Item1 - Pointer to first critical section association descriptor.
- *    Item2 - Pointer to second critical section association descriptor.
+ *    Signal - Pointer to signal descriptor.
  *
  *  Return:
- *    - < 0 if Item1 is less than Item2
- *    - 0 if Item1 is the same as Item2
- *    - > 0 if Item1 is greater than Item2
+ *    Pointer to the first task waiting for the signal (or for a wait set
+ *    watching the signal, if its priority is higher) or NULL when no task
+ *    is waiting for the signal.
  *
  ***************************************************************************/
 
-int osCSPtrCmp(PVOID Item1, PVOID Item2)
+static struct TTask FAR *osSignalUpdated(struct TSignal FAR *Signal)
 {
-  /* Compare objects */
-  if(((struct TCSAssoc FAR *) Item1)->CS <
-    ((struct TCSAssoc FAR *) Item2)->CS)
-    return -1;
+  struct TWaitAssoc FAR *WaitAssoc;
+  struct TTask FAR *Task;
 
-  if(((struct TCSAssoc FAR *) Item1)->CS >
-    ((struct TCSAssoc FAR *) Item2)->CS)
-    return 1;
+  #if (OS_USE_WAIT_SET)
+    struct TTask FAR *WatchTask;
+  #endif
 
-  /* Items are equal */
-  return 0;
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    BOOL Deferred;
+    Deferred = (BOOL) ((Signal->Flags & OS_SIGNAL_FLAG_DEFERRED) != 0);
+  #endif
+
+  /* Remove signal from deferred signalization list */
+  if(Signal->Flags & OS_SIGNAL_FLAG_DEFERRED)
+  {
+    stBSTreeRemove(&osDeferredSignal, &Signal->DeferredSgn);
+    Signal->Flags &= (UINT8) ~OS_SIGNAL_FLAG_DEFERRED;
+  }
+
+  /* Insert signal into deferred signalization list if necessary */
+  WaitAssoc = (struct TWaitAssoc FAR *)
+    stBSTreeGetFirst(&Signal->WaitingTasks);
+  if(Signal->Signaled && WaitAssoc)
+  {
+    stBSTreeInsert(&osDeferredSignal, &Signal->DeferredSgn, NULL, Signal);
+    Signal->Flags |= OS_SIGNAL_FLAG_DEFERRED;
+
+    /* Waiting tasks are ready from now on */
+    #if (OS_USE_LATENCY_HISTOGRAM)
+      if(!Deferred)
+        Signal->DeferredCycles = OS_GET_CYCLE_COUNT();
+    #endif
+  }
+
+  /* [!] ISSUE: Check when this is called. There might be a bug if this is
+     called when the priority is the same, as it might change the position
+     in the queue incorrectly. */
+
+  /* Pointer to first task waiting for signal */
+  Task = WaitAssoc ? WaitAssoc->Task : NULL;
+
+  /* Notify wait sets watching the signal */
+  #if (OS_USE_WAIT_SET)
+    if((Signal->Flags & OS_SIGNAL_FLAG_WATCHED) && Signal->Signaled)
+    {
+      WatchTask = osWatchNotify(Signal);
+      if(WatchTask)
+        if(!Task || (WatchTask->Priority < Task->Priority))
+          Task = WatchTask;
+    }
+  #endif
+
+  return Task;
 }
 
 
+/****************************************************************************
+ *
+ *  Scheduling
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_USE_READY_BITMAP)
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osCSAssocAlloc
+ *    osReadyQueueInsert
  *
  *  Description:
- *    Allocates a new critical section association descriptor for the
- *    specified critical section. This function does not control error
- *    situations; they should never happen.
+ *    Appends the task at the end of the ready to run list of its priority
+ *    level and marks the level as not empty in the bitmap.
  *
  *  Parameters:
- *    CS - Address of the critical section descriptor.
- *
- *  Return:
- *    Address of the newly allocated critical section association
- *    descriptor.
+ *    Task - Pointer to task descriptor.
  *
  ***************************************************************************/
 
-static struct TCSAssoc FAR *osCSAssocAlloc(struct TCriticalSection *CS)
+static void osReadyQueueInsert(struct TTask FAR *Task)
 {
-  struct TCSAssoc FAR *CSAssoc;
+  struct TTask FAR *Head;
+  INDEX Level;
 
-  /* Allocate a new critical section association descriptor */
-  if(CS->FirstFree)
+  /* Get ready queue level */
+  Level = OS_READY_LEVEL(Task->Priority);
+  Head = osReadyHead[Level];
+
+  /* Level is empty, the task becomes the only item of its list */
+  if(!Head)
   {
-    CSAssoc = CS->FirstFree;
-    CS->FirstFree = CSAssoc->Next;
+    Task->PrevReady = Task;
+    Task->NextReady = Task;
+    osReadyHead[Level] = Task;
+    osReadyMap[Level >> 5] |= OS_BITMAP_BIT(Level);
+    osReadyGroup |= OS_BITMAP_BIT(Level >> 5);
   }
-  else
-    CSAssoc = &CS->TasksInCS[CS->Count++];
-
-  /* Add to list of allocated critical section association descriptors */
-  CSAssoc->Prev = NULL;
-  CSAssoc->Next = CS->FirstAllocated;
-  if(CS->FirstAllocated)
-    CS->FirstAllocated->Prev = CSAssoc;
-  CS->FirstAllocated = CSAssoc;
 
-  /* Pointer to newly allocated critical section association descriptor */
-  return CSAssoc;
+  /* Insert at the end of the circular list */
+  else
+  {
+    Task->PrevReady = Head->PrevReady;
+    Task->NextReady = Head;
+    Head->PrevReady->NextReady = Task;
+    Head->PrevReady = Task;
+  }
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osCSAssocFree
+ *    osReadyQueueRemove
  *
  *  Description:
- *    Releases the specified critical section association descriptor for
- *    the specified critical section.
+ *    Removes the task from the ready to run list of its priority level.
+ *    When the list becomes empty, the level is cleared in the bitmap.
  *
  *  Parameters:
- *    CS - Address of the critical section descriptor.
- *    CSAssoc - Pointer to critical section association descriptor to
- *      release.
+ *    Task - Pointer to task descriptor.
  *
  ***************************************************************************/
 
-static void osCSAssocFree(struct TCriticalSection *CS,
-  struct TCSAssoc FAR *CSAssoc)
+static void osReadyQueueRemove(struct TTask FAR *Task)
 {
-  /* Remove from list of allocated critical section association
-     descriptors */
-  if(!CSAssoc->Prev)
-    CS->FirstAllocated = CSAssoc->Next;
-  else
-    CSAssoc->Prev->Next = CSAssoc->Next;
-  if(CSAssoc->Next)
-    CSAssoc->Next->Prev = CSAssoc->Prev;
+  INDEX Level;
 
-  /* Add to list of free critical section association descriptors */
-  CSAssoc->Next = CS->FirstFree;
-  CS->FirstFree = CSAssoc;
+  /* Get ready queue level */
+  Level = OS_READY_LEVEL(Task->Priority);
+
+  /* The task was the only one at this level */
+  if(Task->NextReady == Task)
+  {
+    osReadyHead[Level] = NULL;
+    osReadyMap[Level >> 5] &= ~OS_BITMAP_BIT(Level);
+    if(!osReadyMap[Level >> 5])
+      osReadyGroup &= ~OS_BITMAP_BIT(Level >> 5);
+    return;
+  }
+
+  /* Unlink the task from the circular list */
+  Task->PrevReady->NextReady = Task->NextReady;
+  Task->NextReady->PrevReady = Task->PrevReady;
+  if(osReadyHead[Level] == Task)
+    osReadyHead[Level] = Task->NextReady;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osRegisterCS
+ *    osReadyQueueHighestLevel
  *
  *  Description:
- *    Registers a critical section descriptor.
+ *    Returns the highest priority level with ready to run tasks. At least
+ *    one task (idle task) must be ready to run.
  *
- *  Parameters:
- *    Signal - Pointer to the signal descriptor.
- *    CS - Pointer to the critical section descriptor.
- *    InitialCount - The initial count for the critical section.
- *    MaxCount - The maximum count for the critical section.
- *    MutualExclusion - Boolean flag for mutual exclusion mode.
+ *  Return:
+ *    Ready queue level.
  *
  ***************************************************************************/
 
-void osRegisterCS(struct TSignal FAR *Signal,
-  struct TCriticalSection FAR *CS, INDEX InitialCount, INDEX MaxCount,
-  BOOL MutualExclusion)
+static INLINE INDEX osReadyQueueHighestLevel(void)
 {
-  BOOL PrevLockState;
+  INDEX Word;
 
-  /* Define signal */
-  Signal->Flags = (UINT8)
-    (OS_SIGNAL_FLAG_DEC_ON_RELEASE | OS_SIGNAL_FLAG_CRITICAL_SECTION |
-    (MutualExclusion ? OS_SIGNAL_FLAG_MUTUAL_EXCLUSION : 0));
-  Signal->Signaled = InitialCount;
-  Signal->CS = CS;
-  
-  /* [!] NOTE: This might be redundant as it was already initialized */
-  stBSTreeInit(&Signal->WaitingTasks, osWaitAssocCmp);
+  /* First non-empty word, then first non-empty level in the word */
+  Word = stCountLeadingZeros(osReadyGroup);
+  return (Word << 5) + stCountLeadingZeros(osReadyMap[Word]);
+}
 
-  /* Critical section descriptor */
-  CS->Signal = Signal;
-  CS->MaxSignaled = MaxCount;
-  CS->PriorityPath.Task = NULL;
-  CS->PriorityPath.CS = CS;
-  CS->FirstFree = NULL;
-  CS->Count = 0;
 
-  /* When critical section is owned at creation, the corresponding
-     association must be defined */
-  if(InitialCount != MaxCount)
-  {
-    struct TCSAssoc FAR *CSAssoc;
+/****************************************************************************
+ *
+ *  Name:
+ *    osReadyQueueGet
+ *
+ *  Description:
+ *    Returns the first task of the highest priority level.
+ *
+ *  Return:
+ *    Pointer to task descriptor or NULL if no task is ready to run.
+ *
+ ***************************************************************************/
 
-    /* Define association */
-    CSAssoc = osCSAssocAlloc(CS);
-    CSAssoc->CS = CS;
-    CSAssoc->Task = osCurrentTask;
-    CSAssoc->Count = MaxCount - InitialCount;
+static INLINE struct TTask FAR *osReadyQueueGet(void)
+{
+  /* Return the head of the highest non-empty level */
+  return osReadyGroup ? osReadyHead[osReadyQueueHighestLevel()] : NULL;
+}
 
-    /* Enter critical section */
-    PrevLockState = arLock();
 
-    /* Assign association to task */
-    stPQueueInsert(&osCurrentTask->OwnedCS, &CSAssoc->Item, CSAssoc);
-    stBSTreeInsert(&osCurrentTask->OwnedCSPtr, &CSAssoc->Node, NULL,
-      CSAssoc);
+/****************************************************************************
+ *
+ *  Name:
+ *    osReadyQueueRotate
+ *
+ *  Description:
+ *    Rotates the list of the highest priority level.
+ *
+ *  Parameters:
+ *    Forward - If TRUE, the first task is moved to the end of the list.
+ *      Otherwise, the last task is moved to the beginning.
+ *
+ ***************************************************************************/
 
-    /* Leave critical section */
-    arRestore(PrevLockState);
-  }
+static void osReadyQueueRotate(BOOL Forward)
+{
+  struct TTask FAR *Head;
+  INDEX Level;
+
+  /* Skip if no task is ready to run */
+  if(!osReadyGroup)
+    return;
+
+  /* Move the list head */
+  Level = osReadyQueueHighestLevel();
+  Head = osReadyHead[Level];
+  osReadyHead[Level] = Forward ? Head->NextReady : Head->PrevReady;
 }
 
 
+/***************************************************************************/
+#else
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
- *    osPriorityPath
+ *    osRoundRobinTaskCmp
  *
  *  Description:
- *    Executes the priority path algorithm for the specified object.
- *    Function fails if a deadlock occurs. After detecting a deadlock,
- *    the Task must stop waiting and the osPriorityPath function must be
- *    called for each critical section that the task previously awaited.
+ *    Compares two tasks only by their priorities.
  *
  *  Parameters:
- *    Priority - Pointer to priority path descriptor.
+ *    Item1 - Pointer to first task descriptor.
+ *    Item2 - Pointer to second task descriptor.
  *
  *  Return:
- *    TRUE on success or FALSE on failure.
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
  *
  ***************************************************************************/
 
-BOOL osPriorityPath(struct TPriorityPath FAR *Priority)
+static int osRoundRobinTaskCmp(PVOID Item1, PVOID Item2)
 {
-  struct TPriorityPath FAR *FirstPriority;
-  struct TPriorityPath FAR *LastPriority;
-  struct TPriorityPath FAR *NewPriority;
-  struct TCriticalSection *CS;
-  struct TCSAssoc *CSAssoc;
-  struct TTask FAR *Task;
+  /* Compare tasks by their priorities only */
+  return ((int) ((struct TTask FAR *) Item1)->Priority) -
+    ((int) ((struct TTask FAR *) Item2)->Priority);
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_READY_BITMAP */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osSchedCmp
+ *
+ *  Description:
+ *    Compares the current task with another specified task. If the
+ *    priority is higher, the current task pointer is overwritten with
+ *    the specified task and the reason code is set.
+ *
+ *  Parameters:
+ *    Reason - Pointer to current reason index.
+ *    NewReason - New reason index.
+ *    Task - New task pointer (may be NULL).
+ *
+ ***************************************************************************/
+
+static void osSchedCmp(INDEX *Reason, INDEX NewReason,
+  struct TTask FAR *Task)
+{
+  /* Overwrite current task pointer, when new task has higher priority
+     or time quantum assign time */
+  if(Task)
+    if(osTaskCmp(osCurrentTask, Task) >= 0)
+    {
+      *Reason = NewReason;
+      osCurrentTask = Task;
+    }
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMakeReady
+ *
+ *  Description:
+ *    Makes a task ready to run if it is not blocked.
+ *
+ *  Parameters:
+ *    Task - Pointer to task descriptor.
+ *
+ ***************************************************************************/
+
+void osMakeReady(struct TTask FAR *Task)
+{
+  /* Do not make ready if some blocking flag is set or task is already
+     ready to run */
+  if((Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN) ||
+    Task->BlockingFlags)
+    return;
+
+  /* Make task ready */
+  Task->Object.Flags |= OS_OBJECT_FLAG_READY_TO_RUN;
+  osReadyQueueInsert(Task);
+
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    Task->ReadyCycles = OS_GET_CYCLE_COUNT();
+    Task->ReadyPending = TRUE;
+  #endif
+
+  /* Reset time quanta counter */
+  #if (OS_USE_TIME_QUANTA)
+    Task->TimeQuantumCounter = Task->MaxTimeQuantum;
+  #endif
+
+  /* Reschedule if new task has higher priority */
+  if(osCurrentTask)
+    if(osCurrentTask->Priority > Task->Priority)
+      osYield();
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMakeNotReady
+ *
+ *  Description:
+ *    Removes the specified task from the ready to run queue.
+ *
+ *  Parameters:
+ *    Task - Pointer to task descriptor.
+ *
+ ***************************************************************************/
+
+void osMakeNotReady(struct TTask FAR *Task)
+{
+  /* Skip if task is not ready to run */
+  if(!(Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN))
+    return;
+
+  /* Remove task from the ready to run tasks queue */
+  osReadyQueueRemove(Task);
+  Task->Object.Flags &= (UINT8) ~OS_OBJECT_FLAG_READY_TO_RUN;
+
+  /* Call scheduler when current task is specified */
+  if(Task == osCurrentTask)
+    osYield();
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osScheduler
+ *
+ *  Description:
+ *    The scheduler determines which task gets the next slice of CPU time.
+ *    Priority-based scheduling allows running ready tasks with the
+ *    highest priority only. When several tasks can run, the scheduler
+ *    uses a Round-Robin algorithm, activating the task that hasn't run
+ *    for the longest time first.
+ *
+ *  Parameters:
+ *    TaskContext - Pointer to current task context descriptor.
+ *
+ ***************************************************************************/
+
+static void CALLBACK osScheduler(struct TTaskContext FAR *TaskContext)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+  struct TSignal FAR *Signal;
+  TIME CurrentTime;
+  INDEX Reason;
+
+  #if (OS_USE_TIME_OBJECTS)
+    struct TTimeNotify FAR *TimeNotify;
+  #endif
+
+  #if (OS_USE_TRACE)
+    struct TTask FAR *PrevTask;
+  #endif
+
+  /* Return immediately if ISR is processing */
+  if(osInISR)
+  {
+    osYieldAfterISR = TRUE;
+    return;
+  }
+
+  /* If the operating system is not running */
+  if(!osCurrentTask)
+  {
+    #if (OS_STOP_FUNC)
+
+      /* If osStart was called, save caller context */
+      if(osSaveCallerAndStart)
+        osCallerContext = *TaskContext;
+
+      /* Else exit immediately */
+      else
+        return;
+
+    #else
+
+      /* Exit immediately */
+      return;
+
+    #endif
+  }
+
+  /* Save context of the preempted task and account its CPU time */
+  if(osCurrentTask)
+  {
+    osCurrentTask->TaskContext = *TaskContext;
+
+    #if (OS_USE_STATISTICS)
+      osAccountCPUTime(&osCurrentTask->CPUStat);
+    #endif
+  }
+
+  #if (OS_USE_TRACE)
+    PrevTask = osCurrentTask;
+  #endif
+
+  /* If osStop was called, restore caller context */
+  #if (OS_STOP_FUNC)
+    if(osRestoreCallerAndStop)
+    {
+      *TaskContext = osCallerContext;
+      osCurrentTask = NULL;
+      return;
+    }
+  #endif
+
+  /* Get current time */
+  CurrentTime = arGetTickCount();
+
+  /* Set a new current task pointer based on Round-Robin scheduling
+     and time quanta */
+  Reason = OS_SCHED_READY_TO_RUN;
+  #if (OS_USE_TIME_QUANTA)
+    osCurrentTask = osReadyQueueGet();
+    if(!osCurrentTask->TimeQuantumCounter)
+    {
+      osCurrentTask->TimeQuantumCounter = osCurrentTask->MaxTimeQuantum;
+      osReadyQueueRotate(TRUE);
+      osCurrentTask = osReadyQueueGet();
+    }
+  #else
+    osCurrentTask = osReadyQueueGet();
+  #endif
+
+  /* Time notification */
+  #if (OS_USE_TIME_OBJECTS)
+    TimeNotify = osGetTimeNotify(osCurrentTask->Priority, CurrentTime);
+    if(TimeNotify)
+    {
+      if(TimeNotify->Task)
+        osSchedCmp(&Reason, OS_SCHED_TIME_NOTIFICATION, TimeNotify->Task);
+      else
+      {
+        TimeNotify->Signal->Signaled = (INDEX) TRUE;
+        osSignalUpdated(TimeNotify->Signal);
+
+        #if (OS_USE_TRACE)
+          osTraceRecord(OS_TRACE_SIGNAL, NULL, TimeNotify->Signal,
+            (UINT32) TRUE, 0);
+        #endif
+        osUnregisterTimeNotify(TimeNotify);
+      }
+    }
+  #endif
+
+  /* Deferred signalization */
+  Signal = (struct TSignal FAR *) stBSTreeGetFirst(&osDeferredSignal);
+  if(Signal)
+  {
+    WaitAssoc = (struct TWaitAssoc FAR *)
+      stBSTreeGetFirst(&Signal->WaitingTasks);
+    osSchedCmp(&Reason, OS_SCHED_DEFERRED_SIGNALIZATION, WaitAssoc->Task);
+  }
+
+  /* Perform operation depending on task release reason */
+  switch(Reason)
+  {
+    #if (OS_USE_TIME_OBJECTS)
+      case OS_SCHED_TIME_NOTIFICATION:
+        osUnregisterTimeNotify(TimeNotify);
+        osCurrentTask->WaitExitCode = ERR_WAIT_TIMEOUT;
+        osCurrentTask->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_SLEEP;
+
+        #if (OS_USE_LATENCY_HISTOGRAM)
+          osCurrentTask->ReadyCycles = OS_GET_CYCLE_COUNT();
+        #endif
+        break;
+    #endif
+
+    case OS_SCHED_DEFERRED_SIGNALIZATION:
+
+      /* Task is ready since the signal was set */
+      #if (OS_USE_LATENCY_HISTOGRAM)
+        osCurrentTask->ReadyCycles = Signal->DeferredCycles;
+      #endif
+
+      /* Task waiting for all objects is only released, it acquires them
+         by itself when all are available */
+      #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+        if(!osCurrentTask->WaitAll)
+      #endif
+          osAcquire(Signal, FALSE);
+      break;
+  }
+
+  /* Insert task at the beginning of the ready to run task queue */
+  if(Reason != OS_SCHED_READY_TO_RUN)
+  {
+    /* Make task not waiting */
+    if(osCurrentTask->BlockingFlags & OS_BLOCK_FLAG_WAITING)
+      osMakeNotWaiting(osCurrentTask);
+
+    /* Insert item at the queue beginning */
+    osReadyQueueInsert(osCurrentTask);
+    osReadyQueueRotate(FALSE);
+    osCurrentTask->Object.Flags |= OS_OBJECT_FLAG_READY_TO_RUN;
+
+    #if (OS_USE_LATENCY_HISTOGRAM)
+      osCurrentTask->ReadyPending = TRUE;
+    #endif
+
+    /* Restart time quanta counter */
+    #if (OS_USE_TIME_QUANTA)
+      osCurrentTask->TimeQuantumCounter = osCurrentTask->MaxTimeQuantum;
+    #endif
+  }
+
+  /* Round Robin fashion scheduling with time quanta */
+  #if (OS_USE_TIME_QUANTA)
+    osCurrentTask->TimeQuantumCounter--;
+  #else
+    osReadyQueueRotate(TRUE);
+  #endif
+
+  /* Update last time quantum assign time */
+  if(osLastQuantumTime != CurrentTime)
+  {
+    osLastQuantumTime = CurrentTime;
+    osLastQuantumIndex = 0;
+  }
+
+  /* Set the last time quantum assign time */
+  osCurrentTask->LastQuantumTime = osLastQuantumTime;
+  osCurrentTask->LastQuantumIndex = osLastQuantumIndex++;
+
+  /* Account the scheduler CPU time and begin a new statistics period when
+     the current one is complete */
+  #if (OS_USE_STATISTICS)
+    osAccountCPUTime(&osKernelStat);
+    if(CurrentTime >= (osCPUCalcTime + OS_STAT_SAMPLE_RATE))
+    {
+      osCPUUsageTime = osCPUCalcTime;
+      osCPUUsage = osCPULastCycles - osCPUCalcCycles;
+      osCPUCalcTime = CurrentTime;
+      osCPUCalcCycles = osCPULastCycles;
+    }
+  #endif
+
+  /* Time spent ready before running */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    if(osCurrentTask->ReadyPending)
+    {
+      osCurrentTask->ReadyPending = FALSE;
+      osLatencyRecord(osCurrentTask->ReadyHistogram,
+        OS_GET_CYCLE_COUNT() - osCurrentTask->ReadyCycles);
+    }
+  #endif
+
+  /* Record the context switch */
+  #if (OS_USE_TRACE)
+    if(PrevTask != osCurrentTask)
+      osTraceRecord(OS_TRACE_SWITCH, osCurrentTask,
+        PrevTask ? &PrevTask->Object.Signal : NULL, 0, 0);
+  #endif
+
+  /* Restore task context */
+  *TaskContext = osCurrentTask->TaskContext;
+}
+
+
+/****************************************************************************
+ *
+ *  Critical section management
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_USE_CSEC_OBJECTS)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetCSPriority
+ *
+ *  Description:
+ *    Returns the priority that the owners of the critical section should
+ *    have. It is the priority ceiling of the critical section, if it is
+ *    defined, otherwise the priority of the first waiting task.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ *  Return:
+ *    Priority of the critical section or OS_LOWEST_PRIORITY if it does not
+ *    affect priorities of its owners.
+ *
+ ***************************************************************************/
+
+static UINT8 osGetCSPriority(struct TCriticalSection FAR *CS)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+
+  /* Owners run at the priority ceiling regardless of waiting tasks */
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    if(CS->Ceiling != OS_LOWEST_PRIORITY)
+      return CS->Ceiling;
+  #endif
+
+  /* Owners inherit the priority of the first waiting task */
+  WaitAssoc = (struct TWaitAssoc FAR *)
+    stBSTreeGetFirst(&CS->Signal->WaitingTasks);
+  return WaitAssoc ? WaitAssoc->Task->Priority : OS_LOWEST_PRIORITY;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCSAssocCmp
+ *
+ *  Description:
+ *    Compares two critical sections by their priorities.
+ *
+ *  Parameters:
+ *    Item1 - Pointer to first critical section association descriptor.
+ *    Item2 - Pointer to second critical section association descriptor.
+ *
+ *  Return:
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
+ *
+ ***************************************************************************/
+
+int osCSAssocCmp(PVOID Item1, PVOID Item2)
+{
+  /* Return a difference between priorities of specified critical section
+     associations */
+  return
+    (int) osGetCSPriority(((struct TCSAssoc FAR *) Item1)->CS) -
+    (int) osGetCSPriority(((struct TCSAssoc FAR *) Item2)->CS);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCSPtrCmp
+ *
+ *  Description:
+ *    Compares two critical sections by their addresses.
+ *
+ *  Parameters:
+ *    Item1 - Pointer to first critical section association descriptor.
+ *    Item2 - Pointer to second critical section association descriptor.
+ *
+ *  Return:
+ *    - < 0 if Item1 is less than Item2
+ *    - 0 if Item1 is the same as Item2
+ *    - > 0 if Item1 is greater than Item2
+ *
+ ***************************************************************************/
+
+int osCSPtrCmp(PVOID Item1, PVOID Item2)
+{
+  /* Compare objects */
+  if(((struct TCSAssoc FAR *) Item1)->CS <
+    ((struct TCSAssoc FAR *) Item2)->CS)
+    return -1;
+
+  if(((struct TCSAssoc FAR *) Item1)->CS >
+    ((struct TCSAssoc FAR *) Item2)->CS)
+    return 1;
+
+  /* Items are equal */
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCSAssocAlloc
+ *
+ *  Description:
+ *    Allocates a new critical section association descriptor for the
+ *    specified critical section. This function does not control error
+ *    situations; they should never happen.
+ *
+ *  Parameters:
+ *    CS - Address of the critical section descriptor.
+ *
+ *  Return:
+ *    Address of the newly allocated critical section association
+ *    descriptor.
+ *
+ ***************************************************************************/
+
+static struct TCSAssoc FAR *osCSAssocAlloc(struct TCriticalSection *CS)
+{
+  struct TCSAssoc FAR *CSAssoc;
+
+  /* Allocate a new critical section association descriptor */
+  if(CS->FirstFree)
+  {
+    CSAssoc = CS->FirstFree;
+    CS->FirstFree = CSAssoc->Next;
+  }
+  else
+    CSAssoc = &CS->TasksInCS[CS->Count++];
+
+  /* Add to list of allocated critical section association descriptors */
+  CSAssoc->Prev = NULL;
+  CSAssoc->Next = CS->FirstAllocated;
+  if(CS->FirstAllocated)
+    CS->FirstAllocated->Prev = CSAssoc;
+  CS->FirstAllocated = CSAssoc;
+
+  /* Ownership begins */
+  #if (OS_USE_LOCK_PROFILER)
+    CSAssoc->HoldCycles = OS_GET_CYCLE_COUNT();
+  #endif
+
+  /* No recursive acquisition yet */
+  #if (OS_USE_RWLOCK)
+    CSAssoc->Recursion = 0;
+  #endif
+
+  /* Pointer to newly allocated critical section association descriptor */
+  return CSAssoc;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCSAssocFree
+ *
+ *  Description:
+ *    Releases the specified critical section association descriptor for
+ *    the specified critical section.
+ *
+ *  Parameters:
+ *    CS - Address of the critical section descriptor.
+ *    CSAssoc - Pointer to critical section association descriptor to
+ *      release.
+ *
+ ***************************************************************************/
+
+static void osCSAssocFree(struct TCriticalSection *CS,
+  struct TCSAssoc FAR *CSAssoc)
+{
+  /* Ownership ends */
+  #if (OS_USE_LOCK_PROFILER)
+    osLockHeld(CS, CSAssoc->HoldCycles);
+  #endif
+
+  /* Remove from list of allocated critical section association
+     descriptors */
+  if(!CSAssoc->Prev)
+    CS->FirstAllocated = CSAssoc->Next;
+  else
+    CSAssoc->Prev->Next = CSAssoc->Next;
+  if(CSAssoc->Next)
+    CSAssoc->Next->Prev = CSAssoc->Prev;
+
+  /* Add to list of free critical section association descriptors */
+  CSAssoc->Next = CS->FirstFree;
+  CS->FirstFree = CSAssoc;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osRegisterCS
+ *
+ *  Description:
+ *    Registers a critical section descriptor.
+ *
+ *  Parameters:
+ *    Signal - Pointer to the signal descriptor.
+ *    CS - Pointer to the critical section descriptor.
+ *    InitialCount - The initial count for the critical section.
+ *    MaxCount - The maximum count for the critical section.
+ *    MutualExclusion - Boolean flag for mutual exclusion mode.
+ *
+ ***************************************************************************/
+
+void osRegisterCS(struct TSignal FAR *Signal,
+  struct TCriticalSection FAR *CS, INDEX InitialCount, INDEX MaxCount,
+  BOOL MutualExclusion)
+{
+  BOOL PrevLockState;
+
+  /* Define signal */
+  Signal->Flags = (UINT8)
+    (OS_SIGNAL_FLAG_DEC_ON_RELEASE | OS_SIGNAL_FLAG_CRITICAL_SECTION |
+    (MutualExclusion ? OS_SIGNAL_FLAG_MUTUAL_EXCLUSION : 0));
+  Signal->Signaled = InitialCount;
+  Signal->CS = CS;
+  
+  /* [!] NOTE: This might be redundant as it was already initialized */
+  stBSTreeInit(&Signal->WaitingTasks, osWaitAssocCmp);
+
+  /* Critical section descriptor */
+  CS->Signal = Signal;
+  CS->MaxSignaled = MaxCount;
+  CS->PriorityPath.Task = NULL;
+  CS->PriorityPath.CS = CS;
+  CS->FirstFree = NULL;
+  CS->FirstAllocated = NULL;
+  CS->Count = 0;
+
+  #if (OS_MUTEX_FAST_PATH)
+    CS->FastOwner = NULL;
+  #endif
+
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    CS->Ceiling = OS_LOWEST_PRIORITY;
+  #endif
+
+  /* Append to the list of profiled critical sections */
+  #if (OS_USE_LOCK_PROFILER)
+    stMemSet(&CS->LockStat, 0x00, sizeof(CS->LockStat));
+    CS->PrevLockCS = NULL;
+
+    PrevLockState = arLock();
+    CS->NextLockCS = osFirstLockCS;
+    if(osFirstLockCS)
+      osFirstLockCS->PrevLockCS = CS;
+    osFirstLockCS = CS;
+    arRestore(PrevLockState);
+  #endif
+
+  /* When critical section is owned at creation, the corresponding
+     association must be defined */
+  if(InitialCount != MaxCount)
+  {
+    struct TCSAssoc FAR *CSAssoc;
+
+    /* Define association */
+    CSAssoc = osCSAssocAlloc(CS);
+    CSAssoc->CS = CS;
+    CSAssoc->Task = osCurrentTask;
+    CSAssoc->Count = MaxCount - InitialCount;
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* Assign association to task */
+    stPQueueInsert(&osCurrentTask->OwnedCS, &CSAssoc->Item, CSAssoc);
+    stBSTreeInsert(&osCurrentTask->OwnedCSPtr, &CSAssoc->Node, NULL,
+      CSAssoc);
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+  }
+}
+
+
+/***************************************************************************/
+#if (OS_MUTEX_PRIORITY_CEILING)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osSetCSCeiling
+ *
+ *  Description:
+ *    Defines the priority ceiling of a newly registered critical section
+ *    and raises the priority of its initial owner.
+ *
+ *  Parameters:
+ *    CS - Pointer to the critical section descriptor.
+ *    Ceiling - Priority ceiling.
+ *
+ ***************************************************************************/
+
+void osSetCSCeiling(struct TCriticalSection FAR *CS, UINT8 Ceiling)
+{
+  struct TCSAssoc FAR *CSAssoc;
+  BOOL PrevLockState;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Set the ceiling */
+  CS->Ceiling = Ceiling;
+
+  /* Reorder queues of critical sections owned by the owners, as the
+     priority of the critical section has changed, and update their
+     priorities */
+  for(CSAssoc = CS->FirstAllocated; CSAssoc; CSAssoc = CSAssoc->Next)
+  {
+    stPQueueRemove(&CSAssoc->Task->OwnedCS, &CSAssoc->Item);
+    stPQueueInsert(&CSAssoc->Task->OwnedCS, &CSAssoc->Item, CSAssoc);
+    osChangeTaskPriority(CSAssoc->Task, CSAssoc->Task->AssignedPriority);
+  }
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
+
+
+/***************************************************************************/
+#endif /* OS_MUTEX_PRIORITY_CEILING */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitsForCS
+ *
+ *  Description:
+ *    Checks if the task is waiting for the specified critical section.
+ *
+ *  Parameters:
+ *    Task - Pointer to task descriptor.
+ *    CS - Pointer to critical section descriptor.
+ *
+ *  Return:
+ *    TRUE if the task is waiting for the critical section, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+static BOOL osWaitsForCS(struct TTask FAR *Task,
+  struct TCriticalSection FAR *CS)
+{
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    INDEX i;
+  #endif
+
+  /* Task is not waiting at all */
+  if(!(Task->BlockingFlags & OS_BLOCK_FLAG_WAITING))
+    return FALSE;
+
+  /* Check all awaited signals */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    for(i = 0; i < Task->WaitingCount; i++)
+      if(Task->WaitingFor[i].Signal->CS == CS)
+        return TRUE;
+    return FALSE;
+  #else
+    return (BOOL) (Task->WaitingFor[0].Signal->CS == CS);
+  #endif
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osPriorityPath
+ *
+ *  Description:
+ *    Executes the priority path algorithm for the specified object.
+ *    Function fails if a deadlock occurs. After detecting a deadlock,
+ *    the Task must stop waiting and the osPriorityPath function must be
+ *    called for each critical section that the task previously awaited.
+ *
+ *  Parameters:
+ *    Priority - Pointer to priority path descriptor.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osPriorityPath(struct TPriorityPath FAR *Priority)
+{
+  struct TPriorityPath FAR *FirstPriority;
+  struct TPriorityPath FAR *LastPriority;
+  struct TPriorityPath FAR *NewPriority;
+  struct TCriticalSection *CS;
+  struct TCSAssoc *CSAssoc;
+  struct TTask FAR *Task;
+  BOOL SelfWait;
+
+  #if (OS_USE_LOCK_PROFILER)
+    UINT8 PrevPriority;
+  #endif
+
+  /* Begin priority path */
+  FirstPriority = Priority;
+  LastPriority = Priority;
+  Priority->Next = NULL;
+
+  /* Analyze priority path */
+  while(Priority)
+  {
+    /* Append any critical section that the task is waiting for into
+       the priority path */
+    Task = Priority->Task;
+    if(Task)
+    {
+      if(Task->BlockingFlags & OS_BLOCK_FLAG_WAITING)
+      {
+        #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+          INDEX i;
+          for(i = 0; i < Task->WaitingCount; i++)
+          {
+            CS = Task->WaitingFor[i].Signal->CS;
+        #else
+            CS = Task->WaitingFor[0].Signal->CS;
+        #endif
+
+            if(CS)
+            {
+              NewPriority = &CS->PriorityPath;
+              NewPriority->Next = NULL;
+              LastPriority->Next = NewPriority;
+              LastPriority = NewPriority;
+            }
+
+        #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+          }
+        #endif
+      }
+    }
+
+    /* Append all tasks owning this critical section */
+    else
+    {
+      CS = Priority->CS;
+      CSAssoc = CS->FirstAllocated;
+
+      /* Owners of a critical section with a priority ceiling already run
+         at the ceiling, and no task with higher priority is allowed to
+         wait for it, so there is nothing to inherit */
+      #if (OS_MUTEX_PRIORITY_CEILING)
+        if(CS->Ceiling != OS_LOWEST_PRIORITY)
+          CSAssoc = NULL;
+      #endif
+
+      while(CSAssoc)
+      {
+        Task = CSAssoc->Task;
+
+        /* Task waiting for more units of a critical section that it already
+           owns is deadlocked only when it owns all of them. Otherwise its
+           path leads back to this critical section and is not followed. */
+        SelfWait = osWaitsForCS(Task, CS);
+        if(SelfWait)
+        {
+          if((CS->FirstAllocated == CSAssoc) && !CSAssoc->Next &&
+            !CS->Signal->Signaled)
+            return FALSE;
+        }
+
+        /* Stop immediately when deadlock has been detected */
+        else if(Task == FirstPriority->Task)
+          return FALSE;
+
+        /* Update task priority, count the raise of the owner priority */
+        #if (OS_USE_LOCK_PROFILER)
+          PrevPriority = Task->Priority;
+        #endif
+        osChangeTaskPriority(Task, Task->AssignedPriority);
+        #if (OS_USE_LOCK_PROFILER)
+          if(Task->Priority < PrevPriority)
+            CS->LockStat.Boosts++;
+        #endif
+
+        /* Add at the end of the priority path all critical sections that
+           the task awaits */
+        if(!SelfWait)
+        {
+          NewPriority = &Task->PriorityPath;
+          NewPriority->Next = NULL;
+          LastPriority->Next = NewPriority;
+          LastPriority = NewPriority;
+        }
+
+        /* For each task owning this critical section, update queue of
+           critical sections, ordered by priorities of tasks waiting for
+           critical section */
+        stPQueueRemove(&Task->OwnedCS, &CSAssoc->Item);
+        stPQueueInsert(&Task->OwnedCS, &CSAssoc->Item, CSAssoc);
+
+        /* Check next association descriptor */
+        CSAssoc = CSAssoc->Next;
+      }
+
+      /* Tasks waiting for a critical section have updated priority */
+      osSignalUpdated(CS->Signal);
+    }
+
+    /* Check next object in the priority path */
+    Priority = Priority->Next;
+  }
+
+  /* Return with success */
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osFindCSAssoc
+ *
+ *  Description:
+ *    Returns a pointer to the critical section association descriptor
+ *    associating the specified task and critical section.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *    Task - Pointer to task descriptor.
+ *
+ *  Return:
+ *    Pointer to found association descriptor or NULL if not exists.
+ *
+ ***************************************************************************/
+
+static struct TCSAssoc FAR *osFindCSAssoc(struct TCriticalSection *CS,
+  struct TTask *Task)
+{
+  struct TBSTreeNode FAR *BSTreeNode;
+  struct TCSAssoc FAR *CSAssoc = NULL;
+
+  /* Optimize search when only one task can own a critical section.
+     [!] NOTE: Optimization depends on MaxSignaled, not Count, as
+     positions are variable (0: NULL, 1: first, ...). */
+  if(CS->MaxSignaled == 1)
+  {
+    CSAssoc = &CS->TasksInCS[0];
+    if(CSAssoc->Task != Task)
+      return NULL;
+  }
+
+  /* Find existing association */
+  BSTreeNode = (struct TBSTreeNode FAR *) Task->OwnedCSPtr.Root;
+  while(BSTreeNode)
+  {
+    CSAssoc = (struct TCSAssoc FAR *) BSTreeNode->Data;
+    if(CS == CSAssoc->CS)
+      break;
+
+    BSTreeNode = (CS <= CSAssoc->CS) ?
+      CSAssoc->Node.Left : CSAssoc->Node.Right;
+  }
+
+  /* Return pointer to found association descriptor */
+  return BSTreeNode ? CSAssoc : NULL;
+}
+
+
+/***************************************************************************/
+#if (OS_MUTEX_FAST_PATH)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osUnlinkFastCS
+ *
+ *  Description:
+ *    Removes the critical section acquired by the fast path from the list
+ *    of its owner and marks it as not owned by the fast path. Must be
+ *    called with interrupts disabled.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ ***************************************************************************/
+
+void osUnlinkFastCS(struct TCriticalSection FAR *CS)
+{
+  struct TCriticalSection FAR * FAR *Link;
+
+  /* Find the link pointing to the critical section (usually the first
+     one, as critical sections are mostly released in reverse order) */
+  Link = &CS->FastOwner->FastCS;
+  while(*Link != CS)
+    Link = &(*Link)->NextFastCS;
+
+  /* Remove from the list */
+  *Link = CS->NextFastCS;
+  CS->FastOwner = NULL;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osInflateCS
+ *
+ *  Description:
+ *    Converts the ownership of a critical section acquired by the fast
+ *    path into a regular one, with the association descriptor used by
+ *    priority inheritance and abandonment. Must be called with interrupts
+ *    disabled.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ ***************************************************************************/
+
+static void osInflateCS(struct TCriticalSection FAR *CS)
+{
+  struct TCSAssoc FAR *CSAssoc;
+  struct TTask FAR *Task;
+
+  /* Remove from the fast path owner list */
+  Task = CS->FastOwner;
+  osUnlinkFastCS(CS);
+
+  /* Define association (signal is already in the non-signaled state) */
+  CSAssoc = osCSAssocAlloc(CS);
+  CSAssoc->CS = CS;
+  CSAssoc->Task = Task;
+  CSAssoc->Count = 1;
+
+  /* Ownership began at the fast path acquisition */
+  #if (OS_USE_LOCK_PROFILER)
+    CSAssoc->HoldCycles = CS->FastCycles;
+  #endif
+
+  /* Assign association to task */
+  stPQueueInsert(&Task->OwnedCS, &CSAssoc->Item, CSAssoc);
+  stBSTreeInsert(&Task->OwnedCSPtr, &CSAssoc->Node, NULL, CSAssoc);
+}
+
+
+/***************************************************************************/
+#endif /* OS_MUTEX_FAST_PATH */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#endif /* OS_USE_CSEC_OBJECTS */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_MODIFIABLE_TASK_PRIO)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osChangeTaskPriority
+ *
+ *  Description:
+ *    Changes task priority and updates system queues ordered by task priority.
+ *
+ *  Parameters:
+ *    Task - Pointer to task descriptor.
+ *    Priority - New task priority.
+ *
+ *  Return:
+ *    TRUE when inherited priority has been changed, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+BOOL osChangeTaskPriority(struct TTask FAR *Task, UINT8 Priority)
+{
+  BOOL IsHigher;
+  struct TWaitAssoc FAR *WaitAssoc;
+  struct TSignal FAR *Signal;
+
+  #if (OS_USE_CSEC_OBJECTS)
+    struct TCSAssoc FAR *CSAssoc;
+  #endif
+
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    INDEX i;
+  #endif
+
+  /* Calculate expected value of inherited priority */
+  #if (OS_USE_CSEC_OBJECTS)
+    CSAssoc = (struct TCSAssoc FAR *) stPQueueGet(&Task->OwnedCS);
+    if(CSAssoc)
+      if(Priority > osGetCSPriority(CSAssoc->CS))
+        Priority = osGetCSPriority(CSAssoc->CS);
+  #endif
+
+  /* Skip if already set */
+  if(Task->Priority == Priority)
+    return FALSE;
+
+  /* Assign new priority */
+  IsHigher = (BOOL) (Priority < Task->Priority);
+
+  /* Rearrange task queue. If new priority is higher than current, a task
+     will be stored at the beginning of the queue to be processed
+     immediately, otherwise at the end. The task is removed before the
+     priority changes, because its ready queue level depends on it. */
+  if(Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN)
+  {
+    osReadyQueueRemove(Task);
+    Task->Priority = Priority;
+    osReadyQueueInsert(Task);
+    if(IsHigher)
+      osReadyQueueRotate(FALSE);
+
+    /* [!] ISSUE: Is rotate correct? Should it be for a node on
+       another level? */
+  }
+  else
+    Task->Priority = Priority;
+
+  /* Update time notification */
+  #if (OS_USE_TIME_OBJECTS)
+    if(Task->WaitTimeout.Registered)
+    {
+      osUnregisterTimeNotify(&Task->WaitTimeout);
+      osRegisterTimeNotify(&Task->WaitTimeout, Task->WaitTimeout.Time);
+
+      /* [!] ISSUE: Rotate as above? */
+      /* [!] ISSUE: What about the timer if waiting for it? */
+    }
+  #endif
+
+  /* Rearrange waiting queue */
+  if(Task->BlockingFlags & OS_BLOCK_FLAG_WAITING)
+  {
+    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+      for(i = 0; i < Task->WaitingCount; i++)
+      {
+        WaitAssoc = &Task->WaitingFor[i];
+        Signal = WaitAssoc->Signal;
+        stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
+        stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node,
+           NULL, WaitAssoc);
+        osSignalUpdated(Signal);
+
+        /* [!] TODO: Time Notify timer updates... */
+      }
+    #else
+      WaitAssoc = &Task->WaitingFor[0];
+      Signal = WaitAssoc->Signal;
+      stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
+      stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node,
+        NULL, WaitAssoc);
+      osSignalUpdated(Signal);
+
+      /* [!] TODO: Time Notify timer updates... */
+    #endif
+  }
+
+  /* Priority has been changed */
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osRescheduleIfHigherPriority
+ *
+ *  Description:
+ *    Calls scheduler if some task has priority higher than the priority
+ *    of the current task.
+ *
+ ***************************************************************************/
+
+void osRescheduleIfHigherPriority(void)
+{
+  struct TSignal FAR *Signal;
+  struct TWaitAssoc FAR *WaitAssoc;
+
+  #if (OS_USE_TIME_OBJECTS)
+    struct TTimeNotify FAR *TimeNotify;
+  #endif
+
+  while(TRUE)
+  {
+    /* Check first task in queue */
+    if(osCurrentTask->Priority >
+      osReadyQueueGet()->Priority)
+      break;
+
+    /* Time notification */
+    #if (OS_USE_TIME_OBJECTS)
+      TimeNotify = osGetTimeNotify(osCurrentTask->Priority,
+        osLastQuantumTime);
+      if(TimeNotify)
+      {
+        if(TimeNotify->Task)
+        {
+          if(osCurrentTask->Priority > TimeNotify->Task->Priority)
+            break;
+        }
+        else
+        {
+          WaitAssoc = (struct TWaitAssoc FAR *)
+            stBSTreeGetFirst(&TimeNotify->Signal->WaitingTasks);
+          if(WaitAssoc)
+            if(osCurrentTask->Priority > WaitAssoc->Task->Priority)
+              break;
+        }
+      }
+    #endif
+
+    /* Deferred signalization */
+    Signal = (struct TSignal FAR *) stBSTreeGetFirst(&osDeferredSignal);
+    if(Signal)
+    {
+      WaitAssoc =
+        (struct TWaitAssoc FAR *) stBSTreeGetFirst(&Signal->WaitingTasks);
+      if(WaitAssoc)
+        if(osCurrentTask->Priority > WaitAssoc->Task->Priority)
+          break;
+    }
+
+    /* Each task has priority lower or equal to priority of the current
+       task */
+    return;
+  }
+
+  /* Reschedule, because some task has higher priority than current */
+  osYield();
+}
+
+
+/***************************************************************************/
+#endif /* OS_MODIFIABLE_TASK_PRIO */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Synchronization
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osAcquire
+ *
+ *  Description:
+ *    Tries to acquire the signal.
+ *
+ *  Parameters:
+ *    Signal - Pointer to the signal descriptor.
+ *    OnCheck - If TRUE, the task will not acquire the signal when it has
+ *      the "decrement on release" flag set and the task priority is lower
+ *      or equal to the priority of the signal. This queues signal acquire
+ *      requests.
+ *
+ *  Return:
+ *    TRUE if object was acquired, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+static BOOL osAcquire(struct TSignal FAR *Signal, BOOL OnCheck)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    INDEX i;
+  #endif
+
+  #if (OS_USE_CSEC_OBJECTS)
+    struct TCSAssoc FAR *CSAssoc;
+  #endif
+
+  /* Register the owner of a critical section acquired by the fast path
+     before the signal state is examined */
+  #if (OS_MUTEX_FAST_PATH)
+    if(Signal->CS)
+      if(Signal->CS->FastOwner)
+        osInflateCS(Signal->CS);
+  #endif
+
+  /* Check signalization state */
+  #if (OS_USE_SYSTEM_IO_CTRL)
+    if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+    {
+      if(!Signal->Object->DeviceIOCtrl(Signal->Object,
+        OS_IO_CTL_GET_SIGNAL_STATE, NULL, 0, NULL))
+        return FALSE;
+    }
+    else
+  #endif
+
+  if(!Signal->Signaled)
+  {
+    /* Mutexes are always signaled for owning task */
+    #if (OS_USE_CSEC_OBJECTS)
+      if(Signal->Flags & OS_SIGNAL_FLAG_MUTUAL_EXCLUSION)
+        if(Signal->CS->TasksInCS[0].Task == osCurrentTask)
+          return TRUE;
+    #endif
+
+    /* All other objects cannot be acquired when not signaled */
+    return FALSE;
+  }
+
+  /* Decrement signal counter when the "decrement on release" is set */
+  if(Signal->Flags & OS_SIGNAL_FLAG_DEC_ON_RELEASE)
+  {
+    /* Check signal priority */
+    if(OnCheck)
+    {
+      WaitAssoc = (struct TWaitAssoc FAR *)
+        stBSTreeGetFirst(&Signal->WaitingTasks);
+      if(WaitAssoc)
+        if(WaitAssoc->Task->Priority <= osCurrentTask->Priority)
+          return FALSE;
+    }
+
+    /* Decrement signal state */
+    Signal->Signaled--;
+    osSignalUpdated(Signal);
+  }
+
+  /* Define association between the task and a critical section */
+  #if (OS_USE_CSEC_OBJECTS)
+    if(Signal->Flags & OS_SIGNAL_FLAG_CRITICAL_SECTION)
+    {
+      /* Try to find existing association */
+      CSAssoc = osFindCSAssoc(Signal->CS, osCurrentTask);
+      if(CSAssoc)
+        CSAssoc->Count++;
+
+      /* Define new association */
+      else
+      {
+        CSAssoc = osCSAssocAlloc(Signal->CS);
+        CSAssoc->CS = Signal->CS;
+        CSAssoc->Task = osCurrentTask;
+        CSAssoc->Count = 1;
+
+        #if (OS_USE_LOCK_PROFILER)
+          Signal->CS->LockStat.Acquisitions++;
+        #endif
+
+        /* Assign association to task */
+        stPQueueInsert(&osCurrentTask->OwnedCS, &CSAssoc->Item, CSAssoc);
+        stBSTreeInsert(&osCurrentTask->OwnedCSPtr, &CSAssoc->Node, NULL,
+          CSAssoc);
+
+        /* Raise the task priority to the priority ceiling */
+        #if (OS_MUTEX_PRIORITY_CEILING)
+          if(Signal->CS->Ceiling != OS_LOWEST_PRIORITY)
+            osChangeTaskPriority(osCurrentTask,
+              osCurrentTask->AssignedPriority);
+        #endif
+      }
+
+      /* Is the "abandon flag" set? */
+      if(Signal->Flags & OS_SIGNAL_FLAG_ABANDONED)
+      {
+        Signal->Flags &= (UINT8) ~OS_SIGNAL_FLAG_ABANDONED;
+        osCurrentTask->WaitExitCode = ERR_WAIT_ABANDONED;
+      }
+    }
+  #endif
+
+  /* Notify object acquiring */
+  #if (OS_USE_SYSTEM_IO_CTRL)
+    if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+      Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_ACQUIRE,
+        NULL, 0, NULL);
+  #endif
+
+  /* Return with success */
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCanAcquire
+ *
+ *  Description:
+ *    Checks whether osAcquire with the OnCheck parameter set would acquire
+ *    the signal, without changing its state.
+ *
+ *  Parameters:
+ *    Signal - Pointer to the signal descriptor.
+ *
+ *  Return:
+ *    TRUE if the signal can be acquired, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+static BOOL osCanAcquire(struct TSignal FAR *Signal)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+
+  /* Register the owner of a critical section acquired by the fast path */
+  #if (OS_MUTEX_FAST_PATH)
+    if(Signal->CS)
+      if(Signal->CS->FastOwner)
+        osInflateCS(Signal->CS);
+  #endif
+
+  /* Check signalization state */
+  #if (OS_USE_SYSTEM_IO_CTRL)
+    if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+    {
+      if(!Signal->Object->DeviceIOCtrl(Signal->Object,
+        OS_IO_CTL_GET_SIGNAL_STATE, NULL, 0, NULL))
+        return FALSE;
+    }
+    else
+  #endif
+
+  if(!Signal->Signaled)
+  {
+    /* Mutexes are always signaled for owning task */
+    #if (OS_USE_CSEC_OBJECTS)
+      if(Signal->Flags & OS_SIGNAL_FLAG_MUTUAL_EXCLUSION)
+        if(Signal->CS->TasksInCS[0].Task == osCurrentTask)
+          return TRUE;
+    #endif
+
+    return FALSE;
+  }
+
+  /* Tasks with higher or equal priority waiting for the signal take it
+     first */
+  if(Signal->Flags & OS_SIGNAL_FLAG_DEC_ON_RELEASE)
+  {
+    WaitAssoc = (struct TWaitAssoc FAR *)
+      stBSTreeGetFirst(&Signal->WaitingTasks);
+    if(WaitAssoc)
+      if(WaitAssoc->Task->Priority <= osCurrentTask->Priority)
+        return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osAcquireAll
+ *
+ *  Description:
+ *    Acquires all signals the current task is waiting for, only when each
+ *    of them can be acquired. Otherwise no signal is acquired, and the
+ *    signals which cannot be acquired are moved to the beginning of the
+ *    WaitingFor array, their number is stored in WaitingCount. Must be
+ *    called with interrupts disabled.
+ *
+ *  Return:
+ *    TRUE if all signals were acquired, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+static BOOL osAcquireAll(void)
+{
+  struct TWaitAssoc WaitAssoc;
+  INDEX i, Count;
+
+  /* Move signals which cannot be acquired to the array beginning */
+  Count = 0;
+  for(i = 0; i < osCurrentTask->WaitingCount; i++)
+    if(!osCanAcquire(osCurrentTask->WaitingFor[i].Signal))
+    {
+      if(i != Count)
+      {
+        WaitAssoc = osCurrentTask->WaitingFor[Count];
+        osCurrentTask->WaitingFor[Count] = osCurrentTask->WaitingFor[i];
+        osCurrentTask->WaitingFor[i] = WaitAssoc;
+      }
+      Count++;
+    }
+
+  /* Wait only for signals which cannot be acquired */
+  if(Count)
+  {
+    osCurrentTask->WaitingCount = Count;
+    return FALSE;
+  }
+
+  /* Acquire all signals at once */
+  for(i = 0; i < osCurrentTask->WaitingCount; i++)
+    osAcquire(osCurrentTask->WaitingFor[i].Signal, FALSE);
+
+  osCurrentTask->WaitAll = FALSE;
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_MAX_WAIT_FOR_OBJECTS */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMakeNotWaiting
+ *
+ *  Description:
+ *    Exits from the wait state.
+ *
+ *  Parameters:
+ *    Task - Pointer to task that should exit from the wait state.
+ *
+ ***************************************************************************/
+
+void osMakeNotWaiting(struct TTask FAR *Task)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+  struct TSignal FAR *Signal;
+
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    INDEX i;
+  #endif
+
+  #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+    UINT32 WaitTime;
+    WaitTime = OS_GET_CYCLE_COUNT() - Task->WaitCycles;
+  #endif
+
+  /* Remove waiting flags */
+  Task->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_WAITING;
+
+  #if (OS_USE_TRACE)
+    osTraceRecord(OS_TRACE_WAIT_END, Task, NULL,
+      (UINT32) Task->WaitExitCode, 0);
+  #endif
+
+  /* Cancel the waiting timeout (still registered when the task is
+     released by a signal) */
+  #if (OS_USE_TIME_OBJECTS)
+    if(Task->WaitTimeout.Registered)
+      osUnregisterTimeNotify(&Task->WaitTimeout);
+  #endif
+
+  /* Remove task from waiting queue of each signal */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    for(i = 0; i < Task->WaitingCount; i++)
+    {
+      WaitAssoc = &Task->WaitingFor[i];
+  #else
+      WaitAssoc = &Task->WaitingFor[0];
+  #endif
+
+      Signal = WaitAssoc->Signal;
+      stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
+      osSignalUpdated(Signal);
+
+      /* Time spent waiting for the object */
+      #if (OS_USE_LATENCY_HISTOGRAM)
+        osLatencyRecord(Signal->Object->WaitHistogram, WaitTime);
+      #endif
+
+      /* [!] TODO: Unregister timer by OS_IO_CTL_WAIT_UPDATE... */
+
+      /* Update priority path */
+      #if (OS_USE_CSEC_OBJECTS)
+        if(Signal->CS)
+        {
+          #if (OS_USE_LOCK_PROFILER)
+            osLockWaited(Signal->CS, WaitTime);
+          #endif
+          osPriorityPath(&Signal->CS->PriorityPath);
+        }
+      #endif
+
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    }
+  #endif
+}
+
+
+/***************************************************************************/
+#if (OS_USE_CONDVAR)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osReleaseCSOnWait
+ *
+ *  Description:
+ *    Releases the critical section owned by the current task, which is
+ *    entering the wait state. Unlike osReleaseCS, the scheduler is not
+ *    called; the next owner is chosen by the deferred signalization after
+ *    the current task stops running. Must be called with interrupts
+ *    disabled.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ ***************************************************************************/
+
+static void osReleaseCSOnWait(struct TCriticalSection FAR *CS)
+{
+  struct TCSAssoc FAR *CSAssoc;
+  INDEX Count;
+
+  /* Release mutex acquired by the fast path */
+  #if (OS_MUTEX_FAST_PATH)
+    if(CS->FastOwner == osCurrentTask)
+    {
+      #if (OS_USE_LOCK_PROFILER)
+        osLockHeld(CS, CS->FastCycles);
+      #endif
+
+      osUnlinkFastCS(CS);
+      CS->Signal->Signaled++;
+      osSignalUpdated(CS->Signal);
+      return;
+    }
+  #endif
+
+  /* Remove the association (the ownership is checked by the caller) */
+  CSAssoc = osFindCSAssoc(CS, osCurrentTask);
+  Count = CSAssoc->Count;
+  stPQueueRemove(&osCurrentTask->OwnedCS, &CSAssoc->Item);
+  stBSTreeRemove(&osCurrentTask->OwnedCSPtr, &CSAssoc->Node);
+  osCSAssocFree(CS, CSAssoc);
+
+  /* Update task priority */
+  osChangeTaskPriority(osCurrentTask, osCurrentTask->AssignedPriority);
+
+  /* Release critical section */
+  CS->Signal->Signaled += Count;
+  osSignalUpdated(CS->Signal);
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_CONDVAR */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMakeWaiting
+ *
+ *  Description:
+ *    Makes the current task wait for specified signals. The task will
+ *    wait until the signal is in the signaled state or the specified
+ *    timeout elapses. To exit from the wait state, osMakeNotWaiting must
+ *    be called.
+ *
+ *  Parameters:
+ *    Timeout - Timeout value in time units.
+ *    ReleaseCS - Pointer to the critical section owned by the current task,
+ *      released after the task is queued, or NULL.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL osMakeWaiting(TIME Timeout, struct TCriticalSection FAR *ReleaseCS)
+{
+  BOOL PrevLockState;
+  struct TWaitAssoc FAR *WaitAssoc;
+  struct TSignal FAR *Signal;
+
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    INDEX i;
+  #endif
+
+  /* Mark unused parameters to avoid warning messages */
+  #if !(OS_USE_CONDVAR)
+    AR_UNUSED_PARAM(ReleaseCS);
+  #endif
+
+  /* Check timeout value */
+  #if !(OS_USE_TIME_OBJECTS)
+    if((Timeout != OS_IGNORE) && (Timeout != OS_INFINITE))
+    {
+      osSetLastError(ERR_INVALID_PARAMETER);
+      return FALSE;
+    }
+  #endif
+
+  /* Obtain pointers of descriptors */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) == 1)
+    WaitAssoc = &osCurrentTask->WaitingFor[0];
+    Signal = WaitAssoc->Signal;
+  #endif
+
+  /* Task with priority higher than the priority ceiling of a critical
+     section must not acquire it (owners of such a critical section do not
+     inherit priorities). The assigned priority is compared, a task raised
+     by another ceiling or by inheritance still may acquire it. */
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+      for(i = 0; i < osCurrentTask->WaitingCount; i++)
+      {
+        Signal = osCurrentTask->WaitingFor[i].Signal;
+    #endif
+
+        if(Signal->CS)
+          if((Signal->CS->Ceiling != OS_LOWEST_PRIORITY) &&
+            (osCurrentTask->AssignedPriority < Signal->CS->Ceiling))
+          {
+            osSetLastError(ERR_PRIORITY_ABOVE_CEILING);
+            return FALSE;
+          }
+
+    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+      }
+    #endif
+  #endif
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* [!] NOTE: Will be cleared already */
+  osCurrentTask->WaitExitCode = ERR_NO_ERROR;
+
+  /* Check object signalization */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    if(osCurrentTask->WaitAll)
+    {
+      /* Acquire all signals or wait only for the ones which cannot be
+         acquired (signals already available are checked again when the
+         task is released) */
+      if(osAcquireAll())
+      {
+        arRestore(PrevLockState);
+
+        /* Return with error on acquiring abandoned critical section */
+        #if (OS_USE_CSEC_OBJECTS)
+          if(osCurrentTask->WaitExitCode)
+          {
+            osSetLastError(osCurrentTask->WaitExitCode);
+            return FALSE;
+          }
+        #endif
+
+        return TRUE;
+      }
+    }
+    else
+    {
+      for(i = 0; i < osCurrentTask->WaitingCount; i++)
+        if(osAcquire(osCurrentTask->WaitingFor[i].Signal, TRUE))
+        {
+          arRestore(PrevLockState);
+          osCurrentTask->WaitingIndex = i;
+
+          /* Return with error on acquiring abandoned critical section */
+          #if (OS_USE_CSEC_OBJECTS)
+            if(osCurrentTask->WaitExitCode)
+            {
+              osSetLastError(osCurrentTask->WaitExitCode);
+              return FALSE;
+            }
+          #endif
+
+          return TRUE;
+        }
+    }
+  #else
+    if(osAcquire(Signal, TRUE))
+    {
+      arRestore(PrevLockState);
+
+      /* Return with error on acquiring abandoned critical section */
+      #if (OS_USE_CSEC_OBJECTS)
+        if(osCurrentTask->WaitExitCode)
+        {
+          osSetLastError(osCurrentTask->WaitExitCode);
+          return FALSE;
+        }
+      #endif
+
+      return TRUE;
+    }
+  #endif
+
+  /* Return immediately if timeout value is set to OS_IGNORE (or 0) */
+  if(Timeout == OS_IGNORE)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_WAIT_TIMEOUT);
+    return FALSE;
+  }
+
+  /* Set the waiting flag (interrupts are disabled, so code will be
+     continued uninterrupted) */
+  osCurrentTask->BlockingFlags |= OS_BLOCK_FLAG_WAITING;
+
+  #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+    osCurrentTask->WaitCycles = OS_GET_CYCLE_COUNT();
+  #endif
+
+  /* Append waiting tasks to waiting queue of specified signals */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    for(i = 0; i < osCurrentTask->WaitingCount; i++)
+    {
+      WaitAssoc = &osCurrentTask->WaitingFor[i];
+      Signal = WaitAssoc->Signal;
+
+      stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node, NULL,
+        WaitAssoc);
+      osSignalUpdated(Signal);
+
+      #if (OS_USE_SYSTEM_IO_CTRL)
+        if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+          Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_START,
+            NULL, 0, NULL);
+      #endif
+    }
+  #else
+    stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node, NULL, WaitAssoc);
+    osSignalUpdated(Signal);
+
+    #if (OS_USE_SYSTEM_IO_CTRL)
+      if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+        Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_START,
+          NULL, 0, NULL);
+    #endif
+  #endif
 
-  /* Begin priority path */
-  FirstPriority = Priority;
-  LastPriority = Priority;
-  Priority->Next = NULL;
+  /* Record the beginning of waiting (first signal and number of signals) */
+  #if (OS_USE_TRACE)
+    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+      osTraceRecord(OS_TRACE_WAIT_BEGIN, osCurrentTask,
+        osCurrentTask->WaitingFor[0].Signal, (UINT32) Timeout,
+        (UINT16) osCurrentTask->WaitingCount);
+    #else
+      osTraceRecord(OS_TRACE_WAIT_BEGIN, osCurrentTask, Signal,
+        (UINT32) Timeout, 1);
+    #endif
+  #endif
 
-  /* Analyze priority path */
-  while(Priority)
-  {
-    /* Append any critical section that the task is waiting for into
-       the priority path */
-    Task = Priority->Task;
-    if(Task)
+  /* Set the timeout */
+  #if (OS_USE_TIME_OBJECTS)
+    if(Timeout != OS_INFINITE)
     {
-      if(Task->BlockingFlags & OS_BLOCK_FLAG_WAITING)
-      {
-        #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-          INDEX i;
-          for(i = 0; i < Task->WaitingCount; i++)
-          {
-            CS = Task->WaitingFor[i].Signal->CS;
-        #else
-            CS = Task->WaitingFor[0].Signal->CS;
-        #endif
+      TIME CurrentTime;
+      CurrentTime = arGetTickCount();
 
-            if(CS)
-            {
-              NewPriority = &CS->PriorityPath;
-              NewPriority->Next = NULL;
-              LastPriority->Next = NewPriority;
-              LastPriority = NewPriority;
-            }
+      /* Control time overflow */
+      Timeout = ((OS_INFINITE - CurrentTime) <= Timeout) ?
+        OS_INFINITE : (CurrentTime + Timeout);
 
-        #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-          }
-        #endif
-      }
+      osRegisterTimeNotify(&osCurrentTask->WaitTimeout, Timeout);
     }
+  #endif
 
-    /* Append all tasks owning this critical section */
-    else
+  /* Update priority path for waiting task */
+  #if (OS_USE_CSEC_OBJECTS)
+    if(!osPriorityPath(&osCurrentTask->PriorityPath))
     {
-      CS = Priority->CS;
-      CSAssoc = CS->FirstAllocated;
-      while(CSAssoc)
-      {
-        Task = CSAssoc->Task;
-
-        /* Stop immediately when deadlock has been detected */
-        if(Task == FirstPriority->Task)
-          return FALSE;
-
-        /* Update task priority */
-        osChangeTaskPriority(Task, Task->AssignedPriority);
+      /* Exit wait state when deadlock occurs */
+      osMakeNotWaiting(osCurrentTask);
+      arRestore(PrevLockState);
+      osSetLastError(ERR_WAIT_DEADLOCK);
+      return FALSE;
+    }
+  #endif
 
-        /* Add at the end of the priority path all critical sections that
-           the task awaits */
-        NewPriority = &Task->PriorityPath;
-        NewPriority->Next = NULL;
-        LastPriority->Next = NewPriority;
-        LastPriority = NewPriority;
+  /* Release the critical section. The task is already queued, so any
+     signal sent after the release will find it. */
+  #if (OS_USE_CONDVAR)
+    if(ReleaseCS)
+      osReleaseCSOnWait(ReleaseCS);
+  #endif
 
-        /* For each task owning this critical section, update queue of
-           critical sections, ordered by priorities of tasks waiting for
-           critical section */
-        stPQueueRemove(&Task->OwnedCS, &CSAssoc->Item);
-        stPQueueInsert(&Task->OwnedCS, &CSAssoc->Item, CSAssoc);
+  /* Begin waiting and reschedule. This function will return when one of the
+     signals is in the signaled state or specified timeout interval
+     elapses. */
+  /* [!] NOTE: already cleared above */
+  osCurrentTask->WaitExitCode = ERR_NO_ERROR;
+  osMakeNotReady(osCurrentTask);
 
-        /* Check next association descriptor */
-        CSAssoc = CSAssoc->Next;
-      }
+  /* Leave critical section */
+  arRestore(PrevLockState);
 
-      /* Tasks waiting for a critical section have updated priority */
-      osSignalUpdated(CS->Signal);
+  /* Set the last error code when error occurs */
+  /* [!] ISSUE: Remove ifdefs? */
+  #if ((OS_USE_WAITING_WITH_TIME_OUT) || (OS_USE_CSEC_OBJECTS) || \
+    (OS_USE_IPC_DIRECT_RW))
+    if(osCurrentTask->WaitExitCode != ERR_NO_ERROR)
+    {
+      osSetLastError(osCurrentTask->WaitExitCode);
+      return FALSE;
     }
-
-    /* Check next object in the priority path */
-    Priority = Priority->Next;
-  }
+  #endif
 
   /* Return with success */
   return TRUE;
@@ -2344,785 +5020,763 @@ BOOL osPriorityPath(struct TPriorityPath FAR *Priority)
 /****************************************************************************
  *
  *  Name:
- *    osFindCSAssoc
+ *    osUpdateSignalState
  *
  *  Description:
- *    Returns a pointer to the critical section association descriptor
- *    associating the specified task and critical section.
+ *    Changes object signalization state.
  *
  *  Parameters:
- *    CS - Pointer to critical section descriptor.
- *    Task - Pointer to task descriptor.
- *
- *  Return:
- *    Pointer to found association descriptor or NULL if not exists.
+ *    Signal - Pointer to signal descriptor.
+ *    Signaled - New signal value.
  *
  ***************************************************************************/
 
-static struct TCSAssoc FAR *osFindCSAssoc(struct TCriticalSection *CS,
-  struct TTask *Task)
+void osUpdateSignalState(struct TSignal FAR *Signal, INDEX Signaled)
 {
-  struct TBSTreeNode FAR *BSTreeNode;
-  struct TCSAssoc FAR *CSAssoc = NULL;
+  BOOL PrevLockState, NeedUpdate;
+  struct TTask FAR *Task;
 
-  /* Optimize search when only one task can own a critical section.
-     [!] NOTE: Optimization depends on MaxSignaled, not Count, as
-     positions are variable (0: NULL, 1: first, ...). */
-  if(CS->MaxSignaled == 1)
-  {
-    CSAssoc = &CS->TasksInCS[0];
-    if(CSAssoc->Task != Task)
-      return NULL;
-  }
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-  /* Find existing association */
-  BSTreeNode = (struct TBSTreeNode FAR *) Task->OwnedCSPtr.Root;
-  while(BSTreeNode)
+  /* Is signal updating mandatory? */
+  NeedUpdate = ((BOOL) (Signal->Signaled > 0)) ^ ((BOOL) (Signaled > 0));
+
+  /* Change signalization state */
+  Signal->Signaled = Signaled;
+
+  #if (OS_USE_TRACE)
+    osTraceRecord(OS_TRACE_SIGNAL, osCurrentTask, Signal, (UINT32) Signaled,
+      0);
+  #endif
+
+  /* Update signal when it is mandatory */
+  /* [!] CHECK: It is ok here before calling osSignalUpdated - verify
+     elsewhere! */
+  if(NeedUpdate)
   {
-    CSAssoc = (struct TCSAssoc FAR *) BSTreeNode->Data;
-    if(CS == CSAssoc->CS)
-      break;
+    Task = osSignalUpdated(Signal);
 
-    BSTreeNode = (CS <= CSAssoc->CS) ?
-      CSAssoc->Node.Left : CSAssoc->Node.Right;
+    /* When signal is in the signaled state and priority of task waiting for
+       signal is higher than priority of the current task, reschedule
+       immediately. Terminated task reschedules when it leaves the ready
+       queue, otherwise it could be deleted while still queued. */
+    if(Signaled && Task)
+      if((Task->Priority < osCurrentTask->Priority) &&
+        !(osCurrentTask->BlockingFlags & OS_BLOCK_FLAG_TERMINATED))
+        osYield();
   }
 
-  /* Return pointer to found association descriptor */
-  return BSTreeNode ? CSAssoc : NULL;
+  /* Leave critical section */
+  arRestore(PrevLockState);
 }
 
 
 /***************************************************************************/
-#endif /* OS_USE_CSEC_OBJECTS */
-/***************************************************************************/
-
-
-/***************************************************************************/
-#if (OS_MODIFIABLE_TASK_PRIO)
+#if (OS_USE_CSEC_OBJECTS)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osChangeTaskPriority
+ *    osReleaseCS
  *
  *  Description:
- *    Changes task priority and updates system queues ordered by task priority.
+ *    Releases a specified critical section.
  *
  *  Parameters:
+ *    CS - Pointer to critical section descriptor.
  *    Task - Pointer to task descriptor.
- *    Priority - New task priority.
+ *    ReleaseCount - The value which will be added to critical section
+ *      counter. If it is too large, the critical section will not be
+ *      released and an error occurs. Must be greater than zero.
+ *    PrevCount - Pointer to variable that receives the counter value
+ *      before releasing (may be NULL if not expected).
  *
  *  Return:
- *    TRUE when inherited priority has been changed, otherwise FALSE.
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-BOOL osChangeTaskPriority(struct TTask FAR *Task, UINT8 Priority)
+BOOL osReleaseCS(struct TCriticalSection FAR *CS, struct TTask FAR *Task,
+  INDEX ReleaseCount, INDEX *PrevCount)
 {
-  BOOL IsHigher;
-  struct TWaitAssoc FAR *WaitAssoc;
-  struct TSignal FAR *Signal;
+  BOOL PrevLockState, Lowered;
+  struct TCSAssoc FAR *CSAssoc;
 
-  #if (OS_USE_CSEC_OBJECTS)
-    struct TCSAssoc FAR *CSAssoc;
-  #endif
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
 
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    INDEX i;
-  #endif
+  /* Enter critical section (disable interrupts) */
+  PrevLockState = arLock();
 
-  /* Calculate expected value of inherited priority */
-  #if (OS_USE_CSEC_OBJECTS)
-    CSAssoc = (struct TCSAssoc FAR *) stPQueueGet(&Task->OwnedCS);
-    if(CSAssoc)
-    {
-      WaitAssoc = (struct TWaitAssoc FAR *)
-        stBSTreeGetFirst(&CSAssoc->CS->Signal->WaitingTasks);
-      if(WaitAssoc)
-        if(Priority > WaitAssoc->Task->Priority)
-          Priority = WaitAssoc->Task->Priority;
-    }
-  #endif
+  /* Fail if ReleaseCount is incorrect */
+  CSAssoc = osFindCSAssoc(CS, Task);
+  if(CSAssoc)
+    if(ReleaseCount > CSAssoc->Count)
+      CSAssoc = NULL;
+
+  /* Fail if association is not defined */
+  if(!CSAssoc)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_OBJECT_CAN_NOT_BE_RELEASED);
+    return FALSE;
+  }
+
+  /* Subtract the ReleaseCount from the counter value */
+  CSAssoc->Count -= ReleaseCount;
+
+  /* Remove association when counter is zero */
+  Lowered = FALSE;
+  if(!CSAssoc->Count)
+  {
+    stPQueueRemove(&Task->OwnedCS, &CSAssoc->Item);
+    stBSTreeRemove(&Task->OwnedCSPtr, &CSAssoc->Node);
+    osCSAssocFree(CS, CSAssoc);
+
+    /* Update task priority. The task is not waiting for any signal, so
+       priority path is already valid. */
+    Lowered = osChangeTaskPriority(Task, Task->AssignedPriority);
+  }
+
+  /* Save previous counter value */
+  if(PrevCount)
+    *PrevCount = CS->Signal->Signaled;
+
+  /* Release critical section */
+  osUpdateSignalState(CS->Signal, CS->Signal->Signaled + ReleaseCount);
+
+  /* Task which has lost a raised priority (e.g. the priority ceiling) lets
+     the tasks held off by it run immediately, even if none of them waits
+     for the critical section */
+  if(Lowered && (Task == osCurrentTask) &&
+    !(Task->BlockingFlags & OS_BLOCK_FLAG_TERMINATED))
+    osRescheduleIfHigherPriority();
+
+  /* Leave critical section (restore interrupts) */
+  arRestore(PrevLockState);
+  return TRUE;
+}
 
-  /* Skip if already set */
-  if(Task->Priority == Priority)
-    return FALSE;
 
-  /* Assign new priority */
-  IsHigher = (BOOL) (Priority < Task->Priority);
-  Task->Priority = Priority;
+/***************************************************************************/
+#endif /* OS_USE_CSEC_OBJECTS */
+/***************************************************************************/
 
-  /* Rearrange task queue. If new priority is higher than current, a task
-     will be stored at the beginning of the queue to be processed
-     immediately, otherwise at the end. */
-  if(Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN)
-  {
-    stPQueueRemove(&osTaskPQueue, &Task->ReadyTask);
-    stPQueueInsert(&osTaskPQueue, &Task->ReadyTask, Task);
-    if(IsHigher)
-      stPQueueRotate(&osTaskPQueue, NULL, FALSE);
 
-    /* [!] ISSUE: Is rotate correct? Should it be for a node on
-       another level? */
-  }
+/***************************************************************************/
+#if (OS_USE_RWLOCK)
+/***************************************************************************/
 
-  /* Update time notification */
-  #if (OS_USE_TIME_OBJECTS)
-    if(Task->WaitTimeout.Registered)
-    {
-      osUnregisterTimeNotify(&Task->WaitTimeout);
-      osRegisterTimeNotify(&Task->WaitTimeout, Task->WaitTimeout.Time);
 
-      /* [!] ISSUE: Rotate as above? */
-      /* [!] ISSUE: What about the timer if waiting for it? */
-    }
-  #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osAcquireOwnedCS
+ *
+ *  Description:
+ *    Acquires recursively a critical section already owned by the current
+ *    task. The acquisition is counted without taking another unit, so the
+ *    task never waits for itself.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ *  Return:
+ *    TRUE if the critical section was acquired, FALSE if the current task
+ *    does not own it.
+ *
+ ***************************************************************************/
 
-  /* Rearrange waiting queue */
-  if(Task->BlockingFlags & OS_BLOCK_FLAG_WAITING)
-  {
-    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-      for(i = 0; i < Task->WaitingCount; i++)
-      {
-        WaitAssoc = &Task->WaitingFor[i];
-        Signal = WaitAssoc->Signal;
-        stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
-        stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node,
-           NULL, WaitAssoc);
-        osSignalUpdated(Signal);
+BOOL osAcquireOwnedCS(struct TCriticalSection FAR *CS)
+{
+  struct TCSAssoc FAR *CSAssoc;
+  BOOL PrevLockState;
 
-        /* [!] TODO: Time Notify timer updates... */
-      }
-    #else
-      WaitAssoc = &Task->WaitingFor[0];
-      Signal = WaitAssoc->Signal;
-      stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
-      stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node,
-        NULL, WaitAssoc);
-      osSignalUpdated(Signal);
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-      /* [!] TODO: Time Notify timer updates... */
-    #endif
-  }
+  /* Count the acquisition */
+  CSAssoc = osFindCSAssoc(CS, osCurrentTask);
+  if(CSAssoc)
+    CSAssoc->Recursion++;
 
-  /* Priority has been changed */
-  return TRUE;
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return (BOOL) (CSAssoc != NULL);
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osRescheduleIfHigherPriority
+ *    osReleaseOwnedCS
  *
  *  Description:
- *    Calls scheduler if some task has priority higher than the priority
- *    of the current task.
+ *    Releases a recursive acquisition of a critical section counted by
+ *    osAcquireOwnedCS.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *
+ *  Return:
+ *    TRUE if a recursive acquisition was released, FALSE if there is none
+ *    (the units must be released by osReleaseCS).
  *
  ***************************************************************************/
 
-void osRescheduleIfHigherPriority(void)
+BOOL osReleaseOwnedCS(struct TCriticalSection FAR *CS)
 {
-  struct TSignal FAR *Signal;
-  struct TWaitAssoc FAR *WaitAssoc;
-
-  #if (OS_USE_TIME_OBJECTS)
-    struct TTimeNotify FAR *TimeNotify;
-  #endif
-
-  while(TRUE)
-  {
-    /* Check first task in queue */
-    if(osCurrentTask->Priority >
-      ((struct TTask FAR *) stPQueueGet(&osTaskPQueue))->Priority)
-      break;
+  struct TCSAssoc FAR *CSAssoc;
+  BOOL PrevLockState, Released;
 
-    /* Time notification */
-    #if (OS_USE_TIME_OBJECTS)
-      TimeNotify = osGetTimeNotify(osCurrentTask->Priority,
-        osLastQuantumTime);
-      if(TimeNotify)
-      {
-        if(TimeNotify->Task)
-        {
-          if(osCurrentTask->Priority > TimeNotify->Task->Priority)
-            break;
-        }
-        else
-        {
-          WaitAssoc = (struct TWaitAssoc FAR *)
-            stBSTreeGetFirst(&TimeNotify->Signal->WaitingTasks);
-          if(WaitAssoc)
-            if(osCurrentTask->Priority > WaitAssoc->Task->Priority)
-              break;
-        }
-      }
-    #endif
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-    /* Deferred signalization */
-    Signal = (struct TSignal FAR *) stBSTreeGetFirst(&osDeferredSignal);
-    if(Signal)
+  /* Uncount the acquisition */
+  Released = FALSE;
+  CSAssoc = osFindCSAssoc(CS, osCurrentTask);
+  if(CSAssoc)
+    if(CSAssoc->Recursion)
     {
-      WaitAssoc =
-        (struct TWaitAssoc FAR *) stBSTreeGetFirst(&Signal->WaitingTasks);
-      if(WaitAssoc)
-        if(osCurrentTask->Priority > WaitAssoc->Task->Priority)
-          break;
+      CSAssoc->Recursion--;
+      Released = TRUE;
     }
 
-    /* Each task has priority lower or equal to priority of the current
-       task */
-    return;
-  }
-
-  /* Reschedule, because some task has higher priority than current */
-  osYield();
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Released;
 }
 
 
 /***************************************************************************/
-#endif /* OS_MODIFIABLE_TASK_PRIO */
+#endif /* OS_USE_RWLOCK */
 /***************************************************************************/
 
 
-/****************************************************************************
- *
- *  Synchronization
- *
- ***************************************************************************/
+/***************************************************************************/
+#if (OS_USE_MULTIPLE_SIGNALS)
+/***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osAcquire
+ *    osWaitFor
  *
  *  Description:
- *    Tries to acquire the signal.
+ *    Switches the task into a wait state until the specified signal is in
+ *    the signaled state or the specified timeout interval elapses.
  *
  *  Parameters:
- *    Signal - Pointer to the signal descriptor.
- *    OnCheck - If TRUE, the task will not acquire the signal when it has
- *      the "decrement on release" flag set and the task priority is lower
- *      or equal to the priority of the signal. This queues signal acquire
- *      requests.
+ *    Signal - Pointer to signal descriptor.
+ *    Timeout - Timeout value.
  *
  *  Return:
- *    TRUE if object was acquired, otherwise FALSE.
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-static BOOL osAcquire(struct TSignal FAR *Signal, BOOL OnCheck)
+BOOL osWaitFor(struct TSignal FAR *Signal, TIME Timeout)
 {
-  struct TWaitAssoc FAR *WaitAssoc;
+  /* Prepare association descriptor */
+  osCurrentTask->WaitingFor[0].Signal = Signal;
+  osCurrentTask->WaitingFor[0].Task = osCurrentTask;
 
+  /* Number of objects that the task is waiting for */
   #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    INDEX i;
-  #endif
-
-  #if (OS_USE_CSEC_OBJECTS)
-    struct TCSAssoc FAR *CSAssoc;
-  #endif
-
-  /* Check signalization state */
-  #if (OS_USE_SYSTEM_IO_CTRL)
-    if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
-    {
-      if(!Signal->Object->DeviceIOCtrl(Signal->Object,
-        OS_IO_CTL_GET_SIGNAL_STATE, NULL, 0, NULL))
-        return FALSE;
-    }
-    else
+    osCurrentTask->WaitingCount = 1;
   #endif
 
-  if(!Signal->Signaled)
-  {
-    /* Mutexes are always signaled for owning task */
-    #if (OS_USE_CSEC_OBJECTS)
-      if(Signal->Flags & OS_SIGNAL_FLAG_MUTUAL_EXCLUSION)
-        if(Signal->CS->TasksInCS[0].Task == osCurrentTask)
-          return TRUE;
-    #endif
-
-    /* All other objects cannot be acquired when not signaled */
-    return FALSE;
-  }
-
-  /* Decrement signal counter when the "decrement on release" is set */
-  if(Signal->Flags & OS_SIGNAL_FLAG_DEC_ON_RELEASE)
-  {
-    /* Check signal priority */
-    if(OnCheck)
-    {
-      WaitAssoc = (struct TWaitAssoc FAR *)
-        stBSTreeGetFirst(&Signal->WaitingTasks);
-      if(WaitAssoc)
-        if(WaitAssoc->Task->Priority <= osCurrentTask->Priority)
-          return FALSE;
-    }
-
-    /* Decrement signal state */
-    Signal->Signaled--;
-    osSignalUpdated(Signal);
-  }
-
-  /* Define association between the task and a critical section */
-  #if (OS_USE_CSEC_OBJECTS)
-    if(Signal->Flags & OS_SIGNAL_FLAG_CRITICAL_SECTION)
-    {
-      /* Try to find existing association */
-      CSAssoc = osFindCSAssoc(Signal->CS, osCurrentTask);
-      if(CSAssoc)
-        CSAssoc->Count++;
-
-      /* Define new association */
-      else
-      {
-        CSAssoc = osCSAssocAlloc(Signal->CS);
-        CSAssoc->CS = Signal->CS;
-        CSAssoc->Task = osCurrentTask;
-        CSAssoc->Count = 1;
-
-        /* Assign association to task */
-        stPQueueInsert(&osCurrentTask->OwnedCS, &CSAssoc->Item, CSAssoc);
-        stBSTreeInsert(&osCurrentTask->OwnedCSPtr, &CSAssoc->Node, NULL,
-          CSAssoc);
-      }
+  /* Start waiting for specified object */
+  return osMakeWaiting(Timeout, NULL);
+}
 
-      /* Is the "abandon flag" set? */
-      if(Signal->Flags & OS_SIGNAL_FLAG_ABANDONED)
-      {
-        Signal->Flags &= (UINT8) ~OS_SIGNAL_FLAG_ABANDONED;
-        osCurrentTask->WaitExitCode = ERR_WAIT_ABANDONED;
-      }
-    }
-  #endif
 
-  /* Notify object acquiring */
-  #if (OS_USE_SYSTEM_IO_CTRL)
-    if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
-      Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_ACQUIRE,
-        NULL, 0, NULL);
-  #endif
+/***************************************************************************/
+#endif /* OS_USE_MULTIPLE_SIGNALS */
+/***************************************************************************/
 
-  /* Return with success */
-  return TRUE;
-}
+
+/***************************************************************************/
+#if (OS_USE_CONDVAR)
+/***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osMakeNotWaiting
+ *    osWaitForAndReleaseCS
  *
  *  Description:
- *    Exits from the wait state.
+ *    Releases the critical section owned by the current task and switches
+ *    the task into a wait state until the specified signal is in the
+ *    signaled state or the specified timeout interval elapses. The task is
+ *    queued before the critical section is released, so no signal sent
+ *    after releasing can be lost. The critical section is not released
+ *    when the function fails before the task starts to wait.
  *
  *  Parameters:
- *    Task - Pointer to task that should exit from the wait state.
+ *    Signal - Pointer to signal descriptor.
+ *    CS - Pointer to critical section descriptor.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-void osMakeNotWaiting(struct TTask FAR *Task)
+BOOL osWaitForAndReleaseCS(struct TSignal FAR *Signal,
+  struct TCriticalSection FAR *CS, TIME Timeout)
 {
-  struct TWaitAssoc FAR *WaitAssoc;
-  struct TSignal FAR *Signal;
+  BOOL PrevLockState, Owned;
 
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    INDEX i;
+  /* Check the ownership of the critical section */
+  PrevLockState = arLock();
+  Owned = (BOOL) (osFindCSAssoc(CS, osCurrentTask) != NULL);
+  #if (OS_MUTEX_FAST_PATH)
+    if(CS->FastOwner == osCurrentTask)
+      Owned = TRUE;
   #endif
+  arRestore(PrevLockState);
 
-  /* Remove waiting flags */
-  Task->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_WAITING;
+  /* Fail if the critical section is not owned */
+  if(!Owned)
+  {
+    osSetLastError(ERR_OBJECT_CAN_NOT_BE_RELEASED);
+    return FALSE;
+  }
 
-  /* Remove task from waiting queue of each signal */
+  /* Prepare association descriptor */
+  osCurrentTask->WaitingFor[0].Signal = Signal;
+  osCurrentTask->WaitingFor[0].Task = osCurrentTask;
+
+  /* Number of objects that the task is waiting for */
   #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    for(i = 0; i < Task->WaitingCount; i++)
-    {
-      WaitAssoc = &Task->WaitingFor[i];
-  #else
-      WaitAssoc = &Task->WaitingFor[0];
+    osCurrentTask->WaitingCount = 1;
   #endif
 
-      Signal = WaitAssoc->Signal;
-      stBSTreeRemove(&Signal->WaitingTasks, &WaitAssoc->Node);
-      osSignalUpdated(Signal);
+  /* Start waiting for specified object */
+  return osMakeWaiting(Timeout, CS);
+}
 
-      /* [!] TODO: Unregister timer by OS_IO_CTL_WAIT_UPDATE... */
 
-      /* Update priority path */
-      #if (OS_USE_CSEC_OBJECTS)
-        if(Signal->CS)
-          osPriorityPath(&Signal->CS->PriorityPath);
-      #endif
+/***************************************************************************/
+#endif /* OS_USE_CONDVAR */
+/***************************************************************************/
 
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    }
-  #endif
-}
+
+/***************************************************************************/
+#if ((OS_USE_CONDVAR) || (OS_WAIT_FOR_FLAGS_FUNC))
+/***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osMakeWaiting
+ *    osWakeWaitingTask
  *
  *  Description:
- *    Makes the current task wait for specified signals. The task will
- *    wait until the signal is in the signaled state or the specified
- *    timeout elapses. To exit from the wait state, osMakeNotWaiting must
- *    be called.
+ *    Releases the task waiting for a signal without changing the
+ *    signalization state and without rescheduling. Must be called with
+ *    interrupts disabled.
  *
  *  Parameters:
- *    Timeout - Timeout value in time units.
- *
- *  Return:
- *    TRUE on success or FALSE on failure.
+ *    WaitAssoc - Pointer to the wait association of the task.
  *
  ***************************************************************************/
 
-static BOOL osMakeWaiting(TIME Timeout)
+void osWakeWaitingTask(struct TWaitAssoc FAR *WaitAssoc)
 {
-  BOOL PrevLockState;
-  struct TWaitAssoc FAR *WaitAssoc;
-  struct TSignal FAR *Signal;
+  struct TTask FAR *Task;
 
+  /* Exit from the wait state */
+  Task = WaitAssoc->Task;
   #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    INDEX i;
+    Task->WaitingIndex = WaitAssoc->Index;
   #endif
+  osMakeNotWaiting(Task);
 
-  /* Check timeout value */
-  #if !(OS_USE_TIME_OBJECTS)
-    if((Timeout != OS_IGNORE) && (Timeout != OS_INFINITE))
-    {
-      osSetLastError(ERR_INVALID_PARAMETER);
-      return FALSE;
-    }
-  #endif
+  /* Make task ready */
+  if(!(Task->Object.Flags & OS_OBJECT_FLAG_READY_TO_RUN) &&
+    !Task->BlockingFlags)
+  {
+    Task->Object.Flags |= OS_OBJECT_FLAG_READY_TO_RUN;
+    osReadyQueueInsert(Task);
 
-  /* Obtain pointers of descriptors */
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) == 1)
-    WaitAssoc = &osCurrentTask->WaitingFor[0];
-    Signal = WaitAssoc->Signal;
-  #endif
+    #if (OS_USE_LATENCY_HISTOGRAM)
+      Task->ReadyCycles = OS_GET_CYCLE_COUNT();
+      Task->ReadyPending = TRUE;
+    #endif
 
-  /* Enter critical section */
-  PrevLockState = arLock();
+    #if (OS_USE_TIME_QUANTA)
+      Task->TimeQuantumCounter = Task->MaxTimeQuantum;
+    #endif
+  }
+}
 
-  /* [!] NOTE: Will be cleared already */
-  osCurrentTask->WaitExitCode = ERR_NO_ERROR;
 
-  /* Check object signalization */
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    for(i = 0; i < osCurrentTask->WaitingCount; i++)
-      if(osAcquire(osCurrentTask->WaitingFor[i].Signal, TRUE))
-      {
-        arRestore(PrevLockState);
-        osCurrentTask->WaitingIndex = i;
+/****************************************************************************
+ *
+ *  Name:
+ *    osWakeWaitingTasks
+ *
+ *  Description:
+ *    Releases the highest priority task or all tasks waiting for the
+ *    specified signal without changing its signalization state. The
+ *    scheduler is called once, after all tasks are released, so a task
+ *    released by this call cannot wait again and be released twice.
+ *
+ *  Parameters:
+ *    Signal - Pointer to signal descriptor.
+ *    All - TRUE to release all waiting tasks, FALSE to release only the
+ *      first one.
+ *
+ ***************************************************************************/
 
-        /* Return with error on acquiring abandoned critical section */
-        #if (OS_USE_CSEC_OBJECTS)
-          if(osCurrentTask->WaitExitCode)
-          {
-            osSetLastError(osCurrentTask->WaitExitCode);
-            return FALSE;
-          }
-        #endif
+void osWakeWaitingTasks(struct TSignal FAR *Signal, BOOL All)
+{
+  struct TWaitAssoc FAR *WaitAssoc;
+  BOOL PrevLockState;
 
-        return TRUE;
-      }
-  #else
-    if(osAcquire(Signal, TRUE))
-    {
-      arRestore(PrevLockState);
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-      /* Return with error on acquiring abandoned critical section */
-      #if (OS_USE_CSEC_OBJECTS)
-        if(osCurrentTask->WaitExitCode)
-        {
-          osSetLastError(osCurrentTask->WaitExitCode);
-          return FALSE;
-        }
-      #endif
+  /* Release waiting tasks in the order of their priorities */
+  while(TRUE)
+  {
+    WaitAssoc = (struct TWaitAssoc FAR *)
+      stBSTreeGetFirst(&Signal->WaitingTasks);
+    if(!WaitAssoc)
+      break;
 
-      return TRUE;
-    }
-  #endif
+    /* Exit from the wait state (without rescheduling) */
+    osWakeWaitingTask(WaitAssoc);
 
-  /* Return immediately if timeout value is set to OS_IGNORE (or 0) */
-  if(Timeout == OS_IGNORE)
-  {
-    arRestore(PrevLockState);
-    osSetLastError(ERR_WAIT_TIMEOUT);
-    return FALSE;
+    if(!All)
+      break;
   }
 
-  /* Set the waiting flag (interrupts are disabled, so code will be
-     continued uninterrupted) */
-  osCurrentTask->BlockingFlags |= OS_BLOCK_FLAG_WAITING;
-
-  /* Append waiting tasks to waiting queue of specified signals */
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    for(i = 0; i < osCurrentTask->WaitingCount; i++)
-    {
-      WaitAssoc = &osCurrentTask->WaitingFor[i];
-      Signal = WaitAssoc->Signal;
+  /* Reschedule if some released task has higher priority */
+  if(osCurrentTask)
+    osRescheduleIfHigherPriority();
 
-      stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node, NULL,
-        WaitAssoc);
-      osSignalUpdated(Signal);
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
 
-      #if (OS_USE_SYSTEM_IO_CTRL)
-        if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
-          Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_START,
-            NULL, 0, NULL);
-      #endif
-    }
-  #else
-    stBSTreeInsert(&Signal->WaitingTasks, &WaitAssoc->Node, NULL, WaitAssoc);
-    osSignalUpdated(Signal);
 
-    #if (OS_USE_SYSTEM_IO_CTRL)
-      if(Signal->Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
-        Signal->Object->DeviceIOCtrl(Signal->Object, OS_IO_CTL_WAIT_START,
-          NULL, 0, NULL);
-    #endif
-  #endif
+/***************************************************************************/
+#endif /* OS_USE_CONDVAR || OS_WAIT_FOR_FLAGS_FUNC */
+/***************************************************************************/
 
-  /* Set the timeout */
-  #if (OS_USE_TIME_OBJECTS)
-    if(Timeout != OS_INFINITE)
-    {
-      TIME CurrentTime;
-      CurrentTime = arGetTickCount();
 
-      /* Control time overflow */
-      Timeout = ((OS_INFINITE - CurrentTime) <= Timeout) ?
-        OS_INFINITE : (CurrentTime + Timeout);
+/***************************************************************************/
+#if (OS_USE_WAIT_SET)
+/***************************************************************************/
 
-      osRegisterTimeNotify(&osCurrentTask->WaitTimeout, Timeout);
-    }
-  #endif
 
-  /* Update priority path for waiting task */
-  #if (OS_USE_CSEC_OBJECTS)
-    if(!osPriorityPath(&osCurrentTask->PriorityPath))
-    {
-      /* Exit wait state when deadlock occurs */
-      osMakeNotWaiting(osCurrentTask);
-      arRestore(PrevLockState);
-      osSetLastError(ERR_WAIT_DEADLOCK);
-      return FALSE;
-    }
-  #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osWatchNotify
+ *
+ *  Description:
+ *    Appends the watches of the specified signal to the ready lists of
+ *    their wait sets and signals the wait sets. Called when the signal is
+ *    in the signaled state. Must be called with interrupts disabled.
+ *
+ *  Parameters:
+ *    Signal - Pointer to signal descriptor.
+ *
+ *  Return:
+ *    Pointer to the highest priority task waiting for one of the signaled
+ *    wait sets or NULL when no task is waiting.
+ *
+ ***************************************************************************/
 
-  /* Begin waiting and reschedule. This function will return when one of the
-     signals is in the signaled state or specified timeout interval
-     elapses. */
-  /* [!] NOTE: already cleared above */
-  osCurrentTask->WaitExitCode = ERR_NO_ERROR;
-  osMakeNotReady(osCurrentTask);
+static struct TTask FAR *osWatchNotify(struct TSignal FAR *Signal)
+{
+  struct TWatch FAR *Watch;
+  struct TWaitSet FAR *WaitSet;
+  struct TTask FAR *Task;
+  struct TTask FAR *FirstTask;
 
-  /* Leave critical section */
-  arRestore(PrevLockState);
+  FirstTask = NULL;
+  for(Watch = Signal->Watches; Watch; Watch = Watch->NextWatch)
+  {
+    /* Skip watches which are already in the ready list */
+    if(Watch->Ready)
+      continue;
+
+    /* Append to the ready list of the wait set */
+    WaitSet = Watch->WaitSet;
+    Watch->Ready = TRUE;
+    Watch->NextReady = NULL;
+    if(WaitSet->LastReady)
+      WaitSet->LastReady->NextReady = Watch;
+    else
+      WaitSet->FirstReady = Watch;
+    WaitSet->LastReady = Watch;
 
-  /* Set the last error code when error occurs */
-  /* [!] ISSUE: Remove ifdefs? */
-  #if ((OS_USE_WAITING_WITH_TIME_OUT) || (OS_USE_CSEC_OBJECTS) || \
-    (OS_USE_IPC_DIRECT_RW))
-    if(osCurrentTask->WaitExitCode != ERR_NO_ERROR)
+    /* Signal the wait set */
+    if(!WaitSet->Signal->Signaled)
     {
-      osSetLastError(osCurrentTask->WaitExitCode);
-      return FALSE;
+      WaitSet->Signal->Signaled = (INDEX) TRUE;
+      Task = osSignalUpdated(WaitSet->Signal);
+      if(Task)
+        if(!FirstTask || (Task->Priority < FirstTask->Priority))
+          FirstTask = Task;
     }
-  #endif
+  }
 
-  /* Return with success */
-  return TRUE;
+  return FirstTask;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osUpdateSignalState
+ *    osWatchSignal
  *
  *  Description:
- *    Changes object signalization state.
+ *    Starts watching the specified signal by the wait set. The watch is
+ *    put in the ready list of the wait set each time the signal becomes
+ *    signaled, without any task waiting for the signal.
  *
  *  Parameters:
+ *    WaitSet - Pointer to wait set descriptor.
+ *    Watch - Pointer to watch descriptor.
  *    Signal - Pointer to signal descriptor.
- *    Signaled - New signal value.
  *
  ***************************************************************************/
 
-void osUpdateSignalState(struct TSignal FAR *Signal, INDEX Signaled)
+void osWatchSignal(struct TWaitSet FAR *WaitSet, struct TWatch FAR *Watch,
+  struct TSignal FAR *Signal)
 {
-  BOOL PrevLockState, NeedUpdate;
-  struct TTask FAR *Task;
+  BOOL PrevLockState;
+
+  /* Prepare watch descriptor */
+  Watch->Signal = Signal;
+  Watch->WaitSet = WaitSet;
+  Watch->Ready = FALSE;
 
   /* Enter critical section */
   PrevLockState = arLock();
 
-  /* Is signal updating mandatory? */
-  NeedUpdate = ((BOOL) (Signal->Signaled > 0)) ^ ((BOOL) (Signaled > 0));
-
-  /* Change signalization state */
-  Signal->Signaled = Signaled;
+  /* Register the owner of a critical section acquired by the fast path,
+     as its fast release does not update the signal */
+  #if (OS_MUTEX_FAST_PATH)
+    if(Signal->CS)
+      if(Signal->CS->FastOwner)
+        osInflateCS(Signal->CS);
+  #endif
 
-  /* Update signal when it is mandatory */
-  /* [!] CHECK: It is ok here before calling osSignalUpdated - verify
-     elsewhere! */
-  if(NeedUpdate)
-  {
-    Task = osSignalUpdated(Signal);
+  /* Add watch to the list of the signal */
+  Watch->NextWatch = Signal->Watches;
+  Signal->Watches = Watch;
+  Signal->Flags |= OS_SIGNAL_FLAG_WATCHED;
 
-    /* When signal is in the signaled state and priority of task waiting for
-       signal is higher than priority of the current task, reschedule
-       immediately */
-    if(Signaled && Task)
-      if(Task->Priority < osCurrentTask->Priority)
-        osYield();
-  }
+  /* Signal may be already signaled */
+  if(Signal->Signaled)
+    osWatchNotify(Signal);
 
   /* Leave critical section */
   arRestore(PrevLockState);
 }
 
 
-/***************************************************************************/
-#if (OS_USE_CSEC_OBJECTS)
-/***************************************************************************/
-
-
 /****************************************************************************
  *
  *  Name:
- *    osReleaseCS
+ *    osUnwatchSignal
  *
  *  Description:
- *    Releases a specified critical section.
+ *    Stops watching the signal. The watch is removed from the list of the
+ *    signal and from the ready list of its wait set.
  *
  *  Parameters:
- *    CS - Pointer to critical section descriptor.
- *    Task - Pointer to task descriptor.
- *    ReleaseCount - The value which will be added to critical section
- *      counter. If it is too large, the critical section will not be
- *      released and an error occurs. Must be greater than zero.
- *    PrevCount - Pointer to variable that receives the counter value
- *      before releasing (may be NULL if not expected).
- *
- *  Return:
- *    TRUE on success or FALSE on failure.
+ *    Watch - Pointer to watch descriptor.
  *
  ***************************************************************************/
 
-BOOL osReleaseCS(struct TCriticalSection FAR *CS, struct TTask FAR *Task,
-  INDEX ReleaseCount, INDEX *PrevCount)
+void osUnwatchSignal(struct TWatch FAR *Watch)
 {
+  struct TWatch FAR * FAR *Link;
+  struct TWatch FAR *Prev;
+  struct TWaitSet FAR *WaitSet;
+  struct TSignal FAR *Signal;
   BOOL PrevLockState;
-  struct TCSAssoc FAR *CSAssoc;
 
-  /* Operation can be performed only by a task */
-  if(!osCurrentTask || osInISR)
-  {
-    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
-    return FALSE;
-  }
-
-  /* Enter critical section (disable interrupts) */
+  /* Enter critical section */
   PrevLockState = arLock();
 
-  /* Fail if ReleaseCount is incorrect */
-  CSAssoc = osFindCSAssoc(CS, Task);
-  if(CSAssoc)
-    if(ReleaseCount > CSAssoc->Count)
-      CSAssoc = NULL;
-
-  /* Fail if association is not defined */
-  if(!CSAssoc)
-  {
-    arRestore(PrevLockState);
-    osSetLastError(ERR_OBJECT_CAN_NOT_BE_RELEASED);
-    return FALSE;
-  }
-
-  /* Subtract the ReleaseCount from the counter value */
-  CSAssoc->Count -= ReleaseCount;
-
-  /* Remove association when counter is zero */
-  if(!CSAssoc->Count)
+  /* Remove from the list of the signal */
+  Signal = Watch->Signal;
+  Link = &Signal->Watches;
+  while(*Link != Watch)
+    Link = &(*Link)->NextWatch;
+  *Link = Watch->NextWatch;
+  if(!Signal->Watches)
+    Signal->Flags &= (UINT8) ~OS_SIGNAL_FLAG_WATCHED;
+
+  /* Remove from the ready list. The wait set signal stays signaled, it is
+     updated by the next wait. */
+  if(Watch->Ready)
   {
-    stPQueueRemove(&Task->OwnedCS, &CSAssoc->Item);
-    stBSTreeRemove(&Task->OwnedCSPtr, &CSAssoc->Node);
-    osCSAssocFree(CS, CSAssoc);
-
-    /* Update task priority. The task is not waiting for any signal, so
-       priority path is already valid. */
-    osChangeTaskPriority(Task, Task->AssignedPriority);
+    WaitSet = Watch->WaitSet;
+    Prev = NULL;
+    Link = &WaitSet->FirstReady;
+    while(*Link != Watch)
+    {
+      Prev = *Link;
+      Link = &Prev->NextReady;
+    }
+    *Link = Watch->NextReady;
+    if(WaitSet->LastReady == Watch)
+      WaitSet->LastReady = Prev;
+    Watch->Ready = FALSE;
   }
 
-  /* Save previous counter value */
-  if(PrevCount)
-    *PrevCount = CS->Signal->Signaled;
-
-  /* Release critical section */
-  osUpdateSignalState(CS->Signal, CS->Signal->Signaled + ReleaseCount);
+  /* Watch is not used */
+  Watch->Signal = NULL;
 
-  /* Leave critical section (restore interrupts) */
+  /* Leave critical section */
   arRestore(PrevLockState);
-  return TRUE;
 }
 
 
-/***************************************************************************/
-#endif /* OS_USE_CSEC_OBJECTS */
-/***************************************************************************/
-
-
-/***************************************************************************/
-#if (OS_USE_MULTIPLE_SIGNALS)
-/***************************************************************************/
-
-
 /****************************************************************************
  *
  *  Name:
- *    osWaitFor
+ *    osWaitForWatch
  *
  *  Description:
- *    Switches the task into a wait state until the specified signal is in
- *    the signaled state or the specified timeout interval elapses.
+ *    Acquires the signal of one of the watches in the ready list of the
+ *    wait set. When no signal can be acquired, the task waits for the wait
+ *    set until one of its watches becomes ready or the specified timeout
+ *    interval elapses. Only the wait set signal is waited for, so the
+ *    cost of waiting does not depend on the number of watched signals.
+ *    The watch of an acquired signal which is still signaled is moved to
+ *    the end of the ready list, so other signals are served in turn.
  *
  *  Parameters:
- *    Signal - Pointer to signal descriptor.
+ *    WaitSet - Pointer to wait set descriptor.
  *    Timeout - Timeout value.
+ *    Watch - Pointer to variable that receives the watch of the acquired
+ *      signal (set also when the acquired critical section was abandoned).
  *
  *  Return:
  *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-BOOL osWaitFor(struct TSignal FAR *Signal, TIME Timeout)
+BOOL osWaitForWatch(struct TWaitSet FAR *WaitSet, TIME Timeout,
+  struct TWatch FAR * FAR *Watch)
 {
-  /* Prepare association descriptor */
-  osCurrentTask->WaitingFor[0].Signal = Signal;
-  osCurrentTask->WaitingFor[0].Task = osCurrentTask;
+  struct TWatch FAR *ReadyWatch;
+  BOOL PrevLockState, Acquired;
 
-  /* Number of objects that the task is waiting for */
-  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
-    osCurrentTask->WaitingCount = 1;
+  #if (OS_USE_TIME_OBJECTS)
+    TIME CurrentTime, EndTime;
   #endif
 
-  /* Start waiting for specified object */
-  return osMakeWaiting(Timeout);
+  /* Time at which waiting ends */
+  #if (OS_USE_TIME_OBJECTS)
+    EndTime = OS_INFINITE;
+    if((Timeout != OS_IGNORE) && (Timeout != OS_INFINITE))
+    {
+      CurrentTime = arGetTickCount();
+      if((OS_INFINITE - CurrentTime) > Timeout)
+        EndTime = CurrentTime + Timeout;
+    }
+  #endif
+
+  while(TRUE)
+  {
+    /* Enter critical section */
+    PrevLockState = arLock();
+    osCurrentTask->WaitExitCode = ERR_NO_ERROR;
+
+    /* Take ready watches until one of the signals is acquired. A watch
+       whose signal cannot be acquired is dropped, it is appended again
+       when the signal is updated. */
+    ReadyWatch = NULL;
+    Acquired = FALSE;
+    while(!Acquired && WaitSet->FirstReady)
+    {
+      ReadyWatch = WaitSet->FirstReady;
+      WaitSet->FirstReady = ReadyWatch->NextReady;
+      if(!WaitSet->FirstReady)
+        WaitSet->LastReady = NULL;
+      ReadyWatch->Ready = FALSE;
+
+      Acquired = osAcquire(ReadyWatch->Signal, TRUE);
+    }
+
+    /* Signal still signaled after acquiring stays ready */
+    if(Acquired && ReadyWatch->Signal->Signaled && !ReadyWatch->Ready)
+      osWatchNotify(ReadyWatch->Signal);
+
+    /* Clear the wait set signal when no watch is ready */
+    if(!WaitSet->FirstReady && WaitSet->Signal->Signaled)
+    {
+      WaitSet->Signal->Signaled = 0;
+      osSignalUpdated(WaitSet->Signal);
+    }
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+
+    /* Return the watch of the acquired signal */
+    if(Acquired)
+    {
+      *Watch = ReadyWatch;
+
+      /* Return with error on acquiring abandoned critical section */
+      #if (OS_USE_CSEC_OBJECTS)
+        if(osCurrentTask->WaitExitCode)
+        {
+          osSetLastError(osCurrentTask->WaitExitCode);
+          return FALSE;
+        }
+      #endif
+
+      return TRUE;
+    }
+
+    /* Remaining timeout */
+    #if (OS_USE_TIME_OBJECTS)
+      if(EndTime != OS_INFINITE)
+      {
+        CurrentTime = arGetTickCount();
+        Timeout = (CurrentTime < EndTime) ? (EndTime - CurrentTime) :
+          OS_IGNORE;
+      }
+    #endif
+
+    /* Wait until one of the watches becomes ready */
+    osCurrentTask->WaitingFor[0].Signal = WaitSet->Signal;
+    osCurrentTask->WaitingFor[0].Task = osCurrentTask;
+
+    #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+      osCurrentTask->WaitingCount = 1;
+    #endif
+
+    if(!osMakeWaiting(Timeout, NULL))
+      return FALSE;
+  }
 }
 
 
 /***************************************************************************/
-#endif /* OS_USE_MULTIPLE_SIGNALS */
+#endif /* OS_USE_WAIT_SET */
 /***************************************************************************/
 
 
@@ -3236,6 +5890,13 @@ BOOL osWaitForObject(HANDLE Handle, TIME Timeout)
   if(!Object)
     return FALSE;
 
+  /* Acquire uncontended mutex without entering the wait state */
+  #if (OS_MUTEX_FAST_PATH)
+    if(Object->Type == OS_OBJECT_TYPE_MUTEX)
+      if(osMutexFastAcquire(Object))
+        return TRUE;
+  #endif
+
   /* Prepare association descriptor */
   osCurrentTask->WaitingFor[0].Signal = &Object->Signal;
   osCurrentTask->WaitingFor[0].Task = osCurrentTask;
@@ -3246,7 +5907,7 @@ BOOL osWaitForObject(HANDLE Handle, TIME Timeout)
   #endif
 
   /* Start waiting for specified object */
-  return osMakeWaiting(Timeout);
+  return osMakeWaiting(Timeout, NULL);
 }
 
 
@@ -3279,11 +5940,48 @@ BOOL osWaitForObject(HANDLE Handle, TIME Timeout)
 BOOL osWaitForObjects(HANDLE *Handles, INDEX Count, TIME Timeout,
   INDEX *ObjectIndex)
 {
-  INDEX i;
+  return osWaitForObjectsEx(Handles, Count, FALSE, Timeout, ObjectIndex);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitForObjectsEx
+ *
+ *  Description:
+ *    Switches task into wait state until at least one or all of the
+ *    specified objects are in the signaled state or the specified timeout
+ *    interval elapses. When waiting for all objects, they are acquired at
+ *    once, only when each of them can be acquired; the task does not hold
+ *    any of them while waiting for the others.
+ *
+ *  Parameters:
+ *    Handles - Array of object handles.
+ *    Count - Number of handles in array.
+ *    WaitAll - TRUE to wait for all objects, FALSE to wait for any of them.
+ *      The same object cannot be specified twice when waiting for all.
+ *    Timeout - Timeout value.
+ *    ObjectIndex - Pointer to variable that will receive a reason index
+ *      (not changed when waiting for all objects).
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osWaitForObjectsEx(HANDLE *Handles, INDEX Count, BOOL WaitAll,
+  TIME Timeout, INDEX *ObjectIndex)
+{
+  INDEX i, j;
   BOOL Success;
   struct TSysObject FAR *Object;
   struct TWaitAssoc FAR *WaitAssoc;
 
+  #if (OS_USE_TIME_OBJECTS)
+    TIME CurrentTime, EndTime;
+  #endif
+
   /* Check parameters */
   if((Count <= 0) || (Count > OS_MAX_WAIT_FOR_OBJECTS))
   {
@@ -3306,6 +6004,15 @@ BOOL osWaitForObjects(HANDLE *Handles, INDEX Count, TIME Timeout,
     if(!Object)
       return FALSE;
 
+    /* Each object can be acquired only once when waiting for all */
+    if(WaitAll)
+      for(j = 0; j < i; j++)
+        if(osCurrentTask->WaitingFor[j].Signal == &Object->Signal)
+        {
+          osSetLastError(ERR_INVALID_PARAMETER);
+          return FALSE;
+        }
+
     /* Prepare association descriptor */
     WaitAssoc = &osCurrentTask->WaitingFor[i];
     WaitAssoc->Signal = &Object->Signal;
@@ -3316,14 +6023,56 @@ BOOL osWaitForObjects(HANDLE *Handles, INDEX Count, TIME Timeout,
   /* Number of objects that the task is waiting for */
   osCurrentTask->WaitingCount = Count;
 
-  /* Start waiting for specified objects */
-  Success = osMakeWaiting(Timeout);
+  /* Start waiting for any of the specified objects */
+  if(!WaitAll)
+  {
+    Success = osMakeWaiting(Timeout, NULL);
+
+    /* Set the index of the object that caused osMakeWaiting function
+       exit */
+    if(Success && ObjectIndex)
+      *ObjectIndex = osCurrentTask->WaitingIndex;
+
+    /* Return completion status */
+    return Success;
+  }
+
+  /* Time at which waiting ends */
+  #if (OS_USE_TIME_OBJECTS)
+    EndTime = OS_INFINITE;
+    if((Timeout != OS_IGNORE) && (Timeout != OS_INFINITE))
+    {
+      CurrentTime = arGetTickCount();
+      if((OS_INFINITE - CurrentTime) > Timeout)
+        EndTime = CurrentTime + Timeout;
+    }
+  #endif
+
+  /* Wait until all objects are acquired. The task is released by any of
+     the objects it waits for, then all of them are checked again. */
+  osCurrentTask->WaitAll = TRUE;
+  while(TRUE)
+  {
+    Success = osMakeWaiting(Timeout, NULL);
+    if(!Success || !osCurrentTask->WaitAll)
+      break;
 
-  /* Set the index of the object that caused osMakeWaiting function exit */
-  if(Success && ObjectIndex)
-    *ObjectIndex = osCurrentTask->WaitingIndex;
+    /* Wait again for all objects (only some were waited for) */
+    osCurrentTask->WaitingCount = Count;
+
+    /* Remaining timeout */
+    #if (OS_USE_TIME_OBJECTS)
+      if(EndTime != OS_INFINITE)
+      {
+        CurrentTime = arGetTickCount();
+        Timeout = (CurrentTime < EndTime) ? (EndTime - CurrentTime) :
+          OS_IGNORE;
+      }
+    #endif
+  }
 
   /* Return completion status */
+  osCurrentTask->WaitAll = FALSE;
   return Success;
 }
 
@@ -3462,17 +6211,84 @@ BOOL osWrite(HANDLE Handle, PVOID Buffer, SIZE Size,
 
 
 /***************************************************************************/
-#endif /* OS_READ_WRITE_FUNC */
+#endif /* OS_READ_WRITE_FUNC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  General system management
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_USE_TICKLESS)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osTicklessIdle
+ *
+ *  Description:
+ *    Suspends the periodic system tick until the earliest time notification
+ *    when the idle task is the only task ready to run.
+ *
+ *  Return:
+ *    TRUE if the CPU was in tickless mode or FALSE if it was not possible.
+ *
+ ***************************************************************************/
+
+static BOOL osTicklessIdle(void)
+{
+  BOOL PrevLockState, Result;
+  TIME Ticks;
+
+  #if (OS_USE_TIME_OBJECTS)
+    TIME CurrentTime, NextTime;
+  #endif
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Other task is ready to run or signalization is pending */
+  Result = FALSE;
+  if((osReadyQueueGet() == osCurrentTask) &&
+    !stBSTreeGetFirst(&osDeferredSignal))
+  {
+    /* Number of ticks to the earliest time notification */
+    Ticks = OS_INFINITE;
+    #if (OS_USE_TIME_OBJECTS)
+      NextTime = osGetNextTimeNotify();
+      if(NextTime != OS_INFINITE)
+      {
+        CurrentTime = arGetTickCount();
+        Ticks = (NextTime > CurrentTime) ?
+          (TIME) (NextTime - CurrentTime) : OS_IGNORE;
+      }
+    #endif
+
+    /* Sleep until the deadline, unless it has already passed */
+    if(Ticks != OS_IGNORE)
+    {
+      arTicklessIdle(Ticks);
+      Result = TRUE;
+    }
+  }
+
+  /* Leave critical section (wakeup interrupt executes the scheduler) */
+  arRestore(PrevLockState);
+  return Result;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_TICKLESS */
 /***************************************************************************/
 
 
-/****************************************************************************
- *
- *  General system management
- *
- ***************************************************************************/
-
-
 /****************************************************************************
  *
  *  Name:
@@ -3481,7 +6297,8 @@ BOOL osWrite(HANDLE Handle, PVOID Buffer, SIZE Size,
  *  Description:
  *    System idle task. The task runs whenever the CPU is not used by other
  *    tasks. It allows switching the CPU to power-save mode, which resumes
- *    the CPU on every interrupt.
+ *    the CPU on every interrupt. In tickless mode the periodic tick is
+ *    also stopped until the next time notification.
  *
  ***************************************************************************/
 
@@ -3489,7 +6306,14 @@ static void CALLBACK osIdleTaskProc(void)
 {
   /* Call arSavePower function to reduce power consumption */
   while(1)
+  {
+    #if (OS_USE_TICKLESS)
+      if(osTicklessIdle())
+        continue;
+    #endif
+
     arSavePower();
+  }
 }
 
 
@@ -3508,7 +6332,7 @@ static void CALLBACK osIdleTaskProc(void)
 
 BOOL osInit(void)
 {
-  #if (OS_USE_TIME_OBJECTS)
+  #if ((OS_USE_TIME_OBJECTS) || (OS_USE_READY_BITMAP) || (OS_USE_SLAB))
     int i;
   #endif
 
@@ -3550,9 +6374,29 @@ BOOL osInit(void)
       return FALSE;
   #endif
 
+  /* Size classes have no slabs */
+  #if (OS_USE_SLAB)
+    for(i = 0; i < (int) (OS_SLAB_CLASS_COUNT); i++)
+    {
+      osSlabs[i] = NULL;
+      osFreeSlabs[i] = NULL;
+    }
+  #endif
+
   /* Last error code set to no error */
   osLastErrorCode = ERR_NO_ERROR;
 
+  /* Initialize kernel event trace */
+  #if (OS_USE_TRACE)
+    osInitTrace();
+  #endif
+
+  /* No critical section is profiled yet */
+  #if (OS_USE_LOCK_PROFILER)
+    osFirstLockCS = NULL;
+    osFirstLockCursor = NULL;
+  #endif
+
   /* Not in the ISR */
   osInISR = FALSE;
 
@@ -3563,7 +6407,22 @@ BOOL osInit(void)
   #endif
 
   /* Initialize time notification */
-  #if (OS_USE_TIME_OBJECTS)
+  #if ((OS_USE_TIME_OBJECTS) && (OS_USE_TIME_WHEEL))
+    osTimeWheelTime = arGetTickCount();
+
+    for(i = 0; i < OS_TIME_WHEEL_LEVELS; i++)
+    {
+      stMemSet(osTimeWheel[i], 0x00, sizeof(osTimeWheel[i]));
+      osTimeWheelMap[i] = 0;
+    }
+
+    for(i = 0; i < OS_TIME_DUE_LEVEL_COUNT; i++)
+      osTimeNotifyDue[i] = NULL;
+
+    for(i = 0; i < OS_TIME_DUE_WORD_COUNT; i++)
+      osTimeDueMap[i] = 0;
+    osTimeDueGroup = 0;
+  #elif (OS_USE_TIME_OBJECTS)
     stPQueueInit(&osTimeNotifyQueue, osTimeNotifyCmp);
 
     for(i = 1; i < OS_PRIORITY_COUNT + OS_LOWEST_USED_PRIORITY + 2; i++)
@@ -3573,8 +6432,12 @@ BOOL osInit(void)
       osTimeNotify[i] = NULL;
   #endif
 
-  /* Initialize binary search tree for registered system object names */
-  #if (OS_USE_OBJECT_NAMES)
+  /* Initialize hash table or binary search tree for registered system
+     object names */
+  #if ((OS_USE_OBJECT_NAMES) && ((OS_NAME_HASH_SIZE) > 0UL))
+    stMemSet(osSysNameHash, 0x00, sizeof(osSysNameHash));
+    osSysNameCount = 0;
+  #elif (OS_USE_OBJECT_NAMES)
     stBSTreeInit(&osSysNames, osObjectByNameCmp);
   #endif
 
@@ -3582,7 +6445,15 @@ BOOL osInit(void)
   stBSTreeInit(&osDeferredSignal, osSignalCmp);
 
   /* Initialize ready to run task queue */
-  stPQueueInit(&osTaskPQueue, osRoundRobinTaskCmp);
+  #if (OS_USE_READY_BITMAP)
+    for(i = 0; i < OS_READY_LEVEL_COUNT; i++)
+      osReadyHead[i] = NULL;
+    for(i = 0; i < OS_READY_WORD_COUNT; i++)
+      osReadyMap[i] = 0;
+    osReadyGroup = 0;
+  #else
+    stPQueueInit(&osTaskPQueue, osRoundRobinTaskCmp);
+  #endif
 
   /* Current task pointer (NULL means that operating system is stopped) */
   osCurrentTask = NULL;
@@ -3596,7 +6467,10 @@ BOOL osInit(void)
     osCPUUsageTime = OS_INFINITE;
     osCPUUsage = 0;
     osCPUCalcTime = arGetTickCount();
-    osCPUCalc = 0;
+    osCPUCalcCycles = OS_GET_CYCLE_COUNT();
+    osCPULastCycles = osCPUCalcCycles;
+    osInitCPUStat(&osISRStat);
+    osInitCPUStat(&osKernelStat);
   #endif
 
   /* Prepare idle task */
@@ -3624,8 +6498,7 @@ BOOL osInit(void)
   #endif
 
   #if (OS_USE_STATISTICS)
-    osIdleTask->CPUUsageTime = OS_INFINITE;
-    osIdleTask->CPUCalcTime = osCPUUsageTime;
+    osInitCPUStat(&osIdleTask->CPUStat);
   #endif
 
   /* Initialize system object deinitialization list */
@@ -3658,201 +6531,668 @@ BOOL osInit(void)
 
 
 /***************************************************************************/
-#if (OS_DEINIT_FUNC)
+#if (OS_DEINIT_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osDeinit
+ *
+ *  Description:
+ *    Deinitializes the operating system. Function may be executed only when
+ *    the operating system is not running. It removes all resources allocated
+ *    by the operating system (not by tasks) and calls the deinit IO function
+ *    for each object (if defined).
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osDeinit(void)
+{
+  struct TBSTreeNode FAR *Node;
+  struct TSysObject FAR *Object;
+  struct TTask FAR *Task;
+
+  #if (OS_USE_SLAB)
+    struct TSlab FAR *Slab;
+    int i;
+  #endif
+
+  /* Operating System cannot be running at deinitialization */
+  if(osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_OS_CAN_NOT_BE_RUNNING);
+    return FALSE;
+  }
+
+  /* Deinitialization of the system objects */
+  while(osFirstObject)
+  {
+    Object = osFirstObject;
+    osFirstObject = osFirstObject->NextObject;
+
+    /* Deleting object is a task */
+    if(Object->Type == OS_OBJECT_TYPE_TASK)
+    {
+      Task = (struct TTask FAR *) Object->ObjectDesc;
+
+      /* Release task children */
+      #if (!(OS_USE_FIXMEM_POOLS) && !(OS_INTERNAL_MEMORY_SIZE))
+        while(TRUE)
+        {
+          Node = (struct TBSTreeNode FAR *) Task->Childs.Min;
+          if(!Node)
+            break;
+
+          stBSTreeRemove(&Task->Childs, Node);
+          osMemFree(Node);
+        }
+      #endif
+
+      /* Release task context */
+      arReleaseTaskContext(&Task->TaskContext);
+    }
+
+    /* Call deinit IO */
+    #if (OS_USE_DEVICE_IO_CTRL)
+      if(Object->Flags & OS_OBJECT_FLAG_USES_IO_DEINIT)
+        Object->DeviceIOCtrl(Object, DEV_IO_CTL_DEINIT, NULL, 0, NULL);
+    #endif
+
+    /* Release system object descriptor */
+    #if (!(OS_USE_FIXMEM_POOLS) || ((OS_INTERNAL_MEMORY_SIZE) <= 0))
+      osMemFree(Object);
+    #endif
+  }
+
+  /* Release all slabs (with any blocks left in them) */
+  #if (OS_USE_SLAB)
+    for(i = 0; i < (int) (OS_SLAB_CLASS_COUNT); i++)
+    {
+      while(osSlabs[i])
+      {
+        Slab = osSlabs[i];
+        osSlabs[i] = Slab->Next;
+        stMemFree(Slab);
+      }
+      osFreeSlabs[i] = NULL;
+    }
+  #endif
+
+  /* Restore default clock handler */
+  return arSetPreemptiveHandler(NULL, 0);
+}
+
+
+/***************************************************************************/
+#endif /* OS_DEINIT_FUNC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStart
+ *
+ *  Description:
+ *    Starts the operating system execution. All tasks created before the
+ *    function call will be executed. The function will return with success
+ *    when osStop is called. Before calling osStart, osInit must be
+ *    executed.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osStart(void)
+{
+  /* Operating system is already running */
+  if(osCurrentTask)
+  {
+    osSetLastError(ERR_OS_ALREADY_RUNNING);
+    return FALSE;
+  }
+
+  /* Start operating system */
+  #if (OS_STOP_FUNC)
+    osRestoreCallerAndStop = FALSE;
+    osSaveCallerAndStart = TRUE;
+  #else
+    osCurrentTask = osReadyQueueGet();
+  #endif
+
+  /* Execute task scheduler to start operating system immediately */
+  osYield();
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#if (OS_STOP_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStop
+ *
+ *  Description:
+ *    Stops the operating system execution. It does not terminate any task
+ *    and does not release any system resources. This operation returns to
+ *    the osStart function execution point. osStart returns with TRUE
+ *    (successful operating system execution). To continue execution of
+ *    the operating system, call osStart again. To permanently exit and
+ *    release system resources (all created tasks and objects), use
+ *    osDeinit when the operating system is stopped.
+ *
+ ***************************************************************************/
+
+void osStop(void)
+{
+  /* Stop the operating system execution */
+  osSaveCallerAndStart = FALSE;
+  osRestoreCallerAndStop = TRUE;
+
+  /* Execute task scheduler to restore the caller */
+  osYield();
+}
+
+
+/***************************************************************************/
+#endif /* OS_STOP_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_GET_SYSTEM_STAT_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetSystemStat
+ *
+ *  Description:
+ *    Returns current CPU usage. This is the total CPU time minus the idle
+ *    task CPU usage during the last statistics period, both in
+ *    OS_CYCLES_PER_SECOND units. The percentage of CPU usage can be
+ *    calculated from the formula: 100 * CPUTime / TotalTime.
+ *
+ *  Parameters:
+ *    CPUTime - Pointer to variable that receives CPU usage.
+ *    TotalTime - Pointer to variable that receives total CPU time.
+ *
+ ***************************************************************************/
+
+void osGetSystemStat(INDEX *CPUTime, INDEX *TotalTime)
+{
+  BOOL PrevLockState;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Get system usage */
+  *TotalTime = (INDEX) osCPUUsage;
+  *CPUTime = (INDEX) (osCPUUsage - osGetCPUTime(&osIdleTask->CPUStat));
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetSystemStatEx
+ *
+ *  Description:
+ *    Returns CPU time of the last statistics period divided into the time
+ *    of tasks, the idle task, ISRs (between osEnterISR and osLeaveISR) and
+ *    the scheduler. Times are in OS_CYCLES_PER_SECOND units.
+ *
+ *  Parameters:
+ *    Stat - Pointer to structure that receives CPU times.
+ *
+ ***************************************************************************/
+
+void osGetSystemStatEx(struct TSystemStat *Stat)
+{
+  BOOL PrevLockState;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  Stat->TotalTime = (INDEX) osCPUUsage;
+  Stat->IdleTime = (INDEX) osGetCPUTime(&osIdleTask->CPUStat);
+  Stat->ISRTime = (INDEX) osGetCPUTime(&osISRStat);
+  Stat->KernelTime = (INDEX) osGetCPUTime(&osKernelStat);
+  Stat->TaskTime = (INDEX) (Stat->TotalTime - Stat->IdleTime -
+    Stat->ISRTime - Stat->KernelTime);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
+
+
+/***************************************************************************/
+#endif /* OS_GET_SYSTEM_STAT_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_USE_LATENCY_HISTOGRAM)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osDeinit
+ *    osLatencyRecord
  *
  *  Description:
- *    Deinitializes the operating system. Function may be executed only when
- *    the operating system is not running. It removes all resources allocated
- *    by the operating system (not by tasks) and calls the deinit IO function
- *    for each object (if defined).
+ *    Counts the latency in its logarithmic histogram bucket. Must be called
+ *    with interrupts disabled.
+ *
+ *  Parameters:
+ *    Histogram - Pointer to histogram buckets.
+ *    Cycles - Latency.
+ *
+ ***************************************************************************/
+
+static void osLatencyRecord(UINT32 FAR *Histogram, UINT32 Cycles)
+{
+  INDEX Bucket;
+
+  /* Bucket of the most significant bit, the last one for longer times */
+  Bucket = Cycles ? (INDEX) (31 - stCountLeadingZeros(Cycles)) : 0;
+  if(Bucket >= (OS_LATENCY_BUCKET_COUNT))
+    Bucket = (INDEX) ((OS_LATENCY_BUCKET_COUNT) - 1);
+
+  /* Counters saturate instead of wrapping around */
+  if(Histogram[Bucket] != 0xFFFFFFFFUL)
+    Histogram[Bucket]++;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetLatencyHistogram
+ *
+ *  Description:
+ *    Returns a latency histogram of OS_LATENCY_BUCKET_COUNT buckets. Bucket
+ *    i counts latencies from 2^i to 2^(i+1) - 1 cycles (bucket 0 also
+ *    counts zero latencies), the last bucket counts all longer ones.
+ *    Cycles are in OS_CYCLES_PER_SECOND units.
+ *
+ *  Parameters:
+ *    Handle - Object handle.
+ *    Kind - OS_LATENCY_WAIT for the time tasks spent waiting for the
+ *      object (a task waiting for many objects is counted by each of
+ *      them) or OS_LATENCY_READY for the time the task spent ready to run
+ *      after it was released, before it was given the CPU.
+ *    Buckets - Pointer to array that receives the histogram.
+ *    Reset - TRUE to clear the histogram after reading it.
  *
  *  Return:
  *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-BOOL osDeinit(void)
+BOOL osGetLatencyHistogram(HANDLE Handle, UINT8 Kind, UINT32 *Buckets,
+  BOOL Reset)
 {
-  struct TBSTreeNode FAR *Node;
   struct TSysObject FAR *Object;
-  struct TTask FAR *Task;
+  UINT32 FAR *Histogram;
+  BOOL PrevLockState;
+  INDEX i;
 
-  /* Operating System cannot be running at deinitialization */
-  if(osCurrentTask || osInISR)
+  /* Check parameters */
+  if(((Kind != OS_LATENCY_WAIT) && (Kind != OS_LATENCY_READY)) || !Buckets)
   {
-    osSetLastError(ERR_OS_CAN_NOT_BE_RUNNING);
+    osSetLastError(ERR_INVALID_PARAMETER);
     return FALSE;
   }
 
-  /* Deinitialization of the system objects */
-  while(osFirstObject)
+  /* Get object by handle, only tasks have the ready histogram */
+  Object = osGetObjectByHandle(Handle, (UINT8) ((Kind == OS_LATENCY_READY) ?
+    OS_OBJECT_TYPE_TASK : OS_OBJECT_TYPE_IGNORE));
+  if(!Object)
+    return FALSE;
+
+  Histogram = (Kind == OS_LATENCY_READY) ?
+    ((struct TTask FAR *) Object->ObjectDesc)->ReadyHistogram :
+    Object->WaitHistogram;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  for(i = 0; i < (OS_LATENCY_BUCKET_COUNT); i++)
   {
-    Object = osFirstObject;
-    osFirstObject = osFirstObject->NextObject;
+    Buckets[i] = Histogram[i];
+    if(Reset)
+      Histogram[i] = 0;
+  }
 
-    /* Deleting object is a task */
-    if(Object->Type == OS_OBJECT_TYPE_TASK)
-    {
-      Task = (struct TTask FAR *) Object->ObjectDesc;
+  /* Leave critical section */
+  arRestore(PrevLockState);
 
-      /* Release task children */
-      #if (!(OS_USE_FIXMEM_POOLS) && !(OS_INTERNAL_MEMORY_SIZE))
-        while(TRUE)
-        {
-          Node = (struct TBSTreeNode FAR *) Task->Childs.Min;
-          if(!Node)
-            break;
+  /* Return with success */
+  return TRUE;
+}
 
-          stBSTreeRemove(&Task->Childs, Node);
-          osMemFree(Node);
-        }
-      #endif
 
-      /* Release task context */
-      arReleaseTaskContext(&Task->TaskContext);
-    }
+/***************************************************************************/
+#endif /* OS_USE_LATENCY_HISTOGRAM */
+/***************************************************************************/
 
-    /* Call deinit IO */
-    #if (OS_USE_DEVICE_IO_CTRL)
-      if(Object->Flags & OS_OBJECT_FLAG_USES_IO_DEINIT)
-        Object->DeviceIOCtrl(Object, DEV_IO_CTL_DEINIT, NULL, 0, NULL);
-    #endif
 
-    /* Release system object descriptor */
-    #if (!(OS_USE_FIXMEM_POOLS) || ((OS_INTERNAL_MEMORY_SIZE) <= 0))
-      osMemFree(Object);
-    #endif
-  }
+/***************************************************************************/
+#if (OS_USE_LOCK_PROFILER)
+/***************************************************************************/
 
-  /* Restore default clock handler */
-  return arSetPreemptiveHandler(NULL, 0);
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osLockHeld
+ *
+ *  Description:
+ *    Counts the time the critical section was owned. Must be called with
+ *    interrupts disabled.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *    HoldCycles - Cycle counter value at the beginning of ownership.
+ *
+ ***************************************************************************/
+
+void osLockHeld(struct TCriticalSection FAR *CS, UINT32 HoldCycles)
+{
+  UINT32 HoldTime;
+
+  HoldTime = OS_GET_CYCLE_COUNT() - HoldCycles;
+  CS->LockStat.TotalHoldTime += HoldTime;
+  if(HoldTime > CS->LockStat.MaxHoldTime)
+    CS->LockStat.MaxHoldTime = HoldTime;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osLockWaited
+ *
+ *  Description:
+ *    Counts the wait for the critical section. Must be called with
+ *    interrupts disabled.
+ *
+ *  Parameters:
+ *    CS - Pointer to critical section descriptor.
+ *    WaitTime - Time the task spent waiting.
+ *
+ ***************************************************************************/
+
+static void osLockWaited(struct TCriticalSection FAR *CS, UINT32 WaitTime)
+{
+  CS->LockStat.Contentions++;
+  CS->LockStat.TotalWaitTime += WaitTime;
+  if(WaitTime > CS->LockStat.MaxWaitTime)
+    CS->LockStat.MaxWaitTime = WaitTime;
 }
 
 
 /***************************************************************************/
-#endif /* OS_DEINIT_FUNC */
+#if (OS_ALLOW_OBJECT_DELETION)
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osStart
+ *    osUnlinkLockCS
  *
  *  Description:
- *    Starts the operating system execution. All tasks created before the
- *    function call will be executed. The function will return with success
- *    when osStop is called. Before calling osStart, osInit must be
- *    executed.
+ *    Removes critical sections of the object from the lock profiler list.
+ *    Walks positioned at a removed critical section move to the next one.
  *
- *  Return:
- *    TRUE on success or FALSE on failure.
+ *  Parameters:
+ *    Object - Pointer to system object descriptor.
  *
  ***************************************************************************/
 
-BOOL osStart(void)
+static void osUnlinkLockCS(struct TSysObject FAR *Object)
 {
-  /* Operating system is already running */
-  if(osCurrentTask)
-  {
-    osSetLastError(ERR_OS_ALREADY_RUNNING);
-    return FALSE;
-  }
+  struct TCriticalSection FAR *CS;
+  struct TLockCursor FAR *Cursor;
+  BOOL PrevLockState;
 
-  /* Start operating system */
-  #if (OS_STOP_FUNC)
-    osRestoreCallerAndStop = FALSE;
-    osSaveCallerAndStart = TRUE;
+  #if (OS_USE_MULTIPLE_SIGNALS)
+    struct TSignal FAR *Signal;
+  #endif
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  #if (OS_USE_MULTIPLE_SIGNALS)
+    for(Signal = &Object->Signal; Signal; Signal = Signal->NextSignal)
+    {
+      CS = Signal->CS;
   #else
-    osCurrentTask = (struct TTask FAR *) stPQueueGet(&osTaskPQueue);
+      CS = Object->Signal.CS;
   #endif
 
-  /* Execute task scheduler to start operating system immediately */
-  osYield();
-  return TRUE;
+      if(CS)
+      {
+        if(CS->PrevLockCS)
+          CS->PrevLockCS->NextLockCS = CS->NextLockCS;
+        else
+          osFirstLockCS = CS->NextLockCS;
+        if(CS->NextLockCS)
+          CS->NextLockCS->PrevLockCS = CS->PrevLockCS;
+
+        for(Cursor = osFirstLockCursor; Cursor; Cursor = Cursor->Next)
+          if(Cursor->CS == CS)
+            Cursor->CS = CS->NextLockCS;
+      }
+
+  #if (OS_USE_MULTIPLE_SIGNALS)
+    }
+  #endif
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
 }
 
 
 /***************************************************************************/
-#if (OS_STOP_FUNC)
+#endif /* OS_ALLOW_OBJECT_DELETION */
 /***************************************************************************/
 
 
 /****************************************************************************
  *
  *  Name:
- *    osStop
+ *    osLockWalkStart
  *
  *  Description:
- *    Stops the operating system execution. It does not terminate any task
- *    and does not release any system resources. This operation returns to
- *    the osStart function execution point. osStart returns with TRUE
- *    (successful operating system execution). To continue execution of
- *    the operating system, call osStart again. To permanently exit and
- *    release system resources (all created tasks and objects), use
- *    osDeinit when the operating system is stopped.
+ *    Starts a walk through the list of profiled critical sections.
+ *    Critical sections created during the walk are not visited, so every
+ *    walk finishes. Function must be called from inside a critical
+ *    section.
+ *
+ *  Parameters:
+ *    Cursor - Pointer to position of the walk.
  *
  ***************************************************************************/
 
-void osStop(void)
+static void osLockWalkStart(struct TLockCursor FAR *Cursor)
 {
-  /* Stop the operating system execution */
-  osSaveCallerAndStart = FALSE;
-  osRestoreCallerAndStop = TRUE;
-
-  /* Execute task scheduler to restore the caller */
-  osYield();
+  /* Start at the first critical section and register the walk */
+  Cursor->CS = osFirstLockCS;
+  Cursor->Next = osFirstLockCursor;
+  osFirstLockCursor = Cursor;
 }
 
 
-/***************************************************************************/
-#endif /* OS_STOP_FUNC */
-/***************************************************************************/
+/****************************************************************************
+ *
+ *  Name:
+ *    osLockWalkEnd
+ *
+ *  Description:
+ *    Ends a walk through the list of profiled critical sections. Function
+ *    must be called from inside a critical section.
+ *
+ *  Parameters:
+ *    Cursor - Pointer to position of the walk.
+ *
+ ***************************************************************************/
 
+static void osLockWalkEnd(struct TLockCursor FAR *Cursor)
+{
+  struct TLockCursor FAR * FAR *Link;
 
-/***************************************************************************/
-#if (OS_GET_SYSTEM_STAT_FUNC)
-/***************************************************************************/
+  /* Remove the walk from the list of walks in progress */
+  Link = &osFirstLockCursor;
+  while(*Link != Cursor)
+    Link = &(*Link)->Next;
+  *Link = Cursor->Next;
+}
 
 
 /****************************************************************************
  *
  *  Name:
- *    osGetSystemStat
+ *    osGetContendedLocks
  *
  *  Description:
- *    Returns current CPU usage. This is the total CPU time minus the idle
- *    task CPU usage. The percentage of CPU usage can be calculated from
- *    the formula: 100 * CPUTime / TotalTime.
+ *    Returns statistics of the most contended critical sections, ordered
+ *    by the total wait time, then by the number of contentions and
+ *    acquisitions. An object with more critical sections (reader-writer
+ *    lock gate, protected queue or stream ends) has an entry for each of
+ *    them. Times are in OS_CYCLES_PER_SECOND units. Interrupts are
+ *    disabled only while copying statistics of a single critical section,
+ *    so the entries may come from slightly different moments.
  *
  *  Parameters:
- *    CPUTime - Pointer to variable that receives CPU usage.
- *    TotalTime - Pointer to variable that receives total CPU time.
+ *    Stat - Pointer to array that receives the statistics.
+ *    Count - Number of entries in the array.
+ *
+ *  Return:
+ *    Number of entries filled or 0 on failure.
  *
  ***************************************************************************/
 
-void osGetSystemStat(INDEX *CPUTime, INDEX *TotalTime)
+INDEX osGetContendedLocks(struct TLockStat *Stat, INDEX Count)
 {
-  /* Get system usage */
-  if(osIdleTask->CPUUsageTime == osCPUUsageTime)
-    *CPUTime = osCPUUsage - osIdleTask->CPUUsage;
-  else if(osIdleTask->CPUCalcTime == osCPUUsageTime)
-    *CPUTime = osCPUUsage - osIdleTask->CPUCalc;
-  else
-    *CPUTime = osCPUUsage;
-  *TotalTime = osCPUUsage;
+  struct TCriticalSection FAR *CS;
+  struct TLockCursor Cursor;
+  struct TLockStat Entry;
+  BOOL PrevLockState;
+  INDEX Filled, i, j;
+
+  /* Check parameters */
+  if(!Stat || !Count)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return 0;
+  }
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  Filled = 0;
+  osLockWalkStart(&Cursor);
+  while(Cursor.CS)
+  {
+    /* Copy statistics of the critical section */
+    CS = Cursor.CS;
+    Entry = CS->LockStat;
+    Entry.Handle = CS->Signal->Object->Handle;
+    Entry.Type = CS->Signal->Object->Type;
+    Cursor.CS = CS->NextLockCS;
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+
+    /* Find position of the entry, skip it when it is past the array */
+    for(i = Filled; i; i--)
+      if((Stat[i - 1].TotalWaitTime > Entry.TotalWaitTime) ||
+        ((Stat[i - 1].TotalWaitTime == Entry.TotalWaitTime) &&
+        ((Stat[i - 1].Contentions > Entry.Contentions) ||
+        ((Stat[i - 1].Contentions == Entry.Contentions) &&
+        (Stat[i - 1].Acquisitions >= Entry.Acquisitions)))))
+        break;
+
+    /* Insert the entry, the last one is dropped when the array is full */
+    if(i < Count)
+    {
+      if(Filled < Count)
+        Filled++;
+      for(j = Filled - 1; j > i; j--)
+        Stat[j] = Stat[j - 1];
+      Stat[i] = Entry;
+    }
+
+    /* Enter critical section (the cursor has moved past critical
+       sections removed in the meantime) */
+    PrevLockState = arLock();
+  }
+  osLockWalkEnd(&Cursor);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Filled;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osResetLockStat
+ *
+ *  Description:
+ *    Clears statistics of all critical sections. Interrupts are disabled
+ *    only while clearing a single critical section.
+ *
+ ***************************************************************************/
+
+void osResetLockStat(void)
+{
+  struct TLockCursor Cursor;
+  BOOL PrevLockState;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  osLockWalkStart(&Cursor);
+  while(Cursor.CS)
+  {
+    stMemSet(&Cursor.CS->LockStat, 0x00, sizeof(Cursor.CS->LockStat));
+    Cursor.CS = Cursor.CS->NextLockCS;
+
+    /* Let pending interrupts run (the cursor moves past critical sections
+       removed in the meantime) */
+    arRestore(PrevLockState);
+    PrevLockState = arLock();
+  }
+  osLockWalkEnd(&Cursor);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
 }
 
 
 /***************************************************************************/
-#endif /* OS_GET_SYSTEM_STAT_FUNC */
+#endif /* OS_USE_LOCK_PROFILER */
 /***************************************************************************/
 
 
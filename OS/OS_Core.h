@@ -38,6 +38,32 @@
   #error OS_LOWEST_USED_PRIORITY must be between 0 and 254
 #endif
 
+/* Bitmap-indexed ready to run task queue is disabled by default (the
+   ready to run tasks are kept in a priority queue) */
+#ifndef OS_USE_READY_BITMAP
+  #define OS_USE_READY_BITMAP           0
+#elif (((OS_USE_READY_BITMAP) != 0) && ((OS_USE_READY_BITMAP) != 1))
+  #error OS_USE_READY_BITMAP must be either 0 or 1
+#endif
+
+/* Tickless idle mode is disabled by default */
+#ifndef OS_USE_TICKLESS
+  #define OS_USE_TICKLESS               0
+#elif (((OS_USE_TICKLESS) != 0) && ((OS_USE_TICKLESS) != 1))
+  #error OS_USE_TICKLESS must be either 0 or 1
+#elif ((OS_USE_TICKLESS) && !(AR_USE_TICKLESS_IDLE))
+  #error OS_USE_TICKLESS requires AR_USE_TICKLESS_IDLE architecture support
+#endif
+
+/* Time notifications are kept in a priority queue by default. The
+   hierarchical timing wheel makes registering and unregistering a time
+   notification constant time operations. */
+#ifndef OS_USE_TIME_WHEEL
+  #define OS_USE_TIME_WHEEL             0
+#elif (((OS_USE_TIME_WHEEL) != 0) && ((OS_USE_TIME_WHEEL) != 1))
+  #error OS_USE_TIME_WHEEL must be either 0 or 1
+#endif
+
 /* Using timeouts is enabled by default */
 #ifndef OS_USE_WAITING_WITH_TIME_OUT
   #define OS_USE_WAITING_WITH_TIME_OUT  1
@@ -51,6 +77,9 @@
   #define OS_STAT_SAMPLE_RATE           100UL
 #elif ((OS_STAT_SAMPLE_RATE) < 1UL)
   #error OS_STAT_SAMPLE_RATE must be greater than or equal to 1
+#elif ((AR_USE_CYCLE_COUNTER) && ((OS_STAT_SAMPLE_RATE) > (0xFFFFFFFFUL / \
+  ((AR_CYCLES_PER_SECOND) / (AR_TICKS_PER_SECOND)))))
+  #error OS_STAT_SAMPLE_RATE is too large for 32-bit cycle counts
 #endif
 
 /* Using fixed-size memory allocation for system objects is disabled by
@@ -132,12 +161,59 @@
 
 #endif
 
+/* Slab allocation of system objects is disabled by default. Objects of
+   similar size share a size class, each class is grown on demand by
+   slabs of fixed-size blocks allocated on the heap. */
+#ifndef OS_USE_SLAB
+  #define OS_USE_SLAB                   0
+#elif (((OS_USE_SLAB) != 0) && ((OS_USE_SLAB) != 1))
+  #error OS_USE_SLAB must be either 0 or 1
+#elif ((OS_USE_SLAB) && !(ST_USE_FIXMEM))
+  #error ST_USE_FIXMEM must be set to 1 when OS_USE_SLAB is 1
+#elif ((OS_USE_SLAB) && (OS_USE_FIXMEM_POOLS))
+  #error OS_USE_SLAB must be 0 when OS_USE_FIXMEM_POOLS is 1
+#endif
+
+/* Slab allocator configuration */
+#if (OS_USE_SLAB)
+
+  /* Size classes are 16 bytes apart by default */
+  #ifndef OS_SLAB_GRANULARITY
+    #define OS_SLAB_GRANULARITY         16UL
+  #elif ((OS_SLAB_GRANULARITY) <= 0UL)
+    #error OS_SLAB_GRANULARITY must be greater than 0
+  #endif
+
+  /* Objects up to 1024 bytes are allocated in slabs by default (larger
+     objects are allocated on the heap) */
+  #ifndef OS_SLAB_MAX_SIZE
+    #define OS_SLAB_MAX_SIZE            1024UL
+  #elif (((OS_SLAB_MAX_SIZE) < (OS_SLAB_GRANULARITY)) || \
+    ((OS_SLAB_MAX_SIZE) % (OS_SLAB_GRANULARITY)))
+    #error OS_SLAB_MAX_SIZE must be a multiple of OS_SLAB_GRANULARITY
+  #endif
+
+  /* Single slab holds 8 blocks by default */
+  #ifndef OS_SLAB_BLOCK_COUNT
+    #define OS_SLAB_BLOCK_COUNT         8UL
+  #elif ((OS_SLAB_BLOCK_COUNT) < 1UL)
+    #error OS_SLAB_BLOCK_COUNT must be greater than 0
+  #endif
+
+  /* Number of size classes */
+  #define OS_SLAB_CLASS_COUNT \
+    ((OS_SLAB_MAX_SIZE) / (OS_SLAB_GRANULARITY))
+
+#endif
+
 /* Internal system memory is disabled by default */
 #ifndef OS_INTERNAL_MEMORY_SIZE
   #define OS_INTERNAL_MEMORY_SIZE       0UL
 #elif (OS_USE_FIXMEM_POOLS)
   #error OS_INTERNAL_MEMORY_SIZE must be set to 0 when \
     OS_USE_FIXMEM_POOLS is set to 1
+#elif (OS_USE_SLAB)
+  #error OS_INTERNAL_MEMORY_SIZE must be set to 0 when OS_USE_SLAB is 1
 #elif ((OS_INTERNAL_MEMORY_SIZE) < 0UL)
   #error OS_INTERNAL_MEMORY_SIZE must be greater than or equal to 0
 #endif
@@ -181,6 +257,11 @@
   #define OS_USE_CSEC_OBJECTS           0
 #endif
 
+/* Lock profiler counts critical sections (mutexes, semaphores, ...) */
+#if ((OS_USE_LOCK_PROFILER) && !(OS_USE_CSEC_OBJECTS))
+  #error OS_USE_LOCK_PROFILER requires objects with critical sections
+#endif
+
 /* System supports time signalization objects (disabled by default, but
    will be enabled automatically when it is necessary) */
 #ifndef OS_USE_TIME_OBJECTS
@@ -246,6 +327,7 @@
 #define OS_SIGNAL_FLAG_CRITICAL_SECTION 0x08
 #define OS_SIGNAL_FLAG_MUTUAL_EXCLUSION 0x10
 #define OS_SIGNAL_FLAG_ABANDONED        0x20
+#define OS_SIGNAL_FLAG_WATCHED          0x40
 
 /* Task blocking flags */
 #define OS_BLOCK_FLAG_SLEEP             0x01
@@ -290,6 +372,10 @@
 struct TSignal;
 struct TWaitAssoc;
 
+#if (OS_USE_WAIT_SET)
+  struct TWatch;
+#endif
+
 #if (OS_USE_TIME_OBJECTS)
   struct TTimeNotify;
 #endif
@@ -297,9 +383,9 @@ struct TWaitAssoc;
 #if (OS_USE_CSEC_OBJECTS)
   struct TCSAssoc;
   struct TPriorityPath;
-  struct TCriticalSection;
 #endif
 
+struct TCriticalSection;
 struct TSysObject;
 struct TTask;
 
@@ -325,8 +411,12 @@ typedef INDEX (FAR * TDeviceIOCtrl)(struct TSysObject FAR *Object,
     /* System object descriptor pointer */
     struct TSysObject FAR *Object;
 
-    /* Binary search tree node for object names */
-    struct TBSTreeNode Node;
+    /* Name hash (hash table) or binary search tree node for object names */
+    #if ((OS_NAME_HASH_SIZE) > 0UL)
+      UINT32 Hash;
+    #else
+      struct TBSTreeNode Node;
+    #endif
   };
 
 #endif
@@ -348,10 +438,16 @@ struct TSignal
   struct TBSTreeNode DeferredSgn;
 
   /* System object descriptor pointer */
-  #if (OS_USE_SYSTEM_IO_CTRL)
+  #if ((OS_USE_SYSTEM_IO_CTRL) || (OS_USE_LATENCY_HISTOGRAM) || \
+    (OS_USE_LOCK_PROFILER))
     struct TSysObject FAR *Object;
   #endif
 
+  /* Time at which the signal released its first waiting task */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    UINT32 DeferredCycles;
+  #endif
+
   /* Critical section descriptor pointer */
   #if (OS_USE_CSEC_OBJECTS)
     struct TCriticalSection FAR *CS;
@@ -360,6 +456,11 @@ struct TSignal
   #if ((OS_USE_MULTIPLE_SIGNALS) && (OS_ALLOW_OBJECT_DELETION))
     struct TSignal FAR *NextSignal;
   #endif
+
+  /* List of wait set watches of this signal */
+  #if (OS_USE_WAIT_SET)
+    struct TWatch FAR *Watches;
+  #endif
 };
 
 
@@ -380,6 +481,36 @@ struct TWaitAssoc
 };
 
 
+#if (OS_USE_WAIT_SET)
+
+  /* Wait set descriptor */
+  struct TWaitSet
+  {
+    /* Signal in the signaled state while the ready list is not empty */
+    struct TSignal FAR *Signal;
+
+    /* List of watches whose signals have become signaled */
+    struct TWatch FAR *FirstReady;
+    struct TWatch FAR *LastReady;
+  };
+
+  /* Watch descriptor (relation between a signal and a wait set) */
+  struct TWatch
+  {
+    struct TSignal FAR *Signal;
+    struct TWaitSet FAR *WaitSet;
+
+    /* Next watch of the same signal and next watch in the ready list */
+    struct TWatch FAR *NextWatch;
+    struct TWatch FAR *NextReady;
+
+    /* Is the watch in the ready list? */
+    BOOL Ready;
+  };
+
+#endif
+
+
 #if (OS_USE_TIME_OBJECTS)
 
   /* Time notification descriptor */
@@ -396,8 +527,15 @@ struct TWaitAssoc
     struct TTask FAR *Task;
     struct TSignal FAR *Signal;
 
-    /* Priority queue item descriptor */
-    struct TPQueueItem Item;
+    /* Timing wheel list links and position or priority queue item */
+    #if (OS_USE_TIME_WHEEL)
+      struct TTimeNotify FAR *Prev;
+      struct TTimeNotify FAR *Next;
+      UINT8 Level;
+      UINT8 Slot;
+    #else
+      struct TPQueueItem Item;
+    #endif
   };
 
 #endif
@@ -423,6 +561,17 @@ struct TWaitAssoc
     /* Critical section own counter */
     INDEX Count;
 
+    /* Number of recursive acquisitions, which own no additional units (used
+       by the shared access of reader-writer locks) */
+    #if (OS_USE_RWLOCK)
+      INDEX Recursion;
+    #endif
+
+    /* Time at which the task became the owner */
+    #if (OS_USE_LOCK_PROFILER)
+      UINT32 HoldCycles;
+    #endif
+
     /* Pointer to previous and next association descriptor */
     struct TCSAssoc FAR *Prev;
     struct TCSAssoc FAR *Next;
@@ -459,6 +608,30 @@ struct TWaitAssoc
     struct TCSAssoc FAR *FirstAllocated;
     INDEX Count;
 
+    /* Task owning the critical section acquired by the fast path (it has
+       no association descriptor) and next critical section of that task */
+    #if (OS_MUTEX_FAST_PATH)
+      struct TTask FAR *FastOwner;
+      struct TCriticalSection FAR *NextFastCS;
+    #endif
+
+    /* Priority assigned to the owners (OS_LOWEST_PRIORITY if the critical
+       section uses priority inheritance only) */
+    #if (OS_MUTEX_PRIORITY_CEILING)
+      UINT8 Ceiling;
+    #endif
+
+    /* Contention statistics, time of the fast path acquisition and the
+       list of all critical sections */
+    #if (OS_USE_LOCK_PROFILER)
+      struct TLockStat LockStat;
+      #if (OS_MUTEX_FAST_PATH)
+        UINT32 FastCycles;
+      #endif
+      struct TCriticalSection FAR *PrevLockCS;
+      struct TCriticalSection FAR *NextLockCS;
+    #endif
+
     /* List of the critical section owners */
     struct TCSAssoc TasksInCS[1];
   };
@@ -504,9 +677,29 @@ struct TSysObject
 
   /* Pointer to specific object descriptor */
   PVOID ObjectDesc;
+
+  /* Time spent by tasks waiting for the object */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    UINT32 WaitHistogram[OS_LATENCY_BUCKET_COUNT];
+  #endif
 };
 
 
+#if (OS_USE_STATISTICS)
+
+  /* CPU time descriptor (cycles of the last and the current statistics
+     period, each period is identified by its starting time) */
+  struct TCPUStat
+  {
+    TIME UsageTime;
+    UINT32 Usage;
+    TIME CalcTime;
+    UINT32 Calc;
+  };
+
+#endif
+
+
 /* Task descriptor */
 struct TTask
 {
@@ -521,7 +714,12 @@ struct TTask
   PVOID Arg;
 
   /* Priority queue item descriptor for queue of ready to run tasks */
-  struct TPQueueItem ReadyTask;
+  #if (OS_USE_READY_BITMAP)
+    struct TTask FAR *PrevReady;
+    struct TTask FAR *NextReady;
+  #else
+    struct TPQueueItem ReadyTask;
+  #endif
 
   /* Task priority */
   UINT8 Priority;
@@ -551,6 +749,9 @@ struct TTask
   #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
     INDEX WaitingCount;
     INDEX WaitingIndex;
+
+    /* Waiting for all objects at once (osWaitForObjectsEx) */
+    BOOL WaitAll;
   #endif
 
   /* Waiting exit code */
@@ -569,6 +770,14 @@ struct TTask
     struct TTask FAR *IPCBlockingTask;
   #endif
 
+  /* Condition of waiting for flags */
+  #if (OS_WAIT_FOR_FLAGS_FUNC)
+    INDEX FlagsMask;
+    INDEX FlagsState;
+    BOOL FlagsWaitAll;
+    BOOL FlagsClearOnExit;
+  #endif
+
   /* Lists of the owned critical sections, ordered by its priorities
      and addresses */
   #if (OS_USE_CSEC_OBJECTS)
@@ -576,6 +785,11 @@ struct TTask
     struct TBSTree OwnedCSPtr;
   #endif
 
+  /* List of the critical sections acquired by the fast path */
+  #if (OS_MUTEX_FAST_PATH)
+    struct TCriticalSection FAR *FastCS;
+  #endif
+
   /* Task children (created or opened system objects) */
   #if (OS_ALLOW_OBJECT_DELETION)
     struct TBSTree Childs;
@@ -583,10 +797,20 @@ struct TTask
 
   /* CPU usage */
   #if (OS_USE_STATISTICS)
-    TIME CPUUsageTime;
-    INDEX CPUUsage;
-    TIME CPUCalcTime;
-    INDEX CPUCalc;
+    struct TCPUStat CPUStat;
+  #endif
+
+  /* Time at which the task became ready and the histogram of time spent
+     ready before running */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    BOOL ReadyPending;
+    UINT32 ReadyCycles;
+    UINT32 ReadyHistogram[OS_LATENCY_BUCKET_COUNT];
+  #endif
+
+  /* Time at which the task began waiting */
+  #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+    UINT32 WaitCycles;
   #endif
 
   /* Last error code */
@@ -613,7 +837,7 @@ extern INDEX osLastQuantumIndex;
 /* Total CPU usage */
 #if (OS_USE_STATISTICS)
   extern TIME osCPUUsageTime;
-  extern INDEX osCPUUsage;
+  extern UINT32 osCPUUsage;
 #endif
 
 
@@ -623,8 +847,15 @@ extern INDEX osLastQuantumIndex;
  *
  ***************************************************************************/
 
+/* High resolution time of CPU usage statistics and trace records */
+#if (AR_USE_CYCLE_COUNTER)
+  #define OS_GET_CYCLE_COUNT()          arGetCycleCount()
+#else
+  #define OS_GET_CYCLE_COUNT()          ((UINT32) arGetTickCount())
+#endif
+
 /* Memory management */
-#if !(OS_USE_FIXMEM_POOLS)
+#if (!(OS_USE_FIXMEM_POOLS) && !(OS_USE_SLAB))
   #if ((OS_INTERNAL_MEMORY_SIZE) > 0)
 
     extern UINT8 osMemoryPool[OS_INTERNAL_MEMORY_SIZE];
@@ -640,6 +871,15 @@ extern INDEX osLastQuantumIndex;
   #endif
 #endif
 
+/* Memory barrier used by lock-free code (may be provided by the port) */
+#if defined(AR_MEMORY_BARRIER)
+  #define OS_MEMORY_BARRIER()           AR_MEMORY_BARRIER()
+#elif defined(__GNUC__)
+  #define OS_MEMORY_BARRIER()           __sync_synchronize()
+#else
+  #define OS_MEMORY_BARRIER()
+#endif
+
 
 /****************************************************************************
  *
@@ -651,8 +891,9 @@ extern INDEX osLastQuantumIndex;
   extern "C" {
 #endif
 
-  #if (OS_USE_FIXMEM_POOLS)
+  #if ((OS_USE_FIXMEM_POOLS) || (OS_USE_SLAB))
     PVOID osMemAlloc(SIZE Size);
+    BOOL osMemFree(PVOID Ptr);
   #endif
 
   #if (OS_ALLOW_OBJECT_DELETION)
@@ -679,6 +920,10 @@ extern INDEX osLastQuantumIndex;
       BOOL MutualExclusion);
   #endif
 
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    void osSetCSCeiling(struct TCriticalSection FAR *CS, UINT8 Ceiling);
+  #endif
+
   #if (OS_ALLOW_OBJECT_DELETION)
     void osDeleteObject(struct TSysObject FAR *Object);
   #endif
@@ -702,14 +947,57 @@ extern INDEX osLastQuantumIndex;
     BOOL osWaitFor(struct TSignal FAR *Signal, TIME Timeout);
   #endif
 
+  #if (OS_USE_CONDVAR)
+    BOOL osWaitForAndReleaseCS(struct TSignal FAR *Signal,
+      struct TCriticalSection FAR *CS, TIME Timeout);
+  #endif
+
+  #if ((OS_USE_CONDVAR) || (OS_WAIT_FOR_FLAGS_FUNC))
+    void osWakeWaitingTask(struct TWaitAssoc FAR *WaitAssoc);
+    void osWakeWaitingTasks(struct TSignal FAR *Signal, BOOL All);
+  #endif
+
+  #if (OS_USE_WAIT_SET)
+    void osWatchSignal(struct TWaitSet FAR *WaitSet,
+      struct TWatch FAR *Watch, struct TSignal FAR *Signal);
+    void osUnwatchSignal(struct TWatch FAR *Watch);
+    BOOL osWaitForWatch(struct TWaitSet FAR *WaitSet, TIME Timeout,
+      struct TWatch FAR * FAR *Watch);
+  #endif
+
   void osUpdateSignalState(struct TSignal FAR *Signal, INDEX Signaled);
 
+  #if (OS_USE_STATISTICS)
+    void osInitCPUStat(struct TCPUStat FAR *Stat);
+    UINT32 osGetCPUTime(struct TCPUStat FAR *Stat);
+  #endif
+
+  #if (OS_USE_TRACE)
+    void osInitTrace(void);
+    void osTraceRecord(UINT8 Event, struct TTask FAR *Task,
+      struct TSignal FAR *Signal, UINT32 Value, UINT16 Info);
+  #endif
+
   #if (OS_USE_CSEC_OBJECTS)
     BOOL osPriorityPath(struct TPriorityPath FAR *Priority);
     BOOL osReleaseCS(struct TCriticalSection FAR *CS,
       struct TTask FAR *Task, INDEX ReleaseCount, INDEX *PrevCount);
   #endif
 
+  #if (OS_USE_RWLOCK)
+    BOOL osAcquireOwnedCS(struct TCriticalSection FAR *CS);
+    BOOL osReleaseOwnedCS(struct TCriticalSection FAR *CS);
+  #endif
+
+  #if (OS_USE_LOCK_PROFILER)
+    void osLockHeld(struct TCriticalSection FAR *CS, UINT32 HoldCycles);
+  #endif
+
+  #if (OS_MUTEX_FAST_PATH)
+    void osUnlinkFastCS(struct TCriticalSection FAR *CS);
+    BOOL osMutexFastAcquire(struct TSysObject FAR *Object);
+  #endif
+
   #if (OS_USE_TIME_OBJECTS)
     void osInitTimeNotify(struct TTimeNotify FAR *TimeNotify);
     void osRegisterTimeNotify(struct TTimeNotify FAR *TimeNotify,
@@ -40,9 +40,102 @@ struct TFlagsObject
   #if (OS_OPEN_FLAGS_FUNC)
     struct TObjectName Name;
   #endif
+
+  /* Signal used only to queue tasks waiting for a mask of flags (never
+     signaled, tasks are released by osSetFlags) */
+  #if (OS_WAIT_FOR_FLAGS_FUNC)
+    struct TSignal MaskSync;
+  #endif
 };
 
 
+/***************************************************************************/
+#if (OS_WAIT_FOR_FLAGS_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osFlagsMatch
+ *
+ *  Description:
+ *    Checks whether the flags state satisfies the waiting condition.
+ *
+ *  Parameters:
+ *    State - State of the flags.
+ *    Mask - Bitmask of the awaited flags.
+ *    WaitAll - TRUE if all flags of the mask must be set, FALSE if any of
+ *      them is enough.
+ *
+ *  Return:
+ *    TRUE if the condition is satisfied, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+static BOOL osFlagsMatch(INDEX State, INDEX Mask, BOOL WaitAll)
+{
+  return (BOOL) (WaitAll ? ((State & Mask) == Mask) : ((State & Mask) != 0));
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osReleaseFlagsWaiting
+ *
+ *  Description:
+ *    Releases tasks waiting for a mask of flags satisfied by the specified
+ *    state, in the order of their priorities. Flags cleared on exit by a
+ *    released task are not seen by the following tasks. Must be called
+ *    with interrupts disabled.
+ *
+ *  Parameters:
+ *    FlagsObject - Pointer to the flags object descriptor.
+ *    State - New state of the flags.
+ *
+ *  Return:
+ *    State of the flags after the released tasks cleared their flags.
+ *
+ ***************************************************************************/
+
+static INDEX osReleaseFlagsWaiting(struct TFlagsObject FAR *FlagsObject,
+  INDEX State)
+{
+  struct TWaitAssoc FAR *WaitAssoc, FAR *NextAssoc;
+  struct TTask FAR *Task;
+
+  WaitAssoc = (struct TWaitAssoc FAR *)
+    stBSTreeGetFirst(&FlagsObject->MaskSync.WaitingTasks);
+  while(WaitAssoc)
+  {
+    /* Successor must be found before the task is removed */
+    NextAssoc = (struct TWaitAssoc FAR *) stBSTreeGetNext(
+      &FlagsObject->MaskSync.WaitingTasks, WaitAssoc);
+
+    /* Release the task when its condition is satisfied */
+    Task = WaitAssoc->Task;
+    if(osFlagsMatch(State, Task->FlagsMask, Task->FlagsWaitAll))
+    {
+      Task->FlagsState = State;
+      if(Task->FlagsClearOnExit)
+        State &= ~Task->FlagsMask;
+
+      osWakeWaitingTask(WaitAssoc);
+    }
+
+    WaitAssoc = NextAssoc;
+  }
+
+  return State;
+}
+
+
+/***************************************************************************/
+#endif /* OS_WAIT_FOR_FLAGS_FUNC */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
@@ -97,6 +190,28 @@ HANDLE osCreateFlags(SYSNAME Name, INDEX InitialState)
   /* Setup the object */
   Object->Signal.Signaled = InitialState;
 
+  /* Setup the signal of tasks waiting for a mask of flags */
+  #if (OS_WAIT_FOR_FLAGS_FUNC)
+    FlagsObject->MaskSync.Flags = 0;
+    FlagsObject->MaskSync.Signaled = 0;
+    stBSTreeInit(&FlagsObject->MaskSync.WaitingTasks, osWaitAssocCmp);
+
+    #if (OS_USE_CSEC_OBJECTS)
+      FlagsObject->MaskSync.CS = NULL;
+    #endif
+
+    /* Object of the signal (latency histogram and lock statistics) */
+    #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+      FlagsObject->MaskSync.Object = Object;
+    #endif
+
+    /* Multiple signals associated with the object */
+    #if (OS_ALLOW_OBJECT_DELETION)
+      FlagsObject->MaskSync.NextSignal = Object->Signal.NextSignal;
+      Object->Signal.NextSignal = &FlagsObject->MaskSync;
+    #endif
+  #endif
+
   /* Mark object as ready to use and return its handle */
   Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
   return Object->Handle;
@@ -219,9 +334,17 @@ BOOL osSetFlags(HANDLE Handle, INDEX Mask, INDEX *Changed)
   if(Changed)
     *Changed = (INDEX) ((Object->Signal.Signaled ^ Mask) & Mask);
 
-  /* Set the flags */
-  osUpdateSignalState(&Object->Signal,
-    (INDEX) (Object->Signal.Signaled | Mask));
+  /* Set the flags and release tasks waiting for them */
+  #if (OS_WAIT_FOR_FLAGS_FUNC)
+    osUpdateSignalState(&Object->Signal, osReleaseFlagsWaiting(
+      (struct TFlagsObject FAR *) Object->ObjectDesc,
+      (INDEX) (Object->Signal.Signaled | Mask)));
+    if(osCurrentTask)
+      osRescheduleIfHigherPriority();
+  #else
+    osUpdateSignalState(&Object->Signal,
+      (INDEX) (Object->Signal.Signaled | Mask));
+  #endif
 
   /* Leave critical section */
   arRestore(PrevLockState);
@@ -280,6 +403,104 @@ BOOL osResetFlags(HANDLE Handle, INDEX Mask, INDEX *Changed)
 }
 
 
+/***************************************************************************/
+#if (OS_WAIT_FOR_FLAGS_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitForFlags
+ *
+ *  Description:
+ *    Waits until any or all of the specified flags are set or the
+ *    specified timeout interval elapses. Unlike osWaitForObject, the task
+ *    is released only when its condition is satisfied.
+ *
+ *  Parameters:
+ *    Handle - Handle of the flags object.
+ *    Mask - Bitmask of the awaited flags.
+ *    WaitAll - TRUE to wait until all flags of the mask are set, FALSE to
+ *      wait until any of them is set.
+ *    ClearOnExit - TRUE to reset the flags of the mask when the condition
+ *      is satisfied.
+ *    Timeout - Timeout value.
+ *    State - Pointer to a variable that receives the flags state which
+ *      satisfied the condition (before clearing). Can be NULL if this
+ *      information is not needed.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osWaitForFlags(HANDLE Handle, INDEX Mask, BOOL WaitAll,
+  BOOL ClearOnExit, TIME Timeout, INDEX *State)
+{
+  struct TFlagsObject FAR *FlagsObject;
+  struct TSysObject FAR *Object;
+  BOOL PrevLockState, Success;
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
+
+  /* Check parameters */
+  if(!Mask)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_FLAGS);
+  if(!Object)
+    return FALSE;
+  FlagsObject = (struct TFlagsObject FAR *) Object->ObjectDesc;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Condition already satisfied */
+  if(osFlagsMatch(Object->Signal.Signaled, Mask, WaitAll))
+  {
+    osCurrentTask->FlagsState = Object->Signal.Signaled;
+    if(ClearOnExit)
+      osUpdateSignalState(&Object->Signal,
+        (INDEX) (Object->Signal.Signaled & ~Mask));
+    Success = TRUE;
+  }
+
+  /* Wait until osSetFlags satisfies the condition. Interrupts stay
+     disabled until the task is queued, so no change can be lost. */
+  else
+  {
+    osCurrentTask->FlagsMask = Mask;
+    osCurrentTask->FlagsWaitAll = WaitAll;
+    osCurrentTask->FlagsClearOnExit = ClearOnExit;
+    Success = osWaitFor(&FlagsObject->MaskSync, Timeout);
+  }
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+
+  /* Return the flags state */
+  if(Success && State)
+    *State = osCurrentTask->FlagsState;
+
+  return Success;
+}
+
+
+/***************************************************************************/
+#endif /* OS_WAIT_FOR_FLAGS_FUNC */
+/***************************************************************************/
+
+
 /***************************************************************************/
 #endif /* OS_USE_FLAGS */
 /***************************************************************************/
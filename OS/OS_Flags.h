@@ -47,6 +47,15 @@
   #error OS_OPEN_FLAGS_FUNC must be 0 when OS_USE_FLAGS is 0
 #endif
 
+/* Enable osWaitForFlags (waiting for a mask of flags) by default */
+#ifndef OS_WAIT_FOR_FLAGS_FUNC
+  #define OS_WAIT_FOR_FLAGS_FUNC        (OS_USE_FLAGS)
+#elif (((OS_WAIT_FOR_FLAGS_FUNC) != 0) && ((OS_WAIT_FOR_FLAGS_FUNC) != 1))
+  #error OS_WAIT_FOR_FLAGS_FUNC must be either 0 or 1
+#elif (((OS_WAIT_FOR_FLAGS_FUNC) != 0) && !(OS_USE_FLAGS))
+  #error OS_WAIT_FOR_FLAGS_FUNC must be 0 when OS_USE_FLAGS is 0
+#endif
+
 
 /****************************************************************************
  *
@@ -59,6 +68,17 @@
   #define OS_USE_OBJECT_NAMES           1
 #endif
 
+/* Enable Multiple Signals support (queue of tasks waiting for a mask) */
+#if ((OS_WAIT_FOR_FLAGS_FUNC) && !defined(OS_USE_MULTIPLE_SIGNALS))
+  #define OS_USE_MULTIPLE_SIGNALS       1
+#endif
+
+/* Enable modifiable task priority (rescheduling after waiting tasks are
+   released) */
+#if ((OS_WAIT_FOR_FLAGS_FUNC) && !defined(OS_MODIFIABLE_TASK_PRIO))
+  #define OS_MODIFIABLE_TASK_PRIO       1
+#endif
+
 
 /****************************************************************************
  *
@@ -91,6 +111,11 @@
     BOOL osSetFlags(HANDLE Handle, INDEX Mask, INDEX *Changed);
     BOOL osResetFlags(HANDLE Handle, INDEX Mask, INDEX *Changed);
 
+    #if (OS_WAIT_FOR_FLAGS_FUNC)
+      BOOL osWaitForFlags(HANDLE Handle, INDEX Mask, BOOL WaitAll,
+        BOOL ClearOnExit, TIME Timeout, INDEX *State);
+    #endif
+
   #endif
 
 #ifdef __cplusplus
@@ -114,6 +114,12 @@ struct TMailboxObject
   /* Mode flags */
   UINT8 Mode;
 
+  /* Message pool (NULL if messages are allocated only on the heap) */
+  #if (OS_MBOX_ALLOW_POOL)
+    PVOID Pool;
+    SIZE PoolMsgSize;
+  #endif
+
   /* Mailbox access synchronization */
   #if (OS_MBOX_PEEK_FUNC)
     BOOL PrevLockState;
@@ -253,6 +259,95 @@ static void osMailboxUnlock(struct TMailboxObject FAR *MailboxObject)
 /***************************************************************************/
 
 
+/****************************************************************************
+ *
+ *  Name:
+ *    osMailboxMsgAlloc
+ *
+ *  Description:
+ *    Allocates memory for a new message. The message is taken from the
+ *    mailbox pool when it fits in the pool block and a free block is
+ *    available; otherwise, it is allocated on the heap.
+ *
+ *  Parameters:
+ *    MailboxObject - Pointer to the mailbox object.
+ *    Size - Size of the message data.
+ *
+ *  Return:
+ *    Pointer to the message descriptor or NULL on failure.
+ *
+ ***************************************************************************/
+
+static struct TMailboxMsg FAR *osMailboxMsgAlloc(
+  struct TMailboxObject FAR *MailboxObject, SIZE Size)
+{
+  #if (OS_MBOX_ALLOW_POOL)
+    struct TMailboxMsg FAR *MailboxMsg;
+    BOOL PrevLockState;
+
+    /* Try to allocate the message from the pool */
+    if(MailboxObject->Pool && (Size <= MailboxObject->PoolMsgSize))
+    {
+      PrevLockState = arLock();
+      MailboxMsg = (struct TMailboxMsg FAR *)
+        stFixedMemAlloc(MailboxObject->Pool);
+      arRestore(PrevLockState);
+
+      if(MailboxMsg)
+        return MailboxMsg;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(MailboxObject);
+  #endif
+
+  /* Oversized message or the pool is exhausted */
+  return (struct TMailboxMsg FAR *) stMemAlloc(OS_MBOX_MSG_DESC_SIZE + Size);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMailboxMsgFree
+ *
+ *  Description:
+ *    Releases memory allocated for the message by osMailboxMsgAlloc.
+ *
+ *  Parameters:
+ *    MailboxObject - Pointer to the mailbox object.
+ *    MailboxMsg - Pointer to the message descriptor.
+ *
+ ***************************************************************************/
+
+static void osMailboxMsgFree(struct TMailboxObject FAR *MailboxObject,
+  struct TMailboxMsg FAR *MailboxMsg)
+{
+  #if (OS_MBOX_ALLOW_POOL)
+    BOOL PrevLockState, Released;
+
+    /* Return the message to the pool, if it comes from there */
+    if(MailboxObject->Pool)
+    {
+      PrevLockState = arLock();
+      Released = stFixedMemFree(MailboxObject->Pool, MailboxMsg);
+      arRestore(PrevLockState);
+
+      if(Released)
+        return;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(MailboxObject);
+  #endif
+
+  /* Message allocated on the heap */
+  stMemFree(MailboxMsg);
+}
+
+
 /****************************************************************************
  *
  *  Name:
@@ -353,8 +448,7 @@ static SIZE osMailboxWrite(struct TMailboxObject FAR *MailboxObject,
   #endif
 
   /* Allocate memory for new message */
-  MailboxMsg = (struct TMailboxMsg FAR *)
-    stMemAlloc(OS_MBOX_MSG_DESC_SIZE + Size);
+  MailboxMsg = osMailboxMsgAlloc(MailboxObject, Size);
   if(!MailboxMsg)
     return 0;
 
@@ -383,8 +477,9 @@ static SIZE osMailboxWrite(struct TMailboxObject FAR *MailboxObject,
 
   /* Release single task waiting for read completion */
   #if (OS_MBOX_ALLOW_WAIT_IF_EMPTY)
-    osUpdateSignalState(&MailboxObject->SyncOnEmpty,
-      MailboxObject->Object.Signal.Signaled);
+    if(MailboxObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+      osUpdateSignalState(&MailboxObject->SyncOnEmpty,
+        MailboxObject->Object.Signal.Signaled);
   #endif
 
   /* Execute delayed scheduler and leave critical section */
@@ -580,7 +675,7 @@ static SIZE osMailboxRead(struct TMailboxObject FAR *MailboxObject,
     stMemCpy(Buffer, OS_MBOX_MSG_DATA(MailboxMsg), Size);
 
     /* Release memory allocated for the message */
-    stMemFree(MailboxMsg);
+    osMailboxMsgFree(MailboxObject, MailboxMsg);
   }
 
   /* Return number of successfully transferred bytes */
@@ -647,7 +742,7 @@ static INDEX osMailboxIOCtrl(struct TSysObject FAR *Object,
         while(MailboxMsg)
         {
           MailboxObject->FirstMessage = MailboxMsg->NextMessage;
-          stMemFree(MailboxMsg);
+          osMailboxMsgFree(MailboxObject, MailboxMsg);
           MailboxMsg = MailboxObject->FirstMessage;
         }
         return 1;
@@ -663,37 +758,34 @@ static INDEX osMailboxIOCtrl(struct TSysObject FAR *Object,
 /****************************************************************************
  *
  *  Name:
- *    osCreateMailbox
+ *    osMailboxCreate
  *
  *  Description:
- *    Creates a mailbox object.
+ *    Creates a mailbox object with an optional message pool placed right
+ *    after the mailbox descriptor.
  *
  *  Parameters:
  *    Name - Name of the object.
- *    Mode - Mode flags. Specifying values other than those listed below
- *      will cause function failure. Features are available only when enabled.
- *
- *      Protection Method (select one, defaults to Int Ctrl):
- *      OS_IPC_PROTECT_INT_CTRL - Protection by interrupt disabling.
- *      OS_IPC_PROTECT_EVENT - Protection by auto-reset event.
- *      OS_IPC_PROTECT_MUTEX - Protection by mutex.
- *
- *      Data Transfer Flags:
- *      OS_IPC_WAIT_IF_EMPTY - Enables waiting for read completion.
- *      OS_IPC_DIRECT_READ_WRITE - Enables direct read-write feature (can
- *      be used only with OS_IPC_WAIT_IF_EMPTY flag).
+ *    Mode - Mode flags (see osCreateMailbox).
+ *    PoolCount - Number of messages in the pool (zero for no pool).
+ *    PoolMsgSize - Maximal size of the message data stored in the pool.
  *
  *  Return:
  *    Handle of the created object or NULL_HANDLE on failure.
  *
  ***************************************************************************/
 
-HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
+static HANDLE osMailboxCreate(SYSNAME Name, UINT8 Mode, INDEX PoolCount,
+  SIZE PoolMsgSize)
 {
   struct TMailboxObject FAR *MailboxObject;
   struct TSysObject FAR *Object;
   BOOL InvalidParam;
 
+  #if (OS_MBOX_ALLOW_POOL)
+    SIZE MailboxDescSize, PoolSize;
+  #endif
+
   /* Check the mode flags */
   InvalidParam = FALSE;
   if(Mode & ((UINT8) ~OS_MBOX_MODE_MASK))
@@ -714,6 +806,25 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
       InvalidParam = TRUE;
   #endif
 
+  /* Determine the size of the message pool */
+  #if (OS_MBOX_ALLOW_POOL)
+    MailboxDescSize = AR_MEMORY_ALIGN_UP(sizeof(*MailboxObject));
+    PoolSize = 0;
+    if(PoolCount)
+    {
+      if(PoolMsgSize && (PoolMsgSize <= ((SIZE) -1) - OS_MBOX_MSG_DESC_SIZE))
+        PoolSize = stFixedMemSize(OS_MBOX_MSG_DESC_SIZE + PoolMsgSize,
+          (SIZE) PoolCount);
+      if(!PoolSize || (PoolSize > ((SIZE) -1) - MailboxDescSize))
+        InvalidParam = TRUE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(PoolCount);
+    AR_UNUSED_PARAM(PoolMsgSize);
+  #endif
+
   /* Return when some parameter is invalid */
   if(InvalidParam)
   {
@@ -721,9 +832,14 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
     return NULL_HANDLE;
   }
 
-  /* Allocate memory for the object */
-  MailboxObject =
-    (struct TMailboxObject FAR *) osMemAlloc(sizeof(*MailboxObject));
+  /* Allocate memory for the object (followed by the message pool) */
+  #if (OS_MBOX_ALLOW_POOL)
+    MailboxObject = (struct TMailboxObject FAR *)
+      osMemAlloc(MailboxDescSize + PoolSize);
+  #else
+    MailboxObject =
+      (struct TMailboxObject FAR *) osMemAlloc(sizeof(*MailboxObject));
+  #endif
   if(!MailboxObject)
     return NULL_HANDLE;
 
@@ -758,6 +874,18 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
   MailboxObject->FirstMessage = NULL;
   MailboxObject->Mode = Mode;
 
+  /* Setup the message pool */
+  #if (OS_MBOX_ALLOW_POOL)
+    MailboxObject->Pool = NULL;
+    MailboxObject->PoolMsgSize = PoolMsgSize;
+    if(PoolSize)
+    {
+      MailboxObject->Pool = &((UINT8 FAR *) MailboxObject)[MailboxDescSize];
+      stFixedMemInit(MailboxObject->Pool, PoolSize,
+        OS_MBOX_MSG_DESC_SIZE + PoolMsgSize);
+    }
+  #endif
+
   #if (OS_MBOX_PEEK_FUNC)
 
     /* Setup the auto-reset event / mutex for protection */
@@ -772,6 +900,11 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
           MailboxObject->Sync.CS = NULL;
         #endif
 
+        /* Object of the signal (latency histogram and lock statistics) */
+        #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+          MailboxObject->Sync.Object = Object;
+        #endif
+
         /* Multiple signals associated with object */
         #if (OS_ALLOW_OBJECT_DELETION)
           Object->Signal.NextSignal = &MailboxObject->Sync;
@@ -800,6 +933,11 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
         MailboxObject->SyncOnEmpty.CS = NULL;
       #endif
 
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        MailboxObject->SyncOnEmpty.Object = Object;
+      #endif
+
       /* Multiple signals associated with the object */
       #if (OS_ALLOW_OBJECT_DELETION)
         MailboxObject->SyncOnEmpty.NextSignal = Object->Signal.NextSignal;
@@ -814,6 +952,82 @@ HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
 }
 
 
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateMailbox
+ *
+ *  Description:
+ *    Creates a mailbox object.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    Mode - Mode flags. Specifying values other than those listed below
+ *      will cause function failure. Features are available only when enabled.
+ *
+ *      Protection Method (select one, defaults to Int Ctrl):
+ *      OS_IPC_PROTECT_INT_CTRL - Protection by interrupt disabling.
+ *      OS_IPC_PROTECT_EVENT - Protection by auto-reset event.
+ *      OS_IPC_PROTECT_MUTEX - Protection by mutex.
+ *
+ *      Data Transfer Flags:
+ *      OS_IPC_WAIT_IF_EMPTY - Enables waiting for read completion.
+ *      OS_IPC_DIRECT_READ_WRITE - Enables direct read-write feature (can
+ *      be used only with OS_IPC_WAIT_IF_EMPTY flag).
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode)
+{
+  /* Create the mailbox without the message pool */
+  return osMailboxCreate(Name, Mode, 0, 0);
+}
+
+
+/***************************************************************************/
+#if (OS_MBOX_ALLOW_POOL)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateMailboxEx
+ *
+ *  Description:
+ *    Creates a mailbox object with a message pool. Messages that fit in
+ *    the pool are stored in its fixed size blocks, so sending and receiving
+ *    them does not use the heap. Larger messages, and messages sent while
+ *    the pool is exhausted, are allocated on the heap.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    Mode - Mode flags (see osCreateMailbox).
+ *    PoolCount - Number of messages in the pool. If zero, the mailbox is
+ *      created without the pool.
+ *    PoolMsgSize - Maximal size of the message data stored in the pool.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateMailboxEx(SYSNAME Name, UINT8 Mode, INDEX PoolCount,
+  SIZE PoolMsgSize)
+{
+  /* Create the mailbox with the message pool */
+  return osMailboxCreate(Name, Mode, PoolCount, PoolMsgSize);
+}
+
+
+/***************************************************************************/
+#endif /* OS_MBOX_ALLOW_POOL */
+/***************************************************************************/
+
+
 /***************************************************************************/
 #if (OS_OPEN_MBOX_FUNC)
 /***************************************************************************/
@@ -1146,7 +1360,8 @@ BOOL osClearMailbox(HANDLE Handle)
     osUpdateSignalState(&MailboxObject->Object.Signal, 0);
 
     #if (OS_MBOX_ALLOW_WAIT_IF_EMPTY)
-      osUpdateSignalState(&MailboxObject->SyncOnEmpty, 0);
+      if(MailboxObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+        osUpdateSignalState(&MailboxObject->SyncOnEmpty, 0);
     #endif
   }
 
@@ -1164,7 +1379,7 @@ BOOL osClearMailbox(HANDLE Handle)
   {
     MailboxMsgToRemove = MailboxMsg;
     MailboxMsg = MailboxMsgToRemove->NextMessage;
-    stMemFree(MailboxMsgToRemove);
+    osMailboxMsgFree(MailboxObject, MailboxMsgToRemove);
   }
 
   /* Return with success */
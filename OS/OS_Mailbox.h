@@ -125,6 +125,17 @@
     to be enabled
 #endif
 
+/* Enable per-mailbox message pools (osCreateMailboxEx) by default */
+#ifndef OS_MBOX_ALLOW_POOL
+  #define OS_MBOX_ALLOW_POOL            ((OS_USE_MAILBOX) && (ST_USE_FIXMEM))
+#elif (((OS_MBOX_ALLOW_POOL) != 0) && ((OS_MBOX_ALLOW_POOL) != 1))
+  #error OS_MBOX_ALLOW_POOL must be either 0 or 1
+#elif (((OS_MBOX_ALLOW_POOL) != 0) && !(OS_USE_MAILBOX))
+  #error OS_MBOX_ALLOW_POOL must be 0 when OS_USE_MAILBOX is 0
+#elif (((OS_MBOX_ALLOW_POOL) != 0) && !(ST_USE_FIXMEM))
+  #error ST_USE_FIXMEM must be set to 1 when OS_MBOX_ALLOW_POOL is 1
+#endif
+
 
 /****************************************************************************
  *
@@ -185,6 +196,11 @@
 
     HANDLE osCreateMailbox(SYSNAME Name, UINT8 Mode);
 
+    #if (OS_MBOX_ALLOW_POOL)
+      HANDLE osCreateMailboxEx(SYSNAME Name, UINT8 Mode, INDEX PoolCount,
+        SIZE PoolMsgSize);
+    #endif
+
     #if (OS_OPEN_MBOX_FUNC)
       HANDLE osOpenMailbox(SYSNAME Name);
     #endif
@@ -49,23 +49,24 @@ struct TMutexObject
 /****************************************************************************
  *
  *  Name:
- *    osCreateMutex
+ *    osMutexCreate
  *
  *  Description:
- *    Creates a mutex object.
+ *    Creates a mutex object with an optional priority ceiling.
  *
  *  Parameters:
  *    Name - Name of the object.
  *    InitialOwner - If TRUE, the calling task becomes the owner of the
- *      created mutex. To release ownership, use the osReleaseMutex
- *      function.
+ *      created mutex.
+ *    Ceiling - Priority ceiling or OS_LOWEST_PRIORITY for priority
+ *      inheritance.
  *
  *  Return:
  *    Handle of the created object or NULL_HANDLE on failure.
  *
  ***************************************************************************/
 
-HANDLE osCreateMutex(SYSNAME Name, BOOL InitialOwner)
+static HANDLE osMutexCreate(SYSNAME Name, BOOL InitialOwner, UINT8 Ceiling)
 {
   struct TMutexObject FAR *MutexObject;
   struct TSysObject FAR *Object;
@@ -77,6 +78,26 @@ HANDLE osCreateMutex(SYSNAME Name, BOOL InitialOwner)
     return NULL_HANDLE;
   }
 
+  /* Check the priority ceiling and the priority of the initial owner */
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    if((Ceiling != OS_LOWEST_PRIORITY) && (Ceiling > OS_LOWEST_USED_PRIORITY))
+    {
+      osSetLastError(ERR_INVALID_PARAMETER);
+      return NULL_HANDLE;
+    }
+
+    if(InitialOwner && (Ceiling != OS_LOWEST_PRIORITY) &&
+      (osCurrentTask->AssignedPriority < Ceiling))
+    {
+      osSetLastError(ERR_PRIORITY_ABOVE_CEILING);
+      return NULL_HANDLE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(Ceiling);
+  #endif
+
   /* Allocate memory for the object */
   MutexObject = (struct TMutexObject FAR *) osMemAlloc(sizeof(*MutexObject));
   if(!MutexObject)
@@ -110,12 +131,90 @@ HANDLE osCreateMutex(SYSNAME Name, BOOL InitialOwner)
      If InitialOwner is FALSE, initial count is 1 (unlocked). */
   osRegisterCS(&Object->Signal, &MutexObject->CS, !InitialOwner, 1, TRUE);
 
+  /* Define the priority ceiling (raises priority of the initial owner) */
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    if(Ceiling != OS_LOWEST_PRIORITY)
+      osSetCSCeiling(&MutexObject->CS, Ceiling);
+  #endif
+
   /* Mark object as ready to use and return its handle */
   Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
   return Object->Handle;
 }
 
 
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateMutex
+ *
+ *  Description:
+ *    Creates a mutex object. The owner of the mutex inherits the priority
+ *    of the highest priority task waiting for it.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    InitialOwner - If TRUE, the calling task becomes the owner of the
+ *      created mutex. To release ownership, use the osReleaseMutex
+ *      function.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateMutex(SYSNAME Name, BOOL InitialOwner)
+{
+  /* Create the mutex using priority inheritance */
+  return osMutexCreate(Name, InitialOwner, OS_LOWEST_PRIORITY);
+}
+
+
+/***************************************************************************/
+#if (OS_MUTEX_PRIORITY_CEILING)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateMutexEx
+ *
+ *  Description:
+ *    Creates a mutex object using the immediate priority ceiling protocol.
+ *    The owner of the mutex runs at the ceiling priority from acquiring
+ *    until releasing it, so waiting for the mutex does not change the
+ *    priority of any task. The ceiling must not be lower than the priority
+ *    of any task using the mutex; a task with a higher assigned priority
+ *    (the one raised by other mutexes does not count) fails to acquire it
+ *    with ERR_PRIORITY_ABOVE_CEILING. Deadlocks involving the mutex are
+ *    not detected; they cannot occur as long as the owner does not wait
+ *    for other objects.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    InitialOwner - If TRUE, the calling task becomes the owner of the
+ *      created mutex.
+ *    Ceiling - Priority ceiling (between 0 and OS_LOWEST_USED_PRIORITY) or
+ *      OS_LOWEST_PRIORITY to create a mutex using priority inheritance.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateMutexEx(SYSNAME Name, BOOL InitialOwner, UINT8 Ceiling)
+{
+  /* Create the mutex with the priority ceiling */
+  return osMutexCreate(Name, InitialOwner, Ceiling);
+}
+
+
+/***************************************************************************/
+#endif /* OS_MUTEX_PRIORITY_CEILING */
+/***************************************************************************/
+
+
 /***************************************************************************/
 #if (OS_OPEN_MUTEX_FUNC)
 /***************************************************************************/
@@ -154,6 +253,79 @@ HANDLE osOpenMutex(SYSNAME Name)
 /***************************************************************************/
 
 
+/***************************************************************************/
+#if (OS_MUTEX_FAST_PATH)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osMutexFastAcquire
+ *
+ *  Description:
+ *    Acquires the mutex for the current task when it is free and no task
+ *    waits for it. The ownership is only recorded in the critical section
+ *    descriptor; the association descriptor is created later, when other
+ *    task starts to wait for the mutex (see osInflateCS).
+ *
+ *  Parameters:
+ *    Object - Pointer to the mutex system object.
+ *
+ *  Return:
+ *    TRUE if the mutex was acquired, otherwise FALSE.
+ *
+ ***************************************************************************/
+
+BOOL osMutexFastAcquire(struct TSysObject FAR *Object)
+{
+  struct TCriticalSection FAR *CS;
+  BOOL PrevLockState, Acquired;
+
+  /* Obtain critical section descriptor */
+  CS = Object->Signal.CS;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Mutex must be free, not awaited, not abandoned and not watched by a
+     wait set (the fast release does not update the signal) */
+  Acquired = (BOOL) (Object->Signal.Signaled &&
+    !Object->Signal.WaitingTasks.Root && !(Object->Signal.Flags &
+    (OS_SIGNAL_FLAG_ABANDONED | OS_SIGNAL_FLAG_WATCHED)));
+
+  /* Owner of a mutex with the priority ceiling needs the association
+     descriptor, which keeps its priority raised */
+  #if (OS_MUTEX_PRIORITY_CEILING)
+    if(CS->Ceiling != OS_LOWEST_PRIORITY)
+      Acquired = FALSE;
+  #endif
+
+  /* Take the ownership */
+  if(Acquired)
+  {
+    Object->Signal.Signaled = 0;
+    CS->FastOwner = osCurrentTask;
+    CS->NextFastCS = osCurrentTask->FastCS;
+    osCurrentTask->FastCS = CS;
+
+    #if (OS_USE_LOCK_PROFILER)
+      CS->FastCycles = OS_GET_CYCLE_COUNT();
+      CS->LockStat.Acquisitions++;
+    #endif
+  }
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Acquired;
+}
+
+
+/***************************************************************************/
+#endif /* OS_MUTEX_FAST_PATH */
+/***************************************************************************/
+
+
 /****************************************************************************
  *
  *  Name:
@@ -174,11 +346,35 @@ BOOL osReleaseMutex(HANDLE Handle)
 {
   struct TSysObject FAR *Object;
 
+  #if (OS_MUTEX_FAST_PATH)
+    struct TCriticalSection FAR *CS;
+    BOOL PrevLockState;
+  #endif
+
   /* Get object by handle */
   Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_MUTEX);
   if(!Object)
     return FALSE;
 
+  /* Release mutex acquired by the fast path. No task waits for it, since
+     waiting would have converted the ownership into a regular one. */
+  #if (OS_MUTEX_FAST_PATH)
+    CS = Object->Signal.CS;
+    PrevLockState = arLock();
+    if(CS->FastOwner && (CS->FastOwner == osCurrentTask) && !osInISR)
+    {
+      #if (OS_USE_LOCK_PROFILER)
+        osLockHeld(CS, CS->FastCycles);
+      #endif
+
+      osUnlinkFastCS(CS);
+      Object->Signal.Signaled = 1;
+      arRestore(PrevLockState);
+      return TRUE;
+    }
+    arRestore(PrevLockState);
+  #endif
+
   /* Release critical section */
   return osReleaseCS(Object->Signal.CS, osCurrentTask, 1, NULL);
 }
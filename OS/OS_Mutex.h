@@ -47,6 +47,25 @@
   #error OS_OPEN_MUTEX_FUNC must be 0 when OS_USE_MUTEX is 0
 #endif
 
+/* Enable fast path for acquiring and releasing uncontended mutexes */
+#ifndef OS_MUTEX_FAST_PATH
+  #define OS_MUTEX_FAST_PATH            (OS_USE_MUTEX)
+#elif (((OS_MUTEX_FAST_PATH) != 0) && ((OS_MUTEX_FAST_PATH) != 1))
+  #error OS_MUTEX_FAST_PATH must be either 0 or 1
+#elif (((OS_MUTEX_FAST_PATH) != 0) && !(OS_USE_MUTEX))
+  #error OS_MUTEX_FAST_PATH must be 0 when OS_USE_MUTEX is 0
+#endif
+
+/* Enable mutexes with priority ceiling (osCreateMutexEx) by default */
+#ifndef OS_MUTEX_PRIORITY_CEILING
+  #define OS_MUTEX_PRIORITY_CEILING     (OS_USE_MUTEX)
+#elif (((OS_MUTEX_PRIORITY_CEILING) != 0) && \
+  ((OS_MUTEX_PRIORITY_CEILING) != 1))
+  #error OS_MUTEX_PRIORITY_CEILING must be either 0 or 1
+#elif (((OS_MUTEX_PRIORITY_CEILING) != 0) && !(OS_USE_MUTEX))
+  #error OS_MUTEX_PRIORITY_CEILING must be 0 when OS_USE_MUTEX is 0
+#endif
+
 
 /****************************************************************************
  *
@@ -88,6 +107,11 @@
 
     HANDLE osCreateMutex(SYSNAME Name, BOOL InitialOwner);
 
+    #if (OS_MUTEX_PRIORITY_CEILING)
+      HANDLE osCreateMutexEx(SYSNAME Name, BOOL InitialOwner,
+        UINT8 Ceiling);
+    #endif
+
     #if (OS_OPEN_MUTEX_FUNC)
       HANDLE osOpenMutex(SYSNAME Name);
     #endif
@@ -69,8 +69,16 @@
   #define OS_QUEUE_MODE_MASK_4          (OS_QUEUE_MODE_MASK_3)
 #endif
 
+/* Lock-free single-producer/single-consumer flag */
+#if (OS_QUEUE_ALLOW_SPSC)
+  #define OS_QUEUE_MODE_MASK_5          ((OS_QUEUE_MODE_MASK_4) | \
+                                        (OS_IPC_SPSC))
+#else
+  #define OS_QUEUE_MODE_MASK_5          (OS_QUEUE_MODE_MASK_4)
+#endif
+
 /* Available mode flags for the queue object */
-#define OS_QUEUE_MODE_MASK              (OS_QUEUE_MODE_MASK_4)
+#define OS_QUEUE_MODE_MASK              (OS_QUEUE_MODE_MASK_5)
 
 
 /****************************************************************************
@@ -93,10 +101,29 @@ struct TQueueObject
   /* Mode flags */
   UINT8 Mode;
 
-  /* Queue configuration */
+  /* Queue configuration and positions of the first and next message */
   SIZE MessageSize;
   INDEX MaxCount;
   INDEX Offset;
+  INDEX WrOffset;
+
+  /* Lock-free read and write indexes (0 to 2 * MaxCount - 1, the queue
+     is empty when both are equal) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    volatile INDEX RdIndex;
+    volatile INDEX WrIndex;
+  #endif
+
+  /* Messages accessed in place (reserved for write, acquired for read)
+     and tasks owning them in a locked queue */
+  #if (OS_QUEUE_LOAN_FUNC)
+    BOOL WrLoan;
+    BOOL RdLoan;
+    #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+      struct TTask FAR *WrLoanTask;
+      struct TTask FAR *RdLoanTask;
+    #endif
+  #endif
 
   /* Queue access synchronization */
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
@@ -234,294 +261,612 @@ static void osQueueUnlock(struct TQueueObject FAR *QueueObject,
 /****************************************************************************
  *
  *  Name:
- *    osQueueWrite
+ *    osQueueCopy
  *
  *  Description:
- *    Stores data in the specified queue.
+ *    Copies messages between the queue buffer and the specified buffer.
+ *    Messages following the last one in the queue buffer are continued
+ *    from its beginning.
  *
  *  Parameters:
  *    QueueObject - Pointer to the queue object.
- *    Buffer - Pointer to the buffer with data to write.
- *    Size - Size of the data buffer.
- *    Timeout - Timeout value.
- *
- *  Return:
- *    Number of bytes successfully sent, or zero on failure.
+ *    Position - Position of the first message in the queue buffer.
+ *    Buffer - Pointer to the data buffer.
+ *    Size - Size of the single message data (it may be smaller than the
+ *      message size only when a single message is copied).
+ *    Count - Number of messages.
+ *    Write - TRUE to copy data to the queue, FALSE to copy it from there.
  *
  ***************************************************************************/
 
-static SIZE osQueueWrite(struct TQueueObject FAR *QueueObject,
-  PVOID Buffer, SIZE Size, TIME Timeout)
+static void osQueueCopy(struct TQueueObject FAR *QueueObject,
+  INDEX Position, PVOID Buffer, SIZE Size, INDEX Count, BOOL Write)
 {
-  BOOL PrevLockState, Success;
-  SIZE DataOffset;
+  UINT8 FAR *Message;
+  UINT8 FAR *Data;
+  INDEX Chunk;
+  SIZE Bytes;
+
+  /* Copy continuous parts of the queue buffer */
+  Data = (UINT8 FAR *) Buffer;
+  while(Count)
+  {
+    Chunk = QueueObject->MaxCount - Position;
+    if(Chunk > Count)
+      Chunk = Count;
 
-  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    BOOL ProtectByInt;
-  #endif
+    Message = &((UINT8 FAR *) QueueObject)[
+      AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject)) +
+      ((SIZE) Position) * QueueObject->MessageSize];
+    Bytes = ((SIZE) (Chunk - 1)) * QueueObject->MessageSize + Size;
 
-  #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-    BOOL WaitOnFullCompleted;
-  #endif
+    if(Write)
+      stMemCpy(Message, Data, Bytes);
+    else
+      stMemCpy(Data, Message, Bytes);
 
-  #if (OS_QUEUE_ALLOW_DIRECT_RW)
-    struct TTask FAR *Task;
-    struct TWaitAssoc FAR *WaitAssoc;
-  #endif
+    Data += Bytes;
+    Count -= Chunk;
+    Position = 0;
+  }
+}
 
-  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    BOOL PrevISRState;
-  #endif
 
-  /* Mark unused parameter */
-  #if (!((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX) || \
-    (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)))
-    AR_UNUSED_PARAM(Timeout);
-  #endif
+/***************************************************************************/
+#if (OS_QUEUE_LOAN_FUNC)
+/***************************************************************************/
 
-  /* Check parameters */
-  if(!Size)
-  {
-    osSetLastError(ERR_INVALID_PARAMETER);
-    return 0;
-  }
 
-  /* Determine the protection method */
-  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    ProtectByInt = (BOOL) ((QueueObject->Mode & OS_IPC_PROTECTION_MASK) ==
-      OS_IPC_PROTECT_INT_CTRL);
-    if(!ProtectByInt)
-    {
-      /* Operation can be performed only by a task when synchronization
-         other than by interrupt disabling is used */
-      if(!osCurrentTask || osInISR)
-      {
-        osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
-        return 0;
-      }
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueMessage
+ *
+ *  Description:
+ *    Returns the pointer to the message in the queue buffer.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Position - Position of the message in the queue buffer.
+ *
+ *  Return:
+ *    Pointer to the message.
+ *
+ ***************************************************************************/
 
-      /* Wait for write access synchronization */
-      if(!osQueueLock(QueueObject, &QueueObject->WrSync, Timeout))
-        return 0;
-    }
-  #endif
+static PVOID osQueueMessage(struct TQueueObject FAR *QueueObject,
+  INDEX Position)
+{
+  return (PVOID) &((UINT8 FAR *) QueueObject)[
+    AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject)) +
+    ((SIZE) Position) * QueueObject->MessageSize];
+}
 
-  /* Enter critical section */
-  PrevLockState = arLock();
 
-  /* This loop is executed once and it is used to simplify code structure */
-  Success = FALSE;
-  while(1)
-  {
-    /* Direct read-write when some task is waiting for read completion */
-    #if (OS_QUEUE_ALLOW_DIRECT_RW)
-      if(QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE)
-      {
-        /* Get first waiting task */
-        WaitAssoc = (struct TWaitAssoc FAR *)
-          stBSTreeGetFirst(&QueueObject->SyncOnEmpty.WaitingTasks);
-        if(WaitAssoc)
-        {
-          Task = WaitAssoc->Task;
+/***************************************************************************/
+#endif /* OS_QUEUE_LOAN_FUNC */
+/***************************************************************************/
 
-          /* Block a task for IPC operation and make it not waiting. The
-             task is blocked, so during osTerminateTask call for current
-             task, the WaitExitCode may be set. The blocked task will
-             then be resumed and finish the wait function with the
-             specified error code. */
-          Task->BlockingFlags |= OS_BLOCK_FLAG_IPC;
-          osCurrentTask->IPCBlockingTask = Task;
-          osMakeNotWaiting(Task);
 
-          /* Unlock the queue */
-          if(!ProtectByInt)
-            osQueueUnlock(QueueObject, &QueueObject->WrSync);
+/***************************************************************************/
+#if (OS_QUEUE_ALLOW_SPSC)
+/***************************************************************************/
 
-          /* Leave critical section */
-          arRestore(PrevLockState);
 
-          /* Determine the message size */
-          if(Size > Task->IPCSize)
-            Size = Task->IPCSize;
-          else
-            Task->IPCSize = Size;
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscCount
+ *
+ *  Description:
+ *    Returns the number of messages between specified lock-free indexes.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    RdIndex - Read index.
+ *    WrIndex - Write index.
+ *
+ *  Return:
+ *    Number of messages in the queue.
+ *
+ ***************************************************************************/
 
-          /* Copy data directly to waiting task buffer */
-          stMemCpy(Task->IPCBuffer, Buffer, Size);
+static INDEX osQueueSpscCount(struct TQueueObject FAR *QueueObject,
+  INDEX RdIndex, INDEX WrIndex)
+{
+  return (WrIndex >= RdIndex) ? (WrIndex - RdIndex) :
+    (WrIndex + 2 * QueueObject->MaxCount - RdIndex);
+}
 
-          /* Enter critical section */
-          PrevLockState = arLock();
 
-          /* Resume blocked task */
-          Task->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_IPC;
-          Task->IPCDRWCompletion = TRUE;
-          osCurrentTask->IPCBlockingTask = NULL;
-          osMakeReady(Task);
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscNext
+ *
+ *  Description:
+ *    Returns the lock-free index following the specified number of
+ *    messages after the specified one.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Index - Read or write index.
+ *    Count - Number of messages (not greater than MaxCount).
+ *
+ *  Return:
+ *    Next index value.
+ *
+ ***************************************************************************/
 
-          /* Leave critical section */
-          arRestore(PrevLockState);
+static INDEX osQueueSpscNext(struct TQueueObject FAR *QueueObject,
+  INDEX Index, INDEX Count)
+{
+  return (Index >= 2 * QueueObject->MaxCount - Count) ?
+    (Index + Count - 2 * QueueObject->MaxCount) : (Index + Count);
+}
 
-          /* Return the number of bytes transferred */
-          return Size;
-        }
-      }
-    #endif
 
-    /* This variable is used to avoid signal state changing */
-    #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-      WaitOnFullCompleted = FALSE;
-    #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscPosition
+ *
+ *  Description:
+ *    Returns the position of the message in the queue buffer for the
+ *    specified lock-free index.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Index - Read or write index.
+ *
+ *  Return:
+ *    Position of the message.
+ *
+ ***************************************************************************/
 
-    /* When buffer is full */
-    if(QueueObject->Object.Signal.Signaled >= QueueObject->MaxCount)
-    {
-      /* Waiting for buffer space */
-      #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+static INDEX osQueueSpscPosition(struct TQueueObject FAR *QueueObject,
+  INDEX Index)
+{
+  /* Both halves of the index range map to the same messages */
+  return (Index >= QueueObject->MaxCount) ?
+    (Index - QueueObject->MaxCount) : Index;
+}
 
-        /* Exit when not enabled or called not by task */
-        if(!(QueueObject->Mode & OS_IPC_WAIT_IF_FULL) ||
-          !osCurrentTask || osInISR)
-        {
-          osSetLastError(ERR_QUEUE_IS_FULL);
-          break;
-        }
 
-        /* Setup for direct read-write */
-        #if (OS_QUEUE_ALLOW_DIRECT_RW)
-          osCurrentTask->IPCDRWCompletion = FALSE;
-          osCurrentTask->IPCBuffer = Buffer;
-          osCurrentTask->IPCSize = Size;
-        #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscNotify
+ *
+ *  Description:
+ *    Enters the kernel after a lock-free operation, but only when some
+ *    task is waiting for the queue object or for the opposite side of the
+ *    queue. The state of the queue signals is refreshed for them.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Signal - Signal of the opposite side (SyncOnEmpty after write,
+ *      SyncOnFull after read) or NULL when waiting is not enabled.
+ *
+ ***************************************************************************/
 
-        /* Wait when buffer is full */
-        if(!osWaitFor(&QueueObject->SyncOnFull, Timeout))
-          break;
+static void osQueueSpscNotify(struct TQueueObject FAR *QueueObject,
+  struct TSignal FAR *Signal)
+{
+  BOOL PrevLockState, PrevISRState;
 
-        /* Exit on direct read-write operation completion */
-        #if (OS_QUEUE_ALLOW_DIRECT_RW)
-          if(!QueueObject->MaxCount &&
-            (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
-            if(osCurrentTask->IPCDRWCompletion)
-            {
-              Size = osCurrentTask->IPCSize;
-              break;
-            }
-        #endif
+  /* Return when there is no waiting task */
+  if(!stBSTreeGetFirst(&QueueObject->Object.Signal.WaitingTasks))
+    if(!Signal || !stBSTreeGetFirst(&Signal->WaitingTasks))
+      return;
 
-        /* Disallow modification of signal state */
-        WaitOnFullCompleted = TRUE;
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-      /* Exit when buffer is full */
-      #else
-        osSetLastError(ERR_QUEUE_IS_FULL);
-        break;
-      #endif
-    }
+  /* Begin delaying scheduler execution */
+  PrevISRState = osEnterISR();
 
-    /* Calculate offset in buffer to write data */
-    DataOffset = AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject)) +
-      (SIZE) ((QueueObject->Object.Signal.Signaled + QueueObject->Offset) %
-      QueueObject->MaxCount) * QueueObject->MessageSize;
+  /* Update main signal */
+  if(stBSTreeGetFirst(&QueueObject->Object.Signal.WaitingTasks))
+    osUpdateSignalState(&QueueObject->Object.Signal,
+      osQueueSpscCount(QueueObject, QueueObject->RdIndex,
+      QueueObject->WrIndex));
 
-    /* Leave critical section */
-    #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-      if(!ProtectByInt)
-        arRestore(PrevLockState);
-    #endif
+  /* Resume the opposite side (it consumes the signal on release) */
+  if(Signal)
+    if(stBSTreeGetFirst(&Signal->WaitingTasks))
+      osUpdateSignalState(Signal, 1);
 
-    /* Check maximal size */
-    if(Size > QueueObject->MessageSize)
-      Size = QueueObject->MessageSize;
+  /* Execute delayed scheduler */
+  osLeaveISR(PrevISRState);
 
-    /* Copy data */
-    stMemCpy(&((UINT8 FAR *) QueueObject)[DataOffset], Buffer, Size);
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
 
-    /* Enter critical section */
-    #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-      if(!ProtectByInt)
-        PrevLockState = arLock();
-    #endif
 
-    /* Begin delaying scheduler execution */
-    #if ((OS_QUEUE_ALLOW_WAIT_IF_EMPTY) || (OS_QUEUE_ALLOW_WAIT_IF_FULL) || \
-      (OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-      PrevISRState = osEnterISR();
-    #endif
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscWaitForSpace
+ *
+ *  Description:
+ *    Waits until there is space in the lock-free queue. Only the producer
+ *    may call the function. The kernel is entered only when the queue is
+ *    full.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    Number of free messages, or zero on failure.
+ *
+ ***************************************************************************/
 
-    /* Update main signal */
-    osUpdateSignalState(&QueueObject->Object.Signal,
-      QueueObject->Object.Signal.Signaled + 1);
+static INDEX osQueueSpscWaitForSpace(struct TQueueObject FAR *QueueObject,
+  TIME Timeout)
+{
+  INDEX RdIndex, Free;
 
-    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
-      if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
-        osUpdateSignalState(&QueueObject->SyncOnEmpty,
-          QueueObject->SyncOnEmpty.Signaled + 1);
-    #endif
+  #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+    BOOL PrevLockState;
+  #else
+    AR_UNUSED_PARAM(Timeout);
+  #endif
+
+  /* Wait until there is space for the message */
+  while(1)
+  {
+    RdIndex = QueueObject->RdIndex;
+    Free = QueueObject->MaxCount -
+      osQueueSpscCount(QueueObject, RdIndex, QueueObject->WrIndex);
+    if(Free)
+      return Free;
 
+    /* Waiting for buffer space */
     #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-      if(!WaitOnFullCompleted)
-        if(QueueObject->Mode & OS_IPC_WAIT_IF_FULL)
-          osUpdateSignalState(&QueueObject->SyncOnFull,
-            QueueObject->SyncOnFull.Signaled - 1);
+
+      /* Exit when not enabled or called not by task */
+      if(!(QueueObject->Mode & OS_IPC_WAIT_IF_FULL) ||
+        !osCurrentTask || osInISR)
+      {
+        osSetLastError(ERR_QUEUE_IS_FULL);
+        return 0;
+      }
+
+      /* Enter critical section */
+      PrevLockState = arLock();
+
+      /* Wait when the consumer did not free any message in the meantime,
+         it resumes the producer after the next read */
+      if(QueueObject->RdIndex == RdIndex)
+        if(!osWaitFor(&QueueObject->SyncOnFull, Timeout))
+        {
+          arRestore(PrevLockState);
+          return 0;
+        }
+
+      /* Leave critical section */
+      arRestore(PrevLockState);
+
+    /* Exit when buffer is full */
+    #else
+      osSetLastError(ERR_QUEUE_IS_FULL);
+      return 0;
     #endif
+  }
+}
 
-    /* Set success flag to TRUE when code was executed successfully */
-    Success = TRUE;
-    break;
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscPublish
+ *
+ *  Description:
+ *    Publishes messages stored at the write index of the lock-free queue
+ *    and resumes waiting tasks.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Count - Number of messages (not greater than the free space).
+ *
+ ***************************************************************************/
+
+static void osQueueSpscPublish(struct TQueueObject FAR *QueueObject,
+  INDEX Count)
+{
+  /* Publish messages after their data */
+  OS_MEMORY_BARRIER();
+  QueueObject->WrIndex =
+    osQueueSpscNext(QueueObject, QueueObject->WrIndex, Count);
+  OS_MEMORY_BARRIER();
+
+  /* Resume waiting tasks */
+  #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+    osQueueSpscNotify(QueueObject,
+      (QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY) ?
+      &QueueObject->SyncOnEmpty : NULL);
+  #else
+    osQueueSpscNotify(QueueObject, NULL);
+  #endif
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscWaitForData
+ *
+ *  Description:
+ *    Waits until there is a message in the lock-free queue. Only the
+ *    consumer may call the function. The kernel is entered only when the
+ *    queue is empty.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    Number of available messages, or zero on failure.
+ *
+ ***************************************************************************/
+
+static INDEX osQueueSpscWaitForData(struct TQueueObject FAR *QueueObject,
+  TIME Timeout)
+{
+  INDEX WrIndex;
+
+  #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+    BOOL PrevLockState;
+  #else
+    AR_UNUSED_PARAM(Timeout);
+  #endif
+
+  /* Wait until there is a message */
+  while(1)
+  {
+    WrIndex = QueueObject->WrIndex;
+    if(WrIndex != QueueObject->RdIndex)
+    {
+      /* Access data after the write index was read */
+      OS_MEMORY_BARRIER();
+      return osQueueSpscCount(QueueObject, QueueObject->RdIndex, WrIndex);
+    }
+
+    /* Waiting for buffer */
+    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+
+      /* Exit when not enabled or called not by task */
+      if(!(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY) ||
+        !osCurrentTask || osInISR)
+      {
+        osSetLastError(ERR_QUEUE_IS_EMPTY);
+        return 0;
+      }
+
+      /* Enter critical section */
+      PrevLockState = arLock();
+
+      /* Wait when the producer did not store any message in the meantime,
+         it resumes the consumer after the next write */
+      if(QueueObject->WrIndex == WrIndex)
+        if(!osWaitFor(&QueueObject->SyncOnEmpty, Timeout))
+        {
+          arRestore(PrevLockState);
+          return 0;
+        }
+
+      /* Leave critical section */
+      arRestore(PrevLockState);
+
+    /* Exit when buffer is empty */
+    #else
+      osSetLastError(ERR_QUEUE_IS_EMPTY);
+      return 0;
+    #endif
   }
+}
 
-  /* Release mutex or auto-reset event */
-  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    if(!ProtectByInt)
-      osQueueUnlock(QueueObject, &QueueObject->WrSync);
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscConsume
+ *
+ *  Description:
+ *    Removes messages at the read index of the lock-free queue and
+ *    resumes waiting tasks.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Count - Number of messages (not greater than the available ones).
+ *
+ ***************************************************************************/
+
+static void osQueueSpscConsume(struct TQueueObject FAR *QueueObject,
+  INDEX Count)
+{
+  /* Release messages after their data was accessed */
+  OS_MEMORY_BARRIER();
+  QueueObject->RdIndex =
+    osQueueSpscNext(QueueObject, QueueObject->RdIndex, Count);
+  OS_MEMORY_BARRIER();
+
+  /* Resume waiting tasks */
+  #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+    osQueueSpscNotify(QueueObject,
+      (QueueObject->Mode & OS_IPC_WAIT_IF_FULL) ?
+      &QueueObject->SyncOnFull : NULL);
+  #else
+    osQueueSpscNotify(QueueObject, NULL);
   #endif
+}
 
-  /* Execute delayed scheduler */
-  #if ((OS_QUEUE_ALLOW_WAIT_IF_EMPTY) || (OS_QUEUE_ALLOW_WAIT_IF_FULL) || \
-    (OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    if(Success)
-      osLeaveISR(PrevISRState);
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueSpscWrite
+ *
+ *  Description:
+ *    Stores data in the lock-free queue. Only the write index is
+ *    modified, so the function may run concurrently with osQueueSpscRead
+ *    called by another task or ISR. The kernel is entered only when the
+ *    queue is full or when a waiting task must be resumed.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Buffer - Pointer to the buffer with data to write.
+ *    Size - Size of the data of a single message.
+ *    Count - Pointer to the maximal number of messages to write, receives
+ *      the number of messages written.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    Number of bytes of a single message successfully sent, or zero on
+ *    failure.
+ *
+ ***************************************************************************/
+
+static SIZE osQueueSpscWrite(struct TQueueObject FAR *QueueObject,
+  PVOID Buffer, SIZE Size, INDEX *Count, TIME Timeout)
+{
+  INDEX Free;
+
+  /* The message at the write index is reserved */
+  #if (OS_QUEUE_LOAN_FUNC)
+    if(QueueObject->WrLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      return 0;
+    }
   #endif
 
-  /* Leave critical section */
-  arRestore(PrevLockState);
+  /* Wait until there is space for the message */
+  Free = osQueueSpscWaitForSpace(QueueObject, Timeout);
+  if(!Free)
+    return 0;
+
+  /* Check maximal size and number of messages */
+  if(Size > QueueObject->MessageSize)
+    Size = QueueObject->MessageSize;
+  if(*Count > Free)
+    *Count = Free;
+
+  /* Copy data and publish messages */
+  osQueueCopy(QueueObject,
+    osQueueSpscPosition(QueueObject, QueueObject->WrIndex), Buffer, Size,
+    *Count, TRUE);
+  osQueueSpscPublish(QueueObject, *Count);
 
   /* Return number of successfully transmitted bytes */
-  return Success ? Size : 0;
+  return Size;
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osQueueRead
+ *    osQueueSpscRead
  *
  *  Description:
- *    Reads data from the specified queue.
+ *    Reads data from the lock-free queue. Only the read index is
+ *    modified, so the function may run concurrently with osQueueSpscWrite
+ *    called by another task or ISR. The kernel is entered only when the
+ *    queue is empty or when a waiting task must be resumed.
  *
  *  Parameters:
  *    QueueObject - Pointer to the queue object.
  *    Buffer - Pointer to the buffer that obtains data.
- *    Size - Size of the data buffer.
+ *    Size - Size of the data of a single message.
+ *    Count - Pointer to the maximal number of messages to read, receives
+ *      the number of messages read.
  *    Timeout - Timeout value.
  *
  *  Return:
- *    Number of bytes successfully received, or zero on failure.
+ *    Number of bytes of a single message successfully received, or zero
+ *    on failure.
  *
  ***************************************************************************/
 
-static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
-  PVOID *Buffer, SIZE Size, TIME Timeout)
+static SIZE osQueueSpscRead(struct TQueueObject FAR *QueueObject,
+  PVOID Buffer, SIZE Size, INDEX *Count, TIME Timeout)
+{
+  INDEX Available;
+
+  /* The message at the read index is acquired */
+  #if (OS_QUEUE_LOAN_FUNC)
+    if(QueueObject->RdLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      return 0;
+    }
+  #endif
+
+  /* Wait until there is a message */
+  Available = osQueueSpscWaitForData(QueueObject, Timeout);
+  if(!Available)
+    return 0;
+
+  /* Check maximal size and number of messages */
+  if(Size > QueueObject->MessageSize)
+    Size = QueueObject->MessageSize;
+  if(*Count > Available)
+    *Count = Available;
+
+  /* Copy data and release messages */
+  osQueueCopy(QueueObject,
+    osQueueSpscPosition(QueueObject, QueueObject->RdIndex), Buffer, Size,
+    *Count, FALSE);
+  osQueueSpscConsume(QueueObject, *Count);
+
+  /* Return number of successfully transmitted bytes */
+  return Size;
+}
+
+
+/***************************************************************************/
+#endif /* OS_QUEUE_ALLOW_SPSC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueWrite
+ *
+ *  Description:
+ *    Stores data in the specified queue.
+ *
+ *  Parameters:
+ *    QueueObject - Pointer to the queue object.
+ *    Buffer - Pointer to the buffer with data to write.
+ *    Size - Size of the data of a single message (must be equal to the
+ *      message size when more than one message is written).
+ *    Count - Pointer to the maximal number of messages to write, receives
+ *      the number of messages written. All of them are stored at once.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    Number of bytes of a single message successfully sent, or zero on
+ *    failure.
+ *
+ ***************************************************************************/
+
+static SIZE osQueueWrite(struct TQueueObject FAR *QueueObject,
+  PVOID Buffer, SIZE Size, INDEX *Count, TIME Timeout)
 {
   BOOL PrevLockState, Success;
-  SIZE DataOffset;
+  INDEX Position;
 
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
     BOOL ProtectByInt;
   #endif
 
   #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-    BOOL WaitOnEmptyCompleted;
+    BOOL WaitOnFullCompleted;
   #endif
 
   #if (OS_QUEUE_ALLOW_DIRECT_RW)
@@ -540,12 +885,18 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
   #endif
 
   /* Check parameters */
-  if(!Size)
+  if(!Size || !*Count)
   {
     osSetLastError(ERR_INVALID_PARAMETER);
     return 0;
   }
 
+  /* Lock-free single-producer/single-consumer queue */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+      return osQueueSpscWrite(QueueObject, Buffer, Size, Count, Timeout);
+  #endif
+
   /* Determine the protection method */
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
     ProtectByInt = (BOOL) ((QueueObject->Mode & OS_IPC_PROTECTION_MASK) ==
@@ -560,8 +911,8 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
         return 0;
       }
 
-      /* Wait for read access synchronization */
-      if(!osQueueLock(QueueObject, &QueueObject->RdSync, Timeout))
+      /* Wait for write access synchronization */
+      if(!osQueueLock(QueueObject, &QueueObject->WrSync, Timeout))
         return 0;
     }
   #endif
@@ -573,14 +924,22 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
   Success = FALSE;
   while(1)
   {
-    /* Direct read-write when some task is waiting for write completion */
+    /* The message at the write position is accessed in place */
+    #if (OS_QUEUE_LOAN_FUNC)
+      if(QueueObject->WrLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        break;
+      }
+    #endif
+
+    /* Direct read-write when some task is waiting for read completion */
     #if (OS_QUEUE_ALLOW_DIRECT_RW)
-      if(!QueueObject->Object.Signal.Signaled &&
-        (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+      if(QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE)
       {
         /* Get first waiting task */
         WaitAssoc = (struct TWaitAssoc FAR *)
-          stBSTreeGetFirst(&QueueObject->SyncOnFull.WaitingTasks);
+          stBSTreeGetFirst(&QueueObject->SyncOnEmpty.WaitingTasks);
         if(WaitAssoc)
         {
           Task = WaitAssoc->Task;
@@ -596,7 +955,7 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
 
           /* Unlock the queue */
           if(!ProtectByInt)
-            osQueueUnlock(QueueObject, &QueueObject->RdSync);
+            osQueueUnlock(QueueObject, &QueueObject->WrSync);
 
           /* Leave critical section */
           arRestore(PrevLockState);
@@ -607,8 +966,8 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
           else
             Task->IPCSize = Size;
 
-          /* Copy data directly from waiting task buffer */
-          stMemCpy(Buffer, Task->IPCBuffer, Size);
+          /* Copy data directly to waiting task buffer */
+          stMemCpy(Task->IPCBuffer, Buffer, Size);
 
           /* Enter critical section */
           PrevLockState = arLock();
@@ -622,7 +981,8 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
           /* Leave critical section */
           arRestore(PrevLockState);
 
-          /* Return the number of bytes transferred */
+          /* Return the number of bytes transferred (single message) */
+          *Count = 1;
           return Size;
         }
       }
@@ -630,20 +990,20 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
 
     /* This variable is used to avoid signal state changing */
     #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-      WaitOnEmptyCompleted = FALSE;
+      WaitOnFullCompleted = FALSE;
     #endif
 
-    /* When buffer is empty */
-    if(!QueueObject->Object.Signal.Signaled)
+    /* When buffer is full */
+    if(QueueObject->Object.Signal.Signaled >= QueueObject->MaxCount)
     {
-      /* Waiting for buffer */
-      #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+      /* Waiting for buffer space */
+      #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
 
         /* Exit when not enabled or called not by task */
-        if(!(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY) ||
+        if(!(QueueObject->Mode & OS_IPC_WAIT_IF_FULL) ||
           !osCurrentTask || osInISR)
         {
-          osSetLastError(ERR_QUEUE_IS_EMPTY);
+          osSetLastError(ERR_QUEUE_IS_FULL);
           break;
         }
 
@@ -654,13 +1014,14 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
           osCurrentTask->IPCSize = Size;
         #endif
 
-        /* Wait when buffer is empty */
-        if(!osWaitFor(&QueueObject->SyncOnEmpty, Timeout))
+        /* Wait when buffer is full */
+        if(!osWaitFor(&QueueObject->SyncOnFull, Timeout))
           break;
 
         /* Exit on direct read-write operation completion */
         #if (OS_QUEUE_ALLOW_DIRECT_RW)
-          if(QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE)
+          if(!QueueObject->MaxCount &&
+            (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
             if(osCurrentTask->IPCDRWCompletion)
             {
               Size = osCurrentTask->IPCSize;
@@ -669,22 +1030,31 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
         #endif
 
         /* Disallow modification of signal state */
-        WaitOnEmptyCompleted = TRUE;
+        WaitOnFullCompleted = TRUE;
 
-      /* Exit when buffer is empty */
+      /* Exit when buffer is full */
       #else
-        osSetLastError(ERR_QUEUE_IS_EMPTY);
+        osSetLastError(ERR_QUEUE_IS_FULL);
         break;
       #endif
     }
 
-    /* Calculate offset in buffer to read data */
-    DataOffset = AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject)) +
-      ((SIZE) QueueObject->Offset) * QueueObject->MessageSize;
-
-    /* Remove message, before interrupts are restored (avoids problem
-       occurring during task termination) */
-    QueueObject->Offset = (QueueObject->Offset + 1) % QueueObject->MaxCount;
+    /* Position in buffer to write data and number of messages. The write
+       position is kept apart from the read position, since the reader
+       removes the message before it is copied and releases its slot
+       afterwards. */
+    Position = QueueObject->WrOffset;
+    if(*Count > QueueObject->MaxCount - QueueObject->Object.Signal.Signaled)
+      *Count = QueueObject->MaxCount - QueueObject->Object.Signal.Signaled;
+
+    /* Limit the time for which interrupts are disabled during copying */
+    #if (OS_QUEUE_POST_PEND_MANY_FUNC)
+      #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+        if(ProtectByInt)
+      #endif
+          if(*Count > (INDEX) (OS_QUEUE_INT_CTRL_BATCH))
+            *Count = (INDEX) (OS_QUEUE_INT_CTRL_BATCH);
+    #endif
 
     /* Leave critical section */
     #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
@@ -697,7 +1067,7 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
       Size = QueueObject->MessageSize;
 
     /* Copy data */
-    stMemCpy(Buffer, &((UINT8 FAR *) QueueObject)[DataOffset], Size);
+    osQueueCopy(QueueObject, Position, Buffer, Size, *Count, TRUE);
 
     /* Enter critical section */
     #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
@@ -711,21 +1081,26 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
       PrevISRState = osEnterISR();
     #endif
 
+    /* Append messages */
+    QueueObject->WrOffset = (INDEX) ((QueueObject->WrOffset + *Count) %
+      QueueObject->MaxCount);
+
     /* Update main signal */
     osUpdateSignalState(&QueueObject->Object.Signal,
-      QueueObject->Object.Signal.Signaled - 1);
+      QueueObject->Object.Signal.Signaled + *Count);
 
     #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
-      if(!WaitOnEmptyCompleted)
-        if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
-          osUpdateSignalState(&QueueObject->SyncOnEmpty,
-            QueueObject->SyncOnEmpty.Signaled - 1);
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+        osUpdateSignalState(&QueueObject->SyncOnEmpty,
+          QueueObject->SyncOnEmpty.Signaled + *Count);
     #endif
 
+    /* Completed waiting already acquired space for one message */
     #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
       if(QueueObject->Mode & OS_IPC_WAIT_IF_FULL)
         osUpdateSignalState(&QueueObject->SyncOnFull,
-          QueueObject->SyncOnFull.Signaled + 1);
+          QueueObject->SyncOnFull.Signaled - *Count +
+          (WaitOnFullCompleted ? 1 : 0));
     #endif
 
     /* Set success flag to TRUE when code was executed successfully */
@@ -736,7 +1111,7 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
   /* Release mutex or auto-reset event */
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
     if(!ProtectByInt)
-      osQueueUnlock(QueueObject, &QueueObject->RdSync);
+      osQueueUnlock(QueueObject, &QueueObject->WrSync);
   #endif
 
   /* Execute delayed scheduler */
@@ -757,371 +1132,1359 @@ static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
 /****************************************************************************
  *
  *  Name:
- *    osQueueIOCtrl
- *
- *  Description:
- *    Processes device IO control codes for queue objects.
- *
- *  Parameters:
- *    Object - Pointer to the system object.
- *    ControlCode - Device IO control code.
- *    Buffer - Pointer to the data buffer.
- *    BufferSize - Size of the buffer.
- *    IORequest - Pointer to the structure with additional settings.
- *
- *  Return:
- *    Value specific to the specified device IO control code.
- *
- ***************************************************************************/
-
-static INDEX osQueueIOCtrl(struct TSysObject FAR *Object,
-  INDEX ControlCode, PVOID Buffer, SIZE BufferSize,
-  struct TIORequest *IORequest)
-{
-  struct TQueueObject FAR *QueueObject;
-  SIZE BytesTransferred;
-
-  /* Obtain queue descriptor */
-  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
-
-  /* Execute specific operation */
-  switch(ControlCode)
-  {
-    /* Read from the queue */
-    case DEV_IO_CTL_READ:
-      BytesTransferred = osQueueRead(QueueObject, Buffer, BufferSize,
-        IORequest ? IORequest->Timeout : OS_INFINITE);
-      if(IORequest)
-        IORequest->NumberOfBytesTransferred = BytesTransferred;
-      return BytesTransferred != 0;
-
-    /* Write to the queue */
-    case DEV_IO_CTL_WRITE:
-      BytesTransferred = osQueueWrite(QueueObject, Buffer, BufferSize,
-        IORequest ? IORequest->Timeout : OS_INFINITE);
-      if(IORequest)
-        IORequest->NumberOfBytesTransferred = BytesTransferred;
-      return BytesTransferred != 0;
-  }
-
-  /* Not supported device IO control code */
-  osSetLastError(ERR_INVALID_DEVICE_IO_CTL);
-  return 0;
-}
-
-
-/****************************************************************************
- *
- *  Name:
- *    osCreateQueue
+ *    osQueueRead
  *
  *  Description:
- *    Creates a queue object.
+ *    Reads data from the specified queue.
  *
  *  Parameters:
- *    Name - Name of the object.
- *    Mode - Mode flags. Specifying values other than those listed below
- *      will cause function failure. Features are available only when
- *      enabled.
- *
- *      Protection Method (select one, defaults to Int Ctrl):
- *      OS_IPC_PROTECT_INT_CTRL - Protection by interrupt disabling.
- *      OS_IPC_PROTECT_EVENT - Protection by auto-reset event.
- *      OS_IPC_PROTECT_MUTEX - Protection by mutex.
- *
- *      Data Transfer Flags:
- *      OS_IPC_WAIT_IF_EMPTY - Enables waiting for read completion.
- *      OS_IPC_WAIT_IF_FULL - Enables waiting for write completion.
- *      OS_IPC_DIRECT_READ_WRITE - Enables direct read-write feature (must
- *      be used with OS_IPC_WAIT_IF_EMPTY and/or OS_IPC_WAIT_IF_FULL).
- *
- *    MaxCount - Maximal number of messages.
- *    MessageSize - Size of the message.
+ *    QueueObject - Pointer to the queue object.
+ *    Buffer - Pointer to the buffer that obtains data.
+ *    Size - Size of the data of a single message (must be equal to the
+ *      message size when more than one message is read).
+ *    Count - Pointer to the maximal number of messages to read, receives
+ *      the number of messages read. All of them are removed at once.
+ *    Timeout - Timeout value.
  *
  *  Return:
- *    Handle of the created object or NULL_HANDLE on failure.
+ *    Number of bytes of a single message successfully received, or zero
+ *    on failure.
  *
  ***************************************************************************/
 
-HANDLE osCreateQueue(SYSNAME Name, UINT8 Mode, INDEX MaxCount,
-  SIZE MessageSize)
+static SIZE osQueueRead(struct TQueueObject FAR *QueueObject,
+  PVOID *Buffer, SIZE Size, INDEX *Count, TIME Timeout)
 {
-  struct TQueueObject FAR *QueueObject;
-  struct TSysObject FAR *Object;
-  SIZE QueueDescSize;
-  BOOL InvalidParam;
-
-  /* Get size of the queue object descriptor */
-  QueueDescSize = AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject));
+  BOOL PrevLockState, Success;
+  INDEX Position;
 
-  /* Check parameters */
-  InvalidParam = (Mode & ((UINT8) ~OS_QUEUE_MODE_MASK)) || !MessageSize ||
-    (MaxCount > ((((SIZE) (-1)) - QueueDescSize) / MessageSize));
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    BOOL ProtectByInt;
+  #endif
 
-  /* Direct read-write feature (can be used only with OS_IPC_WAIT_IF_EMPTY
-     and/or OS_IPC_WAIT_IF_FULL flag) */
-  #if (OS_QUEUE_ALLOW_DIRECT_RW)
-    if(Mode & OS_IPC_DIRECT_READ_WRITE)
-      if(!(Mode & (OS_IPC_WAIT_IF_EMPTY | OS_IPC_WAIT_IF_FULL)))
-        InvalidParam = TRUE;
+  #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+    BOOL WaitOnEmptyCompleted;
   #endif
 
-  /* MaxCount must be greater than zero when direct read-write is not
-     enabled */
   #if (OS_QUEUE_ALLOW_DIRECT_RW)
-    if(!(Mode & OS_IPC_DIRECT_READ_WRITE) && !MaxCount)
-      InvalidParam = TRUE;
-  #else
-    if(!MaxCount)
-      InvalidParam = TRUE;
+    struct TTask FAR *Task;
+    struct TWaitAssoc FAR *WaitAssoc;
   #endif
 
-  /* Check the protection method */
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    if((Mode & OS_IPC_PROTECTION_MASK) == OS_IPC_PROTECT_MUTEX)
-      InvalidParam = TRUE;
+    BOOL PrevISRState;
   #endif
 
-  /* Return when some parameter is invalid */
-  if(InvalidParam)
-  {
-    osSetLastError(ERR_INVALID_PARAMETER);
-    return NULL_HANDLE;
-  }
-
-  /* Allocate memory for the object */
-  QueueObject = (struct TQueueObject FAR *)
-    osMemAlloc(QueueDescSize + MaxCount * MessageSize);
-  if(!QueueObject)
-    return NULL_HANDLE;
-
-  /* Pointer to system object descriptor */
-  Object = &QueueObject->Object;
+  /* Mark unused parameter */
+  #if (!((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX) || \
+    (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)))
+    AR_UNUSED_PARAM(Timeout);
+  #endif
 
-  /* Register new system object */
-  if(!osRegisterObject((PVOID) QueueObject, Object, OS_OBJECT_TYPE_QUEUE))
+  /* Check parameters */
+  if(!Size || !*Count)
   {
-    osMemFree(QueueObject);
-    return NULL_HANDLE;
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return 0;
   }
 
-  /* Register name descriptor */
-  #if (OS_OPEN_QUEUE_FUNC)
-    if(!osRegisterName(Object, &QueueObject->Name, Name))
-    {
-      osDeleteObject(Object);
-      return NULL_HANDLE;
-    }
-
-  /* Mark unused parameters to avoid warning messages */
-  #else
-    AR_UNUSED_PARAM(Name);
+  /* Lock-free single-producer/single-consumer queue */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+      return osQueueSpscRead(QueueObject, Buffer, Size, Count, Timeout);
   #endif
 
-  /* Setup the queue */
-  Object->Signal.Signaled = 0;
-  Object->Flags |= OS_OBJECT_FLAG_USES_IO_DEINIT;
-  Object->DeviceIOCtrl = osQueueIOCtrl;
-  QueueObject->Mode = Mode;
-  QueueObject->MaxCount = MaxCount;
-  QueueObject->MessageSize = MessageSize;
-
-  /* Setup the auto-reset event / mutex for protection */
+  /* Determine the protection method */
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
-    if((Mode & OS_IPC_PROTECTION_MASK) != OS_IPC_PROTECT_INT_CTRL)
+    ProtectByInt = (BOOL) ((QueueObject->Mode & OS_IPC_PROTECTION_MASK) ==
+      OS_IPC_PROTECT_INT_CTRL);
+    if(!ProtectByInt)
     {
-      /* Setup signal for write protection */
-      QueueObject->WrSync.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
-      QueueObject->WrSync.Signaled = (INDEX) TRUE;
-      stBSTreeInit(&QueueObject->WrSync.WaitingTasks, osWaitAssocCmp);
-
-      /* Setup signal for read protection */
-      QueueObject->RdSync.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
-      QueueObject->RdSync.Signaled = (INDEX) TRUE;
-      stBSTreeInit(&QueueObject->RdSync.WaitingTasks, osWaitAssocCmp);
-
-      #if (OS_USE_CSEC_OBJECTS)
-        QueueObject->WrSync.CS = NULL;
-        QueueObject->RdSync.CS = NULL;
-      #endif
+      /* Operation can be performed only by a task when synchronization
+         other than by interrupt disabling is used */
+      if(!osCurrentTask || osInISR)
+      {
+        osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+        return 0;
+      }
 
-      /* Multiple signals associated with object */
-      #if (OS_ALLOW_OBJECT_DELETION)
-        Object->Signal.NextSignal = &QueueObject->WrSync;
-        QueueObject->WrSync.NextSignal = &QueueObject->RdSync;
-        QueueObject->RdSync.NextSignal = NULL;
-      #endif
+      /* Wait for read access synchronization */
+      if(!osQueueLock(QueueObject, &QueueObject->RdSync, Timeout))
+        return 0;
     }
   #endif
 
-  /* Register the mutex for protection */
-  #if (OS_QUEUE_PROTECT_MUTEX)
-    if((Mode & OS_IPC_PROTECTION_MASK) == OS_IPC_PROTECT_MUTEX)
-    {
-      osRegisterCS(&QueueObject->WrSync, &QueueObject->WrCS, 1, 1, TRUE);
-      osRegisterCS(&QueueObject->RdSync, &QueueObject->RdCS, 1, 1, TRUE);
-    }
-  #endif
+  /* Enter critical section */
+  PrevLockState = arLock();
 
-  /* Setup signal used for waiting for incoming data */
-  #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
-    if(Mode & OS_IPC_WAIT_IF_EMPTY)
-    {
-      QueueObject->SyncOnEmpty.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
-      QueueObject->SyncOnEmpty.Signaled = 0;
-      stBSTreeInit(&QueueObject->SyncOnEmpty.WaitingTasks, osWaitAssocCmp);
+  /* This loop is executed once and it is used to simplify code structure */
+  Success = FALSE;
+  while(1)
+  {
+    /* The message at the read position is accessed in place */
+    #if (OS_QUEUE_LOAN_FUNC)
+      if(QueueObject->RdLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        break;
+      }
+    #endif
 
-      #if (OS_USE_CSEC_OBJECTS)
-        QueueObject->SyncOnEmpty.CS = NULL;
-      #endif
+    /* Direct read-write when some task is waiting for write completion */
+    #if (OS_QUEUE_ALLOW_DIRECT_RW)
+      if(!QueueObject->Object.Signal.Signaled &&
+        (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+      {
+        /* Get first waiting task */
+        WaitAssoc = (struct TWaitAssoc FAR *)
+          stBSTreeGetFirst(&QueueObject->SyncOnFull.WaitingTasks);
+        if(WaitAssoc)
+        {
+          Task = WaitAssoc->Task;
 
-      /* Multiple signals associated with the object */
-      #if (OS_ALLOW_OBJECT_DELETION)
-        QueueObject->SyncOnEmpty.NextSignal = Object->Signal.NextSignal;
-        Object->Signal.NextSignal = &QueueObject->SyncOnEmpty;
+          /* Block a task for IPC operation and make it not waiting. The
+             task is blocked, so during osTerminateTask call for current
+             task, the WaitExitCode may be set. The blocked task will
+             then be resumed and finish the wait function with the
+             specified error code. */
+          Task->BlockingFlags |= OS_BLOCK_FLAG_IPC;
+          osCurrentTask->IPCBlockingTask = Task;
+          osMakeNotWaiting(Task);
+
+          /* Unlock the queue */
+          if(!ProtectByInt)
+            osQueueUnlock(QueueObject, &QueueObject->RdSync);
+
+          /* Leave critical section */
+          arRestore(PrevLockState);
+
+          /* Determine the message size */
+          if(Size > Task->IPCSize)
+            Size = Task->IPCSize;
+          else
+            Task->IPCSize = Size;
+
+          /* Copy data directly from waiting task buffer */
+          stMemCpy(Buffer, Task->IPCBuffer, Size);
+
+          /* Enter critical section */
+          PrevLockState = arLock();
+
+          /* Resume blocked task */
+          Task->BlockingFlags &= (UINT8) ~OS_BLOCK_FLAG_IPC;
+          Task->IPCDRWCompletion = TRUE;
+          osCurrentTask->IPCBlockingTask = NULL;
+          osMakeReady(Task);
+
+          /* Leave critical section */
+          arRestore(PrevLockState);
+
+          /* Return the number of bytes transferred (single message) */
+          *Count = 1;
+          return Size;
+        }
+      }
+    #endif
+
+    /* This variable is used to avoid signal state changing */
+    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+      WaitOnEmptyCompleted = FALSE;
+    #endif
+
+    /* When buffer is empty */
+    if(!QueueObject->Object.Signal.Signaled)
+    {
+      /* Waiting for buffer */
+      #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+
+        /* Exit when not enabled or called not by task */
+        if(!(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY) ||
+          !osCurrentTask || osInISR)
+        {
+          osSetLastError(ERR_QUEUE_IS_EMPTY);
+          break;
+        }
+
+        /* Setup for direct read-write */
+        #if (OS_QUEUE_ALLOW_DIRECT_RW)
+          osCurrentTask->IPCDRWCompletion = FALSE;
+          osCurrentTask->IPCBuffer = Buffer;
+          osCurrentTask->IPCSize = Size;
+        #endif
+
+        /* Wait when buffer is empty */
+        if(!osWaitFor(&QueueObject->SyncOnEmpty, Timeout))
+          break;
+
+        /* Exit on direct read-write operation completion */
+        #if (OS_QUEUE_ALLOW_DIRECT_RW)
+          if(QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE)
+            if(osCurrentTask->IPCDRWCompletion)
+            {
+              Size = osCurrentTask->IPCSize;
+              break;
+            }
+        #endif
+
+        /* Disallow modification of signal state */
+        WaitOnEmptyCompleted = TRUE;
+
+      /* Exit when buffer is empty */
+      #else
+        osSetLastError(ERR_QUEUE_IS_EMPTY);
+        break;
+      #endif
+    }
+
+    /* Position in buffer to read data and number of messages */
+    Position = QueueObject->Offset;
+    if(*Count > QueueObject->Object.Signal.Signaled)
+      *Count = QueueObject->Object.Signal.Signaled;
+
+    /* Limit the time for which interrupts are disabled during copying */
+    #if (OS_QUEUE_POST_PEND_MANY_FUNC)
+      #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+        if(ProtectByInt)
+      #endif
+          if(*Count > (INDEX) (OS_QUEUE_INT_CTRL_BATCH))
+            *Count = (INDEX) (OS_QUEUE_INT_CTRL_BATCH);
+    #endif
+
+    /* Remove messages, before interrupts are restored (avoids problem
+       occurring during task termination) */
+    QueueObject->Offset = (INDEX) ((QueueObject->Offset + *Count) %
+      QueueObject->MaxCount);
+
+    /* Leave critical section */
+    #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+      if(!ProtectByInt)
+        arRestore(PrevLockState);
+    #endif
+
+    /* Check maximal size */
+    if(Size > QueueObject->MessageSize)
+      Size = QueueObject->MessageSize;
+
+    /* Copy data */
+    osQueueCopy(QueueObject, Position, Buffer, Size, *Count, FALSE);
+
+    /* Enter critical section */
+    #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+      if(!ProtectByInt)
+        PrevLockState = arLock();
+    #endif
+
+    /* Begin delaying scheduler execution */
+    #if ((OS_QUEUE_ALLOW_WAIT_IF_EMPTY) || (OS_QUEUE_ALLOW_WAIT_IF_FULL) || \
+      (OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+      PrevISRState = osEnterISR();
+    #endif
+
+    /* Update main signal */
+    osUpdateSignalState(&QueueObject->Object.Signal,
+      QueueObject->Object.Signal.Signaled - *Count);
+
+    /* Completed waiting already acquired one message */
+    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+        osUpdateSignalState(&QueueObject->SyncOnEmpty,
+          QueueObject->SyncOnEmpty.Signaled - *Count +
+          (WaitOnEmptyCompleted ? 1 : 0));
+    #endif
+
+    #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_FULL)
+        osUpdateSignalState(&QueueObject->SyncOnFull,
+          QueueObject->SyncOnFull.Signaled + *Count);
+    #endif
+
+    /* Set success flag to TRUE when code was executed successfully */
+    Success = TRUE;
+    break;
+  }
+
+  /* Release mutex or auto-reset event */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if(!ProtectByInt)
+      osQueueUnlock(QueueObject, &QueueObject->RdSync);
+  #endif
+
+  /* Execute delayed scheduler */
+  #if ((OS_QUEUE_ALLOW_WAIT_IF_EMPTY) || (OS_QUEUE_ALLOW_WAIT_IF_FULL) || \
+    (OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if(Success)
+      osLeaveISR(PrevISRState);
+  #endif
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+
+  /* Return number of successfully transmitted bytes */
+  return Success ? Size : 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueIOCtrl
+ *
+ *  Description:
+ *    Processes device IO control codes for queue objects.
+ *
+ *  Parameters:
+ *    Object - Pointer to the system object.
+ *    ControlCode - Device IO control code.
+ *    Buffer - Pointer to the data buffer.
+ *    BufferSize - Size of the buffer.
+ *    IORequest - Pointer to the structure with additional settings.
+ *
+ *  Return:
+ *    Value specific to the specified device IO control code.
+ *
+ ***************************************************************************/
+
+static INDEX osQueueIOCtrl(struct TSysObject FAR *Object,
+  INDEX ControlCode, PVOID Buffer, SIZE BufferSize,
+  struct TIORequest *IORequest)
+{
+  struct TQueueObject FAR *QueueObject;
+  SIZE BytesTransferred;
+  INDEX Count;
+
+  /* Obtain queue descriptor */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+
+  /* Device IO transfers a single message */
+  Count = 1;
+
+  /* Execute specific operation */
+  switch(ControlCode)
+  {
+    /* Read from the queue */
+    case DEV_IO_CTL_READ:
+      BytesTransferred = osQueueRead(QueueObject, Buffer, BufferSize,
+        &Count, IORequest ? IORequest->Timeout : OS_INFINITE);
+      if(IORequest)
+        IORequest->NumberOfBytesTransferred = BytesTransferred;
+      return BytesTransferred != 0;
+
+    /* Write to the queue */
+    case DEV_IO_CTL_WRITE:
+      BytesTransferred = osQueueWrite(QueueObject, Buffer, BufferSize,
+        &Count, IORequest ? IORequest->Timeout : OS_INFINITE);
+      if(IORequest)
+        IORequest->NumberOfBytesTransferred = BytesTransferred;
+      return BytesTransferred != 0;
+
+    /* Signalization state of the lock-free queue (number of messages) */
+    #if (OS_QUEUE_ALLOW_SPSC)
+
+      case OS_IO_CTL_GET_SIGNAL_STATE:
+        QueueObject->Object.Signal.Signaled = osQueueSpscCount(QueueObject,
+          QueueObject->RdIndex, QueueObject->WrIndex);
+        return QueueObject->Object.Signal.Signaled;
+
+      /* Nothing to do when waiting for the lock-free queue */
+      case OS_IO_CTL_WAIT_ACQUIRE:
+      case OS_IO_CTL_WAIT_START:
+      case OS_IO_CTL_WAIT_UPDATE:
+      case OS_IO_CTL_WAIT_FAILURE:
+        return (INDEX) TRUE;
+
+    #endif
+  }
+
+  /* Not supported device IO control code */
+  osSetLastError(ERR_INVALID_DEVICE_IO_CTL);
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateQueue
+ *
+ *  Description:
+ *    Creates a queue object.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    Mode - Mode flags. Specifying values other than those listed below
+ *      will cause function failure. Features are available only when
+ *      enabled.
+ *
+ *      Protection Method (select one, defaults to Int Ctrl):
+ *      OS_IPC_PROTECT_INT_CTRL - Protection by interrupt disabling.
+ *      OS_IPC_PROTECT_EVENT - Protection by auto-reset event.
+ *      OS_IPC_PROTECT_MUTEX - Protection by mutex.
+ *
+ *      Data Transfer Flags:
+ *      OS_IPC_WAIT_IF_EMPTY - Enables waiting for read completion.
+ *      OS_IPC_WAIT_IF_FULL - Enables waiting for write completion.
+ *      OS_IPC_DIRECT_READ_WRITE - Enables direct read-write feature (must
+ *      be used with OS_IPC_WAIT_IF_EMPTY and/or OS_IPC_WAIT_IF_FULL).
+ *      OS_IPC_SPSC - Lock-free single-producer/single-consumer queue. The
+ *      queue may be written by one task or ISR and read by another one
+ *      without any locking; the kernel is entered only when a task must
+ *      wait or be resumed. Requires OS_IPC_PROTECT_INT_CTRL and cannot be
+ *      used with OS_IPC_DIRECT_READ_WRITE. Peek and clear operations may
+ *      be used only by the consumer.
+ *
+ *    MaxCount - Maximal number of messages.
+ *    MessageSize - Size of the message.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateQueue(SYSNAME Name, UINT8 Mode, INDEX MaxCount,
+  SIZE MessageSize)
+{
+  struct TQueueObject FAR *QueueObject;
+  struct TSysObject FAR *Object;
+  SIZE QueueDescSize;
+  BOOL InvalidParam;
+
+  /* Get size of the queue object descriptor */
+  QueueDescSize = AR_MEMORY_ALIGN_UP(sizeof(struct TQueueObject));
+
+  /* Check parameters */
+  InvalidParam = (Mode & ((UINT8) ~OS_QUEUE_MODE_MASK)) || !MessageSize ||
+    (MaxCount > ((((SIZE) (-1)) - QueueDescSize) / MessageSize));
+
+  /* Direct read-write feature (can be used only with OS_IPC_WAIT_IF_EMPTY
+     and/or OS_IPC_WAIT_IF_FULL flag) */
+  #if (OS_QUEUE_ALLOW_DIRECT_RW)
+    if(Mode & OS_IPC_DIRECT_READ_WRITE)
+      if(!(Mode & (OS_IPC_WAIT_IF_EMPTY | OS_IPC_WAIT_IF_FULL)))
+        InvalidParam = TRUE;
+  #endif
+
+  /* MaxCount must be greater than zero when direct read-write is not
+     enabled */
+  #if (OS_QUEUE_ALLOW_DIRECT_RW)
+    if(!(Mode & OS_IPC_DIRECT_READ_WRITE) && !MaxCount)
+      InvalidParam = TRUE;
+  #else
+    if(!MaxCount)
+      InvalidParam = TRUE;
+  #endif
+
+  /* Check the protection method */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if((Mode & OS_IPC_PROTECTION_MASK) == OS_IPC_PROTECT_MUTEX)
+      InvalidParam = TRUE;
+  #endif
+
+  /* Lock-free queue needs no protection, does not support direct
+     read-write and both its indexes must fit in the INDEX type */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(Mode & OS_IPC_SPSC)
+      if((Mode & (OS_IPC_PROTECTION_MASK | OS_IPC_DIRECT_READ_WRITE)) ||
+        !MaxCount || (MaxCount > (((INDEX) -1) / 2)))
+        InvalidParam = TRUE;
+  #endif
+
+  /* Return when some parameter is invalid */
+  if(InvalidParam)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return NULL_HANDLE;
+  }
+
+  /* Allocate memory for the object */
+  QueueObject = (struct TQueueObject FAR *)
+    osMemAlloc(QueueDescSize + MaxCount * MessageSize);
+  if(!QueueObject)
+    return NULL_HANDLE;
+
+  /* Pointer to system object descriptor */
+  Object = &QueueObject->Object;
+
+  /* Register new system object */
+  if(!osRegisterObject((PVOID) QueueObject, Object, OS_OBJECT_TYPE_QUEUE))
+  {
+    osMemFree(QueueObject);
+    return NULL_HANDLE;
+  }
+
+  /* Register name descriptor */
+  #if (OS_OPEN_QUEUE_FUNC)
+    if(!osRegisterName(Object, &QueueObject->Name, Name))
+    {
+      osDeleteObject(Object);
+      return NULL_HANDLE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(Name);
+  #endif
+
+  /* Setup the queue */
+  Object->Signal.Signaled = 0;
+  Object->Flags |= OS_OBJECT_FLAG_USES_IO_DEINIT;
+  Object->DeviceIOCtrl = osQueueIOCtrl;
+  QueueObject->Mode = Mode;
+  QueueObject->MaxCount = MaxCount;
+  QueueObject->MessageSize = MessageSize;
+  QueueObject->Offset = 0;
+  QueueObject->WrOffset = 0;
+
+  /* No message is accessed in place */
+  #if (OS_QUEUE_LOAN_FUNC)
+    QueueObject->WrLoan = FALSE;
+    QueueObject->RdLoan = FALSE;
+  #endif
+
+  /* Setup the lock-free queue, its state is determined by the indexes */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    QueueObject->RdIndex = 0;
+    QueueObject->WrIndex = 0;
+    if(Mode & OS_IPC_SPSC)
+      Object->Signal.Flags |= OS_SIGNAL_FLAG_USES_IO_SYSTEM;
+  #endif
+
+  /* Setup the auto-reset event / mutex for protection */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if((Mode & OS_IPC_PROTECTION_MASK) != OS_IPC_PROTECT_INT_CTRL)
+    {
+      /* Setup signal for write protection */
+      QueueObject->WrSync.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
+      QueueObject->WrSync.Signaled = (INDEX) TRUE;
+      stBSTreeInit(&QueueObject->WrSync.WaitingTasks, osWaitAssocCmp);
+
+      /* Setup signal for read protection */
+      QueueObject->RdSync.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
+      QueueObject->RdSync.Signaled = (INDEX) TRUE;
+      stBSTreeInit(&QueueObject->RdSync.WaitingTasks, osWaitAssocCmp);
+
+      #if (OS_USE_CSEC_OBJECTS)
+        QueueObject->WrSync.CS = NULL;
+        QueueObject->RdSync.CS = NULL;
+      #endif
+
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        QueueObject->WrSync.Object = Object;
+        QueueObject->RdSync.Object = Object;
+      #endif
+
+      /* Multiple signals associated with object */
+      #if (OS_ALLOW_OBJECT_DELETION)
+        Object->Signal.NextSignal = &QueueObject->WrSync;
+        QueueObject->WrSync.NextSignal = &QueueObject->RdSync;
+        QueueObject->RdSync.NextSignal = NULL;
+      #endif
+    }
+  #endif
+
+  /* Register the mutex for protection */
+  #if (OS_QUEUE_PROTECT_MUTEX)
+    if((Mode & OS_IPC_PROTECTION_MASK) == OS_IPC_PROTECT_MUTEX)
+    {
+      osRegisterCS(&QueueObject->WrSync, &QueueObject->WrCS, 1, 1, TRUE);
+      osRegisterCS(&QueueObject->RdSync, &QueueObject->RdCS, 1, 1, TRUE);
+    }
+  #endif
+
+  /* Setup signal used for waiting for incoming data */
+  #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+    if(Mode & OS_IPC_WAIT_IF_EMPTY)
+    {
+      QueueObject->SyncOnEmpty.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
+      QueueObject->SyncOnEmpty.Signaled = 0;
+      stBSTreeInit(&QueueObject->SyncOnEmpty.WaitingTasks, osWaitAssocCmp);
+
+      #if (OS_USE_CSEC_OBJECTS)
+        QueueObject->SyncOnEmpty.CS = NULL;
+      #endif
+
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        QueueObject->SyncOnEmpty.Object = Object;
+      #endif
+
+      /* Multiple signals associated with the object */
+      #if (OS_ALLOW_OBJECT_DELETION)
+        QueueObject->SyncOnEmpty.NextSignal = Object->Signal.NextSignal;
+        Object->Signal.NextSignal = &QueueObject->SyncOnEmpty;
+      #endif
+    }
+  #endif
+
+  /* Setup signal used for waiting for outgoing data */
+  #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+    if(Mode & OS_IPC_WAIT_IF_FULL)
+    {
+      QueueObject->SyncOnFull.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
+      QueueObject->SyncOnFull.Signaled = MaxCount;
+
+      /* Lock-free queue uses the signal only to resume the producer */
+      #if (OS_QUEUE_ALLOW_SPSC)
+        if(Mode & OS_IPC_SPSC)
+          QueueObject->SyncOnFull.Signaled = 0;
+      #endif
+
+      stBSTreeInit(&QueueObject->SyncOnFull.WaitingTasks, osWaitAssocCmp);
+
+      #if (OS_USE_CSEC_OBJECTS)
+        QueueObject->SyncOnFull.CS = NULL;
+      #endif
+
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        QueueObject->SyncOnFull.Object = Object;
+      #endif
+
+      /* Multiple signals associated with the object */
+      #if (OS_ALLOW_OBJECT_DELETION)
+        QueueObject->SyncOnFull.NextSignal = Object->Signal.NextSignal;
+        Object->Signal.NextSignal = &QueueObject->SyncOnFull;
       #endif
     }
-  #endif
+  #endif
+
+  /* Mark object as ready to use and return its handle */
+  Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
+  return Object->Handle;
+}
+
+
+/***************************************************************************/
+#if (OS_OPEN_QUEUE_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osOpenQueue
+ *
+ *  Description:
+ *    Opens an existing queue object.
+ *
+ *  Parameters:
+ *    Name - Name of the existing object.
+ *
+ *  Return:
+ *    Handle of the object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osOpenQueue(SYSNAME Name)
+{
+  struct TSysObject FAR *Object;
+
+  /* Open named object */
+  Object = osOpenNamedObject(Name, OS_OBJECT_TYPE_QUEUE);
+
+  /* Return handle of the opened object or NULL_HANDLE on failure */
+  return Object ? Object->Handle : NULL_HANDLE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_OPEN_QUEUE_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_QUEUE_POST_PEND_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueuePost
+ *
+ *  Description:
+ *    Appends data to the specified queue.
+ *
+ *  Parameters:
+ *    Handle - Handle of the queue.
+ *    Buffer - Pointer to the buffer with data.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osQueuePost(HANDLE Handle, PVOID Buffer)
+{
+  struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
+  INDEX Count;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return FALSE;
+
+  /* Write data to queue */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+  Count = 1;
+  return osQueueWrite(QueueObject, Buffer, QueueObject->MessageSize,
+    &Count, OS_INFINITE) != 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueuePend
+ *
+ *  Description:
+ *    Reads and then removes data from the specified queue.
+ *
+ *  Parameters:
+ *    Handle - Handle of the queue.
+ *    Buffer - Pointer to the buffer for data.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osQueuePend(HANDLE Handle, PVOID Buffer)
+{
+  struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
+  INDEX Count;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return FALSE;
+
+  /* Write data to queue */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+  Count = 1;
+  return osQueueRead(QueueObject, Buffer, QueueObject->MessageSize,
+    &Count, OS_INFINITE) != 0;
+}
+
+
+/***************************************************************************/
+#endif /* OS_QUEUE_POST_PEND_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_QUEUE_POST_PEND_MANY_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueuePostMany
+ *
+ *  Description:
+ *    Appends several messages to the specified queue at once. All stored
+ *    messages cost a single handle lookup, critical section and update of
+ *    the queue signals. The function waits only when the queue is full
+ *    and then stores as many messages as fit in the queue. A queue
+ *    protected by interrupt disabling stores at most
+ *    OS_QUEUE_INT_CTRL_BATCH messages per call.
+ *
+ *  Parameters:
+ *    Handle - Handle of the queue.
+ *    Buffer - Pointer to the buffer with consecutive messages.
+ *    Count - Number of messages in the buffer.
+ *
+ *  Return:
+ *    Number of messages stored or zero on failure.
+ *
+ ***************************************************************************/
+
+INDEX osQueuePostMany(HANDLE Handle, PVOID Buffer, INDEX Count)
+{
+  struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return 0;
+
+  /* Write data to queue */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+  return osQueueWrite(QueueObject, Buffer, QueueObject->MessageSize,
+    &Count, OS_INFINITE) ? Count : 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueuePendMany
+ *
+ *  Description:
+ *    Reads and then removes several messages from the specified queue at
+ *    once. All removed messages cost a single handle lookup, critical
+ *    section and update of the queue signals. The function waits only
+ *    when the queue is empty and then removes all available messages up
+ *    to the specified number. A queue protected by interrupt disabling
+ *    removes at most OS_QUEUE_INT_CTRL_BATCH messages per call.
+ *
+ *  Parameters:
+ *    Handle - Handle of the queue.
+ *    Buffer - Pointer to the buffer for consecutive messages.
+ *    Count - Maximal number of messages the buffer can hold.
+ *
+ *  Return:
+ *    Number of messages read or zero on failure.
+ *
+ ***************************************************************************/
+
+INDEX osQueuePendMany(HANDLE Handle, PVOID Buffer, INDEX Count)
+{
+  struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return 0;
+
+  /* Read data from queue */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+  return osQueueRead(QueueObject, Buffer, QueueObject->MessageSize,
+    &Count, OS_INFINITE) ? Count : 0;
+}
+
+
+/***************************************************************************/
+#endif /* OS_QUEUE_POST_PEND_MANY_FUNC */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (OS_QUEUE_LOAN_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osQueueReserve
+ *
+ *  Description:
+ *    Reserves space for the next message in the specified queue and
+ *    returns the pointer to it, so the message may be built in place
+ *    (e.g. by DMA) and appended by osQueueCommit without being copied.
+ *    Only one message may be reserved at a time. Available only for
+ *    lock-free queues (called by the producer) and for queues protected
+ *    by event or mutex, which stay locked for writing until the message
+ *    is committed by the same task. Waits while the queue is full.
+ *
+ *  Parameters:
+ *    Handle - Handle of the queue.
+ *
+ *  Return:
+ *    Pointer to the message or NULL on failure.
+ *
+ ***************************************************************************/
+
+PVOID osQueueReserve(HANDLE Handle)
+{
+  struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
+
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    BOOL PrevLockState;
+    PVOID Message;
+  #endif
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return NULL;
+
+  /* Get queue object pointer */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
+
+  /* Lock-free queue (messages may be reserved only by producer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Only one message may be reserved */
+      if(QueueObject->WrLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        return NULL;
+      }
+
+      /* Wait until there is space for the message */
+      if(!osQueueSpscWaitForSpace(QueueObject, OS_INFINITE))
+        return NULL;
+
+      /* Return the message at the write index */
+      QueueObject->WrLoan = TRUE;
+      return osQueueMessage(QueueObject,
+        osQueueSpscPosition(QueueObject, QueueObject->WrIndex));
+    }
+  #endif
+
+  /* Queue protected by interrupt disabling can not stay locked and
+     direct read-write passes messages beside the queue buffer */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if(!(QueueObject->Mode & OS_IPC_PROTECTION_MASK) ||
+      (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      return NULL;
+    }
+
+    /* Operation can be performed only by a task */
+    if(!osCurrentTask || osInISR)
+    {
+      osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+      return NULL;
+    }
 
-  /* Setup signal used for waiting for outgoing data */
-  #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
-    if(Mode & OS_IPC_WAIT_IF_FULL)
+    /* Wait for write access synchronization */
+    if(!osQueueLock(QueueObject, &QueueObject->WrSync, OS_INFINITE))
+      return NULL;
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* This loop is executed once and it is used to simplify code
+       structure */
+    Message = NULL;
+    while(1)
     {
-      QueueObject->SyncOnFull.Flags = OS_SIGNAL_FLAG_DEC_ON_RELEASE;
-      QueueObject->SyncOnFull.Signaled = MaxCount;
-      stBSTreeInit(&QueueObject->SyncOnFull.WaitingTasks, osWaitAssocCmp);
+      /* Only one message may be reserved */
+      if(QueueObject->WrLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        break;
+      }
 
-      #if (OS_USE_CSEC_OBJECTS)
-        QueueObject->SyncOnFull.CS = NULL;
-      #endif
+      /* When buffer is full */
+      if(Object->Signal.Signaled >= QueueObject->MaxCount)
+      {
+        /* Waiting for buffer space */
+        #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
 
-      /* Multiple signals associated with the object */
-      #if (OS_ALLOW_OBJECT_DELETION)
-        QueueObject->SyncOnFull.NextSignal = Object->Signal.NextSignal;
-        Object->Signal.NextSignal = &QueueObject->SyncOnFull;
-      #endif
+          /* Exit when not enabled */
+          if(!(QueueObject->Mode & OS_IPC_WAIT_IF_FULL))
+          {
+            osSetLastError(ERR_QUEUE_IS_FULL);
+            break;
+          }
+
+          /* Wait when buffer is full */
+          if(!osWaitFor(&QueueObject->SyncOnFull, OS_INFINITE))
+            break;
+
+          /* Space acquired by waiting is taken again on commit */
+          osUpdateSignalState(&QueueObject->SyncOnFull,
+            QueueObject->SyncOnFull.Signaled + 1);
+
+        /* Exit when buffer is full */
+        #else
+          osSetLastError(ERR_QUEUE_IS_FULL);
+          break;
+        #endif
+      }
+
+      /* Return the message at the write position */
+      QueueObject->WrLoan = TRUE;
+      QueueObject->WrLoanTask = osCurrentTask;
+      Message = osQueueMessage(QueueObject, QueueObject->WrOffset);
+      break;
     }
-  #endif
 
-  /* Mark object as ready to use and return its handle */
-  Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
-  return Object->Handle;
-}
+    /* The queue stays locked until the message is committed */
+    if(!Message)
+      osQueueUnlock(QueueObject, &QueueObject->WrSync);
 
+    /* Leave critical section */
+    arRestore(PrevLockState);
+    return Message;
 
-/***************************************************************************/
-#if (OS_OPEN_QUEUE_FUNC)
-/***************************************************************************/
+  /* No other queue supports reservation */
+  #else
+    osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+    return NULL;
+  #endif
+}
 
 
 /****************************************************************************
  *
  *  Name:
- *    osOpenQueue
+ *    osQueueCommit
  *
  *  Description:
- *    Opens an existing queue object.
+ *    Appends the message reserved by osQueueReserve to the specified
+ *    queue and unlocks the queue for writing. A locked queue fails with
+ *    ERR_NO_LOANED_BUFFER unless called by the task which reserved the
+ *    message.
  *
  *  Parameters:
- *    Name - Name of the existing object.
+ *    Handle - Handle of the queue.
  *
  *  Return:
- *    Handle of the object or NULL_HANDLE on failure.
+ *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-HANDLE osOpenQueue(SYSNAME Name)
+BOOL osQueueCommit(HANDLE Handle)
 {
   struct TSysObject FAR *Object;
+  struct TQueueObject FAR *QueueObject;
 
-  /* Open named object */
-  Object = osOpenNamedObject(Name, OS_OBJECT_TYPE_QUEUE);
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    BOOL PrevLockState, PrevISRState;
+  #endif
 
-  /* Return handle of the opened object or NULL_HANDLE on failure */
-  return Object ? Object->Handle : NULL_HANDLE;
-}
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
+  if(!Object)
+    return FALSE;
 
+  /* Get queue object pointer */
+  QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
 
-/***************************************************************************/
-#endif /* OS_OPEN_QUEUE_FUNC */
-/***************************************************************************/
+  /* Lock-free queue (messages may be committed only by producer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Return if no message is reserved */
+      if(!QueueObject->WrLoan)
+      {
+        osSetLastError(ERR_NO_LOANED_BUFFER);
+        return FALSE;
+      }
 
+      /* Publish the message */
+      QueueObject->WrLoan = FALSE;
+      osQueueSpscPublish(QueueObject, 1);
+      return TRUE;
+    }
+  #endif
 
-/***************************************************************************/
-#if (OS_QUEUE_POST_PEND_FUNC)
-/***************************************************************************/
+  /* Enter critical section */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    PrevLockState = arLock();
+
+    /* Return if no message is reserved by the calling task */
+    if(!QueueObject->WrLoan || (QueueObject->WrLoanTask != osCurrentTask) ||
+      osInISR)
+    {
+      arRestore(PrevLockState);
+      osSetLastError(ERR_NO_LOANED_BUFFER);
+      return FALSE;
+    }
+
+    /* Begin delaying scheduler execution */
+    QueueObject->WrLoan = FALSE;
+    PrevISRState = osEnterISR();
+
+    /* Append message */
+    QueueObject->WrOffset = (INDEX) ((QueueObject->WrOffset + 1) %
+      QueueObject->MaxCount);
+
+    /* Update main signal */
+    osUpdateSignalState(&Object->Signal, Object->Signal.Signaled + 1);
+
+    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+        osUpdateSignalState(&QueueObject->SyncOnEmpty,
+          QueueObject->SyncOnEmpty.Signaled + 1);
+    #endif
+
+    #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_FULL)
+        osUpdateSignalState(&QueueObject->SyncOnFull,
+          QueueObject->SyncOnFull.Signaled - 1);
+    #endif
+
+    /* Release mutex or auto-reset event */
+    osQueueUnlock(QueueObject, &QueueObject->WrSync);
+
+    /* Execute delayed scheduler */
+    osLeaveISR(PrevISRState);
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+    return TRUE;
+
+  /* No other queue supports reservation */
+  #else
+    osSetLastError(ERR_NO_LOANED_BUFFER);
+    return FALSE;
+  #endif
+}
 
 
 /****************************************************************************
  *
  *  Name:
- *    osQueuePost
+ *    osQueueAcquire
  *
  *  Description:
- *    Appends data to the specified queue.
+ *    Returns the pointer to the first message in the specified queue, so
+ *    it may be processed in place and removed by osQueueRelease without
+ *    being copied. Only one message may be acquired at a time. Available
+ *    only for lock-free queues (called by the consumer) and for queues
+ *    protected by event or mutex, which stay locked for reading until the
+ *    message is released by the same task. Waits while the queue is
+ *    empty.
  *
  *  Parameters:
  *    Handle - Handle of the queue.
- *    Buffer - Pointer to the buffer with data.
  *
  *  Return:
- *    TRUE on success or FALSE on failure.
+ *    Pointer to the message or NULL on failure.
  *
  ***************************************************************************/
 
-BOOL osQueuePost(HANDLE Handle, PVOID Buffer)
+PVOID osQueueAcquire(HANDLE Handle)
 {
   struct TSysObject FAR *Object;
   struct TQueueObject FAR *QueueObject;
 
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    BOOL PrevLockState;
+    PVOID Message;
+  #endif
+
   /* Get object by handle */
   Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
   if(!Object)
-    return FALSE;
+    return NULL;
 
-  /* Write data to queue */
+  /* Get queue object pointer */
   QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
-  return osQueueWrite(QueueObject, Buffer, QueueObject->MessageSize,
-    OS_INFINITE) != 0;
+
+  /* Lock-free queue (messages may be acquired only by consumer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Only one message may be acquired */
+      if(QueueObject->RdLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        return NULL;
+      }
+
+      /* Wait until there is a message */
+      if(!osQueueSpscWaitForData(QueueObject, OS_INFINITE))
+        return NULL;
+
+      /* Return the message at the read index */
+      QueueObject->RdLoan = TRUE;
+      return osQueueMessage(QueueObject,
+        osQueueSpscPosition(QueueObject, QueueObject->RdIndex));
+    }
+  #endif
+
+  /* Queue protected by interrupt disabling can not stay locked and
+     direct read-write passes messages beside the queue buffer */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    if(!(QueueObject->Mode & OS_IPC_PROTECTION_MASK) ||
+      (QueueObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      return NULL;
+    }
+
+    /* Operation can be performed only by a task */
+    if(!osCurrentTask || osInISR)
+    {
+      osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+      return NULL;
+    }
+
+    /* Wait for read access synchronization */
+    if(!osQueueLock(QueueObject, &QueueObject->RdSync, OS_INFINITE))
+      return NULL;
+
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    /* This loop is executed once and it is used to simplify code
+       structure */
+    Message = NULL;
+    while(1)
+    {
+      /* Only one message may be acquired */
+      if(QueueObject->RdLoan)
+      {
+        osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+        break;
+      }
+
+      /* When buffer is empty */
+      if(!Object->Signal.Signaled)
+      {
+        /* Waiting for buffer */
+        #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+
+          /* Exit when not enabled */
+          if(!(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY))
+          {
+            osSetLastError(ERR_QUEUE_IS_EMPTY);
+            break;
+          }
+
+          /* Wait when buffer is empty */
+          if(!osWaitFor(&QueueObject->SyncOnEmpty, OS_INFINITE))
+            break;
+
+          /* Message acquired by waiting is taken again on release */
+          osUpdateSignalState(&QueueObject->SyncOnEmpty,
+            QueueObject->SyncOnEmpty.Signaled + 1);
+
+        /* Exit when buffer is empty */
+        #else
+          osSetLastError(ERR_QUEUE_IS_EMPTY);
+          break;
+        #endif
+      }
+
+      /* Return the message at the read position */
+      QueueObject->RdLoan = TRUE;
+      QueueObject->RdLoanTask = osCurrentTask;
+      Message = osQueueMessage(QueueObject, QueueObject->Offset);
+      break;
+    }
+
+    /* The queue stays locked until the message is released */
+    if(!Message)
+      osQueueUnlock(QueueObject, &QueueObject->RdSync);
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+    return Message;
+
+  /* No other queue supports acquiring */
+  #else
+    osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+    return NULL;
+  #endif
 }
 
 
 /****************************************************************************
  *
  *  Name:
- *    osQueuePend
+ *    osQueueRelease
  *
  *  Description:
- *    Reads and then removes data from the specified queue.
+ *    Removes the message acquired by osQueueAcquire from the specified
+ *    queue and unlocks the queue for reading. A locked queue fails with
+ *    ERR_NO_LOANED_BUFFER unless called by the task which acquired the
+ *    message.
  *
  *  Parameters:
  *    Handle - Handle of the queue.
- *    Buffer - Pointer to the buffer for data.
  *
  *  Return:
  *    TRUE on success or FALSE on failure.
  *
  ***************************************************************************/
 
-BOOL osQueuePend(HANDLE Handle, PVOID Buffer)
+BOOL osQueueRelease(HANDLE Handle)
 {
   struct TSysObject FAR *Object;
   struct TQueueObject FAR *QueueObject;
 
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    BOOL PrevLockState, PrevISRState;
+  #endif
+
   /* Get object by handle */
   Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_QUEUE);
   if(!Object)
     return FALSE;
 
-  /* Write data to queue */
+  /* Get queue object pointer */
   QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
-  return osQueueRead(QueueObject, Buffer, QueueObject->MessageSize,
-    OS_INFINITE) != 0;
+
+  /* Lock-free queue (messages may be released only by consumer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Return if no message is acquired */
+      if(!QueueObject->RdLoan)
+      {
+        osSetLastError(ERR_NO_LOANED_BUFFER);
+        return FALSE;
+      }
+
+      /* Remove the message */
+      QueueObject->RdLoan = FALSE;
+      osQueueSpscConsume(QueueObject, 1);
+      return TRUE;
+    }
+  #endif
+
+  /* Enter critical section */
+  #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+    PrevLockState = arLock();
+
+    /* Return if no message is acquired by the calling task */
+    if(!QueueObject->RdLoan || (QueueObject->RdLoanTask != osCurrentTask) ||
+      osInISR)
+    {
+      arRestore(PrevLockState);
+      osSetLastError(ERR_NO_LOANED_BUFFER);
+      return FALSE;
+    }
+
+    /* Begin delaying scheduler execution */
+    QueueObject->RdLoan = FALSE;
+    PrevISRState = osEnterISR();
+
+    /* Remove message */
+    QueueObject->Offset = (INDEX) ((QueueObject->Offset + 1) %
+      QueueObject->MaxCount);
+
+    /* Update main signal */
+    osUpdateSignalState(&Object->Signal, Object->Signal.Signaled - 1);
+
+    #if (OS_QUEUE_ALLOW_WAIT_IF_EMPTY)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+        osUpdateSignalState(&QueueObject->SyncOnEmpty,
+          QueueObject->SyncOnEmpty.Signaled - 1);
+    #endif
+
+    #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+      if(QueueObject->Mode & OS_IPC_WAIT_IF_FULL)
+        osUpdateSignalState(&QueueObject->SyncOnFull,
+          QueueObject->SyncOnFull.Signaled + 1);
+    #endif
+
+    /* Release mutex or auto-reset event */
+    osQueueUnlock(QueueObject, &QueueObject->RdSync);
+
+    /* Execute delayed scheduler */
+    osLeaveISR(PrevISRState);
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+    return TRUE;
+
+  /* No other queue supports acquiring */
+  #else
+    osSetLastError(ERR_NO_LOANED_BUFFER);
+    return FALSE;
+  #endif
 }
 
 
 /***************************************************************************/
-#endif /* OS_QUEUE_POST_PEND_FUNC */
+#endif /* OS_QUEUE_LOAN_FUNC */
 /***************************************************************************/
 
 
@@ -1169,6 +2532,26 @@ BOOL osQueuePeek(HANDLE Handle, PVOID Buffer)
   /* Get queue object pointer */
   QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
 
+  /* Lock-free queue (the first message may be read only by consumer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Return if queue is empty */
+      if(QueueObject->WrIndex == QueueObject->RdIndex)
+      {
+        osSetLastError(ERR_QUEUE_IS_EMPTY);
+        return FALSE;
+      }
+
+      /* Copy data */
+      OS_MEMORY_BARRIER();
+      osQueueCopy(QueueObject,
+        osQueueSpscPosition(QueueObject, QueueObject->RdIndex), Buffer,
+        QueueObject->MessageSize, 1, FALSE);
+      return TRUE;
+    }
+  #endif
+
   /* Enter critical section */
   PrevLockState = arLock();
 
@@ -1274,6 +2657,10 @@ BOOL osClearQueue(HANDLE Handle)
   struct TQueueObject FAR *QueueObject;
   BOOL PrevLockState;
 
+  #if (OS_QUEUE_ALLOW_SPSC)
+    INDEX WrIndex;
+  #endif
+
   #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
     BOOL ProtectByInt;
   #endif
@@ -1291,6 +2678,43 @@ BOOL osClearQueue(HANDLE Handle)
   /* Get queue object pointer */
   QueueObject = (struct TQueueObject FAR *) Object->ObjectDesc;
 
+  /* Lock-free queue (messages may be removed only by consumer) */
+  #if (OS_QUEUE_ALLOW_SPSC)
+    if(QueueObject->Mode & OS_IPC_SPSC)
+    {
+      /* Return if the first message is acquired */
+      #if (OS_QUEUE_LOAN_FUNC)
+        if(QueueObject->RdLoan)
+        {
+          osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+          return FALSE;
+        }
+      #endif
+
+      /* Return if queue is empty */
+      WrIndex = QueueObject->WrIndex;
+      if(WrIndex == QueueObject->RdIndex)
+      {
+        osSetLastError(ERR_QUEUE_IS_EMPTY);
+        return FALSE;
+      }
+
+      /* Remove all messages */
+      QueueObject->RdIndex = WrIndex;
+      OS_MEMORY_BARRIER();
+
+      /* Resume waiting tasks */
+      #if (OS_QUEUE_ALLOW_WAIT_IF_FULL)
+        osQueueSpscNotify(QueueObject,
+          (QueueObject->Mode & OS_IPC_WAIT_IF_FULL) ?
+          &QueueObject->SyncOnFull : NULL);
+      #else
+        osQueueSpscNotify(QueueObject, NULL);
+      #endif
+      return TRUE;
+    }
+  #endif
+
   /* Enter critical section */
   PrevLockState = arLock();
 
@@ -1335,9 +2759,23 @@ BOOL osClearQueue(HANDLE Handle)
     return FALSE;
   }
 
+  /* Return if the first message is acquired */
+  #if (OS_QUEUE_LOAN_FUNC)
+    if(QueueObject->RdLoan)
+    {
+      #if ((OS_QUEUE_PROTECT_EVENT) || (OS_QUEUE_PROTECT_MUTEX))
+        if(!ProtectByInt)
+          osQueueUnlock(QueueObject, &QueueObject->RdSync);
+      #endif
+
+      arRestore(PrevLockState);
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      return FALSE;
+    }
+  #endif
+
   /* Remove all messages */
-  QueueObject->Offset = (QueueObject->Offset + Object->Signal.Signaled) %
-    QueueObject->MaxCount;
+  QueueObject->Offset = QueueObject->WrOffset;
 
   /* Begin delaying scheduler execution */
   #if ((OS_QUEUE_ALLOW_WAIT_IF_EMPTY) || (OS_QUEUE_ALLOW_WAIT_IF_FULL) || \
@@ -56,6 +56,25 @@
   #error OS_QUEUE_POST_PEND_FUNC must be 0 when OS_USE_QUEUE is 0
 #endif
 
+/* Enable osQueuePostMany and osQueuePendMany by default */
+#ifndef OS_QUEUE_POST_PEND_MANY_FUNC
+  #define OS_QUEUE_POST_PEND_MANY_FUNC  (OS_USE_QUEUE)
+#elif (((OS_QUEUE_POST_PEND_MANY_FUNC) != 0) && \
+  ((OS_QUEUE_POST_PEND_MANY_FUNC) != 1))
+  #error OS_QUEUE_POST_PEND_MANY_FUNC must be either 0 or 1
+#elif (((OS_QUEUE_POST_PEND_MANY_FUNC) != 0) && !(OS_USE_QUEUE))
+  #error OS_QUEUE_POST_PEND_MANY_FUNC must be 0 when OS_USE_QUEUE is 0
+#endif
+
+/* Maximal number of messages transferred at once by osQueuePostMany and
+   osQueuePendMany when the queue is protected by interrupt disabling (the
+   messages are copied with interrupts disabled) */
+#ifndef OS_QUEUE_INT_CTRL_BATCH
+  #define OS_QUEUE_INT_CTRL_BATCH       8UL
+#elif ((OS_QUEUE_INT_CTRL_BATCH) < 1UL)
+  #error OS_QUEUE_INT_CTRL_BATCH must be greater than zero
+#endif
+
 /* Enable osQueuePeek by default */
 #ifndef OS_QUEUE_PEEK_FUNC
   #define OS_QUEUE_PEEK_FUNC            (OS_USE_QUEUE)
@@ -124,6 +143,31 @@
     (WAIT_IF_EMPTY and WAIT_IF_FULL) to be enabled
 #endif
 
+/* Enable Queue single-producer/single-consumer lock-free mode (requires
+   INDEX values to be loaded and stored atomically by the CPU) */
+#ifndef OS_QUEUE_ALLOW_SPSC
+  #define OS_QUEUE_ALLOW_SPSC           (OS_USE_QUEUE)
+#elif (((OS_QUEUE_ALLOW_SPSC) != 0) && ((OS_QUEUE_ALLOW_SPSC) != 1))
+  #error OS_QUEUE_ALLOW_SPSC must be either 0 or 1
+#elif (((OS_QUEUE_ALLOW_SPSC) != 0) && !(OS_USE_QUEUE))
+  #error OS_QUEUE_ALLOW_SPSC must be 0 when OS_USE_QUEUE is 0
+#endif
+
+/* Enable osQueueReserve, osQueueCommit, osQueueAcquire and osQueueRelease
+   (messages accessed in place) when the queue may be protected by event,
+   mutex or be lock-free */
+#ifndef OS_QUEUE_LOAN_FUNC
+  #define OS_QUEUE_LOAN_FUNC            ((OS_QUEUE_PROTECT_EVENT) || \
+                                        (OS_QUEUE_PROTECT_MUTEX) || \
+                                        (OS_QUEUE_ALLOW_SPSC))
+#elif (((OS_QUEUE_LOAN_FUNC) != 0) && ((OS_QUEUE_LOAN_FUNC) != 1))
+  #error OS_QUEUE_LOAN_FUNC must be either 0 or 1
+#elif (((OS_QUEUE_LOAN_FUNC) != 0) && !((OS_QUEUE_PROTECT_EVENT) || \
+  (OS_QUEUE_PROTECT_MUTEX) || (OS_QUEUE_ALLOW_SPSC)))
+  #error OS_QUEUE_LOAN_FUNC requires event or mutex protection or \
+    lock-free mode to be enabled
+#endif
+
 
 /****************************************************************************
  *
@@ -154,6 +198,11 @@
   #define OS_USE_MULTIPLE_SIGNALS       1
 #endif
 
+/* Enable System I/O Control codes (state of lock-free queues) */
+#if ((OS_QUEUE_ALLOW_SPSC) && !defined(OS_USE_SYSTEM_IO_CTRL))
+  #define OS_USE_SYSTEM_IO_CTRL         1
+#endif
+
 /* Enable Direct Read-Write IPC feature */
 #if ((OS_USE_QUEUE) && !defined(OS_USE_IPC_DIRECT_RW) && \
   (OS_QUEUE_ALLOW_DIRECT_RW))
@@ -194,6 +243,18 @@
       BOOL osQueuePend(HANDLE Handle, PVOID Buffer);
     #endif
 
+    #if (OS_QUEUE_POST_PEND_MANY_FUNC)
+      INDEX osQueuePostMany(HANDLE Handle, PVOID Buffer, INDEX Count);
+      INDEX osQueuePendMany(HANDLE Handle, PVOID Buffer, INDEX Count);
+    #endif
+
+    #if (OS_QUEUE_LOAN_FUNC)
+      PVOID osQueueReserve(HANDLE Handle);
+      BOOL osQueueCommit(HANDLE Handle);
+      PVOID osQueueAcquire(HANDLE Handle);
+      BOOL osQueueRelease(HANDLE Handle);
+    #endif
+
     #if (OS_QUEUE_PEEK_FUNC)
       BOOL osQueuePeek(HANDLE Handle, PVOID Buffer);
     #endif
@@ -0,0 +1,446 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_RWLock.c - Reader-writer lock object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_Core.h"
+
+
+/***************************************************************************/
+#if (OS_USE_RWLOCK)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Reader-writer lock object descriptor.
+   The lock is a critical section with MaxReaders units: a reader owns one
+   unit and a writer owns all of them. Ownership of the units is tracked by
+   the critical section associations, so priority inheritance and deadlock
+   detection work for writers blocked by readers as well. Writers are
+   serialized by the gate mutex and collect the units one by one, so a
+   reader coming later waits behind the collecting writer. With the writer
+   preference, readers pass the gate too and so they also wait behind the
+   writers queued at the gate. */
+struct TRWLockObject
+{
+  /* System object descriptor */
+  struct TSysObject Object;
+
+  /* System object name descriptor */
+  #if (OS_OPEN_RWLOCK_FUNC)
+    struct TObjectName Name;
+  #endif
+
+  /* Writer gate */
+  struct TSignal Gate;
+  struct TCriticalSection GateCS;
+
+  /* Task owning the lock for exclusive access */
+  struct TTask FAR *Writer;
+
+  /* Maximal number of readers */
+  INDEX MaxReaders;
+
+  /* Readers wait behind the writers queued at the gate */
+  BOOL WriterPreference;
+
+  /* Critical section descriptor (must be the last member) */
+  struct TCriticalSection CS;
+};
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateRWLock
+ *
+ *  Description:
+ *    Creates a reader-writer lock object.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    MaxReaders - The maximal number of tasks owning the lock for shared
+ *      access at the same time.
+ *    WriterPreference - When TRUE, new readers are not admitted while some
+ *      writer waits for the lock. Otherwise they wait only for the writer
+ *      which is acquiring or owning the lock.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateRWLock(SYSNAME Name, INDEX MaxReaders, BOOL WriterPreference)
+{
+  struct TRWLockObject FAR *RWLockObject;
+  struct TSysObject FAR *Object;
+
+  /* At least one reader must be allowed */
+  if(!MaxReaders)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return NULL_HANDLE;
+  }
+
+  /* Allocate memory for the object.
+     Allocation size includes space for the critical section associations. */
+  RWLockObject = (struct TRWLockObject FAR *) osMemAlloc(
+    sizeof(*RWLockObject) + (MaxReaders - 1) * sizeof(struct TCSAssoc));
+  if(!RWLockObject)
+    return NULL_HANDLE;
+
+  /* Pointer to system object descriptor */
+  Object = &RWLockObject->Object;
+
+  /* Register new system object */
+  if(!osRegisterObject((PVOID) RWLockObject, Object, OS_OBJECT_TYPE_RWLOCK))
+  {
+    osMemFree(RWLockObject);
+    return NULL_HANDLE;
+  }
+
+  /* Register name descriptor */
+  #if (OS_OPEN_RWLOCK_FUNC)
+    if(!osRegisterName(Object, &RWLockObject->Name, Name))
+    {
+      osDeleteObject(Object);
+      return NULL_HANDLE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(Name);
+  #endif
+
+  /* Setup the lock */
+  RWLockObject->Writer = NULL;
+  RWLockObject->MaxReaders = MaxReaders;
+  RWLockObject->WriterPreference = WriterPreference;
+
+  /* Multiple signals associated with object */
+  #if (OS_ALLOW_OBJECT_DELETION)
+    Object->Signal.NextSignal = &RWLockObject->Gate;
+    RWLockObject->Gate.NextSignal = NULL;
+  #endif
+
+  /* Object of the signal (latency histogram and lock statistics) */
+  #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+    RWLockObject->Gate.Object = Object;
+  #endif
+
+  /* Register critical section descriptors */
+  osRegisterCS(&RWLockObject->Gate, &RWLockObject->GateCS, 1, 1, TRUE);
+  osRegisterCS(&Object->Signal, &RWLockObject->CS, MaxReaders,
+    MaxReaders, FALSE);
+
+  /* Mark object as ready to use and return its handle */
+  Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
+  return Object->Handle;
+}
+
+
+/***************************************************************************/
+#if (OS_OPEN_RWLOCK_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osOpenRWLock
+ *
+ *  Description:
+ *    Opens an existing reader-writer lock object.
+ *
+ *  Parameters:
+ *    Name - Name of the existing object.
+ *
+ *  Return:
+ *    Handle of the object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osOpenRWLock(SYSNAME Name)
+{
+  struct TSysObject FAR *Object;
+
+  /* Open named object */
+  Object = osOpenNamedObject(Name, OS_OBJECT_TYPE_RWLOCK);
+
+  /* Return handle of the opened object or NULL_HANDLE on failure */
+  return Object ? Object->Handle : NULL_HANDLE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_OPEN_RWLOCK_FUNC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osRWLockWait
+ *
+ *  Description:
+ *    Acquires a single unit of the critical section associated with the
+ *    specified signal. Acquiring an abandoned critical section is treated
+ *    as a success.
+ *
+ *  Parameters:
+ *    Signal - Pointer to signal descriptor.
+ *    Deadline - The time when waiting expires, OS_IGNORE or OS_INFINITE.
+ *    Abandoned - Pointer to a variable that is set when the critical
+ *      section was abandoned.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+static BOOL osRWLockWait(struct TSignal FAR *Signal, TIME Deadline,
+  BOOL *Abandoned)
+{
+  ERROR LastErrorCode;
+  TIME Timeout;
+
+  /* Compute remaining time */
+  Timeout = Deadline;
+  #if (OS_USE_TIME_OBJECTS)
+    if((Deadline != OS_IGNORE) && (Deadline != OS_INFINITE))
+    {
+      TIME CurrentTime;
+      CurrentTime = arGetTickCount();
+      Timeout = (Deadline > CurrentTime) ? (Deadline - CurrentTime) :
+        OS_IGNORE;
+    }
+  #endif
+
+  /* Save last error code */
+  LastErrorCode = osGetLastError();
+
+  /* Wait for a single unit */
+  if(osWaitFor(Signal, Timeout))
+    return TRUE;
+
+  /* Restore previous last error code when the critical section was
+     abandoned (the unit is owned anyway) */
+  else if(osGetLastError() == ERR_WAIT_ABANDONED)
+  {
+    osSetLastError(LastErrorCode);
+    *Abandoned = TRUE;
+    return TRUE;
+  }
+
+  /* Failure during acquiring the critical section */
+  return FALSE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osAcquireRWLock
+ *
+ *  Description:
+ *    Acquires a reader-writer lock for shared or exclusive access.
+ *    Shared access can be acquired recursively; the reader acquiring it
+ *    again does not wait, even if a writer waits for the lock. Each
+ *    acquisition must be released by osReleaseRWLock. Acquiring exclusive
+ *    access by a task which already owns the lock, or shared access by the
+ *    writer, fails with ERR_WAIT_DEADLOCK. The osWaitForObject function
+ *    acquires the lock for shared access regardless of the writer
+ *    preference.
+ *
+ *  Parameters:
+ *    Handle - Handle of the reader-writer lock object.
+ *    Exclusive - TRUE to acquire exclusive (write) access, FALSE to acquire
+ *      shared (read) access.
+ *    Timeout - Timeout value.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure. When an abandoned lock is
+ *    acquired, FALSE is returned with ERR_WAIT_ABANDONED error code and the
+ *    lock is owned by the calling task.
+ *
+ ***************************************************************************/
+
+BOOL osAcquireRWLock(HANDLE Handle, BOOL Exclusive, TIME Timeout)
+{
+  struct TRWLockObject FAR *RWLockObject;
+  struct TSysObject FAR *Object;
+  BOOL Abandoned, GateAbandoned, Success;
+  INDEX Count;
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_RWLOCK);
+  if(!Object)
+    return FALSE;
+  RWLockObject = (struct TRWLockObject FAR *) Object->ObjectDesc;
+
+  /* Convert timeout to the deadline, so it covers all the waits */
+  #if (OS_USE_TIME_OBJECTS)
+    if((Timeout != OS_IGNORE) && (Timeout != OS_INFINITE))
+    {
+      TIME CurrentTime;
+      CurrentTime = arGetTickCount();
+
+      /* Control time overflow */
+      Timeout = ((OS_INFINITE - CurrentTime) <= Timeout) ?
+        OS_INFINITE : (CurrentTime + Timeout);
+    }
+  #endif
+
+  Abandoned = FALSE;
+  GateAbandoned = FALSE;
+
+  /* Reader acquires a single unit. It passes the gate only when the writer
+     preference is enabled and some writer owns or waits for the gate. */
+  if(!Exclusive)
+  {
+    /* Reader owning a unit counts the acquisition only, as waiting for
+       another unit could wait for the writer waiting for the owned one */
+    if(RWLockObject->Writer != osCurrentTask)
+      if(osAcquireOwnedCS(&RWLockObject->CS))
+        return TRUE;
+
+    if(RWLockObject->WriterPreference &&
+      (!RWLockObject->Gate.Signaled ||
+      stBSTreeGetFirst(&RWLockObject->Gate.WaitingTasks)))
+    {
+      if(!osRWLockWait(&RWLockObject->Gate, Timeout, &GateAbandoned))
+        return FALSE;
+
+      Success = osRWLockWait(&Object->Signal, Timeout, &Abandoned);
+      osReleaseCS(&RWLockObject->GateCS, osCurrentTask, 1, NULL);
+    }
+    else
+      Success = osRWLockWait(&Object->Signal, Timeout, &Abandoned);
+
+    /* No writer can own the lock now */
+    if(!Success)
+      return FALSE;
+    RWLockObject->Writer = NULL;
+  }
+
+  /* Writer passes the gate and acquires all units one by one, so it
+     inherits priority of the waiting readers and writers and it passes its
+     priority to the readers owning the units */
+  else
+  {
+    if(!osRWLockWait(&RWLockObject->Gate, Timeout, &GateAbandoned))
+      return FALSE;
+
+    for(Count = 0; Count < RWLockObject->MaxReaders; Count++)
+      if(!osRWLockWait(&Object->Signal, Timeout, &Abandoned))
+        break;
+
+    /* Release acquired units on failure */
+    if(Count < RWLockObject->MaxReaders)
+    {
+      if(Count)
+        osReleaseCS(&RWLockObject->CS, osCurrentTask, Count, NULL);
+      osReleaseCS(&RWLockObject->GateCS, osCurrentTask, 1, NULL);
+      return FALSE;
+    }
+
+    RWLockObject->Writer = osCurrentTask;
+    osReleaseCS(&RWLockObject->GateCS, osCurrentTask, 1, NULL);
+  }
+
+  /* Lock is owned, but it was abandoned by the previous owner */
+  if(Abandoned)
+  {
+    osSetLastError(ERR_WAIT_ABANDONED);
+    return FALSE;
+  }
+
+  /* Return with success */
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osReleaseRWLock
+ *
+ *  Description:
+ *    Releases shared or exclusive access to a reader-writer lock owned by
+ *    the calling task.
+ *
+ *  Parameters:
+ *    Handle - Handle of the reader-writer lock object.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osReleaseRWLock(HANDLE Handle)
+{
+  struct TRWLockObject FAR *RWLockObject;
+  struct TSysObject FAR *Object;
+  INDEX ReleaseCount;
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_RWLOCK);
+  if(!Object)
+    return FALSE;
+  RWLockObject = (struct TRWLockObject FAR *) Object->ObjectDesc;
+
+  /* Writer owns all units */
+  ReleaseCount = 1;
+  if((RWLockObject->Writer == osCurrentTask) && !Object->Signal.Signaled)
+  {
+    RWLockObject->Writer = NULL;
+    ReleaseCount = RWLockObject->MaxReaders;
+  }
+
+  /* Reader releases recursive acquisitions before its unit */
+  else if(osReleaseOwnedCS(&RWLockObject->CS))
+    return TRUE;
+
+  /* Release critical section */
+  return osReleaseCS(&RWLockObject->CS, osCurrentTask, ReleaseCount, NULL);
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_RWLOCK */
+/***************************************************************************/
+
+
+/***************************************************************************/
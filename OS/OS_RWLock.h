@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_RWLock.h - Reader-writer lock object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef OS_RWLOCK_H
+#define OS_RWLOCK_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_API.h"
+
+
+/****************************************************************************
+ *
+ *  Default configuration
+ *
+ ***************************************************************************/
+
+/* Enable Reader-writer lock objects by default */
+#ifndef OS_USE_RWLOCK
+  #define OS_USE_RWLOCK                 1
+#elif (((OS_USE_RWLOCK) != 0) && ((OS_USE_RWLOCK) != 1))
+  #error OS_USE_RWLOCK must be either 0 or 1
+#endif
+
+/* Enable osOpenRWLock (lookup by name) by default */
+#ifndef OS_OPEN_RWLOCK_FUNC
+  #define OS_OPEN_RWLOCK_FUNC           (OS_USE_RWLOCK)
+#elif (((OS_OPEN_RWLOCK_FUNC) != 0) && ((OS_OPEN_RWLOCK_FUNC) != 1))
+  #error OS_OPEN_RWLOCK_FUNC must be either 0 or 1
+#elif (((OS_OPEN_RWLOCK_FUNC) != 0) && !(OS_USE_RWLOCK))
+  #error OS_OPEN_RWLOCK_FUNC must be 0 when OS_USE_RWLOCK is 0
+#endif
+
+
+/****************************************************************************
+ *
+ *  System configuration
+ *
+ ***************************************************************************/
+
+/* Enable named object support if open function is used */
+#if ((OS_OPEN_RWLOCK_FUNC) && !defined(OS_USE_OBJECT_NAMES))
+  #define OS_USE_OBJECT_NAMES           1
+#endif
+
+/* Enable Critical Section objects if Reader-writer locks are used */
+#if ((OS_USE_RWLOCK) && !defined(OS_USE_CSEC_OBJECTS))
+  #define OS_USE_CSEC_OBJECTS           1
+#endif
+
+/* Enable Multiple Signals support (writer gate) */
+#if ((OS_USE_RWLOCK) && !defined(OS_USE_MULTIPLE_SIGNALS))
+  #define OS_USE_MULTIPLE_SIGNALS       1
+#endif
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+#define OS_OBJECT_TYPE_RWLOCK           13
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  #if (OS_USE_RWLOCK)
+
+    HANDLE osCreateRWLock(SYSNAME Name, INDEX MaxReaders,
+      BOOL WriterPreference);
+
+    #if (OS_OPEN_RWLOCK_FUNC)
+      HANDLE osOpenRWLock(SYSNAME Name);
+    #endif
+
+    BOOL osAcquireRWLock(HANDLE Handle, BOOL Exclusive, TIME Timeout);
+    BOOL osReleaseRWLock(HANDLE Handle);
+
+  #endif
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* OS_RWLOCK_H */
+/***************************************************************************/
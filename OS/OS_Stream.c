@@ -98,6 +98,15 @@ struct TStreamObject
   SIZE Offset;
   SIZE Length;
 
+  /* Number of bytes accessed in place (reserved for write, acquired for
+     read) and tasks owning them */
+  #if (OS_STREAM_LOAN_FUNC)
+    SIZE WrLoan;
+    SIZE RdLoan;
+    struct TTask FAR *WrLoanTask;
+    struct TTask FAR *RdLoanTask;
+  #endif
+
   /* Stream access synchronization */
   #if ((OS_STREAM_PROTECT_EVENT) || (OS_STREAM_PROTECT_MUTEX))
     struct TSignal WrSync;
@@ -307,6 +316,15 @@ static SIZE osStreamWrite(struct TStreamObject FAR *StreamObject,
   /* Enter critical section */
   PrevLockState = arLock();
 
+  /* Nothing is written while data is reserved in place */
+  #if (OS_STREAM_LOAN_FUNC)
+    if(StreamObject->WrLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      Size = 0;
+    }
+  #endif
+
   /* Data transmission */
   NumBytesWritten = 0;
   while(Size > 0)
@@ -552,6 +570,15 @@ static SIZE osStreamRead(struct TStreamObject FAR *StreamObject,
   /* Enter critical section */
   PrevLockState = arLock();
 
+  /* Nothing is read while data is acquired in place */
+  #if (OS_STREAM_LOAN_FUNC)
+    if(StreamObject->RdLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      Size = 0;
+    }
+  #endif
+
   /* Data transmission */
   NumBytesRead = 0;
   while(Size > 0)
@@ -892,6 +919,12 @@ HANDLE osCreateStream(SYSNAME Name, UINT8 Mode, SIZE BufferSize)
   StreamObject->Offset = 0;
   StreamObject->Length = 0;
 
+  /* No data is accessed in place */
+  #if (OS_STREAM_LOAN_FUNC)
+    StreamObject->WrLoan = 0;
+    StreamObject->RdLoan = 0;
+  #endif
+
   /* Setup the auto-reset event / mutex for protection */
   #if ((OS_STREAM_PROTECT_EVENT) || (OS_STREAM_PROTECT_MUTEX))
     if((Mode & OS_IPC_PROTECTION_MASK) != OS_IPC_PROTECT_INT_CTRL)
@@ -911,6 +944,12 @@ HANDLE osCreateStream(SYSNAME Name, UINT8 Mode, SIZE BufferSize)
         StreamObject->RdSync.CS = NULL;
       #endif
 
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        StreamObject->WrSync.Object = Object;
+        StreamObject->RdSync.Object = Object;
+      #endif
+
       /* Multiple signals associated with object */
       #if (OS_ALLOW_OBJECT_DELETION)
         Object->Signal.NextSignal = &StreamObject->WrSync;
@@ -941,6 +980,11 @@ HANDLE osCreateStream(SYSNAME Name, UINT8 Mode, SIZE BufferSize)
         StreamObject->SyncOnEmpty.CS = NULL;
       #endif
 
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        StreamObject->SyncOnEmpty.Object = Object;
+      #endif
+
       /* Multiple signals associated with the object */
       #if (OS_ALLOW_OBJECT_DELETION)
         StreamObject->SyncOnEmpty.NextSignal = Object->Signal.NextSignal;
@@ -961,6 +1005,11 @@ HANDLE osCreateStream(SYSNAME Name, UINT8 Mode, SIZE BufferSize)
         StreamObject->SyncOnFull.CS = NULL;
       #endif
 
+      /* Object of the signal (latency histogram and lock statistics) */
+      #if ((OS_USE_LATENCY_HISTOGRAM) || (OS_USE_LOCK_PROFILER))
+        StreamObject->SyncOnFull.Object = Object;
+      #endif
+
       /* Multiple signals associated with the object */
       #if (OS_ALLOW_OBJECT_DELETION)
         StreamObject->SyncOnFull.NextSignal = Object->Signal.NextSignal;
@@ -975,6 +1024,442 @@ HANDLE osCreateStream(SYSNAME Name, UINT8 Mode, SIZE BufferSize)
 }
 
 
+/***************************************************************************/
+#if (OS_STREAM_LOAN_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStreamReserve
+ *
+ *  Description:
+ *    Reserves continuous free space of the specified stream and returns
+ *    the pointer to it, so data may be written in place (e.g. by DMA) and
+ *    appended by osStreamCommit without being copied. Available only for
+ *    streams protected by event or mutex, which stay locked for writing
+ *    until the data is committed by the same task. Waits while the stream
+ *    is full.
+ *
+ *  Parameters:
+ *    Handle - Handle of the stream.
+ *    Size - Pointer to the maximal number of bytes to reserve, receives
+ *      the number of bytes reserved (limited by the end of the buffer).
+ *
+ *  Return:
+ *    Pointer to the reserved space or NULL on failure.
+ *
+ ***************************************************************************/
+
+PVOID osStreamReserve(HANDLE Handle, SIZE *Size)
+{
+  struct TSysObject FAR *Object;
+  struct TStreamObject FAR *StreamObject;
+  BOOL PrevLockState;
+  SIZE DataOffset, BytesToReserve;
+  PVOID Data;
+
+  /* Check parameters */
+  if(!Size || !*Size)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return NULL;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_STREAM);
+  if(!Object)
+    return NULL;
+
+  /* Stream protected by interrupt disabling can not stay locked and
+     direct read-write passes data beside the stream buffer */
+  StreamObject = (struct TStreamObject FAR *) Object->ObjectDesc;
+  if(!(StreamObject->Mode & OS_IPC_PROTECTION_MASK) ||
+    (StreamObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+  {
+    osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+    return NULL;
+  }
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return NULL;
+  }
+
+  /* Wait for write access synchronization */
+  if(!osStreamLock(StreamObject, &StreamObject->WrSync, OS_INFINITE))
+    return NULL;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* This loop is executed once and it is used to simplify code structure */
+  Data = NULL;
+  while(1)
+  {
+    /* Only one part of the buffer may be reserved */
+    if(StreamObject->WrLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      break;
+    }
+
+    /* When stream buffer is full */
+    if(StreamObject->Length >= StreamObject->BufferSize)
+    {
+      /* Waiting for buffer */
+      #if (OS_STREAM_ALLOW_WAIT_IF_FULL)
+
+        /* Exit when not enabled */
+        if(!(StreamObject->Mode & OS_IPC_WAIT_IF_FULL))
+        {
+          osSetLastError(ERR_STREAM_IS_FULL);
+          break;
+        }
+
+        /* Wait when buffer is full */
+        if(!osWaitFor(&StreamObject->SyncOnFull, OS_INFINITE))
+          break;
+
+      /* Exit when buffer is full */
+      #else
+        osSetLastError(ERR_STREAM_IS_FULL);
+        break;
+      #endif
+    }
+
+    /* Calculate data offset */
+    DataOffset = StreamObject->BufferSize - StreamObject->Offset;
+    if(DataOffset > StreamObject->Length)
+      DataOffset = StreamObject->Offset + StreamObject->Length;
+    else
+      DataOffset = StreamObject->Length - DataOffset;
+
+    /* Calculate number of bytes to reserve */
+    BytesToReserve = StreamObject->BufferSize - DataOffset;
+    if(BytesToReserve > (StreamObject->BufferSize - StreamObject->Length))
+      BytesToReserve = StreamObject->BufferSize - StreamObject->Length;
+    if(*Size > BytesToReserve)
+      *Size = BytesToReserve;
+
+    /* Return the free space following the stored data */
+    StreamObject->WrLoan = *Size;
+    StreamObject->WrLoanTask = osCurrentTask;
+    Data = &((UINT8 FAR *) StreamObject)[
+      AR_MEMORY_ALIGN_UP(sizeof(struct TStreamObject)) + DataOffset];
+    break;
+  }
+
+  /* The stream stays locked until the data is committed */
+  if(!Data)
+    osStreamUnlock(StreamObject, &StreamObject->WrSync);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Data;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStreamCommit
+ *
+ *  Description:
+ *    Appends data written to the space reserved by osStreamReserve to
+ *    the specified stream and unlocks the stream for writing. Fails with
+ *    ERR_NO_LOANED_BUFFER unless called by the task which reserved the
+ *    space.
+ *
+ *  Parameters:
+ *    Handle - Handle of the stream.
+ *    Size - Number of bytes written (not greater than the number of
+ *      reserved bytes, zero cancels the reservation).
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osStreamCommit(HANDLE Handle, SIZE Size)
+{
+  struct TSysObject FAR *Object;
+  struct TStreamObject FAR *StreamObject;
+  BOOL PrevLockState;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_STREAM);
+  if(!Object)
+    return FALSE;
+
+  /* Enter critical section */
+  StreamObject = (struct TStreamObject FAR *) Object->ObjectDesc;
+  PrevLockState = arLock();
+
+  /* Return if nothing is reserved by the calling task */
+  if(!StreamObject->WrLoan || (StreamObject->WrLoanTask != osCurrentTask) ||
+    osInISR)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_NO_LOANED_BUFFER);
+    return FALSE;
+  }
+
+  /* Return if more data is committed */
+  if(Size > StreamObject->WrLoan)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  /* Number of bytes stored in the stream buffer */
+  StreamObject->WrLoan = 0;
+  StreamObject->Length += Size;
+
+  /* Update main signal */
+  osUpdateSignalState(&StreamObject->Object.Signal,
+    (BOOL) (StreamObject->Length > 0));
+
+  #if (OS_STREAM_ALLOW_WAIT_IF_EMPTY)
+    if(StreamObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+      osUpdateSignalState(&StreamObject->SyncOnEmpty,
+        (BOOL) (StreamObject->Length > 0));
+  #endif
+
+  #if (OS_STREAM_ALLOW_WAIT_IF_FULL)
+    if(StreamObject->Mode & OS_IPC_WAIT_IF_FULL)
+      osUpdateSignalState(&StreamObject->SyncOnFull,
+        (BOOL) (StreamObject->Length < StreamObject->BufferSize));
+  #endif
+
+  /* Release mutex or auto-reset event */
+  osStreamUnlock(StreamObject, &StreamObject->WrSync);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStreamAcquire
+ *
+ *  Description:
+ *    Returns the pointer to continuous data at the beginning of the
+ *    specified stream, so it may be processed in place and removed by
+ *    osStreamRelease without being copied. Available only for streams
+ *    protected by event or mutex, which stay locked for reading until the
+ *    data is released by the same task. Waits while the stream is empty.
+ *
+ *  Parameters:
+ *    Handle - Handle of the stream.
+ *    Size - Pointer to the maximal number of bytes to acquire, receives
+ *      the number of bytes acquired (limited by the end of the buffer).
+ *
+ *  Return:
+ *    Pointer to the acquired data or NULL on failure.
+ *
+ ***************************************************************************/
+
+PVOID osStreamAcquire(HANDLE Handle, SIZE *Size)
+{
+  struct TSysObject FAR *Object;
+  struct TStreamObject FAR *StreamObject;
+  BOOL PrevLockState;
+  SIZE BytesToAcquire;
+  PVOID Data;
+
+  /* Check parameters */
+  if(!Size || !*Size)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return NULL;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_STREAM);
+  if(!Object)
+    return NULL;
+
+  /* Stream protected by interrupt disabling can not stay locked and
+     direct read-write passes data beside the stream buffer */
+  StreamObject = (struct TStreamObject FAR *) Object->ObjectDesc;
+  if(!(StreamObject->Mode & OS_IPC_PROTECTION_MASK) ||
+    (StreamObject->Mode & OS_IPC_DIRECT_READ_WRITE))
+  {
+    osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+    return NULL;
+  }
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return NULL;
+  }
+
+  /* Wait for read access synchronization */
+  if(!osStreamLock(StreamObject, &StreamObject->RdSync, OS_INFINITE))
+    return NULL;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* This loop is executed once and it is used to simplify code structure */
+  Data = NULL;
+  while(1)
+  {
+    /* Only one part of the buffer may be acquired */
+    if(StreamObject->RdLoan)
+    {
+      osSetLastError(ERR_LOAN_NOT_AVAILABLE);
+      break;
+    }
+
+    /* When stream buffer is empty */
+    if(!StreamObject->Length)
+    {
+      /* Waiting for buffer */
+      #if (OS_STREAM_ALLOW_WAIT_IF_EMPTY)
+
+        /* Exit when not enabled */
+        if(!(StreamObject->Mode & OS_IPC_WAIT_IF_EMPTY))
+        {
+          osSetLastError(ERR_STREAM_IS_EMPTY);
+          break;
+        }
+
+        /* Wait when buffer is empty */
+        if(!osWaitFor(&StreamObject->SyncOnEmpty, OS_INFINITE))
+          break;
+
+      /* Exit when buffer is empty */
+      #else
+        osSetLastError(ERR_STREAM_IS_EMPTY);
+        break;
+      #endif
+    }
+
+    /* Calculate number of bytes to acquire */
+    BytesToAcquire = StreamObject->BufferSize - StreamObject->Offset;
+    if(BytesToAcquire > StreamObject->Length)
+      BytesToAcquire = StreamObject->Length;
+    if(*Size > BytesToAcquire)
+      *Size = BytesToAcquire;
+
+    /* Return the first stored data */
+    StreamObject->RdLoan = *Size;
+    StreamObject->RdLoanTask = osCurrentTask;
+    Data = &((UINT8 FAR *) StreamObject)[
+      AR_MEMORY_ALIGN_UP(sizeof(struct TStreamObject)) +
+      StreamObject->Offset];
+    break;
+  }
+
+  /* The stream stays locked until the data is released */
+  if(!Data)
+    osStreamUnlock(StreamObject, &StreamObject->RdSync);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return Data;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osStreamRelease
+ *
+ *  Description:
+ *    Removes data acquired by osStreamAcquire from the specified stream
+ *    and unlocks the stream for reading. Fails with ERR_NO_LOANED_BUFFER
+ *    unless called by the task which acquired the data.
+ *
+ *  Parameters:
+ *    Handle - Handle of the stream.
+ *    Size - Number of bytes processed (not greater than the number of
+ *      acquired bytes, the remaining data stays in the stream).
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osStreamRelease(HANDLE Handle, SIZE Size)
+{
+  struct TSysObject FAR *Object;
+  struct TStreamObject FAR *StreamObject;
+  BOOL PrevLockState;
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_STREAM);
+  if(!Object)
+    return FALSE;
+
+  /* Enter critical section */
+  StreamObject = (struct TStreamObject FAR *) Object->ObjectDesc;
+  PrevLockState = arLock();
+
+  /* Return if nothing is acquired by the calling task */
+  if(!StreamObject->RdLoan || (StreamObject->RdLoanTask != osCurrentTask) ||
+    osInISR)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_NO_LOANED_BUFFER);
+    return FALSE;
+  }
+
+  /* Return if more data is released */
+  if(Size > StreamObject->RdLoan)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  /* Number of bytes stored in the stream buffer */
+  StreamObject->RdLoan = 0;
+  StreamObject->Length -= Size;
+  StreamObject->Offset =
+    (StreamObject->Offset + Size) % StreamObject->BufferSize;
+
+  /* Update main signal */
+  osUpdateSignalState(&StreamObject->Object.Signal,
+    (BOOL) (StreamObject->Length > 0));
+
+  #if (OS_STREAM_ALLOW_WAIT_IF_EMPTY)
+    if(StreamObject->Mode & OS_IPC_WAIT_IF_EMPTY)
+      osUpdateSignalState(&StreamObject->SyncOnEmpty,
+        (BOOL) (StreamObject->Length > 0));
+  #endif
+
+  #if (OS_STREAM_ALLOW_WAIT_IF_FULL)
+    if(StreamObject->Mode & OS_IPC_WAIT_IF_FULL)
+      osUpdateSignalState(&StreamObject->SyncOnFull,
+        (BOOL) (StreamObject->Length < StreamObject->BufferSize));
+  #endif
+
+  /* Release mutex or auto-reset event */
+  osStreamUnlock(StreamObject, &StreamObject->RdSync);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_STREAM_LOAN_FUNC */
+/***************************************************************************/
+
+
 /***************************************************************************/
 #if (OS_OPEN_STREAM_FUNC)
 /***************************************************************************/
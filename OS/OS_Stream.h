@@ -97,6 +97,20 @@
     (WAIT_IF_EMPTY and WAIT_IF_FULL) to be enabled
 #endif
 
+/* Enable osStreamReserve, osStreamCommit, osStreamAcquire and
+   osStreamRelease (data accessed in place) when the stream may be
+   protected by event or mutex */
+#ifndef OS_STREAM_LOAN_FUNC
+  #define OS_STREAM_LOAN_FUNC           ((OS_STREAM_PROTECT_EVENT) || \
+                                        (OS_STREAM_PROTECT_MUTEX))
+#elif (((OS_STREAM_LOAN_FUNC) != 0) && ((OS_STREAM_LOAN_FUNC) != 1))
+  #error OS_STREAM_LOAN_FUNC must be either 0 or 1
+#elif (((OS_STREAM_LOAN_FUNC) != 0) && \
+  !((OS_STREAM_PROTECT_EVENT) || (OS_STREAM_PROTECT_MUTEX)))
+  #error OS_STREAM_LOAN_FUNC requires event or mutex protection to be \
+    enabled
+#endif
+
 
 /****************************************************************************
  *
@@ -161,6 +175,13 @@
       HANDLE osOpenStream(SYSNAME Name);
     #endif
 
+    #if (OS_STREAM_LOAN_FUNC)
+      PVOID osStreamReserve(HANDLE Handle, SIZE *Size);
+      BOOL osStreamCommit(HANDLE Handle, SIZE Size);
+      PVOID osStreamAcquire(HANDLE Handle, SIZE *Size);
+      BOOL osStreamRelease(HANDLE Handle, SIZE Size);
+    #endif
+
   #endif
 
 #ifdef __cplusplus
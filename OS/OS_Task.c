@@ -141,6 +141,11 @@ HANDLE osCreateTask(TTaskProc TaskProc, PVOID Arg, SIZE StackSize,
     Task->WaitTimeout.Task = Task;
   #endif
 
+  /* Waiting for any of the objects by default */
+  #if ((OS_MAX_WAIT_FOR_OBJECTS) > 1)
+    Task->WaitAll = FALSE;
+  #endif
+
   /* Direct read-write for IPC */
   #if (OS_MBOX_ALLOW_DIRECT_RW)
     Task->IPCBlockingTask = NULL;
@@ -152,6 +157,11 @@ HANDLE osCreateTask(TTaskProc TaskProc, PVOID Arg, SIZE StackSize,
     stBSTreeInit(&Task->OwnedCSPtr, osCSPtrCmp);
   #endif
 
+  /* List of critical sections acquired by the fast path */
+  #if (OS_MUTEX_FAST_PATH)
+    Task->FastCS = NULL;
+  #endif
+
   /* Binary search tree for task children (created or opened objects) */
   #if (OS_ALLOW_OBJECT_DELETION)
     stBSTreeInit(&Task->Childs, osObjectByHandleCmp);
@@ -159,10 +169,13 @@ HANDLE osCreateTask(TTaskProc TaskProc, PVOID Arg, SIZE StackSize,
 
   /* CPU usage */
   #if (OS_USE_STATISTICS)
-    Task->CPUUsageTime = OS_INFINITE;
-    Task->CPUUsage = 0;
-    Task->CPUCalcTime = osCPUUsageTime;
-    Task->CPUCalc = 0;
+    osInitCPUStat(&Task->CPUStat);
+  #endif
+
+  /* Scheduling latency */
+  #if (OS_USE_LATENCY_HISTOGRAM)
+    Task->ReadyPending = FALSE;
+    stMemSet(Task->ReadyHistogram, 0x00, sizeof(Task->ReadyHistogram));
   #endif
 
   /* Last error code */
@@ -740,9 +753,10 @@ BOOL osSetTaskQuantum(HANDLE Handle, UINT8 Quantum)
  *    osGetTaskStat
  *
  *  Description:
- *    Returns the CPU usage for the specified task. The percentage CPU
- *    usage of the task can be calculated using the formula:
- *    100 * CPUTime / TotalTime.
+ *    Returns the CPU usage for the specified task. Both times are the
+ *    cycles (OS_CYCLES_PER_SECOND units) of the last statistics period,
+ *    accounted at every context switch. The percentage CPU usage of the
+ *    task can be calculated using the formula: 100 * CPUTime / TotalTime.
  *
  *  Parameters:
  *    Handle - Task handle.
@@ -758,6 +772,7 @@ BOOL osGetTaskStat(HANDLE Handle, INDEX *CPUTime, INDEX *TotalTime)
 {
   struct TSysObject FAR *Object;
   struct TTask FAR *Task;
+  BOOL PrevLockState;
 
   /* Get object by handle */
   Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_TASK);
@@ -767,14 +782,15 @@ BOOL osGetTaskStat(HANDLE Handle, INDEX *CPUTime, INDEX *TotalTime)
   /* Get task pointer */
   Task = (struct TTask FAR *) Object->ObjectDesc;
 
+  /* Enter critical section */
+  PrevLockState = arLock();
+
   /* Get task CPU usage */
-  if(Task->CPUUsageTime == osCPUUsageTime)
-    *CPUTime = Task->CPUUsage;
-  else if(Task->CPUCalcTime == osCPUUsageTime)
-    *CPUTime = Task->CPUCalc;
-  else
-    *CPUTime = 0;
-  *TotalTime = osCPUUsage;
+  *CPUTime = (INDEX) osGetCPUTime(&Task->CPUStat);
+  *TotalTime = (INDEX) osCPUUsage;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
 
   /* Return with success */
   return TRUE;
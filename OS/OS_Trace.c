@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_Trace.c - Kernel event trace
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_Core.h"
+
+
+/***************************************************************************/
+#if (OS_USE_TRACE)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Macros
+ *
+ ***************************************************************************/
+
+/* Identifier of a task or an object in the trace records */
+#define OS_TRACE_ID(Ptr)                ((UINT32) ((unsigned long) (Ptr)))
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Ring buffer of trace records. Counters are free running, the oldest
+   record is overwritten when the buffer is full. */
+static struct TTraceRecord osTraceBuffer[OS_TRACE_BUFFER_SIZE];
+static UINT32 osTraceHead;
+static UINT32 osTraceTail;
+
+/* Number of records overwritten before they were read */
+static UINT32 osTraceLost;
+
+/* Recording state */
+static BOOL osTraceEnabled;
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osInitTrace
+ *
+ *  Description:
+ *    Initializes the trace buffer. Recording is enabled.
+ *
+ ***************************************************************************/
+
+void osInitTrace(void)
+{
+  osTraceHead = 0;
+  osTraceTail = 0;
+  osTraceLost = 0;
+  osTraceEnabled = TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osTraceRecord
+ *
+ *  Description:
+ *    Appends a record to the trace buffer. May be called from an ISR.
+ *
+ *  Parameters:
+ *    Event - Trace event (OS_TRACE_xxx).
+ *    Task - Pointer to task descriptor (may be NULL).
+ *    Signal - Pointer to signal descriptor (may be NULL).
+ *    Value - Event specific value.
+ *    Info - Event specific information.
+ *
+ ***************************************************************************/
+
+void osTraceRecord(UINT8 Event, struct TTask FAR *Task,
+  struct TSignal FAR *Signal, UINT32 Value, UINT16 Info)
+{
+  struct TTraceRecord *Record;
+  BOOL PrevLockState;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  if(osTraceEnabled)
+  {
+    /* Overwrite the oldest record when the buffer is full */
+    if((osTraceHead - osTraceTail) == (UINT32) (OS_TRACE_BUFFER_SIZE))
+    {
+      osTraceTail++;
+      osTraceLost++;
+    }
+
+    Record = &osTraceBuffer[osTraceHead++ &
+      (UINT32) ((OS_TRACE_BUFFER_SIZE) - 1UL)];
+    Record->Time = OS_GET_CYCLE_COUNT();
+    Record->Event = Event;
+    Record->Priority = (UINT8) (Task ? Task->Priority : 0);
+    Record->Info = Info;
+    Record->Task = Task ? OS_TRACE_ID(&Task->Object.Signal) : 0;
+    Record->Object = OS_TRACE_ID(Signal);
+    Record->Value = Value;
+  }
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osEnableTrace
+ *
+ *  Description:
+ *    Enables or disables recording of kernel events.
+ *
+ *  Parameters:
+ *    Enable - TRUE to enable recording, FALSE to disable it.
+ *
+ *  Return:
+ *    Previous recording state.
+ *
+ ***************************************************************************/
+
+BOOL osEnableTrace(BOOL Enable)
+{
+  BOOL PrevLockState, PrevEnabled;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  PrevEnabled = osTraceEnabled;
+  osTraceEnabled = Enable;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return PrevEnabled;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osGetTraceHeader
+ *
+ *  Description:
+ *    Fills the header which precedes the records in an exported trace.
+ *
+ *  Parameters:
+ *    Header - Pointer to header that receives the trace information.
+ *
+ ***************************************************************************/
+
+void osGetTraceHeader(struct TTraceHeader *Header)
+{
+  BOOL PrevLockState;
+
+  Header->Magic = OS_TRACE_MAGIC;
+  Header->Version = OS_TRACE_VERSION;
+  Header->RecordSize = (UINT16) sizeof(struct TTraceRecord);
+  Header->Frequency = (UINT32) (OS_TRACE_TIME_FREQUENCY);
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  Header->Lost = osTraceLost;
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osReadTrace
+ *
+ *  Description:
+ *    Moves the oldest trace records to the buffer. Only whole records are
+ *    copied. Interrupts are disabled only while copying a single record.
+ *
+ *  Parameters:
+ *    Buffer - Pointer to buffer that receives the records.
+ *    Size - Size of the buffer in bytes.
+ *
+ *  Return:
+ *    Number of bytes copied to the buffer.
+ *
+ ***************************************************************************/
+
+SIZE osReadTrace(PVOID Buffer, SIZE Size)
+{
+  struct TTraceRecord *Record;
+  BOOL PrevLockState, Empty;
+  SIZE Count;
+
+  Record = (struct TTraceRecord *) Buffer;
+  for(Count = 0; Count < Size / sizeof(struct TTraceRecord); Count++)
+  {
+    /* Enter critical section */
+    PrevLockState = arLock();
+
+    Empty = (BOOL) (osTraceHead == osTraceTail);
+    if(!Empty)
+      Record[Count] = osTraceBuffer[osTraceTail++ &
+        (UINT32) ((OS_TRACE_BUFFER_SIZE) - 1UL)];
+
+    /* Leave critical section */
+    arRestore(PrevLockState);
+
+    if(Empty)
+      break;
+  }
+
+  return Count * sizeof(struct TTraceRecord);
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_TRACE */
+/***************************************************************************/
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_Trace.h - Kernel event trace
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef OS_TRACE_H
+#define OS_TRACE_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_API.h"
+
+
+/****************************************************************************
+ *
+ *  Default configuration
+ *
+ ***************************************************************************/
+
+/* Kernel event trace is disabled by default */
+#ifndef OS_USE_TRACE
+  #define OS_USE_TRACE                  0
+#elif (((OS_USE_TRACE) != 0) && ((OS_USE_TRACE) != 1))
+  #error OS_USE_TRACE must be either 0 or 1
+#endif
+
+/* Number of records in the trace buffer, 1024 by default. Must be a power
+   of two. */
+#ifndef OS_TRACE_BUFFER_SIZE
+  #define OS_TRACE_BUFFER_SIZE          1024UL
+#elif (((OS_TRACE_BUFFER_SIZE) < 2UL) || \
+  ((OS_TRACE_BUFFER_SIZE) & ((OS_TRACE_BUFFER_SIZE) - 1UL)))
+  #error OS_TRACE_BUFFER_SIZE must be a power of two
+#endif
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+/* Trace export format */
+#define OS_TRACE_MAGIC                  0x43525453UL
+#define OS_TRACE_VERSION                1
+
+/* Trace events */
+#define OS_TRACE_SWITCH                 1
+#define OS_TRACE_WAIT_BEGIN             2
+#define OS_TRACE_WAIT_END               3
+#define OS_TRACE_SIGNAL                 4
+#define OS_TRACE_CREATE                 5
+#define OS_TRACE_DELETE                 6
+#define OS_TRACE_ISR_ENTER              7
+#define OS_TRACE_ISR_EXIT               8
+
+/* Units of the trace timestamps per second */
+#define OS_TRACE_TIME_FREQUENCY         (OS_CYCLES_PER_SECOND)
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Header of the exported trace. Written in the CPU byte order, which the
+   decoder recognizes by the magic value. */
+struct TTraceHeader
+{
+  UINT32 Magic;
+  UINT16 Version;
+  UINT16 RecordSize;
+  UINT32 Frequency;
+  UINT32 Lost;
+};
+
+/* Trace record. Tasks and objects are identified by the address of their
+   signal descriptor (lower 32 bits). */
+struct TTraceRecord
+{
+  /* Timestamp (cycle counter or system ticks) */
+  UINT32 Time;
+
+  /* Event and the priority of the task */
+  UINT8 Event;
+  UINT8 Priority;
+
+  /* Event specific information:
+     OS_TRACE_WAIT_BEGIN - number of awaited signals,
+     OS_TRACE_CREATE, OS_TRACE_DELETE - object type */
+  UINT16 Info;
+
+  /* Task which caused the event (the task switched in for
+     OS_TRACE_SWITCH, the released task for OS_TRACE_WAIT_END) */
+  UINT32 Task;
+
+  /* Signal or object (the task switched out for OS_TRACE_SWITCH) */
+  UINT32 Object;
+
+  /* Event specific value:
+     OS_TRACE_WAIT_BEGIN - timeout,
+     OS_TRACE_WAIT_END - wait exit code,
+     OS_TRACE_SIGNAL - new signal state,
+     OS_TRACE_CREATE - object handle */
+  UINT32 Value;
+};
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  #if (OS_USE_TRACE)
+
+    BOOL osEnableTrace(BOOL Enable);
+    void osGetTraceHeader(struct TTraceHeader *Header);
+    SIZE osReadTrace(PVOID Buffer, SIZE Size);
+
+  #endif
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* OS_TRACE_H */
+/***************************************************************************/
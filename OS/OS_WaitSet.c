@@ -0,0 +1,456 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_WaitSet.c - Wait set object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_Core.h"
+
+
+/***************************************************************************/
+#if (OS_USE_WAIT_SET)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Wait set member descriptor */
+struct TWaitSetMember
+{
+  /* Watch of the object signal (not used when the signal is NULL) */
+  struct TWatch Watch;
+
+  /* Handle of the object */
+  HANDLE Handle;
+};
+
+/* Wait set object descriptor */
+struct TWaitSetObject
+{
+  /* System object descriptor */
+  struct TSysObject Object;
+
+  /* System object name descriptor */
+  #if (OS_OPEN_WAIT_SET_FUNC)
+    struct TObjectName Name;
+  #endif
+
+  /* Wait set descriptor */
+  struct TWaitSet WaitSet;
+
+  /* Members of the wait set */
+  INDEX MaxCount;
+  struct TWaitSetMember Members[1];
+};
+
+
+/***************************************************************************/
+#if (OS_ALLOW_OBJECT_DELETION)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitSetIOCtrl
+ *
+ *  Description:
+ *    Processes device IO control codes for wait set objects.
+ *
+ *  Parameters:
+ *    Object - Pointer to the system object.
+ *    ControlCode - Device IO control code.
+ *    Buffer - Not used by wait set objects.
+ *    BufferSize - Not used by wait set objects.
+ *    IORequest - Not used by wait set objects.
+ *
+ *  Return:
+ *    Value specific to the ControlCode.
+ *
+ ***************************************************************************/
+
+static INDEX osWaitSetIOCtrl(struct TSysObject FAR *Object,
+  INDEX ControlCode, PVOID Buffer, SIZE BufferSize,
+  struct TIORequest *IORequest)
+{
+  struct TWaitSetObject FAR *WaitSetObject;
+  INDEX i;
+
+  /* Mark unused parameters */
+  AR_UNUSED_PARAM(Buffer);
+  AR_UNUSED_PARAM(BufferSize);
+  AR_UNUSED_PARAM(IORequest);
+
+  /* Obtain wait set descriptor */
+  WaitSetObject = (struct TWaitSetObject FAR *) Object->ObjectDesc;
+
+  /* Wait set deinitialization. Stops watching the signals of all members.
+     Nothing is done at the system deinitialization (when no task is
+     running), as the watched objects may be already released. */
+  if(ControlCode == DEV_IO_CTL_DEINIT)
+  {
+    if(osCurrentTask)
+      for(i = 0; i < WaitSetObject->MaxCount; i++)
+        if(WaitSetObject->Members[i].Watch.Signal)
+          osUnwatchSignal(&WaitSetObject->Members[i].Watch);
+    return (INDEX) TRUE;
+  }
+
+  /* Not supported device IO control code */
+  osSetLastError(ERR_INVALID_DEVICE_IO_CTL);
+  return 0;
+}
+
+
+/***************************************************************************/
+#endif /* OS_ALLOW_OBJECT_DELETION */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osCreateWaitSet
+ *
+ *  Description:
+ *    Creates a wait set object. A wait set keeps a persistent list of
+ *    objects; the task waits for the wait set only, no matter how many
+ *    objects it contains.
+ *
+ *  Parameters:
+ *    Name - Name of the object.
+ *    MaxCount - Maximum number of objects in the wait set.
+ *
+ *  Return:
+ *    Handle of the created object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osCreateWaitSet(SYSNAME Name, INDEX MaxCount)
+{
+  struct TWaitSetObject FAR *WaitSetObject;
+  struct TSysObject FAR *Object;
+  INDEX i;
+
+  /* Check parameters */
+  if(!MaxCount || (MaxCount > ((((SIZE) (-1)) -
+    sizeof(*WaitSetObject)) / sizeof(struct TWaitSetMember) + 1)))
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return NULL_HANDLE;
+  }
+
+  /* Allocate memory for the object */
+  WaitSetObject = (struct TWaitSetObject FAR *)
+    osMemAlloc(sizeof(*WaitSetObject) + (MaxCount - 1) *
+    sizeof(struct TWaitSetMember));
+  if(!WaitSetObject)
+    return NULL_HANDLE;
+
+  /* Pointer to system object descriptor */
+  Object = &WaitSetObject->Object;
+
+  /* Register new system object */
+  if(!osRegisterObject((PVOID) WaitSetObject, Object,
+    OS_OBJECT_TYPE_WAIT_SET))
+  {
+    osMemFree(WaitSetObject);
+    return NULL_HANDLE;
+  }
+
+  /* Setup the object (signaled while some member may be ready) */
+  Object->Signal.Signaled = 0;
+  WaitSetObject->WaitSet.Signal = &Object->Signal;
+  WaitSetObject->WaitSet.FirstReady = NULL;
+  WaitSetObject->WaitSet.LastReady = NULL;
+  WaitSetObject->MaxCount = MaxCount;
+  for(i = 0; i < MaxCount; i++)
+    WaitSetObject->Members[i].Watch.Signal = NULL;
+
+  /* Stop watching member objects on deletion */
+  #if (OS_ALLOW_OBJECT_DELETION)
+    Object->Flags |= OS_OBJECT_FLAG_USES_IO_DEINIT;
+    Object->DeviceIOCtrl = osWaitSetIOCtrl;
+  #endif
+
+  /* Register name descriptor */
+  #if (OS_OPEN_WAIT_SET_FUNC)
+    if(!osRegisterName(Object, &WaitSetObject->Name, Name))
+    {
+      osDeleteObject(Object);
+      return NULL_HANDLE;
+    }
+
+  /* Mark unused parameters to avoid warning messages */
+  #else
+    AR_UNUSED_PARAM(Name);
+  #endif
+
+  /* Mark object as ready to use and return its handle */
+  Object->Flags |= OS_OBJECT_FLAG_READY_TO_USE;
+  return Object->Handle;
+}
+
+
+/***************************************************************************/
+#if (OS_OPEN_WAIT_SET_FUNC)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osOpenWaitSet
+ *
+ *  Description:
+ *    Opens an existing wait set object by name.
+ *
+ *  Parameters:
+ *    Name - Name of the existing object.
+ *
+ *  Return:
+ *    Handle of the object or NULL_HANDLE on failure.
+ *
+ ***************************************************************************/
+
+HANDLE osOpenWaitSet(SYSNAME Name)
+{
+  struct TSysObject FAR *Object;
+
+  /* Open named object */
+  Object = osOpenNamedObject(Name, OS_OBJECT_TYPE_WAIT_SET);
+
+  /* Return handle of the opened object or NULL_HANDLE on failure */
+  return Object ? Object->Handle : NULL_HANDLE;
+}
+
+
+/***************************************************************************/
+#endif /* OS_OPEN_WAIT_SET_FUNC */
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osAddToWaitSet
+ *
+ *  Description:
+ *    Adds an object to the wait set. The object signal is watched from now
+ *    on, until the object is removed from the wait set or deleted. Wait
+ *    sets and objects whose state is determined on demand (timers and
+ *    lock-free queues) cannot be added.
+ *
+ *  Parameters:
+ *    WaitSet - Handle of the wait set object.
+ *    Handle - Handle of the object to add.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osAddToWaitSet(HANDLE WaitSet, HANDLE Handle)
+{
+  struct TWaitSetObject FAR *WaitSetObject;
+  struct TWaitSetMember FAR *Member;
+  struct TSysObject FAR *Object;
+  BOOL PrevLockState;
+  INDEX i;
+
+  /* Get objects by handles */
+  Object = osGetObjectByHandle(WaitSet, OS_OBJECT_TYPE_WAIT_SET);
+  if(!Object)
+    return FALSE;
+  WaitSetObject = (struct TWaitSetObject FAR *) Object->ObjectDesc;
+
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_IGNORE);
+  if(!Object)
+    return FALSE;
+
+  /* Check the object type */
+  #if (OS_USE_SYSTEM_IO_CTRL)
+    if(Object->Signal.Flags & OS_SIGNAL_FLAG_USES_IO_SYSTEM)
+    {
+      osSetLastError(ERR_INVALID_PARAMETER);
+      return FALSE;
+    }
+  #endif
+
+  if(Object->Type == OS_OBJECT_TYPE_WAIT_SET)
+  {
+    osSetLastError(ERR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Find a free member, the object cannot be added twice */
+  Member = NULL;
+  for(i = 0; i < WaitSetObject->MaxCount; i++)
+  {
+    if(!WaitSetObject->Members[i].Watch.Signal)
+    {
+      if(!Member)
+        Member = &WaitSetObject->Members[i];
+    }
+    else if(WaitSetObject->Members[i].Watch.Signal == &Object->Signal)
+    {
+      arRestore(PrevLockState);
+      osSetLastError(ERR_OBJECT_ALREADY_EXISTS);
+      return FALSE;
+    }
+  }
+
+  /* Fail when the wait set is full */
+  if(!Member)
+  {
+    arRestore(PrevLockState);
+    osSetLastError(ERR_WAIT_SET_IS_FULL);
+    return FALSE;
+  }
+
+  /* Start watching the object signal */
+  Member->Handle = Handle;
+  osWatchSignal(&WaitSetObject->WaitSet, &Member->Watch, &Object->Signal);
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osRemoveFromWaitSet
+ *
+ *  Description:
+ *    Removes an object from the wait set.
+ *
+ *  Parameters:
+ *    WaitSet - Handle of the wait set object.
+ *    Handle - Handle of the object to remove.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osRemoveFromWaitSet(HANDLE WaitSet, HANDLE Handle)
+{
+  struct TWaitSetObject FAR *WaitSetObject;
+  struct TSysObject FAR *Object;
+  BOOL PrevLockState;
+  INDEX i;
+
+  /* Get objects by handles */
+  Object = osGetObjectByHandle(WaitSet, OS_OBJECT_TYPE_WAIT_SET);
+  if(!Object)
+    return FALSE;
+  WaitSetObject = (struct TWaitSetObject FAR *) Object->ObjectDesc;
+
+  Object = osGetObjectByHandle(Handle, OS_OBJECT_TYPE_IGNORE);
+  if(!Object)
+    return FALSE;
+
+  /* Enter critical section */
+  PrevLockState = arLock();
+
+  /* Find the member and stop watching the object signal */
+  for(i = 0; i < WaitSetObject->MaxCount; i++)
+    if(WaitSetObject->Members[i].Watch.Signal == &Object->Signal)
+    {
+      osUnwatchSignal(&WaitSetObject->Members[i].Watch);
+      arRestore(PrevLockState);
+      return TRUE;
+    }
+
+  /* Leave critical section */
+  arRestore(PrevLockState);
+
+  /* Object is not a member of the wait set */
+  osSetLastError(ERR_INVALID_HANDLE);
+  return FALSE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    osWaitForWaitSet
+ *
+ *  Description:
+ *    Switches task into wait state until one of the objects in the wait
+ *    set is in the signaled state or the specified timeout interval
+ *    elapses. The object is acquired the same way as by osWaitForObject.
+ *    Objects which remain signaled are reported in turn. The task does not
+ *    inherit priorities when it waits for a mutex in the wait set.
+ *
+ *  Parameters:
+ *    WaitSet - Handle of the wait set object.
+ *    Timeout - Timeout value.
+ *    Handle - Pointer to variable that receives the handle of the acquired
+ *      object (may be NULL if not expected).
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL osWaitForWaitSet(HANDLE WaitSet, TIME Timeout, HANDLE *Handle)
+{
+  struct TWaitSetObject FAR *WaitSetObject;
+  struct TSysObject FAR *Object;
+  struct TWatch FAR *Watch;
+  BOOL Success;
+
+  /* Operation can be performed only by a task */
+  if(!osCurrentTask || osInISR)
+  {
+    osSetLastError(ERR_ALLOWED_ONLY_FOR_TASKS);
+    return FALSE;
+  }
+
+  /* Get object by handle */
+  Object = osGetObjectByHandle(WaitSet, OS_OBJECT_TYPE_WAIT_SET);
+  if(!Object)
+    return FALSE;
+  WaitSetObject = (struct TWaitSetObject FAR *) Object->ObjectDesc;
+
+  /* Acquire one of the ready objects */
+  Watch = NULL;
+  Success = osWaitForWatch(&WaitSetObject->WaitSet, Timeout, &Watch);
+
+  /* Set the handle of the acquired object */
+  if(Watch && Handle)
+    *Handle = ((struct TWaitSetMember FAR *) Watch)->Handle;
+
+  /* Return completion status */
+  return Success;
+}
+
+
+/***************************************************************************/
+#endif /* OS_USE_WAIT_SET */
+/***************************************************************************/
+
+
+/***************************************************************************/
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  OS_WaitSet.h - Wait set object management functions
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#ifndef OS_WAITSET_H
+#define OS_WAITSET_H
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include "OS_API.h"
+
+
+/****************************************************************************
+ *
+ *  Default configuration
+ *
+ ***************************************************************************/
+
+/* Enable Wait set objects by default */
+#ifndef OS_USE_WAIT_SET
+  #define OS_USE_WAIT_SET               1
+#elif (((OS_USE_WAIT_SET) != 0) && ((OS_USE_WAIT_SET) != 1))
+  #error OS_USE_WAIT_SET must be either 0 or 1
+#endif
+
+/* Enable osOpenWaitSet (lookup by name) by default */
+#ifndef OS_OPEN_WAIT_SET_FUNC
+  #define OS_OPEN_WAIT_SET_FUNC         (OS_USE_WAIT_SET)
+#elif (((OS_OPEN_WAIT_SET_FUNC) != 0) && ((OS_OPEN_WAIT_SET_FUNC) != 1))
+  #error OS_OPEN_WAIT_SET_FUNC must be either 0 or 1
+#elif (((OS_OPEN_WAIT_SET_FUNC) != 0) && !(OS_USE_WAIT_SET))
+  #error OS_OPEN_WAIT_SET_FUNC must be 0 when OS_USE_WAIT_SET is 0
+#endif
+
+
+/****************************************************************************
+ *
+ *  System configuration
+ *
+ ***************************************************************************/
+
+/* Enable named object support if open function is used */
+#if ((OS_OPEN_WAIT_SET_FUNC) && !defined(OS_USE_OBJECT_NAMES))
+  #define OS_USE_OBJECT_NAMES           1
+#endif
+
+/* Enable Device I/O Control function */
+#if ((OS_USE_WAIT_SET) && !defined(OS_USE_DEVICE_IO_CTRL))
+  #define OS_USE_DEVICE_IO_CTRL         1
+#endif
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+#define OS_OBJECT_TYPE_WAIT_SET         15
+
+
+/****************************************************************************
+ *
+ *  Functions
+ *
+ ***************************************************************************/
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+  #if (OS_USE_WAIT_SET)
+
+    HANDLE osCreateWaitSet(SYSNAME Name, INDEX MaxCount);
+
+    #if (OS_OPEN_WAIT_SET_FUNC)
+      HANDLE osOpenWaitSet(SYSNAME Name);
+    #endif
+
+    BOOL osAddToWaitSet(HANDLE WaitSet, HANDLE Handle);
+    BOOL osRemoveFromWaitSet(HANDLE WaitSet, HANDLE Handle);
+    BOOL osWaitForWaitSet(HANDLE WaitSet, TIME Timeout, HANDLE *Handle);
+
+  #endif
+
+#ifdef __cplusplus
+  };
+#endif
+
+
+/***************************************************************************/
+#endif /* OS_WAITSET_H */
+/***************************************************************************/
@@ -0,0 +1,188 @@
+#****************************************************************************
+#
+#  SiriusRTOS
+#  POSIX.mk - Build Configuration for the POSIX simulator, GCC
+#  Version 1.00
+#
+#  Copyright 2010 by SpaceShadow
+#  All rights reserved!
+#
+#****************************************************************************
+
+
+#****************************************************************************
+#
+#  Target Configuration
+#
+#****************************************************************************
+
+# Compiler and Output Filename
+CC = gcc
+OUTPUT_FILE = SiriusRTOS
+
+
+#****************************************************************************
+#
+#  Source Files and Directories
+#
+#****************************************************************************
+
+# C Source Files
+SRC_C += ARCH/POSIX/AR_POSIX.c
+SRC_C += ARCH/POSIX/AR_PosixIntf.c
+SRC_C += STD/ST_BSTree.c
+SRC_C += STD/ST_PQueue.c
+SRC_C += STD/ST_Endian.c
+SRC_C += STD/ST_Errors.c
+SRC_C += STD/ST_Handle.c
+SRC_C += STD/ST_DevMan.c
+SRC_C += STD/ST_Memory.c
+SRC_C += STD/ST_FixMem.c
+SRC_C += STD/ST_CLIB.c
+SRC_C += STD/ST_Init.c
+SRC_C += OS/OS_Core.c
+SRC_C += OS/OS_Task.c
+SRC_C += OS/OS_Mutex.c
+SRC_C += OS/OS_Semaphore.c
+SRC_C += OS/OS_RWLock.c
+SRC_C += OS/OS_CondVar.c
+SRC_C += OS/OS_WaitSet.c
+SRC_C += OS/OS_CountSem.c
+SRC_C += OS/OS_Event.c
+SRC_C += OS/OS_Timer.c
+SRC_C += OS/OS_SharedMem.c
+SRC_C += OS/OS_PtrQueue.c
+SRC_C += OS/OS_Stream.c
+SRC_C += OS/OS_Queue.c
+SRC_C += OS/OS_Mailbox.c
+SRC_C += OS/OS_Flags.c
+SRC_C += OS/OS_Trace.c
+
+# Application Source Files
+SRC_APP += Main.c
+
+# Benchmark Source Files (each one is a separate executable)
+SRC_BENCH += BENCH/BN_TimeNotify.c
+SRC_BENCH += BENCH/BN_Memory.c
+SRC_BENCH += BENCH/BN_MemOps.c
+SRC_BENCH += BENCH/BN_Names.c
+SRC_BENCH += BENCH/BN_Objects.c
+SRC_BENCH += BENCH/BN_RWLock.c
+SRC_BENCH += BENCH/BN_WaitSet.c
+SRC_BENCH += BENCH/BN_Trace.c
+SRC_BENCH += BENCH/BN_Latency.c
+SRC_BENCH += BENCH/BN_Kernel.c
+
+# Benchmark Support Source Files
+SRC_BENCH_LIB += BENCH/BN_Bench.c
+
+# Benchmark Object Directory (the kernel is built again with the benchmark
+# overrides, so the objects are never shared with the build target)
+BENCH_OBJ_DIR = BENCH/Obj
+
+# Host Tool Source Files (each one is a separate executable)
+SRC_TOOLS += TOOLS/TL_Trace.c
+
+# Include Paths
+INCLUDE_DIR += ARCH/POSIX
+INCLUDE_DIR += STD
+INCLUDE_DIR += OS
+
+
+#****************************************************************************
+#
+#  Compiler Flags
+#
+#****************************************************************************
+
+# Language Standard (GNU99)
+CFLAGS = -std=gnu99
+
+# Optimization Level
+CFLAGS += -O2
+
+# Warning Configuration
+CFLAGS += -W -Wall -Wimplicit -Wpointer-arith -Wreturn-type -Wswitch
+
+# Include Path Expansion
+CFLAGS += -I. $(patsubst %,-I%,$(INCLUDE_DIR))
+
+# Configuration Overrides (e.g. DEFS=-DOS_USE_TIME_WHEEL=1). Objects are
+# not rebuilt when the overrides change, run "clean" first.
+CFLAGS += $(DEFS)
+
+# Benchmark Overrides (the benchmarks create up to 10000 objects at once)
+BENCH_DEFS = -DST_MAX_HANDLE_COUNT=16384
+
+# Diagnostic Options (enabled together by the diag target)
+DIAG_DEFS = -DOS_USE_TRACE=1 -DOS_USE_LATENCY_HISTOGRAM=1
+DIAG_DEFS += -DOS_USE_LOCK_PROFILER=1
+
+
+#****************************************************************************
+#
+#  Linker Flags
+#
+#****************************************************************************
+
+# Additional Libraries
+LFLAGS +=
+
+
+#****************************************************************************
+#
+#  Build Rules
+#
+#****************************************************************************
+
+# Object File Definitions
+OBJ_C = $(SRC_C:.c=.o)
+OBJ_APP = $(SRC_APP:.c=.o)
+OBJ_BENCH = $(SRC_BENCH:%.c=$(BENCH_OBJ_DIR)/%.o)
+OBJ_BENCH_LIB = $(SRC_BENCH_LIB:%.c=$(BENCH_OBJ_DIR)/%.o)
+OBJ_BENCH_C = $(SRC_C:%.c=$(BENCH_OBJ_DIR)/%.o)
+BIN_BENCH = $(SRC_BENCH:.c=)
+BIN_TOOLS = $(SRC_TOOLS:.c=)
+
+# Main Target: Build the simulator executable
+build: $(OUTPUT_FILE)
+
+$(OUTPUT_FILE): $(OBJ_C) $(OBJ_APP)
+	$(CC) $(CFLAGS) $(OBJ_C) $(OBJ_APP) -o $@ $(LFLAGS)
+
+# Benchmarks: Build and run the benchmark executables (JSON line output)
+bench: $(BIN_BENCH)
+	@for BENCH in $(BIN_BENCH); do ./$$BENCH || exit 1; done
+
+$(BIN_BENCH): % : $(BENCH_OBJ_DIR)/%.o $(OBJ_BENCH_LIB) $(OBJ_BENCH_C)
+	$(CC) $(CFLAGS) $(BENCH_DEFS) $< $(OBJ_BENCH_LIB) $(OBJ_BENCH_C) \
+	  -o $@ $(LFLAGS)
+
+# Diagnostics: Rebuild and run the benchmarks with all diagnostic options
+diag:
+	$(MAKE) -f POSIX.mk clean
+	$(MAKE) -f POSIX.mk bench DEFS="$(DEFS) $(DIAG_DEFS)"
+	$(MAKE) -f POSIX.mk clean
+
+# Host Tools: Build the tools (e.g. the kernel event trace decoder)
+tools: $(BIN_TOOLS)
+
+$(BIN_TOOLS): % : %.c
+	$(CC) $(CFLAGS) $< -o $@
+
+# Rule: Compile C Sources
+%.o : %.c
+	$(CC) -c $(CFLAGS) $< -o $@
+
+# Rule: Compile C Sources with the benchmark overrides
+$(BENCH_OBJ_DIR)/%.o : %.c
+	@mkdir -p $(@D)
+	$(CC) -c $(CFLAGS) $(BENCH_DEFS) $< -o $@
+
+# Remove build products
+clean:
+	rm -f $(OBJ_C) $(OBJ_APP) $(OUTPUT_FILE)
+	rm -rf $(BENCH_OBJ_DIR) $(BIN_BENCH)
+	rm -f $(BIN_TOOLS)
+
+.PHONY: build bench diag tools clean
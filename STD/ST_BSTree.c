@@ -567,15 +567,20 @@ PVOID stBSTreeGetNext(struct TBSTree FAR *BSTree, PVOID Data)
     /* Match found */
     if(!CmpResult)
     {
-      /* Successor logic:
-         [!] ISSUE? Ensure this logic matches traversal requirements.
-         If right child exists, usually we want the smallest node in
-         that right subtree. */
+      /* The successor is the smallest node of the right subtree or the
+         first ancestor whose left subtree contains the node */
       if(Node->Right)
+      {
+        Node = Node->Right;
         while(Node->Left)
           Node = Node->Left;
+      }
       else
+      {
+        while(Node->Parent && (Node->Parent->Right == Node))
+          Node = Node->Parent;
         Node = Node->Parent;
+      }
 
       /* Return the node data */
       return Node ? Node->Data : NULL;
@@ -22,6 +22,59 @@
   #include <stdlib.h>
 #endif
 
+/* SIMD instruction set of the memory block operations */
+#if (!(ST_USE_MEMORY_CLIB) && (ST_USE_MEMORY_SIMD))
+  #if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define ST_MEMORY_SSE2              1
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define ST_MEMORY_NEON              1
+  #endif
+#endif
+
+
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+#if (!(ST_USE_MEMORY_CLIB) && (ST_USE_MEMORY_WORDS))
+
+  /* Size and alignment mask of the memory word */
+  #define ST_MEM_WORD_SIZE              ((SIZE) sizeof(TMemWord))
+  #define ST_MEM_WORD_MASK              ((SIZE) (sizeof(TMemWord) - 1))
+
+  /* Low bits of the address (alignment within the memory word) */
+  #define ST_MEM_ALIGNMENT(Ptr) \
+    ((SIZE) ((unsigned long) (Ptr)) & ST_MEM_WORD_MASK)
+
+  /* Blocks shorter than this are always processed byte by byte */
+  #define ST_MEM_WORD_MIN_LEN           (2 * ST_MEM_WORD_SIZE)
+
+  /* Size of the SIMD register */
+  #define ST_MEM_SIMD_SIZE              ((SIZE) 16)
+
+#endif
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Machine word of the memory block operations (may alias any object) */
+#if (!(ST_USE_MEMORY_CLIB) && (ST_USE_MEMORY_WORDS))
+  #if defined(__GNUC__)
+    typedef unsigned long __attribute__((__may_alias__)) TMemWord;
+  #else
+    typedef unsigned long TMemWord;
+  #endif
+#endif
+
 
 /****************************************************************************
  *
@@ -128,7 +181,8 @@ BOOL stMemFree(PVOID Ptr)
  *    stMemCmp
  *
  *  Description:
- *    Compares the first n bytes of two memory areas.
+ *    Compares the first n bytes of two memory areas. Blocks with the same
+ *    alignment are compared word by word until the first difference.
  *
  *  Parameters:
  *    s1 - Pointer to the first memory block.
@@ -148,6 +202,73 @@ int stMemCmp(const PVOID s1, const PVOID s2, SIZE n)
   register const UINT8 FAR *Ptr1 = (const UINT8 FAR *) s1;
   register const UINT8 FAR *Ptr2 = (const UINT8 FAR *) s2;
 
+  /* Skip equal words of blocks with the same alignment */
+  #if (ST_USE_MEMORY_WORDS)
+    if(Len >= ST_MEM_WORD_MIN_LEN)
+    {
+      BOOL Words;
+
+      /* Bytes before the word boundary */
+      Words = (BOOL) (ST_MEM_ALIGNMENT(Ptr1) == ST_MEM_ALIGNMENT(Ptr2));
+      if(Words)
+        while(ST_MEM_ALIGNMENT(Ptr1))
+        {
+          if(*Ptr1 != *Ptr2)
+            return (int) ((UINT8) *Ptr1 - (UINT8) *Ptr2);
+
+          Ptr1++;
+          Ptr2++;
+
+          Len--;
+        }
+
+      /* Compare 16 bytes at once (unaligned SIMD access) */
+      #if defined(ST_MEMORY_SSE2)
+        while(Len >= ST_MEM_SIMD_SIZE)
+        {
+          if(_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *) Ptr1),
+            _mm_loadu_si128((const __m128i *) Ptr2))) != 0xFFFF)
+            break;
+
+          Ptr1 += ST_MEM_SIMD_SIZE;
+          Ptr2 += ST_MEM_SIMD_SIZE;
+
+          Len -= ST_MEM_SIMD_SIZE;
+        }
+      #elif defined(ST_MEMORY_NEON)
+        while(Len >= ST_MEM_SIMD_SIZE)
+        {
+          uint64x2_t Equal;
+
+          Equal = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(Ptr1),
+            vld1q_u8(Ptr2)));
+          if((vgetq_lane_u64(Equal, 0) & vgetq_lane_u64(Equal, 1)) !=
+            ~((uint64_t) 0))
+            break;
+
+          Ptr1 += ST_MEM_SIMD_SIZE;
+          Ptr2 += ST_MEM_SIMD_SIZE;
+
+          Len -= ST_MEM_SIMD_SIZE;
+        }
+      #endif
+
+      /* Whole words (the differing word is compared byte by byte) */
+      if(Words)
+        while(Len >= ST_MEM_WORD_SIZE)
+        {
+          if(*(const TMemWord FAR *) Ptr1 != *(const TMemWord FAR *) Ptr2)
+            break;
+
+          Ptr1 += ST_MEM_WORD_SIZE;
+          Ptr2 += ST_MEM_WORD_SIZE;
+
+          Len -= ST_MEM_WORD_SIZE;
+        }
+    }
+  #endif
+
   /* Iterate through the block */
   while(Len > 0)
   {
@@ -174,6 +295,9 @@ int stMemCmp(const PVOID s1, const PVOID s2, SIZE n)
  *  Description:
  *    Copies n bytes from the source to the destination memory area.
  *    Handles overlapping memory regions correctly (like memmove).
+ *    Blocks with the same alignment are copied word by word. Every chunk
+ *    is read before it is written, so the copy direction alone keeps the
+ *    overlapping source intact.
  *
  *  Parameters:
  *    dest - Pointer to the destination memory block.
@@ -191,8 +315,110 @@ PVOID stMemCpy(PVOID dest, const PVOID src, SIZE n)
   register UINT8 FAR *Ptr1 = (UINT8 FAR *) dest;
   register const UINT8 FAR *Ptr2 = (const UINT8 FAR *) src;
 
+  #if (ST_USE_MEMORY_WORDS)
+    BOOL Words;
+
+    /* Copy words if both blocks have the same alignment */
+    Words = (BOOL) (ST_MEM_ALIGNMENT(Ptr1) == ST_MEM_ALIGNMENT(Ptr2));
+  #endif
+
   /* Copy forward (Source is higher or non-overlapping) */
   if(Ptr1 < Ptr2)
+  {
+    #if (ST_USE_MEMORY_WORDS)
+      if(Len >= ST_MEM_WORD_MIN_LEN)
+      {
+        /* Bytes before the word boundary */
+        if(Words)
+          while(ST_MEM_ALIGNMENT(Ptr1))
+          {
+            *Ptr1 = *Ptr2;
+
+            Ptr1++;
+            Ptr2++;
+
+            Len--;
+          }
+
+        /* Copy 64 bytes at once (unaligned SIMD access) */
+        #if defined(ST_MEMORY_SSE2)
+          while(Len >= 4 * ST_MEM_SIMD_SIZE)
+          {
+            __m128i V0, V1, V2, V3;
+
+            V0 = _mm_loadu_si128((const __m128i *) Ptr2);
+            V1 = _mm_loadu_si128((const __m128i *) (Ptr2 + 16));
+            V2 = _mm_loadu_si128((const __m128i *) (Ptr2 + 32));
+            V3 = _mm_loadu_si128((const __m128i *) (Ptr2 + 48));
+            _mm_storeu_si128((__m128i *) Ptr1, V0);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 16), V1);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 32), V2);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 48), V3);
+
+            Ptr1 += 4 * ST_MEM_SIMD_SIZE;
+            Ptr2 += 4 * ST_MEM_SIMD_SIZE;
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+        #elif defined(ST_MEMORY_NEON)
+          while(Len >= 4 * ST_MEM_SIMD_SIZE)
+          {
+            uint8x16_t V0, V1, V2, V3;
+
+            V0 = vld1q_u8(Ptr2);
+            V1 = vld1q_u8(Ptr2 + 16);
+            V2 = vld1q_u8(Ptr2 + 32);
+            V3 = vld1q_u8(Ptr2 + 48);
+            vst1q_u8(Ptr1, V0);
+            vst1q_u8(Ptr1 + 16, V1);
+            vst1q_u8(Ptr1 + 32, V2);
+            vst1q_u8(Ptr1 + 48, V3);
+
+            Ptr1 += 4 * ST_MEM_SIMD_SIZE;
+            Ptr2 += 4 * ST_MEM_SIMD_SIZE;
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+        #endif
+
+        /* Whole words if both blocks have the same alignment */
+        if(Words)
+        {
+          /* Four words per iteration */
+          while(Len >= 4 * ST_MEM_WORD_SIZE)
+          {
+            register TMemWord W0, W1, W2, W3;
+
+            W0 = ((const TMemWord FAR *) Ptr2)[0];
+            W1 = ((const TMemWord FAR *) Ptr2)[1];
+            W2 = ((const TMemWord FAR *) Ptr2)[2];
+            W3 = ((const TMemWord FAR *) Ptr2)[3];
+            ((TMemWord FAR *) Ptr1)[0] = W0;
+            ((TMemWord FAR *) Ptr1)[1] = W1;
+            ((TMemWord FAR *) Ptr1)[2] = W2;
+            ((TMemWord FAR *) Ptr1)[3] = W3;
+
+            Ptr1 += 4 * ST_MEM_WORD_SIZE;
+            Ptr2 += 4 * ST_MEM_WORD_SIZE;
+
+            Len -= 4 * ST_MEM_WORD_SIZE;
+          }
+
+          /* Remaining whole words */
+          while(Len >= ST_MEM_WORD_SIZE)
+          {
+            *(TMemWord FAR *) Ptr1 = *(const TMemWord FAR *) Ptr2;
+
+            Ptr1 += ST_MEM_WORD_SIZE;
+            Ptr2 += ST_MEM_WORD_SIZE;
+
+            Len -= ST_MEM_WORD_SIZE;
+          }
+        }
+      }
+    #endif
+
+    /* Remaining bytes */
     while(Len > 0)
     {
       *Ptr1 = *Ptr2;
@@ -202,20 +428,116 @@ PVOID stMemCpy(PVOID dest, const PVOID src, SIZE n)
 
       Len--;
     }
+  }
 
   /* Copy backward (Source is lower and overlaps) */
   else
   {
-    Ptr1 += Len - 1;
-    Ptr2 += Len - 1;
-
+    /* Start behind the end of the blocks */
+    Ptr1 += Len;
+    Ptr2 += Len;
+
+    #if (ST_USE_MEMORY_WORDS)
+      if(Len >= ST_MEM_WORD_MIN_LEN)
+      {
+        /* Bytes after the last word boundary */
+        if(Words)
+          while(ST_MEM_ALIGNMENT(Ptr1))
+          {
+            Ptr1--;
+            Ptr2--;
+
+            *Ptr1 = *Ptr2;
+
+            Len--;
+          }
+
+        /* Copy 64 bytes at once (unaligned SIMD access) */
+        #if defined(ST_MEMORY_SSE2)
+          while(Len >= 4 * ST_MEM_SIMD_SIZE)
+          {
+            __m128i V0, V1, V2, V3;
+
+            Ptr1 -= 4 * ST_MEM_SIMD_SIZE;
+            Ptr2 -= 4 * ST_MEM_SIMD_SIZE;
+
+            V0 = _mm_loadu_si128((const __m128i *) (Ptr2 + 48));
+            V1 = _mm_loadu_si128((const __m128i *) (Ptr2 + 32));
+            V2 = _mm_loadu_si128((const __m128i *) (Ptr2 + 16));
+            V3 = _mm_loadu_si128((const __m128i *) Ptr2);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 48), V0);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 32), V1);
+            _mm_storeu_si128((__m128i *) (Ptr1 + 16), V2);
+            _mm_storeu_si128((__m128i *) Ptr1, V3);
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+        #elif defined(ST_MEMORY_NEON)
+          while(Len >= 4 * ST_MEM_SIMD_SIZE)
+          {
+            uint8x16_t V0, V1, V2, V3;
+
+            Ptr1 -= 4 * ST_MEM_SIMD_SIZE;
+            Ptr2 -= 4 * ST_MEM_SIMD_SIZE;
+
+            V0 = vld1q_u8(Ptr2 + 48);
+            V1 = vld1q_u8(Ptr2 + 32);
+            V2 = vld1q_u8(Ptr2 + 16);
+            V3 = vld1q_u8(Ptr2);
+            vst1q_u8(Ptr1 + 48, V0);
+            vst1q_u8(Ptr1 + 32, V1);
+            vst1q_u8(Ptr1 + 16, V2);
+            vst1q_u8(Ptr1, V3);
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+        #endif
+
+        /* Whole words if both blocks have the same alignment */
+        if(Words)
+        {
+          /* Four words per iteration */
+          while(Len >= 4 * ST_MEM_WORD_SIZE)
+          {
+            register TMemWord W0, W1, W2, W3;
+
+            Ptr1 -= 4 * ST_MEM_WORD_SIZE;
+            Ptr2 -= 4 * ST_MEM_WORD_SIZE;
+
+            W0 = ((const TMemWord FAR *) Ptr2)[3];
+            W1 = ((const TMemWord FAR *) Ptr2)[2];
+            W2 = ((const TMemWord FAR *) Ptr2)[1];
+            W3 = ((const TMemWord FAR *) Ptr2)[0];
+            ((TMemWord FAR *) Ptr1)[3] = W0;
+            ((TMemWord FAR *) Ptr1)[2] = W1;
+            ((TMemWord FAR *) Ptr1)[1] = W2;
+            ((TMemWord FAR *) Ptr1)[0] = W3;
+
+            Len -= 4 * ST_MEM_WORD_SIZE;
+          }
+
+          /* Remaining whole words */
+          while(Len >= ST_MEM_WORD_SIZE)
+          {
+            Ptr1 -= ST_MEM_WORD_SIZE;
+            Ptr2 -= ST_MEM_WORD_SIZE;
+
+            *(TMemWord FAR *) Ptr1 = *(const TMemWord FAR *) Ptr2;
+
+            Len -= ST_MEM_WORD_SIZE;
+          }
+        }
+      }
+    #endif
+
+    /* Remaining bytes */
     while(Len > 0)
     {
-      *Ptr1 = *Ptr2;
-
       Ptr1--;
       Ptr2--;
 
+      *Ptr1 = *Ptr2;
+
       Len--;
     }
   }
@@ -249,6 +571,95 @@ PVOID stMemSet(PVOID s, UINT8 c, SIZE n)
   register UINT8 Value = c;
   register UINT8 FAR *Ptr = (UINT8 FAR *) s;
 
+  /* Fill whole words */
+  #if (ST_USE_MEMORY_WORDS)
+    if(Len >= ST_MEM_WORD_MIN_LEN)
+    {
+      register TMemWord Word;
+
+      /* Bytes before the word boundary */
+      while(ST_MEM_ALIGNMENT(Ptr))
+      {
+        *Ptr = Value;
+
+        Ptr++;
+
+        Len--;
+      }
+
+      /* Fill 64 bytes at once */
+      #if defined(ST_MEMORY_SSE2)
+        if(Len >= 4 * ST_MEM_SIMD_SIZE)
+        {
+          __m128i Vector;
+
+          Vector = _mm_set1_epi8((char) Value);
+          do
+          {
+            _mm_storeu_si128((__m128i *) Ptr, Vector);
+            _mm_storeu_si128((__m128i *) (Ptr + 16), Vector);
+            _mm_storeu_si128((__m128i *) (Ptr + 32), Vector);
+            _mm_storeu_si128((__m128i *) (Ptr + 48), Vector);
+
+            Ptr += 4 * ST_MEM_SIMD_SIZE;
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+          while(Len >= 4 * ST_MEM_SIMD_SIZE);
+        }
+      #elif defined(ST_MEMORY_NEON)
+        if(Len >= 4 * ST_MEM_SIMD_SIZE)
+        {
+          uint8x16_t Vector;
+
+          Vector = vdupq_n_u8(Value);
+          do
+          {
+            vst1q_u8(Ptr, Vector);
+            vst1q_u8(Ptr + 16, Vector);
+            vst1q_u8(Ptr + 32, Vector);
+            vst1q_u8(Ptr + 48, Vector);
+
+            Ptr += 4 * ST_MEM_SIMD_SIZE;
+
+            Len -= 4 * ST_MEM_SIMD_SIZE;
+          }
+          while(Len >= 4 * ST_MEM_SIMD_SIZE);
+        }
+      #endif
+
+      /* Replicate the value into all bytes of the word */
+      Word = (TMemWord) Value;
+      Word |= Word << 8;
+      Word |= Word << 16;
+      if(ST_MEM_WORD_SIZE > 4)
+        Word |= (Word << 16) << 16;
+
+      /* Four words per iteration */
+      while(Len >= 4 * ST_MEM_WORD_SIZE)
+      {
+        ((TMemWord FAR *) Ptr)[0] = Word;
+        ((TMemWord FAR *) Ptr)[1] = Word;
+        ((TMemWord FAR *) Ptr)[2] = Word;
+        ((TMemWord FAR *) Ptr)[3] = Word;
+
+        Ptr += 4 * ST_MEM_WORD_SIZE;
+
+        Len -= 4 * ST_MEM_WORD_SIZE;
+      }
+
+      /* Remaining whole words */
+      while(Len >= ST_MEM_WORD_SIZE)
+      {
+        *(TMemWord FAR *) Ptr = Word;
+
+        Ptr += ST_MEM_WORD_SIZE;
+
+        Len -= ST_MEM_WORD_SIZE;
+      }
+    }
+  #endif
+
   /* Fill the memory block */
   while(Len > 0)
   {
@@ -727,3 +1138,71 @@ PSTR stStrUpr(PSTR s)
 /***************************************************************************/
 #endif /* !ST_USE_STRING_CLIB */
 /***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Bit Operations
+ *
+ ***************************************************************************/
+
+
+/***************************************************************************/
+#if !defined(stCountLeadingZeros)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stCountLeadingZeros
+ *
+ *  Description:
+ *    Returns the number of leading zero bits of a 32-bit value. Used when
+ *    neither the architecture nor the compiler provides such operation.
+ *
+ *  Parameters:
+ *    Value - Non-zero value.
+ *
+ *  Return:
+ *    Number of zero bits above the most significant set bit.
+ *
+ ***************************************************************************/
+
+INDEX stCountLeadingZeros(UINT32 Value)
+{
+  INDEX Count;
+
+  /* Binary search for the most significant set bit */
+  Count = 0;
+  if(!(Value & 0xFFFF0000UL))
+  {
+    Count += 16;
+    Value <<= 16;
+  }
+  if(!(Value & 0xFF000000UL))
+  {
+    Count += 8;
+    Value <<= 8;
+  }
+  if(!(Value & 0xF0000000UL))
+  {
+    Count += 4;
+    Value <<= 4;
+  }
+  if(!(Value & 0xC0000000UL))
+  {
+    Count += 2;
+    Value <<= 2;
+  }
+  if(!(Value & 0x80000000UL))
+    Count++;
+
+  /* Return number of leading zeros */
+  return Count;
+}
+
+
+/***************************************************************************/
+#endif /* !stCountLeadingZeros */
+/***************************************************************************/
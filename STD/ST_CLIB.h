@@ -47,6 +47,26 @@
   #define ST_USE_STRING_CLIB            0
 #endif
 
+/* Memory block operations process whole machine words when both blocks
+   have the same alignment. Enabled by default, byte-wise operations might
+   be smaller on 8-bit and 16-bit targets. */
+#ifndef ST_USE_MEMORY_WORDS
+  #define ST_USE_MEMORY_WORDS           1
+#elif (((ST_USE_MEMORY_WORDS) != 0) && ((ST_USE_MEMORY_WORDS) != 1))
+  #error ST_USE_MEMORY_WORDS must be either 0 or 1
+#endif
+
+/* Memory block operations use 128-bit SSE2 or NEON registers for large
+   blocks when the compiler targets such instruction set. Disabled by
+   default. */
+#ifndef ST_USE_MEMORY_SIMD
+  #define ST_USE_MEMORY_SIMD            0
+#elif (((ST_USE_MEMORY_SIMD) != 0) && ((ST_USE_MEMORY_SIMD) != 1))
+  #error ST_USE_MEMORY_SIMD must be either 0 or 1
+#elif ((ST_USE_MEMORY_SIMD) && !(ST_USE_MEMORY_WORDS))
+  #error ST_USE_MEMORY_SIMD requires ST_USE_MEMORY_WORDS to be set to 1
+#endif
+
 
 /* Internal Memory Management Configuration */
 #if !ST_USE_MALLOC_CLIB
@@ -200,6 +220,37 @@
 #endif
 
 
+/****************************************************************************
+ *
+ *  Bit Operations
+ *
+ ***************************************************************************/
+
+/* Count leading zeros of a non-zero 32-bit value */
+#if defined(AR_COUNT_LEADING_ZEROS)
+
+  #define stCountLeadingZeros(Value)    AR_COUNT_LEADING_ZEROS(Value)
+
+#elif defined(__GNUC__)
+
+  #define stCountLeadingZeros(Value)    ((INDEX) (__builtin_clzl( \
+    (unsigned long) (Value)) - ((sizeof(unsigned long) - 4) * 8)))
+
+#else
+
+  #ifdef __cplusplus
+    extern "C" {
+  #endif
+
+    INDEX stCountLeadingZeros(UINT32 Value);
+
+  #ifdef __cplusplus
+    };
+  #endif
+
+#endif
+
+
 /***************************************************************************/
 #endif /* ST_CLIB_H */
 /***************************************************************************/
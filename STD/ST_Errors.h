@@ -81,6 +81,11 @@
 #define ERR_QUEUE_IS_FULL               ((ERROR) 0x0113UL)
 #define ERR_QUEUE_IS_EMPTY              ((ERROR) 0x0114UL)
 #define ERR_MAILBOX_IS_EMPTY            ((ERROR) 0x0115UL)
+#define ERR_LOAN_NOT_AVAILABLE          ((ERROR) 0x0116UL)
+#define ERR_NO_LOANED_BUFFER            ((ERROR) 0x0117UL)
+#define ERR_NAME_TABLE_IS_FULL          ((ERROR) 0x0118UL)
+#define ERR_PRIORITY_ABOVE_CEILING      ((ERROR) 0x0119UL)
+#define ERR_WAIT_SET_IS_FULL            ((ERROR) 0x011AUL)
 
 
 /****************************************************************************
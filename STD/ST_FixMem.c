@@ -96,6 +96,41 @@ BOOL stFixedMemInit(PVOID MemoryAddress, SIZE MemorySize, SIZE BlockSize)
 }
 
 
+/****************************************************************************
+ *
+ *  Name:
+ *    stFixedMemSize
+ *
+ *  Description:
+ *    Returns the size of the memory buffer required by stFixedMemInit to
+ *    hold the specified number of blocks.
+ *
+ *  Parameters:
+ *    BlockSize - Desired size of a single memory block.
+ *    BlockCount - Number of memory blocks.
+ *
+ *  Return:
+ *    Size of the buffer in bytes, or zero if it exceeds the SIZE range.
+ *
+ ***************************************************************************/
+
+SIZE stFixedMemSize(SIZE BlockSize, SIZE BlockCount)
+{
+  SIZE HeaderSize;
+
+  /* Align values to architecture requirements */
+  BlockSize = AR_MEMORY_ALIGN_UP(BlockSize);
+  HeaderSize = AR_MEMORY_ALIGN_UP(sizeof(struct TFixedMemDesc));
+
+  /* Check the size range */
+  if(!BlockSize || (BlockCount > (((SIZE) -1) - HeaderSize) / BlockSize))
+    return 0;
+
+  /* Header followed by blocks */
+  return HeaderSize + BlockCount * BlockSize;
+}
+
+
 /****************************************************************************
  *
  *  Name:
@@ -51,6 +51,7 @@
 
     BOOL stFixedMemInit(PVOID MemoryAddress, SIZE MemorySize,
       SIZE BlockSize);
+    SIZE stFixedMemSize(SIZE BlockSize, SIZE BlockCount);
 
     PVOID stFixedMemAlloc(PVOID MemoryAddress);
     BOOL stFixedMemFree(PVOID MemoryAddress, PVOID Address);
@@ -64,6 +64,15 @@ static HANDLE stHighestUsedHandles;
 
 void stHandleInit(void)
 {
+  #if (ST_HANDLE_GENERATIONS)
+    HANDLE i;
+
+    /* Mark all descriptors as free (handles are validated against the
+       whole array, the generation counters are kept) */
+    for(i = 0; i < (HANDLE) ST_MAX_HANDLE_COUNT; i++)
+      stHandleArr[i].Flags = HANDLE_FLAG_FREE;
+  #endif
+
   /* Initialize global variables */
   stFirstFreeHandle = NULL;
   stHighestUsedHandles = 0UL;
@@ -210,8 +219,14 @@ struct THandle FAR * stHandleAlloc(HANDLE FAR *Handle, PVOID Object,
     /* Set pointer to the object internally */
     HandleDesc->Object = ObjPtr;
 
-    /* Set handle value */
-    *Handle = (HANDLE) (1 + ((HANDLE) (HandleDesc - stHandleArr)));
+    /* Set handle value (descriptor index tagged with its generation) */
+    #if (ST_HANDLE_GENERATIONS)
+      HandleDesc->Handle = (HANDLE) ((HandleDesc->Handle &
+        ~ST_HANDLE_INDEX_MASK) | (1UL + (HandleDesc - stHandleArr)));
+      *Handle = HandleDesc->Handle;
+    #else
+      *Handle = (HANDLE) (1 + ((HANDLE) (HandleDesc - stHandleArr)));
+    #endif
 
   #else
 
@@ -266,6 +281,7 @@ BOOL stHandleRelease(HANDLE Handle)
 
     struct THandle FAR *HandleDesc;
     PVOID Object;
+    HANDLE Index;
 
     /* Enter critical section (required only in multitasking) */
     #if (OS_USED)
@@ -273,11 +289,24 @@ BOOL stHandleRelease(HANDLE Handle)
       PrevLockState = arLock();
     #endif
 
+    /* Descriptor index */
+    #if (ST_HANDLE_GENERATIONS)
+      Index = (HANDLE) (Handle & ST_HANDLE_INDEX_MASK);
+    #else
+      Index = Handle;
+    #endif
+
     /* Release handle when valid */
-    if((Handle != NULL_HANDLE) && (Handle <= stHighestUsedHandles))
+    if((Index != NULL_HANDLE) && (Index <= stHighestUsedHandles))
     {
-      HandleDesc = &stHandleArr[Handle - 1];
-      if(HandleDesc->Flags != HANDLE_FLAG_FREE)
+      HandleDesc = &stHandleArr[Index - 1];
+
+      #if (ST_HANDLE_GENERATIONS)
+        if((HandleDesc->Flags != HANDLE_FLAG_FREE) &&
+          (HandleDesc->Handle == Handle))
+      #else
+        if(HandleDesc->Flags != HANDLE_FLAG_FREE)
+      #endif
       {
         /* Get pointer to the object to be released */
         if(HandleDesc->Flags & HANDLE_FLAG_ALLOCATED)
@@ -285,6 +314,12 @@ BOOL stHandleRelease(HANDLE Handle)
         else
           Object = NULL;
 
+        /* Invalidate all copies of the handle */
+        #if (ST_HANDLE_GENERATIONS)
+          HandleDesc->Handle = (HANDLE) (HandleDesc->Handle +
+            ST_HANDLE_INDEX_MASK + 1UL);
+        #endif
+
         /* Release handle logic */
         HandleDesc->Flags = HANDLE_FLAG_FREE;
         HandleDesc->Object = stFirstFreeHandle;
@@ -333,7 +368,9 @@ BOOL stHandleRelease(HANDLE Handle)
  *    stGetHandlePtr
  *
  *  Description:
- *    Provides access to handle-specific information.
+ *    Provides access to handle-specific information. When handles are
+ *    tagged with generations, the handle is validated without entering
+ *    a critical section.
  *
  *  Parameters:
  *    Handle - The handle to query.
@@ -351,10 +388,49 @@ BOOL stHandleRelease(HANDLE Handle)
 struct THandle FAR * stGetHandleInfo(HANDLE Handle, PVOID *Object,
   UINT8 Type)
 {
-  struct THandle FAR *HandleDesc;
+  #if !(ST_HANDLE_GENERATIONS)
+    struct THandle FAR *HandleDesc;
+  #endif
 
-  /* Release handle descriptor */
-  #if ((ST_MAX_HANDLE_COUNT) > 0UL)
+  /* Validate the handle tagged with generation */
+  #if (ST_HANDLE_GENERATIONS)
+
+    volatile struct THandle FAR *Desc;
+    HANDLE Index;
+    PVOID Ptr;
+    UINT8 Flags;
+
+    /* Descriptors above the high-water mark are always free */
+    Index = (HANDLE) (Handle & ST_HANDLE_INDEX_MASK);
+    if((Index != NULL_HANDLE) && (Index <= (HANDLE) ST_MAX_HANDLE_COUNT))
+    {
+      Desc = &stHandleArr[Index - 1];
+      if(Desc->Handle == Handle)
+      {
+        /* Read the descriptor and check that it was not released in the
+           meantime (the generation changes before the descriptor) */
+        Flags = Desc->Flags;
+        Ptr = Desc->Object;
+        if((Desc->Handle == Handle) && (Flags != HANDLE_FLAG_FREE))
+          if((Type == ST_HANDLE_TYPE_IGNORE) ||
+            ((Flags & HANDLE_TYPE_MASK) == Type))
+          {
+            /* Obtain pointer to the object that the handle points to */
+            if(Object)
+              *Object = Ptr;
+
+            /* Return pointer to the handle descriptor */
+            return (struct THandle FAR *) Desc;
+          }
+      }
+    }
+
+    /* Failure: Invalid handle specified */
+    stSetLastError(ERR_INVALID_HANDLE);
+    return NULL;
+
+  /* Validate handle descriptor */
+  #elif ((ST_MAX_HANDLE_COUNT) > 0UL)
 
     /* Enter critical section (required only in multitasking) */
     #if (OS_USED)
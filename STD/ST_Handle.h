@@ -43,6 +43,23 @@
   #error ST_MAX_HANDLE_COUNT must be greater than or equal to zero
 #endif
 
+/* Tag handles with a generation counter, so a handle of a released object
+   is rejected even when its descriptor was reused */
+#ifndef ST_HANDLE_GENERATIONS
+  #if ((ST_MAX_HANDLE_COUNT) > 0UL)
+    #define ST_HANDLE_GENERATIONS       1
+  #else
+    #define ST_HANDLE_GENERATIONS       0
+  #endif
+#elif (((ST_HANDLE_GENERATIONS) != 0) && ((ST_HANDLE_GENERATIONS) != 1))
+  #error ST_HANDLE_GENERATIONS must be either 0 or 1
+#elif (((ST_HANDLE_GENERATIONS) != 0) && ((ST_MAX_HANDLE_COUNT) == 0UL))
+  #error ST_HANDLE_GENERATIONS must be 0 when ST_MAX_HANDLE_COUNT is 0
+#elif (((ST_HANDLE_GENERATIONS) != 0) && \
+  ((ST_MAX_HANDLE_COUNT) >= 0xFFFFFFUL))
+  #error ST_MAX_HANDLE_COUNT is too large for ST_HANDLE_GENERATIONS
+#endif
+
 /* Enable the handle owner counter if an operating system is present */
 #ifndef ST_USE_OWNER_COUNTER
   #ifdef OS_ALLOW_OBJECT_DELETION
@@ -77,6 +94,19 @@
   #define NULL_HANDLE                   ((HANDLE) 0UL)
 #endif
 
+/* Number of low handle bits used for the descriptor index (the remaining
+   bits hold the generation counter) */
+#if (ST_HANDLE_GENERATIONS)
+  #if ((ST_MAX_HANDLE_COUNT) < 0xFFUL)
+    #define ST_HANDLE_INDEX_BITS        8
+  #elif ((ST_MAX_HANDLE_COUNT) < 0xFFFFUL)
+    #define ST_HANDLE_INDEX_BITS        16
+  #else
+    #define ST_HANDLE_INDEX_BITS        24
+  #endif
+  #define ST_HANDLE_INDEX_MASK          ((1UL << ST_HANDLE_INDEX_BITS) - 1UL)
+#endif
+
 /* Predefined handle types */
 #define ST_HANDLE_TYPE_IGNORE           0x40
 #define ST_HANDLE_TYPE_DRIVER           0x00
@@ -105,6 +135,12 @@
 /* Handle type definition */
 #if ((ST_MAX_HANDLE_COUNT) == 0UL)
   typedef PVOID HANDLE;
+#elif (ST_HANDLE_GENERATIONS)
+  #if ((ST_HANDLE_INDEX_BITS) == 8)
+    typedef UINT16 HANDLE;
+  #else
+    typedef UINT32 HANDLE;
+  #endif
 #elif ((ST_MAX_HANDLE_COUNT) < 65535UL)
   typedef UINT16 HANDLE;
 #else
@@ -124,6 +160,10 @@ struct THandle
     PVOID Object;
   #endif
 
+  #if (ST_HANDLE_GENERATIONS)
+    HANDLE Handle;
+  #endif
+
   #if (ST_USE_OWNER_COUNTER)
     INDEX OwnerCount;
   #endif
@@ -24,12 +24,79 @@
 /***************************************************************************/
 
 
+/****************************************************************************
+ *
+ *  Definitions
+ *
+ ***************************************************************************/
+
+/* Two-level segregated fit lists */
+#if (ST_USE_TLSF_MEMORY)
+
+  /* Number of second level lists of each first level */
+  #define ST_TLSF_SL_COUNT              (1 << (ST_TLSF_SL_COUNT_LOG2))
+
+  /* Number of first level lists (block sizes up to 32 bits) */
+  #define ST_TLSF_FL_COUNT              (33 - (ST_TLSF_SL_COUNT_LOG2))
+
+  /* Bitmap bit of the list index (lowest index is the most significant bit,
+     so it is found by counting leading zeros) */
+  #define ST_TLSF_BIT(Index)            (0x80000000UL >> (Index))
+
+#endif
+
+
 /****************************************************************************
  *
  *  Type definitions
  *
  ***************************************************************************/
 
+
+/***************************************************************************/
+#if (ST_USE_TLSF_MEMORY)
+/***************************************************************************/
+
+
+/* Memory Block descriptor */
+struct TMemoryBlock
+{
+  SIZE Size;
+
+  struct TMemoryBlock FAR *Prev;
+  struct TMemoryBlock FAR *Next;
+
+  /* Memory pool of the occupied block or NULL if the block is free */
+  struct TMemoryPool FAR *Owner;
+
+  struct TMemoryBlock FAR *PrevFree;
+  struct TMemoryBlock FAR *NextFree;
+};
+
+/* Memory Pool descriptor */
+struct TMemoryPool
+{
+  UINT32 FLMap;
+  UINT32 SLMap[ST_TLSF_FL_COUNT];
+  struct TMemoryBlock FAR *FreeBlocks[ST_TLSF_FL_COUNT][ST_TLSF_SL_COUNT];
+
+  SIZE TotalSize;
+
+  #if (ST_GET_MEMORY_INFO_FUNC)
+    SIZE FreeSize;
+  #endif
+
+  #if (ST_MEMORY_EXPAND_FUNC)
+    struct TMemoryPool FAR *NextMemoryPool;
+  #endif
+};
+
+
+/***************************************************************************/
+#else
+/***************************************************************************/
+
+
 /* Memory Block descriptor */
 struct TMemoryBlock
 {
@@ -64,6 +131,544 @@ struct TMemoryPool
 };
 
 
+/***************************************************************************/
+#endif /* ST_USE_TLSF_MEMORY */
+/***************************************************************************/
+
+
+/***************************************************************************/
+#if (ST_USE_TLSF_MEMORY)
+/***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stTlsfMapping
+ *
+ *  Description:
+ *    Returns indexes of the free list containing blocks of the specified
+ *    size. The first level index is the power of two of the size and the
+ *    second level index divides that range linearly.
+ *
+ *  Parameters:
+ *    Size - Memory block size.
+ *    FL - Pointer to receive the first level index.
+ *    SL - Pointer to receive the second level index.
+ *
+ ***************************************************************************/
+
+static void stTlsfMapping(SIZE Size, INDEX *FL, INDEX *SL)
+{
+  INDEX Msb;
+
+  /* Small blocks are stored in the lists of the first level 0 */
+  if(Size < ST_TLSF_SL_COUNT)
+  {
+    *FL = 0;
+    *SL = (INDEX) Size;
+    return;
+  }
+
+  /* Find the most significant bit of the size */
+  Msb = 31 - stCountLeadingZeros((UINT32) Size);
+  *FL = Msb - ST_TLSF_SL_COUNT_LOG2 + 1;
+  *SL = (INDEX) ((Size >> (Msb - ST_TLSF_SL_COUNT_LOG2)) &
+    (ST_TLSF_SL_COUNT - 1));
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stTlsfInsert
+ *
+ *  Description:
+ *    Inserts a free memory block into its free list.
+ *
+ *  Parameters:
+ *    MemPool - Pointer to the memory pool descriptor.
+ *    Block - Pointer to the memory block descriptor.
+ *
+ ***************************************************************************/
+
+static void stTlsfInsert(struct TMemoryPool FAR *MemPool,
+  struct TMemoryBlock FAR *Block)
+{
+  INDEX FL, SL;
+
+  /* Insert block at the beginning of the list */
+  stTlsfMapping(Block->Size, &FL, &SL);
+  Block->PrevFree = NULL;
+  Block->NextFree = MemPool->FreeBlocks[FL][SL];
+  if(Block->NextFree)
+    Block->NextFree->PrevFree = Block;
+  MemPool->FreeBlocks[FL][SL] = Block;
+
+  /* Mark the list as non-empty */
+  MemPool->FLMap |= ST_TLSF_BIT(FL);
+  MemPool->SLMap[FL] |= ST_TLSF_BIT(SL);
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stTlsfRemove
+ *
+ *  Description:
+ *    Removes a free memory block from its free list.
+ *
+ *  Parameters:
+ *    MemPool - Pointer to the memory pool descriptor.
+ *    Block - Pointer to the memory block descriptor.
+ *
+ ***************************************************************************/
+
+static void stTlsfRemove(struct TMemoryPool FAR *MemPool,
+  struct TMemoryBlock FAR *Block)
+{
+  INDEX FL, SL;
+
+  /* Remove block from the list */
+  stTlsfMapping(Block->Size, &FL, &SL);
+  if(Block->NextFree)
+    Block->NextFree->PrevFree = Block->PrevFree;
+  if(Block->PrevFree)
+    Block->PrevFree->NextFree = Block->NextFree;
+  else
+    MemPool->FreeBlocks[FL][SL] = Block->NextFree;
+
+  /* Mark the list as empty if it was the last block */
+  if(!MemPool->FreeBlocks[FL][SL])
+  {
+    MemPool->SLMap[FL] &= ~ST_TLSF_BIT(SL);
+    if(!MemPool->SLMap[FL])
+      MemPool->FLMap &= ~ST_TLSF_BIT(FL);
+  }
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stTlsfFind
+ *
+ *  Description:
+ *    Finds a free memory block of at least the specified size. The size is
+ *    rounded up to the next list boundary, so any block of the first
+ *    non-empty list found is big enough (Good Fit). If there is no such
+ *    list, the first block of the list of the exact size is checked.
+ *
+ *  Parameters:
+ *    MemPool - Pointer to the memory pool descriptor.
+ *    Size - Requested block size.
+ *
+ *  Return:
+ *    Pointer to the free memory block or NULL if not found.
+ *
+ ***************************************************************************/
+
+static struct TMemoryBlock FAR *stTlsfFind(struct TMemoryPool FAR *MemPool,
+  SIZE Size)
+{
+  SIZE Round;
+  UINT32 Map;
+  INDEX FL, SL;
+  struct TMemoryBlock FAR *Block;
+
+  /* Round size up to the next list boundary */
+  Round = 0;
+  if(Size >= ST_TLSF_SL_COUNT)
+    Round = (SIZE) (((SIZE) 1 << (31 - stCountLeadingZeros((UINT32) Size) -
+      ST_TLSF_SL_COUNT_LOG2)) - 1);
+
+  if((SIZE) (Size + Round) >= Size)
+  {
+    /* Search the lists of the same first level */
+    stTlsfMapping((SIZE) (Size + Round), &FL, &SL);
+    Map = MemPool->SLMap[FL] & (0xFFFFFFFFUL >> SL);
+
+    /* Search the lists of higher first levels */
+    if(!Map && (FL + 1 < ST_TLSF_FL_COUNT))
+    {
+      Map = MemPool->FLMap & (0xFFFFFFFFUL >> (FL + 1));
+      if(Map)
+      {
+        FL = stCountLeadingZeros(Map);
+        Map = MemPool->SLMap[FL];
+      }
+    }
+
+    /* First block of the list */
+    if(Map)
+      return MemPool->FreeBlocks[FL][stCountLeadingZeros(Map)];
+  }
+
+  /* Check the first block of the list of the exact size */
+  stTlsfMapping(Size, &FL, &SL);
+  Block = MemPool->FreeBlocks[FL][SL];
+  return (Block && (Block->Size >= Size)) ? Block : NULL;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stMemoryInit
+ *
+ *  Description:
+ *    Initializes the Memory Management functions for the specified
+ *    memory pool. The memory pool cannot be used until this function
+ *    finalizes its initialization.
+ *
+ *  Parameters:
+ *    MemoryPool - Memory pool start address.
+ *    MemorySize - Total size of the memory pool.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL stMemoryInit(PVOID MemoryPool, SIZE MemorySize)
+{
+  SIZE MemoryPoolDescSize, FreeSize;
+  struct TMemoryPool FAR *MemPool;
+  struct TMemoryBlock FAR *MemoryBlock;
+  INDEX FL, SL;
+
+
+  /* Calculate size of the memory pool descriptor located at the
+     beginning of the specified memory address */
+  MemoryPoolDescSize = AR_MEMORY_ALIGN_UP(sizeof(struct TMemoryPool));
+
+  /* Check memory size (at least one block must fit in the pool) */
+  if(MemorySize < MemoryPoolDescSize +
+    AR_MEMORY_ALIGN_UP(sizeof(struct TMemoryBlock)) + AR_MEMORY_ALIGNMENT)
+  {
+    stSetLastError(ERR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  /* Calculate size of the free memory available after alignment */
+  FreeSize = (MemorySize & ((SIZE) ~((AR_MEMORY_ALIGNMENT) - 1))) -
+    MemoryPoolDescSize;
+
+  /* Initialize memory pool descriptor */
+  MemPool = (struct TMemoryPool FAR *) MemoryPool;
+  MemPool->FLMap = 0;
+  for(FL = 0; FL < ST_TLSF_FL_COUNT; FL++)
+  {
+    MemPool->SLMap[FL] = 0;
+    for(SL = 0; SL < ST_TLSF_SL_COUNT; SL++)
+      MemPool->FreeBlocks[FL][SL] = NULL;
+  }
+
+  MemPool->TotalSize = MemorySize;
+
+  #if (ST_GET_MEMORY_INFO_FUNC)
+    MemPool->FreeSize = FreeSize;
+  #endif
+
+  #if (ST_MEMORY_EXPAND_FUNC)
+    MemPool->NextMemoryPool = NULL;
+  #endif
+
+  /* Define the initial single large free memory block */
+  MemoryBlock = (struct TMemoryBlock FAR *)
+    (PVOID) &((UINT8 FAR *) MemoryPool)[MemoryPoolDescSize];
+  MemoryBlock->Size = FreeSize;
+  MemoryBlock->Prev = NULL;
+  MemoryBlock->Next = NULL;
+  MemoryBlock->Owner = NULL;
+  stTlsfInsert(MemPool, MemoryBlock);
+
+
+  /* Return with success */
+  return TRUE;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stMemoryAlloc
+ *
+ *  Description:
+ *    Allocates a new memory block. The allocated memory block address
+ *    will be aligned to the value specified in ST_MALLOC_ALIGNMENT
+ *    relative to the memory pool start address.
+ *
+ *  Parameters:
+ *    MemoryPool - Memory pool start address.
+ *    Size - Size of the memory to be allocated.
+ *
+ *  Return:
+ *    Address of the newly allocated block of memory, or NULL on failure.
+ *
+ ***************************************************************************/
+
+PVOID stMemoryAlloc(PVOID MemoryPool, SIZE Size)
+{
+  SIZE NewSize, BlockDescSize;
+  struct TMemoryPool FAR *MemPool;
+  struct TMemoryBlock FAR *Block;
+  struct TMemoryBlock FAR *NewFree;
+
+  /* Check parameters */
+  if(!Size)
+  {
+    stSetLastError(ERR_INVALID_PARAMETER);
+    return NULL;
+  }
+
+  /* Calculate the new size with additional bytes required for the memory
+     block definition. Size variable overflow is controlled. */
+  BlockDescSize = AR_MEMORY_ALIGN_UP(sizeof(struct TMemoryBlock));
+  NewSize = BlockDescSize + AR_MEMORY_ALIGN_UP(Size);
+  if(NewSize < Size)
+  {
+    stSetLastError(ERR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+
+  Size = NewSize;
+
+  /* Memory pool cast */
+  MemPool = (struct TMemoryPool FAR *) MemoryPool;
+
+
+  /* Check each memory pool (if expansion is used) */
+  while(TRUE)
+  {
+    /* Enter critical section (required only in multitasking) */
+    #if (OS_USED)
+      BOOL PrevLockState;
+      PrevLockState = arLock();
+    #endif
+
+    /* Find free memory block of the rounded up size (Good Fit) */
+    Block = stTlsfFind(MemPool, Size);
+
+    /* Free block not found in this pool */
+    if(!Block)
+    {
+      /* Get next memory pool address if defined */
+      #if (ST_MEMORY_EXPAND_FUNC)
+        MemPool = MemPool->NextMemoryPool;
+      #endif
+
+      /* Leave critical section */
+      #if (OS_USED)
+        arRestore(PrevLockState);
+      #endif
+
+      /* Check in another memory pool */
+      #if (ST_MEMORY_EXPAND_FUNC)
+        if(MemPool)
+          continue;
+      #endif
+
+      /* No more memory pools, free block not found anywhere */
+      break;
+    }
+
+    /* Remove block from free blocks */
+    stTlsfRemove(MemPool, Block);
+
+    /* If the free block is big enough to store the requested size plus
+       another minimal block, split it. */
+    if(Block->Size > (Size + BlockDescSize + AR_MEMORY_ALIGNMENT))
+    {
+      /* Define new free block from the remainder */
+      NewFree = (struct TMemoryBlock FAR *)
+        (PVOID) &((UINT8 FAR *) Block)[Size];
+      NewFree->Size = Block->Size - Size;
+      NewFree->Prev = Block;
+      NewFree->Next = Block->Next;
+      NewFree->Owner = NULL;
+
+      /* Update pointers */
+      if(Block->Next)
+        Block->Next->Prev = NewFree;
+      Block->Next = NewFree;
+      Block->Size = Size;
+
+      /* Insert the new free block back into the free lists */
+      stTlsfInsert(MemPool, NewFree);
+    }
+
+    /* Update free size statistics */
+    #if (ST_GET_MEMORY_INFO_FUNC)
+      MemPool->FreeSize -= Block->Size;
+    #endif
+
+    /* Mark block as occupied */
+    Block->Owner = MemPool;
+
+    /* Leave critical section */
+    #if (OS_USED)
+      arRestore(PrevLockState);
+    #endif
+
+    /* Return address of the allocated block (after the header) */
+    return (PVOID) (((UINT8 FAR *) Block) + BlockDescSize);
+  }
+
+  /* Cannot allocate memory for new block */
+  stSetLastError(ERR_NOT_ENOUGH_MEMORY);
+  return NULL;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    stMemoryFree
+ *
+ *  Description:
+ *    Releases an allocated memory block.
+ *
+ *  Parameters:
+ *    MemoryPool - Memory pool start address.
+ *    Ptr - Address of the memory block to be released.
+ *
+ *  Return:
+ *    TRUE on success or FALSE on failure.
+ *
+ ***************************************************************************/
+
+BOOL stMemoryFree(PVOID MemoryPool, PVOID Ptr)
+{
+  SIZE BlockDescSize;
+  struct TMemoryPool FAR *MemPool;
+  struct TMemoryBlock FAR *Block;
+  struct TMemoryBlock FAR *Merge;
+
+  #if (OS_USED)
+    BOOL PrevLockState;
+  #endif
+
+
+  /* Memory pool pointer */
+  MemPool = (struct TMemoryPool FAR *) MemoryPool;
+
+  /* Determine in which memory pool the specified block is located */
+  #if (ST_MEMORY_EXPAND_FUNC)
+    while(TRUE)
+    {
+      /* Check that pointer is located in this memory pool */
+      if(Ptr > ((PVOID) MemPool))
+        if(Ptr < ((PVOID) &((UINT8 FAR *) MemPool)[MemPool->TotalSize]))
+          break;
+
+      /* Check next memory pool */
+      MemPool = MemPool->NextMemoryPool;
+
+      /* Return if no more memory pools are defined */
+      if(!MemPool)
+      {
+        stSetLastError(ERR_INVALID_MEMORY_BLOCK);
+        return FALSE;
+      }
+    }
+  #endif
+
+
+  /* Size of memory block definition */
+  BlockDescSize = AR_MEMORY_ALIGN_UP(sizeof(struct TMemoryBlock));
+
+  /* Find specified memory block structure by its address */
+  Block = (struct TMemoryBlock FAR *)
+    (PVOID) (((UINT8 FAR *) Ptr) - BlockDescSize);
+
+  /* Validate the block without searching. The block must be located in
+     the pool, must be occupied and linked with its neighbors. */
+  #if (ST_USE_SAFE_MEMORY_FREE)
+    if((((UINT8 FAR *) Block) < &((UINT8 FAR *) MemPool)[
+      AR_MEMORY_ALIGN_UP(sizeof(struct TMemoryPool))]) ||
+      (((UINT8 FAR *) Ptr) >=
+      &((UINT8 FAR *) MemPool)[MemPool->TotalSize]) ||
+      ((SIZE) (((UINT8 FAR *) Block) - ((UINT8 FAR *) MemPool)) &
+      ((AR_MEMORY_ALIGNMENT) - 1)))
+    {
+      stSetLastError(ERR_INVALID_MEMORY_BLOCK);
+      return FALSE;
+    }
+  #endif
+
+
+  /* Enter critical section (required only in multitasking) */
+  #if (OS_USED)
+    PrevLockState = arLock();
+  #endif
+
+  #if (ST_USE_SAFE_MEMORY_FREE)
+    if((Block->Owner != MemPool) ||
+      (Block->Next && (Block->Next->Prev != Block)) ||
+      (Block->Prev && (Block->Prev->Next != Block)))
+    {
+      #if (OS_USED)
+        arRestore(PrevLockState);
+      #endif
+
+      stSetLastError(ERR_INVALID_MEMORY_BLOCK);
+      return FALSE;
+    }
+  #endif
+
+  /* Mark block as free */
+  Block->Owner = NULL;
+
+  #if (ST_GET_MEMORY_INFO_FUNC)
+    MemPool->FreeSize += Block->Size;
+  #endif
+
+  /* Merge with the next block if it is free */
+  Merge = Block->Next;
+  if(Merge && !Merge->Owner)
+  {
+    stTlsfRemove(MemPool, Merge);
+
+    if(Merge->Next)
+      Merge->Next->Prev = Block;
+    Block->Next = Merge->Next;
+    Block->Size += Merge->Size;
+  }
+
+  /* Merge with the previous block if it is free */
+  Merge = Block->Prev;
+  if(Merge && !Merge->Owner)
+  {
+    stTlsfRemove(MemPool, Merge);
+
+    if(Block->Next)
+      Block->Next->Prev = Merge;
+    Merge->Next = Block->Next;
+    Merge->Size += Block->Size;
+    Block = Merge;
+  }
+
+  /* Store the new (possibly merged) free block into the free lists */
+  stTlsfInsert(MemPool, Block);
+
+
+  /* Leave critical section */
+  #if (OS_USED)
+    arRestore(PrevLockState);
+  #endif
+
+  /* Return with success */
+  return TRUE;
+}
+
+
+/***************************************************************************/
+#else
+/***************************************************************************/
+
+
 /***************************************************************************/
 #if (ST_USE_SAFE_MEMORY_FREE)
 /***************************************************************************/
@@ -589,6 +1194,11 @@ BOOL stMemoryFree(PVOID MemoryPool, PVOID Ptr)
 }
 
 
+/***************************************************************************/
+#endif /* ST_USE_TLSF_MEMORY */
+/***************************************************************************/
+
+
 /***************************************************************************/
 #if (ST_GET_MEMORY_INFO_FUNC)
 /***************************************************************************/
@@ -51,13 +51,29 @@
   #define ST_MEMORY_EXPAND_FUNC         1
 #endif
 
+/* Memory Management uses the best fit search in a tree of free blocks by
+   default. The two-level segregated fit allocator (TLSF) allocates and
+   releases memory blocks in constant time. */
+#ifndef ST_USE_TLSF_MEMORY
+  #define ST_USE_TLSF_MEMORY            0
+#endif
+
+/* Number of TLSF free lists per power of two, as a power of two. Default
+   value 4 (16 lists, block sizes rounded up by at most 1/16). */
+#ifndef ST_TLSF_SL_COUNT_LOG2
+  #define ST_TLSF_SL_COUNT_LOG2         4
+#elif (((ST_TLSF_SL_COUNT_LOG2) < 1) || ((ST_TLSF_SL_COUNT_LOG2) > 5))
+  #error ST_TLSF_SL_COUNT_LOG2 must be in range from 1 to 5
+#endif
+
 /* Binary Search Trees must be enabled for Memory Management */
-#if ((ST_USE_MEMORY) && (!ST_USE_BSTREE))
+#if ((ST_USE_MEMORY) && !(ST_USE_TLSF_MEMORY) && (!ST_USE_BSTREE))
   #error ST_USE_BSTREE must be set to 1 for Memory Management
 #endif
 
 /* The stBSTreeExchange function must be enabled for Memory Management */
-#if ((ST_USE_MEMORY) && (!ST_BSTREE_EXCHANGE_FUNC))
+#if ((ST_USE_MEMORY) && !(ST_USE_TLSF_MEMORY) && \
+  (!ST_BSTREE_EXCHANGE_FUNC))
   #error ST_BSTREE_EXCHANGE_FUNC must be set to 1 for Memory Management
 #endif
 
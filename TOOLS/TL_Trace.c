@@ -0,0 +1,405 @@
+/****************************************************************************
+ *
+ *  SiriusRTOS
+ *  TL_Trace.c - Kernel event trace decoder (host tool)
+ *  Version 1.00
+ *
+ *  Copyright 2010 by SpaceShadow
+ *  All rights reserved!
+ *
+ ***************************************************************************/
+
+
+/****************************************************************************
+ *
+ *  Includes
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "OS_Core.h"
+
+
+/****************************************************************************
+ *
+ *  Configuration Constants
+ *
+ ***************************************************************************/
+
+/* Maximum number of tasks tracked by the decoder */
+#define TL_MAX_TASKS                    256
+
+/* Size of the header and the record fields read from the trace */
+#define TL_HEADER_SIZE                  16
+#define TL_RECORD_SIZE                  20
+
+/* Processes of the Chrome trace */
+#define TL_PID_TASKS                    1
+#define TL_PID_WAITS                    2
+#define TL_PID_OBJECTS                  3
+
+
+/****************************************************************************
+ *
+ *  Type definitions
+ *
+ ***************************************************************************/
+
+/* Decoded task state */
+struct TTLTask
+{
+  UINT32 Id;
+  int Running;
+  int Waiting;
+};
+
+
+/****************************************************************************
+ *
+ *  Global variables
+ *
+ ***************************************************************************/
+
+/* Tasks seen in the trace */
+static struct TTLTask tlTasks[TL_MAX_TASKS];
+static int tlTaskCount;
+
+/* Trace written in the other byte order */
+static int tlSwap;
+
+/* Output file and separator state */
+static FILE *tlOut;
+static int tlFirstEvent;
+
+/* Object type names */
+static const char *tlTypeNames[] =
+{
+  "object", "task", "mutex", "semaphore", "count_sem", "event", "timer",
+  "shared_mem", "ptr_queue", "stream", "queue", "mailbox", "flags",
+  "rwlock", "condvar", "wait_set"
+};
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    tlRead16, tlRead32
+ *
+ *  Description:
+ *    Read a field of the trace in the byte order of the traced CPU.
+ *
+ *  Parameters:
+ *    Data - Pointer to the field.
+ *
+ *  Return:
+ *    Field value.
+ *
+ ***************************************************************************/
+
+static UINT16 tlRead16(const unsigned char *Data)
+{
+  UINT16 Value;
+
+  memcpy(&Value, Data, sizeof(Value));
+  return tlSwap ? (UINT16) ((Value >> 8) | (Value << 8)) : Value;
+}
+
+static UINT32 tlRead32(const unsigned char *Data)
+{
+  UINT32 Value;
+
+  memcpy(&Value, Data, sizeof(Value));
+  return tlSwap ? (UINT32) ((Value >> 24) | ((Value >> 8) & 0xFF00UL) |
+    ((Value << 8) & 0xFF0000UL) | (Value << 24)) : Value;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    tlGetTask
+ *
+ *  Description:
+ *    Finds the decoder state of a task, adding it when not found yet.
+ *
+ *  Parameters:
+ *    Id - Task identifier.
+ *
+ *  Return:
+ *    Pointer to task state or NULL when there are too many tasks.
+ *
+ ***************************************************************************/
+
+static struct TTLTask *tlGetTask(UINT32 Id)
+{
+  int i;
+
+  for(i = 0; i < tlTaskCount; i++)
+    if(tlTasks[i].Id == Id)
+      return &tlTasks[i];
+
+  if(tlTaskCount >= TL_MAX_TASKS)
+    return NULL;
+
+  tlTasks[tlTaskCount].Id = Id;
+  tlTasks[tlTaskCount].Running = 0;
+  tlTasks[tlTaskCount].Waiting = 0;
+  return &tlTasks[tlTaskCount++];
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    tlEvent
+ *
+ *  Description:
+ *    Writes a single Chrome trace event.
+ *
+ *  Parameters:
+ *    Phase - Event phase ("B", "E", "i" or "M").
+ *    Name - Event name.
+ *    Pid, Tid - Process and thread of the event.
+ *    Time - Timestamp in microseconds.
+ *    Args - Arguments object (JSON) or NULL.
+ *
+ ***************************************************************************/
+
+static void tlEvent(const char *Phase, const char *Name, int Pid,
+  UINT32 Tid, double Time, const char *Args)
+{
+  fprintf(tlOut, "%s\n{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":%d,"
+    "\"tid\":%lu,\"ts\":%.3f", tlFirstEvent ? "" : ",", Phase, Name, Pid,
+    (unsigned long) Tid, Time);
+  if(Phase[0] == 'i')
+    fprintf(tlOut, ",\"s\":\"t\"");
+  if(Args)
+    fprintf(tlOut, ",\"args\":%s", Args);
+  fprintf(tlOut, "}");
+  tlFirstEvent = 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    tlDecode
+ *
+ *  Description:
+ *    Converts the binary trace to the Chrome trace event format. Tasks
+ *    running and ISRs are shown in the first process, waits of tasks in
+ *    the second and signals of objects in the third one.
+ *
+ *  Parameters:
+ *    In - Binary trace (header followed by records).
+ *
+ *  Return:
+ *    0 on success, 1 on invalid input.
+ *
+ ***************************************************************************/
+
+static int tlDecode(FILE *In)
+{
+  unsigned char Header[TL_HEADER_SIZE];
+  unsigned char Record[256];
+  char Args[128], Name[64];
+  struct TTLTask *Task, *Prev;
+  UINT32 Magic, Frequency, Lost, Time, LastTime, TaskId, ObjectId, Value;
+  UINT16 RecordSize, Info;
+  UINT8 Event;
+  double Now, Ticks;
+  int i, First;
+
+  /* Check the header (magic written in the byte order of the traced CPU) */
+  if(fread(Header, 1, sizeof(Header), In) != sizeof(Header))
+    return 1;
+
+  tlSwap = 0;
+  Magic = tlRead32(&Header[0]);
+  if(Magic != OS_TRACE_MAGIC)
+  {
+    tlSwap = 1;
+    if(tlRead32(&Header[0]) != OS_TRACE_MAGIC)
+      return 1;
+  }
+
+  RecordSize = tlRead16(&Header[6]);
+  Frequency = tlRead32(&Header[8]);
+  Lost = tlRead32(&Header[12]);
+  if((tlRead16(&Header[4]) != OS_TRACE_VERSION) || !Frequency ||
+    (RecordSize < TL_RECORD_SIZE) || (RecordSize > sizeof(Record)))
+    return 1;
+
+  fprintf(tlOut, "{\"otherData\":{\"lost\":%lu},\"traceEvents\":[",
+    (unsigned long) Lost);
+  tlFirstEvent = 1;
+  tlEvent("M", "process_name", TL_PID_TASKS, 0, 0.0,
+    "{\"name\":\"Running\"}");
+  tlEvent("M", "process_name", TL_PID_WAITS, 0, 0.0,
+    "{\"name\":\"Waiting\"}");
+  tlEvent("M", "process_name", TL_PID_OBJECTS, 0, 0.0,
+    "{\"name\":\"Objects\"}");
+
+  /* The 32-bit timestamp is unwrapped by accumulating differences, the
+     gaps between records must be shorter than one wrap period */
+  Ticks = 0.0;
+  LastTime = 0;
+  First = 1;
+  Now = 0.0;
+  while(fread(Record, 1, RecordSize, In) == RecordSize)
+  {
+    Time = tlRead32(&Record[0]);
+    Event = Record[4];
+    Info = tlRead16(&Record[6]);
+    TaskId = tlRead32(&Record[8]);
+    ObjectId = tlRead32(&Record[12]);
+    Value = tlRead32(&Record[16]);
+
+    if(!First)
+      Ticks += (double) (UINT32) (Time - LastTime);
+    First = 0;
+    LastTime = Time;
+    Now = Ticks * 1000000.0 / (double) Frequency;
+
+    switch(Event)
+    {
+      case OS_TRACE_SWITCH:
+        Prev = ObjectId ? tlGetTask(ObjectId) : NULL;
+        if(Prev && Prev->Running)
+        {
+          tlEvent("E", "running", TL_PID_TASKS, ObjectId, Now, NULL);
+          Prev->Running = 0;
+        }
+
+        Task = tlGetTask(TaskId);
+        if(Task && !Task->Running)
+        {
+          sprintf(Args, "{\"priority\":%u}", (unsigned) Record[5]);
+          tlEvent("B", "running", TL_PID_TASKS, TaskId, Now, Args);
+          Task->Running = 1;
+        }
+        break;
+
+      case OS_TRACE_WAIT_BEGIN:
+        Task = tlGetTask(TaskId);
+        if(Task && !Task->Waiting)
+        {
+          sprintf(Args, "{\"object\":\"0x%08lX\",\"count\":%u,"
+            "\"timeout\":%lu}", (unsigned long) ObjectId, (unsigned) Info,
+            (unsigned long) Value);
+          tlEvent("B", "wait", TL_PID_WAITS, TaskId, Now, Args);
+          Task->Waiting = 1;
+        }
+        break;
+
+      case OS_TRACE_WAIT_END:
+        Task = tlGetTask(TaskId);
+        if(Task && Task->Waiting)
+        {
+          sprintf(Args, "{\"exit_code\":\"0x%04lX\"}", (unsigned long) Value);
+          tlEvent("E", "wait", TL_PID_WAITS, TaskId, Now, Args);
+          Task->Waiting = 0;
+        }
+        break;
+
+      case OS_TRACE_SIGNAL:
+        sprintf(Args, "{\"state\":%lu}", (unsigned long) Value);
+        tlEvent("i", "signal", TL_PID_OBJECTS, ObjectId, Now, Args);
+        break;
+
+      case OS_TRACE_CREATE:
+      case OS_TRACE_DELETE:
+        sprintf(Name, "%s 0x%08lX", (Info < sizeof(tlTypeNames) /
+          sizeof(tlTypeNames[0])) ? tlTypeNames[Info] : "object",
+          (unsigned long) ObjectId);
+        sprintf(Args, "{\"name\":\"%s\"}", Name);
+        if(Event == OS_TRACE_CREATE)
+        {
+          tlEvent("M", "thread_name", TL_PID_OBJECTS, ObjectId, Now, Args);
+          if(Info == OS_OBJECT_TYPE_TASK)
+          {
+            tlEvent("M", "thread_name", TL_PID_TASKS, ObjectId, Now, Args);
+            tlEvent("M", "thread_name", TL_PID_WAITS, ObjectId, Now, Args);
+          }
+        }
+
+        sprintf(Args, "{\"handle\":%lu}", (unsigned long) Value);
+        tlEvent("i", Event == OS_TRACE_CREATE ? "create" : "delete",
+          TL_PID_OBJECTS, ObjectId, Now, Args);
+        break;
+
+      case OS_TRACE_ISR_ENTER:
+        tlEvent("B", "isr", TL_PID_TASKS, 0, Now, NULL);
+        break;
+
+      case OS_TRACE_ISR_EXIT:
+        tlEvent("E", "isr", TL_PID_TASKS, 0, Now, NULL);
+        break;
+    }
+  }
+
+  /* Close slices still open at the end of the trace */
+  for(i = 0; i < tlTaskCount; i++)
+  {
+    if(tlTasks[i].Running)
+      tlEvent("E", "running", TL_PID_TASKS, tlTasks[i].Id, Now, NULL);
+    if(tlTasks[i].Waiting)
+      tlEvent("E", "wait", TL_PID_WAITS, tlTasks[i].Id, Now, NULL);
+  }
+
+  fprintf(tlOut, "\n]}\n");
+  return 0;
+}
+
+
+/****************************************************************************
+ *
+ *  Name:
+ *    main
+ *
+ *  Description:
+ *    Decodes the trace file given as the first argument and writes the
+ *    Chrome trace JSON to the file given as the second argument (or to the
+ *    standard output).
+ *
+ ***************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  FILE *In;
+  int Result;
+
+  if((argc < 2) || (argc > 3))
+  {
+    fprintf(stderr, "Usage: %s <trace.bin> [trace.json]\n", argv[0]);
+    return 2;
+  }
+
+  In = fopen(argv[1], "rb");
+  if(!In)
+  {
+    perror(argv[1]);
+    return 2;
+  }
+
+  tlOut = (argc == 3) ? fopen(argv[2], "w") : stdout;
+  if(!tlOut)
+  {
+    perror(argv[2]);
+    fclose(In);
+    return 2;
+  }
+
+  Result = tlDecode(In);
+  if(Result)
+    fprintf(stderr, "%s: not a valid kernel trace\n", argv[1]);
+
+  fclose(In);
+  if(tlOut != stdout)
+    fclose(tlOut);
+  return Result;
+}
+
+
+/***************************************************************************/